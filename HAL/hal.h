@@ -19,6 +19,13 @@
 
     #include "tm4c1294/hal_common_tm4c.h"
     #include "tm4c1294/hal_ts_tm4c.h"
+    #include "tm4c1294/hal_flash_tm4c.h"
+
+#elif defined(__BOARD_HOST__)
+
+    #include "host/hal_common_host.h"
+    #include "host/hal_ts_host.h"
+    #include "host/hal_flash_host.h"
 
 #elif __BOARD_ATMEGA328P__
 //TODO: Arduino support
@@ -0,0 +1,106 @@
+/**
+ * hal_common_host.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "libs/myLib.h"
+#include "hal_common_host.h"
+
+
+uint32_t g_ui32SysClock;
+
+/// State of emulated global interrupt mask
+static bool _intMasked = false;
+
+/// Number of PWM channels emulated on host
+#define HOST_PWM_CHANNELS   8
+static uint32_t _pwmOut[HOST_PWM_CHANNELS];
+
+/**
+ *  Dummy function to be called to suppress "Unused variable" warnings
+ */
+void UNUSED (int32_t arg) { (void)arg; }
+
+/**
+ * Pretend to run board at the same clock as TM4C1294 so that any code deriving
+ * timings from g_ui32SysClock behaves the same on host
+ */
+void HAL_BOARD_CLOCK_Init()
+{
+    g_ui32SysClock = 120000000;
+}
+
+/**
+ * Software-triggered reboot -> on host simply terminates the process
+ */
+void HAL_BOARD_Reset()
+{
+    exit(0);
+}
+
+/**
+ * Wait for given amount of us - host runs on virtual time so this is no-op
+ * @param us time in us to wait
+ */
+void HAL_DelayUS(uint32_t us)
+{
+    UNUSED(us);
+}
+
+/**
+ * There are no interrupts on host, all code runs in a single thread. Only the
+ * state of the mask is kept so that HAL_BOARD_InterruptMasked() matches target
+ */
+void HAL_BOARD_InterruptEnable(bool enable)
+{
+    _intMasked = !enable;
+}
+
+/**
+ * Check whether interrupts are globally disabled
+ * @return true if interrupts are disabled
+ */
+bool HAL_BOARD_InterruptMasked()
+{
+    return _intMasked;
+}
+
+/**
+ * Atomic compare-and-swap; also safe between host threads
+ * @param addr word to update
+ * @param expected value the word must hold for the update to happen
+ * @param desired new value of the word
+ * @return true if word held [expected] and was set to [desired]
+ */
+bool HAL_BOARD_AtomicCAS(volatile uint32_t *addr, uint32_t expected,
+                         uint32_t desired)
+{
+    return __sync_bool_compare_and_swap(addr, expected, desired);
+}
+
+/**
+ * Set desired PWM duty cycle on specific output channel
+ * @param id is channel ID of PWM channel affected
+ * @param pwm value of PWM pulse (duty cycle) to set
+ */
+void HAL_SetPWM(uint32_t id, uint32_t pwm)
+{
+    if (id < HOST_PWM_CHANNELS)
+        _pwmOut[id] = pwm;
+}
+
+/**
+ * Get current PWM duty cycle on specific output channel
+ * @param id is channel ID of PWM channel affected
+ * @return PWM duty cycle at channel id
+ */
+uint32_t HAL_GetPWM(uint32_t id)
+{
+    return (id < HOST_PWM_CHANNELS) ? _pwmOut[id] : 0;
+}
+
+#endif  /* __BOARD_HOST__ */
@@ -0,0 +1,46 @@
+/**
+ * hal_common_host.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Host (PC) stand-in for the board HAL. Used to build kernel modules as a
+ *  regular Linux executable for simulation and benchmarking. Interface is kept
+ *  the same as in HAL/tm4c1294/hal_common_tm4c.h
+ */
+#include "hwconfig.h"
+
+#ifndef ROVERKERNEL_HAL_HOST_HAL_COMMON_HOST_H_
+#define ROVERKERNEL_HAL_HOST_HAL_COMMON_HOST_H_
+
+#define HAL_OK                  0
+
+//  Memory barrier; on host it only has to stop the compiler from moving memory
+//  accesses across it since "interrupts" run on the same thread
+#define HAL_BOARD_MemBarrier()  __asm__ __volatile__("" ::: "memory")
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// Global clock variable
+extern uint32_t g_ui32SysClock;
+
+
+extern void         HAL_DelayUS(uint32_t us);
+extern void         HAL_BOARD_CLOCK_Init();
+extern void         HAL_BOARD_Reset();
+extern void         UNUSED (int32_t arg);
+extern void         HAL_BOARD_InterruptEnable(bool enable);
+extern bool         HAL_BOARD_InterruptMasked();
+extern bool         HAL_BOARD_AtomicCAS(volatile uint32_t *addr,
+                                        uint32_t expected, uint32_t desired);
+
+extern void         HAL_SetPWM(uint32_t id, uint32_t pwm);
+extern uint32_t     HAL_GetPWM(uint32_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_HOST_HAL_COMMON_HOST_H_ */
@@ -0,0 +1,160 @@
+/**
+ * hal_flash_host.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "hal_flash_host.h"
+
+#if defined(__BOARD_HOST__) && defined(__HAL_USE_EVLOGSTORE__)
+
+#include "libs/myLib.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define HOST_FLASH_SIZE     (HAL_FLASH_SECTORS * HAL_FLASH_SECTOR_SIZE)
+
+///Emulated region; points either to _flashRAM or to a file mapped in memory
+static uint8_t _flashRAM[HOST_FLASH_SIZE];
+static uint8_t *_flash = 0;
+static int _flashFd = -1;
+///Number of erases of each sector since the process started
+static uint32_t _erases[HAL_FLASH_SECTORS];
+
+/**
+ * Make sure region is available; without a file it starts erased in RAM
+ */
+static uint8_t* _HostFlash()
+{
+    if (_flash == 0)
+    {
+        memset(_flashRAM, 0xFF, HOST_FLASH_SIZE);
+        _flash = _flashRAM;
+    }
+
+    return _flash;
+}
+
+/**
+ * Back flash region with a file, content written so far is kept in the file
+ * and is there after the next HAL_FLASH_HostOpen() with the same file, just
+ * like on-chip flash survives a reboot. New file starts erased.
+ * @param path file to use
+ * @return true on success
+ */
+bool HAL_FLASH_HostOpen(const char *path)
+{
+    off_t size;
+    void *map;
+
+    HAL_FLASH_HostClose();
+
+    if ((_flashFd = open(path, O_RDWR | O_CREAT, 0644)) < 0)
+        return false;
+
+    //  Extend new (or short) file with erased bytes
+    size = lseek(_flashFd, 0, SEEK_END);
+    if (size < HOST_FLASH_SIZE)
+    {
+        uint8_t erased[256];
+
+        memset(erased, 0xFF, sizeof(erased));
+        while (size < HOST_FLASH_SIZE)
+        {
+            uint32_t n = HOST_FLASH_SIZE - size;
+
+            if (n > sizeof(erased))
+                n = sizeof(erased);
+            if (write(_flashFd, erased, n) != (ssize_t)n)
+                break;
+            size += n;
+        }
+    }
+
+    map = mmap(0, HOST_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+               _flashFd, 0);
+    if ((size < HOST_FLASH_SIZE) || (map == MAP_FAILED))
+    {
+        close(_flashFd);
+        _flashFd = -1;
+        return false;
+    }
+    _flash = (uint8_t*)map;
+
+    return true;
+}
+
+/**
+ * Write out and unmap the file; flash falls back to an erased RAM region
+ */
+void HAL_FLASH_HostClose()
+{
+    if (_flashFd < 0)
+        return;
+
+    msync(_flash, HOST_FLASH_SIZE, MS_SYNC);
+    munmap(_flash, HOST_FLASH_SIZE);
+    close(_flashFd);
+    _flashFd = -1;
+    _flash = 0;
+}
+
+/**
+ * Number of times a sector was erased since the process started
+ */
+uint32_t HAL_FLASH_HostErases(uint32_t sector)
+{
+    return (sector < HAL_FLASH_SECTORS) ? _erases[sector] : 0;
+}
+
+/**
+ * Erase a sector of flash region, setting all of its bytes to 0xFF
+ * @param sector index of sector within region
+ * @return true on success
+ */
+bool HAL_FLASH_Erase(uint32_t sector)
+{
+    if (sector >= HAL_FLASH_SECTORS)
+        return false;
+
+    memset(_HostFlash() + sector*HAL_FLASH_SECTOR_SIZE, 0xFF,
+           HAL_FLASH_SECTOR_SIZE);
+    _erases[sector]++;
+
+    return true;
+}
+
+/**
+ * Program data into flash region; like on NOR flash, bits can only be cleared
+ * @param offset offset from start of region, multiple of 4
+ * @param src data to program
+ * @param len number of bytes to program, multiple of 4
+ * @return true on success
+ */
+bool HAL_FLASH_Program(uint32_t offset, const uint32_t *src, uint32_t len)
+{
+    uint8_t *dst = _HostFlash() + offset;
+    const uint8_t *s = (const uint8_t*)src;
+
+    if (((offset | len) & 0x03) || ((offset + len) > HOST_FLASH_SIZE))
+        return false;
+
+    for (uint32_t i = 0; i < len; i++)
+        dst[i] &= s[i];
+
+    return true;
+}
+
+/**
+ * Read data from flash region
+ * @param offset offset from start of region
+ * @param dst destination buffer
+ * @param len number of bytes to read
+ */
+void HAL_FLASH_Read(uint32_t offset, void *dst, uint32_t len)
+{
+    memcpy(dst, _HostFlash() + offset, len);
+}
+
+#endif  /* __BOARD_HOST__ && __HAL_USE_EVLOGSTORE__ */
@@ -0,0 +1,42 @@
+/**
+ * hal_flash_host.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ ****Hardware dependencies:
+ *  None - flash region is emulated in RAM, optionally backed by a file so its
+ *  content survives the process (see HAL_FLASH_HostOpen()). NOR semantics are
+ *  kept: erase sets bytes to 0xFF, programming can only clear bits.
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_HOST_HAL_FLASH_HOST_H_) \
+    && defined(__HAL_USE_EVLOGSTORE__)
+#define ROVERKERNEL_HAL_HOST_HAL_FLASH_HOST_H_
+
+//  Same geometry as the flash region on TM4C1294
+#define HAL_FLASH_BASE          0x000F0000
+#define HAL_FLASH_SECTOR_SIZE   0x4000
+#define HAL_FLASH_SECTORS       4
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+/**     Flash - related API, offsets are relative to HAL_FLASH_BASE     */
+extern bool        HAL_FLASH_Erase(uint32_t sector);
+extern bool        HAL_FLASH_Program(uint32_t offset, const uint32_t *src,
+                                     uint32_t len);
+extern void        HAL_FLASH_Read(uint32_t offset, void *dst, uint32_t len);
+
+/**     Host-only API for backing flash with a file     */
+extern bool        HAL_FLASH_HostOpen(const char *path);
+extern void        HAL_FLASH_HostClose();
+extern uint32_t    HAL_FLASH_HostErases(uint32_t sector);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_HOST_HAL_FLASH_HOST_H_ */
@@ -0,0 +1,85 @@
+/**
+ * hal_ts_host.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "hal_ts_host.h"
+
+#if defined(__BOARD_HOST__) && defined(__HAL_USE_TASKSCH__)
+
+#include "libs/myLib.h"
+
+///Keep track whether the SysTick has already been configured
+static bool _systickSet = false;
+static bool _systickRun = false;
+static uint32_t _periodMS = 0;
+static void ((*_tickHook)(void)) = 0;
+
+/**
+ * Setup virtual SysTick period and the function called on every tick
+ * @param periodMs time in milliseconds between two ticks
+ * @param custHook pointer to function that will be called on SysTick "interrupt"
+ * @return HAL library error code
+ */
+uint8_t HAL_TS_InitSysTick(uint32_t periodMs,void((*custHook)(void)))
+{
+    /// Forbid configuring the timer period multiple times
+    if (_systickSet)
+        return HAL_SYSTICK_SET_ERR;
+    if (periodMs < 1)
+        return HAL_SYSTICK_PEROOR;
+
+    _tickHook = custHook;
+    _periodMS = periodMs;
+    _systickSet = true;
+
+    return 0;
+}
+
+/**
+ * Start virtual SysTick - HAL_TS_SimTick() calls hook only while running
+ */
+uint8_t HAL_TS_StartSysTick()
+{
+    if(!_systickSet)
+        return HAL_SYSTICK_NOTSET_ERR;
+
+    _systickRun = true;
+    return 0;
+}
+
+/**
+ * Stop virtual SysTick
+ */
+uint8_t HAL_TS_StopSysTick()
+{
+    if(!_systickSet)
+        return HAL_SYSTICK_NOTSET_ERR;
+
+    _systickRun = false;
+    return 0;
+}
+
+/**
+ * Calculate time step between two SysTick interrupts (in milliseconds)
+ * @return time step between two SysTicks (in ms)
+ */
+uint32_t HAL_TS_GetTimeStepMS()
+{
+    return _periodMS;
+}
+
+/**
+ * Emulate a number of SysTick interrupts by calling the registered hook
+ * @param ticks number of SysTick periods to emulate
+ */
+void HAL_TS_SimTick(uint32_t ticks)
+{
+    if (!_systickRun || (_tickHook == 0))
+        return;
+
+    while ((ticks--) > 0)
+        _tickHook();
+}
+
+#endif  /* __BOARD_HOST__ && __HAL_USE_TASKSCH__ */
@@ -0,0 +1,38 @@
+/**
+ * hal_ts_host.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ ****Hardware dependencies:
+ *  None - SysTick is replaced by a virtual clock which is advanced by whoever
+ *  drives the host build (e.g. simulation harness in host/tsSim.cpp)
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_HOST_HAL_TS_HOST_H_) && defined(__HAL_USE_TASKSCH__)
+#define ROVERKERNEL_HAL_HOST_HAL_TS_HOST_H_
+
+/**     SysTick peripheral error codes      */
+#define HAL_SYSTICK_PEROOR      1   /// Period value for SysTick is out of range
+#define HAL_SYSTICK_SET_ERR     2   /// SysTick has already been configured
+#define HAL_SYSTICK_NOTSET_ERR  3   /// SysTick hasn't been configured yet
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+/**     TaskScheduler - related API     */
+extern uint8_t     HAL_TS_InitSysTick(uint32_t periodMs, void((*custHook)(void)));
+extern uint8_t     HAL_TS_StartSysTick();
+extern uint8_t     HAL_TS_StopSysTick();
+extern uint32_t    HAL_TS_GetTimeStepMS();
+
+/**     Host-only API for driving virtual SysTick     */
+extern void        HAL_TS_SimTick(uint32_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_HOST_HAL_TS_HOST_H_ */
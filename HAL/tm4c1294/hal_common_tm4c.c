@@ -20,6 +20,7 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/fpu.h"
 #include "driverlib/interrupt.h"
+#include "driverlib/cpu.h"
 #include "driverlib/pwm.h"
 
 
@@ -84,6 +85,42 @@ void HAL_BOARD_InterruptEnable(bool enable)
     else
         IntMasterDisable();
 }
+
+/**
+ * Check whether interrupts are globally disabled (PRIMASK set), e.g. before
+ * a function disables them, so it knows whether it may enable them again
+ * @return true if interrupts are disabled
+ */
+bool HAL_BOARD_InterruptMasked()
+{
+    return (CPUprimask() != 0);
+}
+
+/**
+ * Atomic compare-and-swap, usable from both thread mode and interrupts
+ * without masking them. Built on exclusive load/store: exception entry clears
+ * the exclusive monitor, so a store interrupted by an ISR that touched the
+ * same word fails and is retried.
+ * @param addr word to update
+ * @param expected value the word must hold for the update to happen
+ * @param desired new value of the word
+ * @return true if word held [expected] and was set to [desired]
+ */
+bool HAL_BOARD_AtomicCAS(volatile uint32_t *addr, uint32_t expected,
+                         uint32_t desired)
+{
+    do
+    {
+        if (__ldrex((void*)addr) != expected)
+        {
+            __clrex();
+            return false;
+        }
+    } while (__strex(desired, (void*)addr) != 0);
+
+    HAL_BOARD_MemBarrier();
+    return true;
+}
 /**
  * Set desired PWM duty cycle on specific output channel
  * @param id is channel ID of PWM channel affected
@@ -11,6 +11,10 @@
 
 #define HAL_OK                  0
 
+//  Data memory barrier; also stops the compiler from moving memory accesses
+//  across it. Single-core M4 needs it only to order accesses against ISRs
+#define HAL_BOARD_MemBarrier()  __asm(" dmb")
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -26,6 +30,9 @@ extern void         HAL_BOARD_Reset();
 extern void         UNUSED (int32_t arg);
 extern uint32_t     _TM4CMsToCycles(uint32_t ms);
 extern void         HAL_BOARD_InterruptEnable(bool enable);
+extern bool         HAL_BOARD_InterruptMasked();
+extern bool         HAL_BOARD_AtomicCAS(volatile uint32_t *addr,
+                                        uint32_t expected, uint32_t desired);
 
 extern void         HAL_SetPWM(uint32_t id, uint32_t pwm);
 extern uint32_t     HAL_GetPWM(uint32_t id);
@@ -0,0 +1,60 @@
+/**
+ * hal_flash_tm4c.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "hal_flash_tm4c.h"
+
+#if  defined(__HAL_USE_EVLOGSTORE__)   //  Compile only if module is enabled
+
+#include "libs/myLib.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+
+#include "driverlib/rom_map.h"
+#include "driverlib/rom.h"
+#include "driverlib/flash.h"
+
+/**
+ * Erase a sector of flash region, setting all of its bytes to 0xFF
+ * @param sector index of sector within region
+ * @return true on success
+ */
+bool HAL_FLASH_Erase(uint32_t sector)
+{
+    if (sector >= HAL_FLASH_SECTORS)
+        return false;
+
+    return MAP_FlashErase(HAL_FLASH_BASE + sector*HAL_FLASH_SECTOR_SIZE) == 0;
+}
+
+/**
+ * Program data into flash region; bits can only be cleared, so every word
+ * should be programmed once after its sector was erased
+ * @param offset offset from start of region, multiple of 4
+ * @param src data to program
+ * @param len number of bytes to program, multiple of 4
+ * @return true on success
+ */
+bool HAL_FLASH_Program(uint32_t offset, const uint32_t *src, uint32_t len)
+{
+    if (((offset | len) & 0x03) ||
+        ((offset + len) > (HAL_FLASH_SECTORS * HAL_FLASH_SECTOR_SIZE)))
+        return false;
+
+    return MAP_FlashProgram((uint32_t*)src, HAL_FLASH_BASE + offset, len) == 0;
+}
+
+/**
+ * Read data from flash region; flash is memory-mapped so this is a plain copy
+ * @param offset offset from start of region
+ * @param dst destination buffer
+ * @param len number of bytes to read
+ */
+void HAL_FLASH_Read(uint32_t offset, void *dst, uint32_t len)
+{
+    memcpy(dst, (const void*)(HAL_FLASH_BASE + offset), len);
+}
+
+#endif  /* __HAL_USE_EVLOGSTORE__ */
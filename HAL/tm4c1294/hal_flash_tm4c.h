@@ -0,0 +1,39 @@
+/**
+ * hal_flash_tm4c.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ ****Hardware dependencies:
+ *  Internal flash memory, region at its top reserved in tm4c1294ncpdt.cmd
+ *  @note Program and erase stall the CPU while they run since code executes
+ *  from the same flash (erase of a sector takes up to 15ms). Interrupts are
+ *  serviced late, not lost.
+ */
+#include "hwconfig.h"
+
+//  Compile following section only if hwconfig.h says to include this module
+#if !defined(ROVERKERNEL_HAL_TM4C1294_HAL_FLASH_TM4C_H_) \
+    && defined(__HAL_USE_EVLOGSTORE__)
+#define ROVERKERNEL_HAL_TM4C1294_HAL_FLASH_TM4C_H_
+
+//  Region of flash used for persistent data: HAL_FLASH_SECTORS erase sectors
+//  of HAL_FLASH_SECTOR_SIZE bytes starting at HAL_FLASH_BASE
+#define HAL_FLASH_BASE          0x000F0000
+#define HAL_FLASH_SECTOR_SIZE   0x4000
+#define HAL_FLASH_SECTORS       4
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+/**     Flash - related API, offsets are relative to HAL_FLASH_BASE     */
+extern bool        HAL_FLASH_Erase(uint32_t sector);
+extern bool        HAL_FLASH_Program(uint32_t offset, const uint32_t *src,
+                                     uint32_t len);
+extern void        HAL_FLASH_Read(uint32_t offset, void *dst, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROVERKERNEL_HAL_TM4C1294_HAL_FLASH_TM4C_H_ */
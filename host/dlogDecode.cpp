@@ -0,0 +1,353 @@
+/**
+ * dlogDecode.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Decoder for deferred log records (host build only)
+ *  Reads a capture of the serial link (raw bytes, e.g. dumped from a terminal
+ *  program), picks out SP_T_LOG frames and prints records as text using the
+ *  format table from serialPort/logFormats.h. Plain text sharing the link is
+ *  skipped by the frame decoder. Lost batches are reported through gaps in
+ *  frame sequence numbers.
+ *  With -t, runs a self-check instead: emits a stream of records, decodes it
+ *  and compares every line with text produced by snprintf for the same
+ *  arguments. Reports bytes on the link and time spent in the call site for
+ *  both approaches; exit status is non-zero on any mismatch.
+ *
+ *  Usage: dlogDecode [captureFile]         (stdin if no file is given)
+ *         dlogDecode -t [-n records] [-s seed] [-v]
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "serialPort/serialProto.h"
+#include "serialPort/deferredLog.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+//  Link from MCU to PC
+static std::vector<uint8_t> _link;
+//  Decoded lines
+static std::vector<std::string> _lines;
+static bool _print = true;
+
+static inline uint64_t DecNowNs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/**
+ * Small xorshift PRNG -> same stream on every platform for a given seed
+ */
+static uint32_t _rndState;
+static uint32_t DecRand(uint32_t lo, uint32_t hi)
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    if (hi <= lo)
+        return lo;
+    return lo + (_rndState % (hi - lo + 1));
+}
+
+/**
+ * Sink of deferred log, i.e. SerialPort::SendRaw on target
+ */
+static void DecSink(const uint8_t *frame, uint16_t len)
+{
+    _link.insert(_link.end(), frame, frame + len);
+}
+
+/**
+ * Called by DLog_Decode for every record
+ */
+static void DecLine(uint64_t time, const char *text)
+{
+    if (_print)
+        printf("[%llu] %s", (unsigned long long)time, text);
+    _lines.push_back(text);
+}
+
+/**
+ * Run all bytes of the link through frame decoder and decode log batches
+ * @return number of batches that couldn't be decoded
+ */
+static uint32_t DecStream(const std::vector<uint8_t> &data, uint32_t &frames,
+                          uint32_t &lost)
+{
+    SPDecoder dec;
+    uint32_t bad = 0;
+    uint8_t expSeq = 0;
+
+    frames = lost = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if (!dec.Feed(data[i]))
+            continue;
+
+        const struct _spFrame &f = dec.GetFrame();
+        if (f.type != SP_T_LOG)
+            continue;
+
+        if ((frames > 0) && (f.seq != expSeq))
+            lost += (uint8_t)(f.seq - expSeq);
+        expSeq = f.seq + 1;
+        frames++;
+
+        if (!DLog_Decode(f.payload, f.len, DecLine))
+            bad++;
+    }
+
+    return bad;
+}
+
+/**
+ * Arguments of a single record in self-check
+ */
+struct _decArgs
+{
+    uint16_t    id;
+    uint8_t     dt;         //  Time since previous record
+    int32_t     a, b;
+    uint32_t    u;
+    float       f;
+    const char  *s;
+};
+
+/**
+ * Log record through deferred logging
+ */
+static void DecEmit(const struct _decArgs &r)
+{
+    switch (r.id)
+    {
+    case DLOG_ID_TS_NOW:
+        DLog_Emit(r.id, r.u);
+        break;
+    case DLOG_ID_TS_PROCESS:
+        DLog_Emit(r.id, r.a, r.b, r.u);
+        break;
+    case DLOG_ID_TS_PROCESS_ARGS:
+        DLog_Emit(r.id, r.a, r.s);
+        break;
+    case DLOG_ID_EL_EVENT:
+        DLog_Emit(r.id, r.u, r.a, r.s, r.b);
+        break;
+    case DLOG_ID_EL_SUPPRESSED:
+        DLog_Emit(r.id, r.u, r.a, r.b, r.s);
+        break;
+    case DLOG_ID_TM_PRINT_INT:
+        DLog_Emit(r.id, r.a);
+        break;
+    case DLOG_ID_TM_PRINT_STR:
+        DLog_Emit(r.id, r.s);
+        break;
+    case DLOG_ID_TM_PRINT_FLOAT:
+        DLog_Emit(r.id, r.f);
+        break;
+    case DLOG_ID_TS_PROF:
+        DLog_Emit(r.id, r.a, r.b, r.u, r.u, r.u % 1000, r.b, r.u, r.u);
+        break;
+    case DLOG_ID_TS_PROF_DROPPED:
+        DLog_Emit(r.id, r.u);
+        break;
+    default:
+        DLog_Emit(r.id);
+        break;
+    }
+}
+
+/**
+ * Format the same record as text, as it's done without deferred logging
+ */
+static int DecFormat(char *dst, size_t len, const struct _decArgs &r)
+{
+    const char *fmt = DLog_Formats[r.id].fmt;
+
+    switch (r.id)
+    {
+    case DLOG_ID_TS_NOW:
+        return snprintf(dst, len, fmt, r.u);
+    case DLOG_ID_TS_PROCESS:
+        return snprintf(dst, len, fmt, r.a, r.b, r.u);
+    case DLOG_ID_TS_PROCESS_ARGS:
+        return snprintf(dst, len, fmt, r.a, r.s);
+    case DLOG_ID_EL_EVENT:
+        return snprintf(dst, len, fmt, r.u, r.a, r.s, r.b);
+    case DLOG_ID_EL_SUPPRESSED:
+        return snprintf(dst, len, fmt, r.u, r.a, r.b, r.s);
+    case DLOG_ID_TM_PRINT_INT:
+        return snprintf(dst, len, fmt, r.a);
+    case DLOG_ID_TM_PRINT_STR:
+        return snprintf(dst, len, fmt, r.s);
+    case DLOG_ID_TM_PRINT_FLOAT:
+        return snprintf(dst, len, fmt, r.f);
+    case DLOG_ID_TS_PROF:
+        return snprintf(dst, len, fmt, r.a, r.b, r.u, r.u, r.u % 1000, r.b,
+                        r.u, r.u);
+    case DLOG_ID_TS_PROF_DROPPED:
+        return snprintf(dst, len, fmt, r.u);
+    default:
+        return snprintf(dst, len, "%s", fmt);
+    }
+}
+
+/**
+ * Emit a stream of records, decode it and compare it with snprintf output
+ * @return number of mismatches
+ */
+static uint32_t DecSelfCheck(uint32_t nRec, bool verbose)
+{
+    static const char *strs[] = { "EVENT_STARTUP", "EVENT_OK", "EVENT_ERROR",
+                                  "Printing at T+4s", "", "x" };
+    const uint32_t nStrs = sizeof(strs) / sizeof(strs[0]);
+    std::vector<struct _decArgs> recs(nRec);
+    std::vector<std::string> expected(nRec);
+    uint64_t textBytes = 0, t0, tEmit, tText;
+    uint32_t frames, lost, bad, errors = 0;
+    char text[512];
+
+    TaskScheduler::GetI().InitHW(1);
+    DLog_SetSink(DecSink);
+    //  Link on target is a preallocated ring, keep allocations out of timing
+    _link.resize((size_t)nRec * 16);
+    _link.clear();
+
+    for (uint32_t i = 0; i < nRec; i++)
+    {
+        recs[i].id = (uint16_t)DecRand(0, DLOG_NUM_FMT - 1);
+        recs[i].dt = (uint8_t)DecRand(0, 3);
+        recs[i].a = (int32_t)DecRand(0, 2000) - 1000;
+        recs[i].b = (int32_t)DecRand(0, 255);
+        recs[i].u = DecRand(0, 0xFFFFFFFE) ^ DecRand(0, 0xFFFF);
+        recs[i].f = (float)((int32_t)DecRand(0, 200000) - 100000) / 100.0f;
+        recs[i].s = strs[DecRand(0, nStrs - 1)];
+    }
+
+    //  Deferred: time spent by call sites, including sending of batches
+    t0 = DecNowNs();
+    for (uint32_t i = 0; i < nRec; i++)
+    {
+        msSinceStartup += recs[i].dt;
+        DecEmit(recs[i]);
+    }
+    DLog_Flush(true);
+    tEmit = DecNowNs() - t0;
+
+    //  Text: time spent formatting the same records
+    t0 = DecNowNs();
+    for (uint32_t i = 0; i < nRec; i++)
+        textBytes += DecFormat(text, sizeof(text), recs[i]);
+    tText = DecNowNs() - t0;
+
+    for (uint32_t i = 0; i < nRec; i++)
+    {
+        DecFormat(text, sizeof(text), recs[i]);
+        expected[i] = text;
+    }
+
+    _print = verbose;
+    bad = DecStream(_link, frames, lost);
+
+    if ((bad > 0) || (lost > 0) || (_lines.size() != nRec))
+    {
+        printf("Stream error: %u bad batches, %u lost, %zu of %u records\n",
+               bad, lost, _lines.size(), nRec);
+        errors++;
+    }
+    for (uint32_t i = 0; (i < nRec) && (i < _lines.size()); i++)
+        if (_lines[i] != expected[i])
+        {
+            if (errors < 10)
+                printf("Mismatch at %u:\n  got: %s  exp: %s", i,
+                       _lines[i].c_str(), expected[i].c_str());
+            errors++;
+        }
+    if (DLog_Dropped() > 0)
+    {
+        printf("Dropped records: %u\n", DLog_Dropped());
+        errors++;
+    }
+
+    printf("Records: %u in %u batches\n", nRec, frames);
+    printf("Link bytes: %zu deferred vs %llu text (%.1fx smaller)\n",
+           _link.size(), (unsigned long long)textBytes,
+           (double)textBytes / (double)_link.size());
+    printf("Call site: %.1f ns/record deferred vs %.1f ns/record snprintf\n",
+           (double)tEmit / nRec, (double)tText / nRec);
+    printf("%s\n", (errors == 0) ? "OK" : "FAILED");
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = 0;
+    bool selfCheck = false, verbose = false;
+    uint32_t nRec = 100000;
+
+    _rndState = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-t"))
+            selfCheck = true;
+        else if (!strcmp(argv[i], "-n") && (i+1 < argc))
+            nRec = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+            _rndState = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else if ((argv[i][0] != '-') && (path == 0))
+            path = argv[i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [captureFile]\n"
+                            "       %s -t [-n records] [-s seed] [-v]\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (_rndState == 0)
+        _rndState = 1;
+
+    if (selfCheck)
+        return (DecSelfCheck(nRec, verbose) == 0) ? 0 : 2;
+
+    /*
+     *  Decode capture of the link
+     */
+    FILE *in = (path != 0) ? fopen(path, "rb") : stdin;
+    std::vector<uint8_t> data;
+    uint32_t frames, lost, bad;
+    uint8_t buf[4096];
+    size_t n;
+
+    if (in == 0)
+    {
+        fprintf(stderr, "Can't open %s\n", path);
+        return 1;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    if (in != stdin)
+        fclose(in);
+
+    bad = DecStream(data, frames, lost);
+    fprintf(stderr, "%u batches, %zu records, %u batches lost, %u undecodable "
+                    "(table CRC 0x%04X)\n",
+            frames, _lines.size(), lost, bad, DLog_TableCRC());
+
+    return (bad == 0) ? 0 : 2;
+}
+
+#endif  /* __BOARD_HOST__ */
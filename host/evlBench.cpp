@@ -0,0 +1,579 @@
+/**
+ * evlBench.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Benchmark of event log hot paths (host build only)
+ *  EventLog::EmitEvent() runs after every dispatched service (EMIT_EV in
+ *  kernel callbacks), so its cost is added to every task. It's timed over
+ *  several mixes of modules and events, each taking a different path through
+ *  it:
+ *      repeat      one module repeating OK, all but the first are dropped
+ *                  and counted by the repeat filter
+ *      dispatch    10 modules reporting OK after services, with occasional
+ *                  hang/error followed by reinitialization
+ *      logged      startup/initialized/OK cycles, every event is logged
+ *      prioinv     error/OK pairs, every OK adds a priority inversion
+ *      ratelimit   module alternating OK/hang faster than its rate limit
+ *      disabled    dispatch mix with recording disabled (counters only)
+ *      rules       dispatch mix with a reactive rule on every module that
+ *                  fires on every 4th OK, ScheduleRules() is called after
+ *                  every event as if from main loop
+ *  Rate limits are off for logged and prioinv, so that every event takes the
+ *  measured path. DropBefore() (half of a full log) and Reset() (full log)
+ *  are timed on a log filled with the logged mix.
+ *  Results are printed to stdout as CSV, one line per benchmark case:
+ *      bench,mix,ops,ns_per_op,allocs_per_op,logged_per_op,bytes_per_1k
+ *  logged_per_op is the number of log entries per emitted event and
+ *  bytes_per_1k the RAM of the log taken by 1000 of those entries. Column set
+ *  and their order are kept stable; ns_per_op is the median of BENCH_REPS
+ *  repetitions. Lines starting with '#' are comments.
+ *  With -c, results are compared with a previous output and exit status is
+ *  non-zero if a case got slower by more than -t percent (default 25), or
+ *  allocates more or takes over BENCH_BYTES_TOL more memory than before.
+ *
+ *  Usage: evlBench [-q] [-f filter] [-c baseline.csv] [-t percent]
+ *      -q          quick run (fewer events, used for smoke-testing)
+ *      -f filter   run only cases whose bench or mix contains 'filter'
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "init/eventLog.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <new>
+
+//  Unique identifier of module serving tasks scheduled by rules
+#define BENCH_UID       8
+//  Number of repetitions of each benchmark case (median is reported)
+#define BENCH_REPS      5
+//  Events emitted in single repetition of emit benchmarks
+#define BENCH_OPS       200000
+#define BENCH_OPS_QUICK 20000
+//  Drops/resets timed in single repetition (log is refilled for each)
+#define BENCH_FILLS     64
+//  Cases kept from baseline file
+#define BENCH_MAX_CASES 64
+//  Growth of bytes_per_1k tolerated by -c; depends on time deltas between
+//  entries, so it changes a little with the cases run before
+#define BENCH_BYTES_TOL 0.05
+
+/*******************************************************************************
+ *********             Allocation counting & timing                    *********
+ ******************************************************************************/
+static uint64_t _allocCnt = 0;
+
+void* operator new(size_t size)
+{
+    _allocCnt++;
+    void *p = malloc(size ? size : 1);
+    if (p == 0)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static inline uint64_t BenchNowNs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/**
+ * Result of single repetition of a benchmark case
+ */
+struct _benchRes
+{
+    uint64_t ns;        //  Time spent in measured section
+    uint64_t allocs;    //  Allocations made in measured section
+    uint32_t ops;       //  Number of operations in measured section
+    uint32_t logged;    //  Log entries added in measured section
+    double   bytes;     //  Log memory per 1000 entries, 0 if log isn't full
+};
+
+/*******************************************************************************
+ *********             Workload                                        *********
+ ******************************************************************************/
+/**
+ * Single pre-generated call of EmitEvent(), generation is kept out of timing
+ */
+struct _benchOp
+{
+    uint8_t  libUID;
+    int8_t   taskID;
+    uint8_t  event;
+    uint16_t stepMs;    //  Time passing before the event
+};
+
+//  Mixes of modules and events, see top of the file
+enum BenchMix { MIX_REPEAT, MIX_DISPATCH, MIX_LOGGED, MIX_PRIOINV,
+                MIX_RATELIMIT, MIX_DISABLED, MIX_RULES, MIX_COUNT };
+static const char *_mixName[MIX_COUNT] = {"repeat", "dispatch", "logged",
+                                          "prioinv", "ratelimit", "disabled",
+                                          "rules"};
+
+static uint32_t _rndState = 1;
+static uint32_t BenchRand()
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+    return _rndState;
+}
+
+static _benchOp _ops[BENCH_OPS];
+static uint32_t _nOps = BENCH_OPS;
+
+/**
+ * Generate events of a mix into _ops[]
+ */
+static void BenchGenerate(BenchMix mix)
+{
+    static const Events cycle[3] = {EVENT_STARTUP, EVENT_INITIALIZED,
+                                    EVENT_OK};
+    //  Step of each module through reinitialization after a fault
+    uint8_t faultStep[NUM_OF_MODULES] = {0};
+
+    _rndState = 1;
+    for (uint32_t i = 0; i < _nOps; i++)
+    {
+        _benchOp &op = _ops[i];
+
+        op.libUID = (uint8_t)(i % NUM_OF_MODULES);
+        op.taskID = (int8_t)(BenchRand() % 8);
+        op.stepMs = 1;
+
+        switch (mix)
+        {
+        case MIX_REPEAT:
+            op.libUID = 3;
+            op.event = EVENT_OK;
+            break;
+        case MIX_LOGGED:
+            op.event = cycle[(i / NUM_OF_MODULES) % 3];
+            break;
+        case MIX_PRIOINV:
+            op.event = ((i / NUM_OF_MODULES) & 1) ? EVENT_OK : EVENT_ERROR;
+            break;
+        case MIX_RATELIMIT:
+            op.libUID = 3;
+            op.event = (i & 1) ? EVENT_OK : EVENT_HANG;
+            break;
+        default:
+            //  Dispatch: one in 256 services hangs or fails, module then goes
+            //  through reinitialization over its next two events
+            op.stepMs = (uint16_t)(BenchRand() % 4);
+            if (faultStep[op.libUID] == 0)
+            {
+                op.event = EVENT_OK;
+                if ((BenchRand() % 256) == 0)
+                {
+                    op.event = (BenchRand() & 1) ? EVENT_HANG : EVENT_ERROR;
+                    faultStep[op.libUID] = 1;
+                }
+            }
+            else
+            {
+                op.event = (faultStep[op.libUID] == 1) ? EVENT_STARTUP :
+                                                         EVENT_INITIALIZED;
+                faultStep[op.libUID] = (faultStep[op.libUID] + 1) % 3;
+            }
+            break;
+        }
+    }
+}
+
+//  Module executing tasks scheduled by rules - does nothing
+static _kernelEntry _benchKer;
+void _BENCH_KernelCallback(void)
+{
+    _benchKer.retVal = STATUS_OK;
+}
+
+/**
+ * Empty task queue
+ */
+static void BenchDrain()
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+
+    while (!ts.IsEmpty())
+        ts.PopFront();
+}
+
+/**
+ * Bring event log into the state a mix is measured in
+ */
+static void BenchSetup(BenchMix mix)
+{
+    EventLog &el = EventLog::GetI();
+    bool limit = (mix != MIX_LOGGED) && (mix != MIX_PRIOINV);
+
+    el.RecordEvents(mix != MIX_DISABLED);
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+        for (uint8_t e = 0; e < EVENT_PRIOINV; e++)
+            el.SetRateLimit(i, (Events)e, limit ? EVLOG_RL_PERIOD_MS : 0,
+                            EVLOG_RL_BURST);
+
+    for (uint8_t r = 0; r < EVLOG_RULES; r++)
+        el.ClearRule(r);
+    if (mix == MIX_RULES)
+        for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+        {
+            struct _evRule rule;
+
+            rule.libUID = i;
+            rule.event = EVENT_OK;
+            rule.count = 4;
+            rule.windowMs = 0;
+            rule.svcUID = BENCH_UID;
+            rule.serviceID = 0;
+            rule.argN = 1;
+            rule.args[0] = i;
+            el.SetRule(i % EVLOG_RULES, rule);
+        }
+
+    el.Reset();
+    //  Move past repeat filter and refill token buckets of previous case
+    msSinceStartup += REP_TIME_DIFF_MS + EVLOG_RL_PERIOD_MS * EVLOG_RL_BURST;
+}
+
+/**
+ * Log memory taken by 1000 entries, 0 until the log is full
+ */
+static double BenchBytesPer1k()
+{
+    uint16_t n = EventLog::GetI().EventCount();
+
+    if ((n == 0) || (EventLog::GetI().Overwritten() == 0))
+        return 0.0;
+
+    return (double)(EVLOG_BLOCKS * EVLOG_BLOCK_SIZE) * 1000.0 / n;
+}
+
+/*******************************************************************************
+ *********             Benchmarks                                      *********
+ ******************************************************************************/
+/**
+ * EmitEvent() of all events of a mix
+ * ops = number of events
+ */
+static _benchRes BenchEmit(BenchMix mix)
+{
+    EventLog &el = EventLog::GetI();
+    _benchRes r;
+
+    BenchSetup(mix);
+    BenchGenerate(mix);
+    uint32_t seq = el.EndSeq();
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < _nOps; i++)
+    {
+        msSinceStartup += _ops[i].stepMs;
+        EventLog::EmitEvent(_ops[i].libUID, _ops[i].taskID,
+                            (Events)_ops[i].event);
+        if (mix == MIX_RULES)
+            el.ScheduleRules();
+    }
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = _nOps;
+    r.logged = el.EndSeq() - seq;
+    r.bytes = BenchBytesPer1k();
+
+    BenchDrain();
+    return r;
+}
+
+/**
+ * Fill the log with events of the logged mix until it overflows
+ */
+static void BenchFill()
+{
+    EventLog &el = EventLog::GetI();
+    uint32_t overwritten = el.Overwritten();
+
+    for (uint32_t i = 0; (el.Overwritten() == overwritten) && (i < _nOps); i++)
+    {
+        msSinceStartup += _ops[i].stepMs;
+        EventLog::EmitEvent(_ops[i].libUID, _ops[i].taskID,
+                            (Events)_ops[i].event);
+    }
+}
+
+/**
+ * DropBefore() of the older half of a full log
+ * ops = number of calls
+ */
+static _benchRes BenchDrop(BenchMix mix)
+{
+    EventLog &el = EventLog::GetI();
+    _benchRes r;
+
+    BenchSetup(mix);
+    BenchGenerate(mix);
+    r.ns = r.allocs = r.ops = r.logged = 0;
+    r.bytes = 0.0;
+
+    for (uint32_t i = 0; i < BENCH_FILLS; i++)
+    {
+        struct _evIter it;
+        struct _eventEntry first, entry;
+        uint64_t last = 0;
+
+        BenchFill();
+        r.bytes = BenchBytesPer1k();
+        it = el.Begin();
+        if (!el.Next(it, first))
+            continue;
+        while (el.Next(it, entry))
+            last = entry.timestamp;
+
+        uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+        el.DropBefore((first.timestamp + last) / 2);
+        r.ns += BenchNowNs() - t0;
+        r.allocs += _allocCnt - a0;
+        r.ops++;
+    }
+
+    return r;
+}
+
+/**
+ * Reset() of a full log
+ * ops = number of calls
+ */
+static _benchRes BenchReset(BenchMix mix)
+{
+    EventLog &el = EventLog::GetI();
+    _benchRes r;
+
+    BenchSetup(mix);
+    BenchGenerate(mix);
+    r.ns = r.allocs = r.ops = r.logged = 0;
+    r.bytes = 0.0;
+
+    for (uint32_t i = 0; i < BENCH_FILLS; i++)
+    {
+        BenchFill();
+        r.bytes = BenchBytesPer1k();
+
+        uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+        el.Reset();
+        r.ns += BenchNowNs() - t0;
+        r.allocs += _allocCnt - a0;
+        r.ops++;
+    }
+
+    return r;
+}
+
+/*******************************************************************************
+ *********             Benchmark driver                                *********
+ ******************************************************************************/
+typedef _benchRes ((*BenchFunc)(BenchMix));
+
+/**
+ * Benchmark case: function and mix it's run with
+ */
+struct _benchDesc
+{
+    const char *name;
+    BenchFunc   func;
+    BenchMix    mix;
+};
+
+static const _benchDesc _benches[] =
+{
+    {"emit",  BenchEmit,  MIX_REPEAT   },
+    {"emit",  BenchEmit,  MIX_DISPATCH },
+    {"emit",  BenchEmit,  MIX_LOGGED   },
+    {"emit",  BenchEmit,  MIX_PRIOINV  },
+    {"emit",  BenchEmit,  MIX_RATELIMIT},
+    {"emit",  BenchEmit,  MIX_DISABLED },
+    {"emit",  BenchEmit,  MIX_RULES    },
+    {"drop",  BenchDrop,  MIX_LOGGED   },
+    {"reset", BenchReset, MIX_LOGGED   },
+};
+
+/**
+ * Result of a case as printed, also loaded from baseline file
+ */
+struct _benchCase
+{
+    char   key[32];     //  bench,mix
+    double ns;
+    double allocs;
+    double bytes;
+};
+
+static _benchCase _base[BENCH_MAX_CASES];
+static uint32_t _nBase = 0;
+
+/**
+ * Load results of a previous run
+ * @return false if file can't be read
+ */
+static bool BenchLoadBase(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[160], bench[16], mix[16];
+    uint32_t ops;
+    double logged;
+
+    if (f == 0)
+    {
+        perror(path);
+        return false;
+    }
+    while ((_nBase < BENCH_MAX_CASES) && fgets(line, sizeof(line), f))
+    {
+        _benchCase &c = _base[_nBase];
+
+        if ((line[0] == '#') ||
+            (sscanf(line, "%15[^,],%15[^,],%u,%lf,%lf,%lf,%lf", bench, mix,
+                    &ops, &c.ns, &c.allocs, &logged, &c.bytes) != 7))
+            continue;
+        snprintf(c.key, sizeof(c.key), "%s,%s", bench, mix);
+        _nBase++;
+    }
+    fclose(f);
+
+    return true;
+}
+
+/**
+ * Compare result of a case with baseline
+ * @return true if case regressed
+ */
+static bool BenchCheck(const _benchCase &c, double tolerance)
+{
+    for (uint32_t i = 0; i < _nBase; i++)
+    {
+        if (strcmp(_base[i].key, c.key))
+            continue;
+
+        if ((c.ns > _base[i].ns * (1.0 + tolerance)) ||
+            (c.allocs > _base[i].allocs + 0.0005) ||
+            (c.bytes > _base[i].bytes * (1.0 + BENCH_BYTES_TOL)))
+        {
+            fprintf(stderr, "REGRESSION %s: %.1f ns (was %.1f), %.3f allocs "
+                    "(was %.3f), %.0f bytes (was %.0f)\n", c.key, c.ns,
+                    _base[i].ns, c.allocs, _base[i].allocs, c.bytes,
+                    _base[i].bytes);
+            return true;
+        }
+        return false;
+    }
+
+    fprintf(stderr, "%s: not in baseline\n", c.key);
+    return false;
+}
+
+static int BenchCmp(const void *a, const void *b)
+{
+    const _benchRes *ra = (const _benchRes*)a, *rb = (const _benchRes*)b;
+    double na = (double)ra->ns / ra->ops, nb = (double)rb->ns / rb->ops;
+    return (na > nb) - (na < nb);
+}
+
+/**
+ * Run single benchmark case BENCH_REPS times and print the median
+ * @return true if case regressed against baseline
+ */
+static bool BenchRun(const _benchDesc &b, double tolerance)
+{
+    _benchRes res[BENCH_REPS];
+    _benchCase c;
+
+    //  Warm-up run (populates allocator free lists, caches...)
+    b.func(b.mix);
+    for (uint8_t i = 0; i < BENCH_REPS; i++)
+        res[i] = b.func(b.mix);
+
+    qsort(res, BENCH_REPS, sizeof(res[0]), BenchCmp);
+    const _benchRes &m = res[BENCH_REPS / 2];
+
+    snprintf(c.key, sizeof(c.key), "%s,%s", b.name, _mixName[b.mix]);
+    c.ns = (double)m.ns / m.ops;
+    c.allocs = (double)m.allocs / m.ops;
+    c.bytes = m.bytes;
+    printf("%s,%u,%.1f,%.3f,%.3f,%.0f\n", c.key, m.ops, c.ns, c.allocs,
+           (double)m.logged / m.ops, c.bytes);
+    fflush(stdout);
+
+    return (_nBase > 0) && BenchCheck(c, tolerance);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = 0, *base = 0;
+    double tolerance = 0.25;
+    uint32_t regressions = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-q"))
+            _nOps = BENCH_OPS_QUICK;
+        else if (!strcmp(argv[i], "-f") && (i+1 < argc))
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "-c") && (i+1 < argc))
+            base = argv[++i];
+        else if (!strcmp(argv[i], "-t") && (i+1 < argc))
+            tolerance = atof(argv[++i]) / 100.0;
+        else
+        {
+            fprintf(stderr, "Usage: %s [-q] [-f filter] [-c baseline.csv] "
+                    "[-t percent]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((base != 0) && !BenchLoadBase(base))
+        return 1;
+
+    //  Same initialization sequence as on the target (see main.cpp)
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    EventLog::GetI().InitSW();
+    _benchKer.callBackFunc = _BENCH_KernelCallback;
+    TS_RegCallback(&_benchKer, BENCH_UID);
+
+    printf("# EventLog: %u bytes of static RAM, %u of them log blocks\n",
+           (uint32_t)sizeof(EventLog),
+           (uint32_t)(EVLOG_BLOCKS * EVLOG_BLOCK_SIZE));
+    printf("bench,mix,ops,ns_per_op,allocs_per_op,logged_per_op,"
+           "bytes_per_1k\n");
+
+    for (uint8_t b = 0; b < sizeof(_benches)/sizeof(_benches[0]); b++)
+    {
+        const _benchDesc &bd = _benches[b];
+
+        if ((filter != 0) && (strstr(bd.name, filter) == 0) &&
+            (strstr(_mixName[bd.mix], filter) == 0))
+            continue;
+
+        if (BenchRun(bd, tolerance))
+            regressions++;
+    }
+
+    if (regressions > 0)
+        fprintf(stderr, "%u cases regressed\n", regressions);
+
+    return (regressions > 0) ? 1 : 0;
+}
+
+#endif  /* __BOARD_HOST__ */
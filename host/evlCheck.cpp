@@ -0,0 +1,1585 @@
+/**
+ * evlCheck.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Consistency checks of the event log (host build only)
+ *  Each section drives EventLog through its public interface and compares
+ *  the outcome with what it has to be, looking at internal state where the
+ *  interface doesn't show it (see friend _evlCheck in eventLog.h):
+ *      stress      EVLOG_WRITERS threads emit events at once while another
+ *                  thread keeps reading the log and a third one moves the
+ *                  clock. Every entry read has to be whole, and once writers
+ *                  are done each emitted event has to be either in the log
+ *                  or counted as overwritten, with no record of module state
+ *                  left taken from the pool.
+ *      codec       entries with edge-case fields (escaped libUID >= 31,
+ *                  taskID -1, time deltas over 32 bits, EVENT_SUPPRESSED
+ *                  counts) are encoded and decoded, also from truncated
+ *                  input. Then random events, some of unknown modules and
+ *                  some with time set back, are emitted one at a time and
+ *                  every entry staged by EmitEvent() is added to a shadow
+ *                  copy of the log. Log read back has to match the newest
+ *                  entries of the shadow copy, and every block has to end
+ *                  only once the next entry doesn't fit into it.
+ *      queries     random Seek(), SeekSeq() and filtered Next() queries, on
+ *                  a full log and after DropBefore(), have to return the
+ *                  same entries as a scan through the whole log
+ *      suppress    a module floods the log with alternating and repeated
+ *                  events under random rate limits while FlushSuppressed()
+ *                  is called in between, as from the main loop. Its entries
+ *                  have to match a model of the repeat filter and the token
+ *                  buckets, and logged events plus reported dropped ones
+ *                  have to add up to emitted ones. A module repeating one
+ *                  event may only report it once every REP_TIME_DIFF_MS
+ *      counters    random events of all modules, with recording turned on
+ *                  and off and counters held by a "preempted" context while
+ *                  more events come in, have to match a model: number of
+ *                  events, time of the first and the last one and the rate
+ *                  over each window. Rate of a steady stream of events has
+ *                  to be close to the number of events in the last window
+ *      tiers       random events overflow the log while parts of it are
+ *                  dropped by DropBefore() and Reset(). Kept entries and
+ *                  summaries have to match a model fed with entries as they
+ *                  get overwritten, with dropped entries left out and tiers
+ *                  trimmed the same way
+ *      rules       random events are counted by random reactive rules, some
+ *                  of them changed, or held as being changed, on the way.
+ *                  EmitEvent() must not schedule anything, and each call to
+ *                  ScheduleRules() has to schedule the service of every rule
+ *                  that fired since, once, as a model of N events within T
+ *                  ms says. Events counted while a rule is being changed,
+ *                  and rules changed after firing, schedule nothing
+ *  Exit status is non-zero if any check fails.
+ *
+ *  Usage: evlCheck [-n events] [-s seed] [-f section]
+ *      -n events   events emitted by each writer in stress section, other
+ *                  sections scale with it
+ *      -f section  run only sections whose name contains 'section'
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "init/eventLog.h"
+#include "init/evlogCodec.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+
+static uint32_t _errors = 0;
+
+/**
+ * Small xorshift PRNG -> same stream on every platform for a given seed
+ */
+static uint32_t _rndState = 1;
+static uint32_t EvlRand()
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    return _rndState;
+}
+
+/**
+ * Report failed check, only the first few of them are printed
+ */
+static void EvlFail(const char *what)
+{
+    if (++_errors <= 10)
+        printf("FAILED: %s\n", what);
+}
+
+static bool EvlSame(const struct _eventEntry &a, const struct _eventEntry &b)
+{
+    return (a.timestamp == b.timestamp) && (a.libUID == b.libUID) &&
+           (a.taskID == b.taskID) && (a.event == b.event) &&
+           (a.count == b.count);
+}
+
+/**
+ * Set time of task scheduler, same as its SysTick interrupt does
+ */
+static void EvlSetTime(uint64_t time)
+{
+    msSinceStartupSeq.WriteBegin();
+    msSinceStartup = time;
+    msSinceStartupSeq.WriteEnd();
+}
+
+/**
+ * Empty the log and restore default settings before a section
+ */
+static void EvlDefaults()
+{
+    EventLog &el = EventLog::GetI();
+
+    el.Reset();
+    el.RecordEvents(true);
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+        for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+            el.SetRateLimit(i, (Events)e, EVLOG_RL_PERIOD_MS, EVLOG_RL_BURST);
+}
+
+/**
+ * Access to internal state of event log
+ */
+struct _evlCheck
+{
+    /**
+     * Number of records of module state not in use
+     */
+    static uint32_t PoolFree()
+    {
+        uint32_t mask = EventLog::GetI()._modFree, n = 0;
+
+        for (; mask != 0; mask &= mask - 1)
+            n++;
+        return n;
+    }
+    /**
+     * Whether every staged entry has been encoded and encoder released
+     */
+    static bool StageEmpty()
+    {
+        EventLog &el = EventLog::GetI();
+
+        return (el._encoding == 0) && (el._stageRead == el._reserve);
+    }
+    /**
+     * Sequence number of the next entry to be staged
+     */
+    static uint32_t Reserved()
+    {
+        return EventLog::GetI()._reserve;
+    }
+    /**
+     * Copy entries staged from sequence number [from] on; only valid while
+     * no other context emits events
+     * @return sequence number of the next entry to be staged
+     */
+    static uint32_t Staged(uint32_t from, std::vector<struct _eventEntry> &dst)
+    {
+        EventLog &el = EventLog::GetI();
+
+        for (; from != el._reserve; from++)
+            dst.push_back(el._ring[from & (EVLOG_STAGE - 1)]);
+        return from;
+    }
+    /**
+     * Mark counter of events as being updated (version odd), as if the
+     * context updating it was preempted, or as done again
+     */
+    static void StatHold(uint8_t libUID, uint8_t event)
+    {
+        EventLog::GetI()._stat[libUID][event].version++;
+    }
+    /**
+     * Number of events left in counter by contexts that found it held
+     */
+    static uint32_t StatPending(uint8_t libUID, uint8_t event)
+    {
+        return EventLog::GetI()._stat[libUID][event].pending;
+    }
+    /**
+     * Sequence number of the oldest entry not overwritten yet; all entries
+     * before it have been folded into older tiers, unless dropped
+     */
+    static uint32_t OldestSeq()
+    {
+        EventLog &el = EventLog::GetI();
+        uint32_t oldest = el._Oldest();
+
+        return el._blkFirst[oldest & (EVLOG_BLOCKS - 1)];
+    }
+    /**
+     * Mark reactive rule as being changed (version odd), as if the main loop
+     * changing it was preempted, or as done again
+     */
+    static void RuleHold(uint8_t index)
+    {
+        EventLog::GetI()._ruleVer[index]++;
+    }
+    /**
+     * Time of the last entry encoded into blocks
+     */
+    static uint64_t HeadTime()
+    {
+        return EventLog::GetI()._headTime;
+    }
+    /**
+     * Check that every block decodes into as many entries as it holds, and
+     * that it was closed only because the first entry of the next block
+     * didn't fit into it
+     * @param full [out] number of blocks filled up to the last byte
+     * @return number of blocks failing the check
+     */
+    static uint32_t CheckBlocks(uint32_t &full)
+    {
+        EventLog &el = EventLog::GetI();
+        struct _eventEntry entries[EVLOG_BLOCK_SIZE];
+        uint8_t buf[EVC_MAX_ENTRY];
+        uint32_t bad = 0;
+
+        full = 0;
+        for (uint32_t b = el._Oldest(); b != el._head; b++)
+        {
+            uint32_t slot = b & (EVLOG_BLOCKS - 1), next;
+            uint8_t len = el._blkLen[slot];
+            uint32_t n = EVC_DecodeBlock(el._blk[slot], len, entries,
+                                         EVLOG_BLOCK_SIZE);
+
+            if ((el._blkSeq[slot] != b) || (n != el._blkCnt[slot]) ||
+                (n == 0))
+            {
+                bad++;
+                continue;
+            }
+            next = EVC_DecodeBlock(el._blk[(b + 1) & (EVLOG_BLOCKS - 1)],
+                                   el._blkLen[(b + 1) & (EVLOG_BLOCKS - 1)],
+                                   &entries[n], 1);
+            if ((next == 0) ||
+                ((len + EVC_PutEntry(buf, entries[n],
+                                     entries[n - 1].timestamp))
+                 <= EVLOG_BLOCK_SIZE))
+                bad++;
+            if (len == EVLOG_BLOCK_SIZE)
+                full++;
+        }
+
+        return bad;
+    }
+};
+
+///-----------------------------------------------------------------------------
+///         Concurrent writers and reader
+///-----------------------------------------------------------------------------
+//  Writers are modules 0 up to EVLOG_WRITERS-1; writer alternates startup and
+//  initialized events (neither repeated nor a priority inversion), with
+//  number of the event in taskID and its parity in the event type
+#define STRESS_EVENT(N)     (((N) & 1) ? EVENT_INITIALIZED : EVENT_STARTUP)
+#define STRESS_TASK(N)      ((int8_t)((N) & 0x7F))
+
+static volatile bool _stressStop;
+static uint32_t _stressEvents;
+//  Failures found by the reader thread and number of entries it read
+static volatile uint32_t _stressTorn, _stressOrder, _stressRead;
+
+/**
+ * Check that entry emitted by a stress writer is whole
+ */
+static bool EvlStressWhole(const struct _eventEntry &e)
+{
+    return (e.libUID >= 0) && (e.libUID < EVLOG_WRITERS) &&
+           (e.taskID >= 0) && (e.count == 0) &&
+           (e.event == STRESS_EVENT(e.taskID));
+}
+
+static void* EvlStressWriter(void *arg)
+{
+    uint8_t libUID = (uint8_t)(uintptr_t)arg;
+
+    for (uint32_t i = 0; i < _stressEvents; i++)
+        EventLog::EmitEvent(libUID, STRESS_TASK(i), STRESS_EVENT(i));
+
+    return 0;
+}
+
+static void* EvlStressReader(void *arg)
+{
+    EventLog &el = EventLog::GetI();
+    uint32_t torn = 0, order = 0, read = 0;
+
+    while (!_stressStop)
+    {
+        struct _evIter it = el.Begin();
+        struct _eventEntry e;
+        uint64_t time = 0;
+        uint32_t seq = 0;
+        bool first = true;
+
+        while (el.Next(it, e))
+        {
+            if (!EvlStressWhole(e))
+                torn++;
+            //  Entries come in order of sequence numbers and time; sequence
+            //  numbers skip only entries overwritten in the meantime
+            if (!first && (((int32_t)(it.seq - seq) <= 0) ||
+                           (e.timestamp < time)))
+                order++;
+            seq = it.seq;
+            time = e.timestamp;
+            first = false;
+            read++;
+        }
+    }
+
+    _stressTorn = torn;
+    _stressOrder = order;
+    _stressRead = read;
+    return arg;
+}
+
+static void* EvlStressClock(void *arg)
+{
+    uint32_t rnd = _rndState;
+    uint64_t time = TS_GetTimeMS();
+
+    while (!_stressStop)
+    {
+        rnd ^= rnd << 13;
+        rnd ^= rnd >> 17;
+        rnd ^= rnd << 5;
+        //  Mostly small steps, sometimes steps needing long time deltas
+        time += ((rnd & 0xF) == 0) ? (rnd >> 12) : (rnd & 0x3F);
+        EvlSetTime(time);
+        usleep(50);
+    }
+
+    return arg;
+}
+
+static void EvlRunStress(uint32_t nEvents)
+{
+    EventLog &el = EventLog::GetI();
+    pthread_t writers[EVLOG_WRITERS], reader, clock;
+    uint32_t total = nEvents * EVLOG_WRITERS, n = 0, seq = 0;
+    struct _eventEntry e;
+    struct _evIter it;
+    char msg[96];
+
+    EvlDefaults();
+    for (uint8_t w = 0; w < EVLOG_WRITERS; w++)
+    {
+        el.SetRateLimit(w, EVENT_STARTUP, 0, 1);
+        el.SetRateLimit(w, EVENT_INITIALIZED, 0, 1);
+    }
+
+    _stressStop = false;
+    _stressEvents = nEvents;
+    pthread_create(&reader, 0, EvlStressReader, 0);
+    pthread_create(&clock, 0, EvlStressClock, 0);
+    for (uint8_t w = 0; w < EVLOG_WRITERS; w++)
+        pthread_create(&writers[w], 0, EvlStressWriter, (void*)(uintptr_t)w);
+    for (uint8_t w = 0; w < EVLOG_WRITERS; w++)
+        pthread_join(writers[w], 0);
+    _stressStop = true;
+    pthread_join(reader, 0);
+    pthread_join(clock, 0);
+
+    printf("Stress:                 %u writers x %u events, reader got %u "
+           "entries\n", EVLOG_WRITERS, nEvents, _stressRead);
+    if (_stressTorn > 0)
+        EvlFail("reader got a torn entry");
+    if (_stressOrder > 0)
+        EvlFail("reader got entries out of order");
+
+    //  Every event is either in the log or counted as overwritten
+    it = el.Begin();
+    while (el.Next(it, e))
+    {
+        if (!EvlStressWhole(e))
+            EvlFail("torn entry in the log");
+        if ((n > 0) && (it.seq != (seq + 1)))
+            EvlFail("gap in sequence numbers of the log");
+        seq = it.seq;
+        n++;
+    }
+    printf("Stress:                 %u entries in the log, %u overwritten\n",
+           n, el.Overwritten());
+    if (!_evlCheck::StageEmpty())
+        EvlFail("staged entries left behind");
+    if ((n != el.EventCount()) || ((n + el.Overwritten()) != total))
+    {
+        snprintf(msg, sizeof(msg), "%u entries in the log plus %u overwritten "
+                 "instead of %u", n, el.Overwritten(), total);
+        EvlFail(msg);
+    }
+
+    //  State of each module is updated by its writer alone, so it has to
+    //  end with the last event the writer emitted
+    for (uint8_t w = 0; w < EVLOG_WRITERS; w++)
+    {
+        e = el.GetLastEvAt(w);
+        if ((e.taskID != STRESS_TASK(nEvents - 1)) ||
+            (e.event != STRESS_EVENT(nEvents - 1)))
+            EvlFail("state of a module lost an update");
+    }
+    if (_evlCheck::PoolFree() != (EVLOG_MOD_POOL - NUM_OF_MODULES))
+    {
+        snprintf(msg, sizeof(msg), "%u records of module state leaked",
+                 (EVLOG_MOD_POOL - NUM_OF_MODULES) - _evlCheck::PoolFree());
+        EvlFail(msg);
+    }
+}
+
+///-----------------------------------------------------------------------------
+///         Encoding and shadow copy of the log
+///-----------------------------------------------------------------------------
+/**
+ * Encode and decode an entry, also from every truncated part of it
+ */
+static void EvlCodecEntry(const struct _eventEntry &entry, uint64_t prevTime)
+{
+    uint8_t buf[EVC_MAX_ENTRY], n = EVC_PutEntry(buf, entry, prevTime);
+    struct _eventEntry dec;
+
+    if ((EVC_GetEntry(buf, buf + n, prevTime, dec) != n) ||
+        !EvlSame(dec, entry))
+        EvlFail("entry differs after encoding");
+    for (uint8_t cut = 0; cut < n; cut++)
+        if (EVC_GetEntry(buf, buf + cut, prevTime, dec) != 0)
+        {
+            EvlFail("truncated entry decoded");
+            break;
+        }
+}
+
+/**
+ * Compare log with the newest entries of its shadow copy
+ */
+static void EvlCodecCompare(const std::vector<struct _eventEntry> &shadow)
+{
+    EventLog &el = EventLog::GetI();
+    uint32_t count = el.EventCount(), k, seq = 0, full;
+    struct _eventEntry e;
+    struct _evIter it;
+
+    if ((count > shadow.size()) ||
+        ((count + el.Overwritten()) != shadow.size()))
+    {
+        EvlFail("entries in the log plus overwritten differ from emitted");
+        return;
+    }
+
+    it = el.Begin();
+    for (k = shadow.size() - count; el.Next(it, e); k++)
+    {
+        if ((k >= shadow.size()) || !EvlSame(e, shadow[k]))
+        {
+            EvlFail("entry in the log differs from shadow copy");
+            return;
+        }
+        if ((k > (shadow.size() - count)) && (it.seq != (seq + 1)))
+            EvlFail("gap in sequence numbers of the log");
+        seq = it.seq;
+    }
+    if (k != shadow.size())
+        EvlFail("entries missing from the log");
+    else if ((count > 0) && (el.EndSeq() != seq))
+        EvlFail("sequence number of the next entry");
+    if (_evlCheck::CheckBlocks(full) > 0)
+        EvlFail("block decodes wrong or was closed too early");
+}
+
+static void EvlRunCodec(uint32_t nEvents)
+{
+    static const int8_t uids[] = {0, 1, 30, 31, 32, 127, -1, -128};
+    static const int8_t tasks[] = {0, 1, 127, -1, -128};
+    static const uint64_t deltas[] = {0, 1, 127, 128, 16383, 16384,
+                                      0xFFFFFFFFull, 0x100000000ull,
+                                      0x10000000000ull, 0x7FFFFFFFFFFFFFFull};
+    static const uint16_t counts[] = {0, 1, 127, 128, 0xFFFF};
+    static const int16_t unknown[] = {NUM_OF_MODULES, 31, 40, 255};
+    std::vector<struct _eventEntry> shadow;
+    struct _eventEntry e;
+    uint64_t time, last;
+    uint32_t staged, nOps = nEvents / 5, full, k;
+
+    //  Edge cases of every field, one field at a time
+    for (uint8_t u = 0; u < sizeof(uids); u++)
+        for (uint8_t t = 0; t < sizeof(tasks); t++)
+            for (uint8_t d = 0; d < sizeof(deltas)/sizeof(deltas[0]); d++)
+                for (uint8_t ev = 0; ev <= EVENT_SUPPRESSED; ev++)
+                {
+                    uint64_t prev = EvlRand();
+
+                    e.libUID = uids[u];
+                    e.taskID = tasks[t];
+                    e.event = (Events)ev;
+                    e.timestamp = prev + deltas[d];
+                    e.count = 0;
+                    if (ev != EVENT_SUPPRESSED)
+                    {
+                        EvlCodecEntry(e, prev);
+                        continue;
+                    }
+                    for (uint8_t c = 0; c < sizeof(counts)/sizeof(counts[0]);
+                         c++)
+                    {
+                        e.count = counts[c];
+                        EvlCodecEntry(e, prev);
+                    }
+                }
+    for (uint8_t d = 0; d < sizeof(deltas)/sizeof(deltas[0]); d++)
+    {
+        uint8_t buf[EVC_MAX_HEADER], n = EVC_PutHeader(buf, ~deltas[d]);
+
+        if ((EVC_GetHeader(buf, buf + n, time) != n) || (time != ~deltas[d])
+            || (EVC_GetHeader(buf, buf + n - 1, time) != 0))
+            EvlFail("block header differs after encoding");
+    }
+
+    //  Random events emitted one at a time, log has to hold the newest
+    //  entries staged for it; time set back is logged as the time of the
+    //  entry before it
+    EvlDefaults();
+    staged = _evlCheck::Reserved();
+    last = _evlCheck::HeadTime();
+    time = TS_GetTimeMS();
+    for (uint32_t i = 0; i < nOps; i++)
+    {
+        uint32_t step = EvlRand() % 100, rnd = EvlRand();
+        uint8_t libUID;
+        int8_t taskID;
+        Events event;
+
+        if (step < 2)
+            time -= (time < (rnd % 100000)) ? time : (rnd % 100000);
+        else if (step < 4)
+            time += (uint64_t)rnd << (EvlRand() % 5);
+        else
+            time += rnd % 300;
+        EvlSetTime(time);
+
+        rnd = EvlRand();
+        if ((rnd % 10) == 0)
+        {
+            libUID = (uint8_t)unknown[(rnd >> 8) % 4];
+            event = (Events)((rnd >> 16) % (EVENT_SUPPRESSED + 1));
+        }
+        else
+        {
+            libUID = (uint8_t)((rnd >> 8) % NUM_OF_MODULES);
+            event = (Events)((rnd >> 16) % EVLOG_RL_EVENTS);
+        }
+        taskID = ((rnd >> 24) < 32) ? -1 : (int8_t)((rnd >> 24) % 100);
+        EventLog::EmitEvent(libUID, taskID, event);
+
+        k = shadow.size();
+        for (staged = _evlCheck::Staged(staged, shadow); k < shadow.size();
+             k++)
+        {
+            if (shadow[k].timestamp < last)
+                shadow[k].timestamp = last;
+            last = shadow[k].timestamp;
+        }
+        if ((EvlRand() % 256) == 0)
+            EvlCodecCompare(shadow);
+    }
+    EvlCodecCompare(shadow);
+    _evlCheck::CheckBlocks(full);
+    printf("Codec:                  %u entries emitted, %u in the log, %u "
+           "blocks filled up\n", (uint32_t)shadow.size(),
+           EventLog::GetI().EventCount(), full);
+}
+
+///-----------------------------------------------------------------------------
+///         Queries compared with a scan through the log
+///-----------------------------------------------------------------------------
+//  Number of queries of each kind
+#define QUERY_N             2000
+
+/**
+ * Entry of the log together with its sequence number
+ */
+struct _evlEntry
+{
+    struct _eventEntry  entry;
+    uint32_t            seq;
+};
+
+/**
+ * Copy the whole log
+ */
+static void EvlScan(std::vector<struct _evlEntry> &log)
+{
+    EventLog &el = EventLog::GetI();
+    struct _evIter it = el.Begin();
+    struct _evlEntry e;
+
+    log.clear();
+    while (el.Next(it, e.entry))
+    {
+        e.seq = it.seq - 1;
+        log.push_back(e);
+    }
+}
+
+/**
+ * Check that iterator returns the entry at [idx] of the scan next, or
+ * nothing if [idx] is past its end
+ */
+static bool EvlQueryAt(struct _evIter it,
+                       const std::vector<struct _evlEntry> &log, uint32_t idx)
+{
+    struct _eventEntry e;
+
+    if (!EventLog::GetI().Next(it, e))
+        return (idx == log.size());
+
+    return (idx < log.size()) && EvlSame(e, log[idx].entry) &&
+           ((it.seq - 1) == log[idx].seq);
+}
+
+/**
+ * Run random queries on the current content of the log
+ */
+static void EvlQueries(const std::vector<struct _evlEntry> &log)
+{
+    EventLog &el = EventLog::GetI();
+    uint64_t tMin = log.front().entry.timestamp,
+             span = log.back().entry.timestamp - tMin + 20;
+    uint32_t sMin = log.front().seq;
+
+    for (uint32_t q = 0; q < QUERY_N; q++)
+    {
+        //  Times of entries and right next to them, and anywhere around
+        uint64_t time = ((EvlRand() % 2) == 0) ?
+                        (log[EvlRand() % log.size()].entry.timestamp +
+                         (EvlRand() % 3) - 1) :
+                        (tMin + (EvlRand() % span) - 10);
+        uint32_t seq = sMin + (EvlRand() % (log.size() + 20)) - 10, i;
+
+        for (i = 0; (i < log.size()) && (log[i].entry.timestamp < time); i++);
+        if (!EvlQueryAt(el.Seek(time), log, i))
+            EvlFail("Seek() differs from scan");
+
+        for (i = 0; (i < log.size()) && ((int32_t)(log[i].seq - seq) < 0);
+             i++);
+        if (!EvlQueryAt(el.SeekSeq(seq), log, i))
+            EvlFail("SeekSeq() differs from scan");
+    }
+
+    for (uint32_t q = 0; q < QUERY_N; q++)
+    {
+        struct _evFilter f;
+        struct _evIter it;
+        struct _eventEntry e;
+        uint32_t i = 0, n = 0;
+        bool same = true;
+
+        //  Half of the filters select by time only
+        f.from = tMin + (EvlRand() % span) - 10;
+        f.to = f.from + (EvlRand() % span);
+        if ((EvlRand() % 2) == 0)
+        {
+            f.modules = EvlRand() | EvlRand();
+            f.events = (uint8_t)(EvlRand() & EvlRand());
+        }
+
+        it = ((EvlRand() % 4) == 0) ? el.Begin() : el.Seek(f.from);
+        while (same && el.Next(it, e, f))
+        {
+            for (; i < log.size(); i++)
+            {
+                const struct _eventEntry &l = log[i].entry;
+
+                if ((l.timestamp >= f.from) && (l.timestamp <= f.to) &&
+                    (EVLOG_MODULE(l.libUID) & f.modules) &&
+                    (EVLOG_EVENT(l.event) & f.events))
+                    break;
+            }
+            same = (i < log.size()) && EvlSame(e, log[i].entry) &&
+                   ((it.seq - 1) == log[i].seq);
+            i++;
+            n++;
+        }
+        //  No entry selected by the filter may be left over
+        for (; same && (i < log.size()); i++)
+        {
+            const struct _eventEntry &l = log[i].entry;
+
+            same = !((l.timestamp >= f.from) && (l.timestamp <= f.to) &&
+                     (EVLOG_MODULE(l.libUID) & f.modules) &&
+                     (EVLOG_EVENT(l.event) & f.events));
+        }
+        if (!same)
+            EvlFail("filtered Next() differs from scan");
+    }
+}
+
+static void EvlRunQueries(uint32_t nEvents)
+{
+    static const uint8_t unknown[] = {31, 40};
+    EventLog &el = EventLog::GetI();
+    std::vector<struct _evlEntry> log;
+    uint64_t time = TS_GetTimeMS();
+    uint32_t full;
+
+    //  Fill the log past its capacity; many entries share time, so that
+    //  queries hit runs of entries with the same time
+    EvlDefaults();
+    for (uint32_t i = 0; i < (nEvents / 50); i++)
+    {
+        uint32_t rnd = EvlRand();
+
+        time += ((rnd % 4) == 0) ? 0 : ((rnd >> 2) % 500);
+        EvlSetTime(time);
+        rnd = EvlRand();
+        EventLog::EmitEvent(((rnd % 16) == 0) ? unknown[(rnd >> 4) % 2]
+                                              : (rnd >> 8) % NUM_OF_MODULES,
+                            (int8_t)((rnd >> 16) % 100),
+                            (Events)((rnd >> 24) % EVLOG_RL_EVENTS));
+    }
+
+    EvlScan(log);
+    if (log.empty())
+    {
+        EvlFail("log is empty");
+        return;
+    }
+    EvlQueries(log);
+    full = log.size();
+
+    //  Log starting in the middle of a block
+    el.DropBefore(log[log.size() / 3].entry.timestamp);
+    EvlScan(log);
+    if (log.empty() || (log.size() >= full))
+    {
+        EvlFail("DropBefore() dropped nothing or everything");
+        return;
+    }
+    EvlQueries(log);
+    printf("Queries:                %u of each kind on %u and %u entries\n",
+           QUERY_N * 2, full, (uint32_t)log.size());
+}
+
+///-----------------------------------------------------------------------------
+///         Rate limiting and reporting of dropped events
+///-----------------------------------------------------------------------------
+//  Module flooding the log; one round of the check with random rate limits
+//  is run for every SUPP_EVENTS events of -n
+#define SUPP_UID            3
+#define SUPP_EVENTS         10000
+
+/**
+ * Model of the state EmitEvent() and FlushSuppressed() keep of a module,
+ * together with entries they're expected to log
+ */
+struct _evlSuppModel
+{
+    uint16_t    period[EVLOG_RL_EVENTS];
+    uint8_t     burst[EVLOG_RL_EVENTS];
+    uint64_t    full[EVLOG_RL_EVENTS];
+    uint32_t    dropped[EVLOG_RL_EVENTS];
+    uint8_t     lastEvent;
+    uint64_t    lastTime;
+    std::vector<struct _eventEntry> log;
+
+    _evlSuppModel(): lastEvent(EVENT_UNINITIALIZED), lastTime(0)
+    {
+        memset(full, 0, sizeof(full));
+        memset(dropped, 0, sizeof(dropped));
+    }
+
+    bool Take(uint8_t event, uint64_t now)
+    {
+        uint64_t t = (full[event] < now) ? now : full[event];
+
+        if ((t - now) > ((uint64_t)period[event] * (burst[event] - 1)))
+            return false;
+        full[event] = t + period[event];
+        return true;
+    }
+    void Log(uint8_t event, int8_t taskID, uint64_t now, uint16_t count)
+    {
+        struct _eventEntry e;
+
+        e.timestamp = now;
+        e.libUID = SUPP_UID;
+        e.taskID = taskID;
+        e.count = count;
+        e.event = (Events)event;
+        log.push_back(e);
+    }
+    void Emit(uint8_t event, int8_t taskID, uint64_t now)
+    {
+        if (((lastEvent == event) && ((now - lastTime) < REP_TIME_DIFF_MS)) ||
+            !Take(event, now))
+        {
+            dropped[event]++;
+            return;
+        }
+        if (dropped[event] > 0)
+            Log(EVENT_SUPPRESSED, event, now, dropped[event]);
+        Log(event, taskID, now, 0);
+        dropped[event] = 0;
+        lastEvent = event;
+        lastTime = now;
+    }
+    void Flush(uint64_t now)
+    {
+        for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+        {
+            if ((dropped[e] == 0) ||
+                ((lastEvent == e) && ((now - lastTime) < REP_TIME_DIFF_MS)) ||
+                !Take(e, now))
+                continue;
+            Log(EVENT_SUPPRESSED, e, now, dropped[e]);
+            dropped[e] = 0;
+        }
+    }
+};
+
+/**
+ * Run one flood of a module and compare its entries with the model
+ * @param nOps number of events emitted
+ * @param stepMs highest time step between events
+ * @param repeat probability (in %) of emitting the same event again
+ */
+static void EvlSuppRound(_evlSuppModel &m, uint32_t nOps, uint32_t stepMs,
+                         uint32_t repeat)
+{
+    static const Events events[2] = {EVENT_STARTUP, EVENT_INITIALIZED};
+    EventLog &el = EventLog::GetI();
+    uint32_t emitted[EVLOG_RL_EVENTS], counted[EVLOG_RL_EVENTS], i = 0;
+    uint64_t time = TS_GetTimeMS();
+    struct _eventEntry e;
+    struct _evIter it;
+    uint8_t ev = 0;
+
+    EvlDefaults();
+    memset(emitted, 0, sizeof(emitted));
+    memset(counted, 0, sizeof(counted));
+    for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+        el.SetRateLimit(SUPP_UID, (Events)j, m.period[j], m.burst[j]);
+
+    for (uint32_t n = 0; n < nOps; n++)
+    {
+        //  Startup and initialized events never cause a priority inversion
+        if ((EvlRand() % 100) >= repeat)
+            ev ^= 1;
+        time += EvlRand() % (stepMs + 1);
+        EvlSetTime(time);
+        EventLog::EmitEvent(SUPP_UID, (int8_t)(n % 100), events[ev]);
+        m.Emit(events[ev], (int8_t)(n % 100), time);
+        emitted[events[ev]]++;
+
+        if ((EvlRand() % 3) == 0)
+        {
+            el.FlushSuppressed();
+            m.Flush(time);
+        }
+    }
+    //  Everything left is reported once buckets are full again and repeats
+    //  are no longer repeats
+    time += REP_TIME_DIFF_MS + (uint64_t)m.period[events[0]] * m.burst[events[0]]
+            + (uint64_t)m.period[events[1]] * m.burst[events[1]];
+    EvlSetTime(time);
+    el.FlushSuppressed();
+    m.Flush(time);
+
+    if (el.Overwritten() > 0)
+    {
+        EvlFail("log overflowed, flood is too long");
+        return;
+    }
+    it = el.Begin();
+    while (el.Next(it, e))
+    {
+        if (e.libUID != SUPP_UID)
+            continue;
+        if ((i >= m.log.size()) || !EvlSame(e, m.log[i]))
+        {
+            EvlFail("logged entries differ from model");
+            return;
+        }
+        i++;
+        if (e.event == EVENT_SUPPRESSED)
+            counted[(uint8_t)e.taskID] += e.count;
+        else
+            counted[e.event]++;
+    }
+    if (i != m.log.size())
+        EvlFail("logged entries missing");
+    for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+        if (counted[j] != emitted[j])
+            EvlFail("logged and suppressed events don't add up to emitted");
+}
+
+static void EvlRunSuppress(uint32_t nEvents)
+{
+    uint32_t entries = 0, reports = 0,
+             rounds = (nEvents + SUPP_EVENTS - 1) / SUPP_EVENTS;
+    _evlSuppModel rep;
+    struct _eventEntry e;
+    struct _evIter it;
+
+    //  Repeating one event for an hour, every 10 ms
+    for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+    {
+        rep.period[j] = EVLOG_RL_PERIOD_MS;
+        rep.burst[j] = EVLOG_RL_BURST;
+    }
+    EvlSuppRound(rep, 360000, 20, 100);
+    it = EventLog::GetI().Begin();
+    while (EventLog::GetI().Next(it, e))
+        if ((e.libUID == SUPP_UID) && (e.event == EVENT_SUPPRESSED))
+            reports++;
+    if (reports > (3600000 / REP_TIME_DIFF_MS + 1))
+        EvlFail("repeated event reported more than once in REP_TIME_DIFF_MS");
+
+    //  Alternating floods, faster than the rate limit
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        _evlSuppModel m;
+
+        for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+        {
+            m.period[j] = 1 + EvlRand() % 2000;
+            m.burst[j] = 1 + EvlRand() % 20;
+        }
+        EvlSuppRound(m, 400, m.period[EVENT_STARTUP] / 4, EvlRand() % 30);
+        entries += m.log.size();
+    }
+    printf("Suppress:               %u reports of a repeated event in an "
+           "hour, %u entries in %u floods\n", reports, entries, rounds);
+}
+
+///-----------------------------------------------------------------------------
+///         Counters of events
+///-----------------------------------------------------------------------------
+static const uint32_t _winMs[EVLOG_STAT_WINDOWS] = EVLOG_STAT_WIN_MS;
+//  Error of rate estimate tolerated for events coming in at a steady rate
+#define STAT_RATE_TOL       0.05
+
+/**
+ * Model of a counter of events: times of all counted events and events
+ * left pending, which are counted at the time of the next event
+ */
+struct _evlStatModel
+{
+    std::vector<uint64_t>   times;
+    uint32_t                pending;
+
+    _evlStatModel(): pending(0) {};
+
+    void Add(uint64_t now, bool held)
+    {
+        if (held)
+        {
+            pending++;
+            return;
+        }
+        for (; pending > 0; pending--)
+            times.push_back(now);
+        times.push_back(now);
+    }
+    uint32_t Count(uint64_t from, uint64_t to) const
+    {
+        return std::lower_bound(times.begin(), times.end(), to) -
+               std::lower_bound(times.begin(), times.end(), from);
+    }
+    //  Events in the current window and the one before it, the latter
+    //  weighted by how much of it is within the last [len] ms
+    uint32_t Rate(uint64_t now, uint64_t len) const
+    {
+        uint64_t start = now - (now % len);
+        uint64_t prev = (start >= len) ? Count(start - len, start) : 0;
+
+        return Count(start, start + len) +
+               (uint32_t)((prev * (len - (now % len))) / len);
+    }
+};
+
+/**
+ * Compare counter of events with its model
+ */
+static void EvlStatCompare(uint8_t libUID, uint8_t event,
+                           const _evlStatModel &m)
+{
+    uint64_t now = TS_GetTimeMS();
+    struct _evStat s;
+
+    if (!EventLog::GetI().GetStat(libUID, (Events)event, s))
+    {
+        EvlFail("counter missing");
+        return;
+    }
+    if (s.count != (m.times.size() + m.pending))
+        EvlFail("number of events differs from model");
+    else if ((m.times.size() > 0) &&
+             ((s.first != m.times.front()) || (s.last != m.times.back())))
+        EvlFail("time of the first or the last event differs from model");
+    for (uint8_t w = 0; w < EVLOG_STAT_WINDOWS; w++)
+        if (s.rate[w] != m.Rate(now, _winMs[w]))
+        {
+            EvlFail("rate differs from model");
+            break;
+        }
+}
+
+static void EvlRunCounters(uint32_t nEvents)
+{
+    static _evlStatModel m[NUM_OF_MODULES][EVLOG_RL_EVENTS];
+    EventLog &el = EventLog::GetI();
+    uint64_t time = TS_GetTimeMS();
+    uint32_t off = 0, held = 0;
+    double worst = 0;
+    bool enabled = true;
+    uint8_t hLib = 0, hEv = 0;
+    _evlStatModel steady;
+
+    EvlDefaults();
+    for (uint32_t i = 0; i < (nEvents / 10); i++)
+    {
+        uint32_t rnd = EvlRand(), step = EvlRand() % 1000;
+        uint8_t libUID = rnd % (NUM_OF_MODULES + 2), event;
+
+        event = (rnd >> 8) % (EVENT_SUPPRESSED + 1);
+        time += (step < 5) ? (EvlRand() % (3 * _winMs[0])) :
+                (step < 6) ? (EvlRand() % (2 * _winMs[1])) : (step % 200);
+        EvlSetTime(time);
+
+        //  Counters don't depend on whether events are recorded
+        if ((EvlRand() % 500) == 0)
+        {
+            enabled = !enabled;
+            el.RecordEvents(enabled);
+        }
+        //  Counter held by a context preempted while updating it; events
+        //  coming in meanwhile are left pending and counted by the next
+        //  event once it's released
+        if ((held == 0) && ((EvlRand() % 300) == 0))
+        {
+            hLib = EvlRand() % NUM_OF_MODULES;
+            hEv = EvlRand() % EVLOG_RL_EVENTS;
+            held = 1 + EvlRand() % 20;
+            _evlCheck::StatHold(hLib, hEv);
+        }
+
+        EventLog::EmitEvent(libUID, (int8_t)(rnd >> 16), (Events)event);
+        if ((libUID < NUM_OF_MODULES) && (event < EVLOG_RL_EVENTS))
+            m[libUID][event].Add(time, (held > 0) && (libUID == hLib) &&
+                                       (event == hEv));
+        if (!enabled)
+            off++;
+
+        if ((held > 0) && (--held == 0))
+        {
+            _evlCheck::StatHold(hLib, hEv);
+            EvlStatCompare(hLib, hEv, m[hLib][hEv]);
+        }
+        if ((held == 0) && ((EvlRand() % 200) == 0))
+            for (uint8_t j = 0; j < NUM_OF_MODULES; j++)
+                for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+                    EvlStatCompare(j, e, m[j][e]);
+    }
+    if (held > 0)
+        _evlCheck::StatHold(hLib, hEv);
+
+    //  Next event takes pending ones in
+    for (uint8_t j = 0; j < NUM_OF_MODULES; j++)
+        for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+        {
+            EvlSetTime(++time);
+            EventLog::EmitEvent(j, 0, (Events)e);
+            m[j][e].Add(time, false);
+            EvlStatCompare(j, e, m[j][e]);
+            if (_evlCheck::StatPending(j, e) != 0)
+                EvlFail("pending events not counted");
+        }
+    el.RecordEvents(true);
+
+    //  Steady stream of events, rate is estimated from two windows and has
+    //  to be within STAT_RATE_TOL of the actual number of events in the last
+    //  window once both windows are covered by the stream
+    EvlDefaults();
+    for (uint32_t i = 0; i < 43200; i++)
+    {
+        struct _evStat s;
+
+        //  250 ms apart on average
+        time += 150 + (EvlRand() % 201);
+        EvlSetTime(time);
+        EventLog::EmitEvent(0, 0, EVENT_OK);
+        steady.Add(time, false);
+        if ((i < (2 * _winMs[EVLOG_STAT_WINDOWS - 1] / 250)) ||
+            !el.GetStat(0, EVENT_OK, s))
+            continue;
+        for (uint8_t w = 0; w < EVLOG_STAT_WINDOWS; w++)
+        {
+            uint32_t actual = steady.Count(time + 1 - _winMs[w], time + 1);
+            double err = ((double)s.rate[w] - actual) / actual;
+
+            if (err < 0)
+                err = -err;
+            if (err > worst)
+                worst = err;
+        }
+    }
+    if (worst > STAT_RATE_TOL)
+        EvlFail("rate of steady events is off");
+
+    printf("Counters:               %u events, %u of them not recorded, rate "
+           "of steady events off by up to %.1f%%\n", nEvents / 10, off,
+           worst * 100.0);
+}
+
+///-----------------------------------------------------------------------------
+///         Older tiers
+///-----------------------------------------------------------------------------
+/**
+ * Model of older tiers, fed with every entry of the log in order of sequence
+ * numbers
+ */
+struct _evlTierModel
+{
+    std::vector<struct _evlEntry>   log;
+    uint32_t                        next;       //  Next entry to read
+    uint32_t                        folded;     //  Index in log
+    uint32_t                        dropBelow;  //  Sequence number
+    std::vector<struct _eventEntry> kept;
+    uint32_t                        keptStart;
+    std::vector<struct _evSummary>  sums;
+    uint32_t                        sumStart;
+
+    _evlTierModel(): folded(0), keptStart(0), sumStart(0)
+    {
+        next = dropBelow = EventLog::GetI().EndSeq();
+    }
+
+    uint32_t KeptBegin() const
+    {
+        return ((kept.size() - keptStart) > EVLOG_KEPT) ?
+               (kept.size() - EVLOG_KEPT) : keptStart;
+    }
+    uint32_t SumBegin() const
+    {
+        return ((sums.size() - sumStart) > EVLOG_SUMMARIES) ?
+               (sums.size() - EVLOG_SUMMARIES) : sumStart;
+    }
+    void Fold(const struct _eventEntry &e)
+    {
+        uint32_t bucket = (uint32_t)(e.timestamp / EVLOG_SUM_BUCKET_MS), total;
+        struct _evSummary *s = 0;
+
+        if (EVLOG_EVENT(e.event) & EVLOG_KEEP_EVENTS)
+            kept.push_back(e);
+        for (uint32_t i = sums.size(); (i > SumBegin()) && (s == 0); i--)
+        {
+            if (sums[i - 1].bucket != bucket)
+                break;
+            if (sums[i - 1].libUID == e.libUID)
+                s = &sums[i - 1];
+        }
+        if (s == 0)
+        {
+            struct _evSummary n;
+
+            memset(&n, 0, sizeof(n));
+            n.bucket = bucket;
+            n.libUID = e.libUID;
+            sums.push_back(n);
+            s = &sums.back();
+        }
+        total = s->counts[e.event] +
+                ((e.event == EVENT_SUPPRESSED) ? e.count : 1);
+        s->counts[e.event] = (total > 0xFFFF) ? 0xFFFF : total;
+        if ((e.event < EVENT_PRIOINV) && (e.event > s->highest))
+            s->highest = e.event;
+    }
+    //  Read entries logged since the last call, and fold those overwritten
+    void Update()
+    {
+        EventLog &el = EventLog::GetI();
+        struct _evIter it = el.SeekSeq(next);
+        struct _evlEntry e;
+        uint32_t oldest;
+
+        while (el.Next(it, e.entry))
+        {
+            e.seq = it.seq - 1;
+            log.push_back(e);
+            next = it.seq;
+        }
+        oldest = _evlCheck::OldestSeq();
+        for (; (folded < log.size()) &&
+               ((int32_t)(log[folded].seq - oldest) < 0); folded++)
+            if ((int32_t)(log[folded].seq - dropBelow) >= 0)
+                Fold(log[folded].entry);
+    }
+    void DropBefore(uint64_t time)
+    {
+        uint32_t i;
+
+        for (i = folded; (i < log.size()) && (log[i].entry.timestamp <= time);
+             i++);
+        if (i < log.size())
+        {
+            if ((int32_t)(log[i].seq - dropBelow) > 0)
+                dropBelow = log[i].seq;
+        }
+        else
+            dropBelow = next;
+        for (keptStart = KeptBegin(); (keptStart < kept.size()) &&
+             (kept[keptStart].timestamp <= time); keptStart++);
+        for (sumStart = SumBegin(); (sumStart < sums.size()) &&
+             (((sums[sumStart].bucket + 1ull) * EVLOG_SUM_BUCKET_MS) <=
+              (time + 1ull)); sumStart++);
+    }
+    void Reset()
+    {
+        dropBelow = next;
+        keptStart = kept.size();
+        sumStart = sums.size();
+    }
+};
+
+/**
+ * Compare older tiers with their model
+ */
+static void EvlTierCompare(const _evlTierModel &m)
+{
+    EventLog &el = EventLog::GetI();
+    uint32_t it = el.KeptBegin(), i = m.KeptBegin();
+    struct _eventEntry e;
+    struct _evSummary s;
+
+    for (; el.KeptNext(it, e); i++)
+        if ((i >= m.kept.size()) || !EvlSame(e, m.kept[i]))
+        {
+            EvlFail("kept entry differs from model");
+            return;
+        }
+    if (i != m.kept.size())
+        EvlFail("kept entries missing");
+
+    it = el.SummaryBegin();
+    for (i = m.SumBegin(); el.SummaryNext(it, s); i++)
+        if ((i >= m.sums.size()) || (s.bucket != m.sums[i].bucket) ||
+            (s.libUID != m.sums[i].libUID) ||
+            (s.highest != m.sums[i].highest) ||
+            memcmp(s.counts, m.sums[i].counts, sizeof(s.counts)))
+        {
+            EvlFail("summary differs from model");
+            return;
+        }
+    if (i != m.sums.size())
+        EvlFail("summaries missing");
+}
+
+static void EvlRunTiers(uint32_t nEvents)
+{
+    static const Events events[] = {EVENT_OK, EVENT_OK, EVENT_OK, EVENT_OK,
+                                    EVENT_HANG, EVENT_ERROR, EVENT_STARTUP,
+                                    EVENT_INITIALIZED};
+    EventLog &el = EventLog::GetI();
+    uint64_t time = TS_GetTimeMS();
+    uint32_t drops = 0, resets = 0;
+
+    //  About half of the run past 32 bits of ms, where drops must still cut
+    //  at the right time
+    if (time < (1ull << 32) - (nEvents / 10) * 750ull)
+        time = (1ull << 32) - (nEvents / 10) * 750ull;
+    EvlDefaults();
+    _evlTierModel m;
+
+    for (uint32_t i = 0; i < (nEvents / 10); i++)
+    {
+        uint32_t rnd = EvlRand();
+
+        time += rnd % 3000;
+        EvlSetTime(time);
+        rnd = EvlRand();
+        EventLog::EmitEvent(rnd % 6, (int8_t)((rnd >> 8) % 100),
+                            events[(rnd >> 16) % 8]);
+        if ((rnd >> 24) < 8)
+            el.FlushSuppressed();
+        m.Update();
+
+        //  Drop a part of the log, or of the older tiers only
+        rnd = EvlRand();
+        if (((rnd % 1000) == 0) && (m.folded < m.log.size()))
+        {
+            uint64_t cut = m.log[m.folded].entry.timestamp;
+            uint32_t k = m.KeptBegin();
+
+            //  Right at the time of a kept entry, or anywhere after the
+            //  oldest summary or the oldest entry still in the log
+            if ((rnd & 0x20000) && (k < m.kept.size()))
+                cut = m.kept[k + EvlRand() % (m.kept.size() - k)].timestamp;
+            else
+            {
+                if ((rnd & 0x10000) && (m.SumBegin() < m.sums.size()))
+                    cut = (uint64_t)m.sums[m.SumBegin()].bucket *
+                          EVLOG_SUM_BUCKET_MS;
+                cut += EvlRand() % (time + 1 - cut);
+            }
+            el.DropBefore(cut);
+            m.DropBefore(cut);
+            drops++;
+        }
+        else if ((rnd % 10000) == 1)
+        {
+            el.Reset();
+            m.Reset();
+            resets++;
+        }
+        else if ((rnd % 100) != 2)
+            continue;
+        EvlTierCompare(m);
+    }
+    EvlTierCompare(m);
+
+    printf("Tiers:                  %u entries overwritten, %u kept, %u "
+           "summaries, %u drops, %u resets\n", m.folded,
+           (uint32_t)m.kept.size(), (uint32_t)m.sums.size(), drops, resets);
+}
+
+///-----------------------------------------------------------------------------
+///         Reactive rules
+///-----------------------------------------------------------------------------
+//  Module serving tasks scheduled by rules - does nothing
+#define CHECK_UID       8
+static _kernelEntry _checkKer;
+void _CHECK_KernelCallback(void)
+{
+    _checkKer.retVal = STATUS_OK;
+}
+
+/**
+ * Model of a reactive rule, fed with every event it counts
+ */
+struct _evlRuleModel
+{
+    struct _evRule          rule;
+    std::vector<uint64_t>   hits;       //  Last events since rule fired
+    bool                    pending;    //  Fired, not scheduled yet
+    uint32_t                late;       //  Reached count, but not within T
+
+    /**
+     * Set random rule on one of the first 3 modules (so that rules match
+     * often) as rule [index], which is also its service ID
+     */
+    void Set(uint8_t index)
+    {
+        uint32_t rnd = EvlRand();
+
+        memset(&rule, 0, sizeof(rule));
+        rule.libUID = rnd % 3;
+        rule.event = EVENT_STARTUP + (rnd >> 8) % 5;
+        rule.count = 1 + (rnd >> 16) % EVLOG_RULE_HITS;
+        rule.windowMs = ((rnd >> 24) < 32) ? 0 : 100 * (1 + (rnd >> 24) % 20);
+        rule.svcUID = CHECK_UID;
+        rule.serviceID = index;
+        rule.argN = EvlRand() % (EVLOG_RULE_ARGS + 1);
+        for (uint8_t a = 0; a < rule.argN; a++)
+            rule.args[a] = (uint8_t)EvlRand();
+        hits.clear();
+        pending = false;
+
+        if (EventLog::GetI().SetRule(index, rule) != STATUS_OK)
+            EvlFail("rule not set");
+    }
+    /**
+     * Count event emitted at [time]; rule fires once [count] events are
+     * counted since it last fired, the first of the last [count] no more
+     * than [windowMs] ago
+     */
+    void Hit(uint64_t time)
+    {
+        hits.push_back(time);
+        if (hits.size() > rule.count)
+            hits.erase(hits.begin());
+        if (hits.size() < rule.count)
+            return;
+
+        if ((rule.windowMs == 0) || ((time - hits[0]) <= rule.windowMs))
+        {
+            pending = true;
+            hits.clear();
+        }
+        else
+            late++;
+    }
+};
+
+static void EvlRunRules(uint32_t nEvents)
+{
+    EventLog &el = EventLog::GetI();
+    TaskScheduler &ts = TaskScheduler::GetI();
+    uint64_t time = TS_GetTimeMS();
+    uint32_t fired = 0, sets = 0, held = 0, late = 0;
+    _evlRuleModel m[EVLOG_RULES];
+
+    EvlDefaults();
+    _checkKer.callBackFunc = _CHECK_KernelCallback;
+    TS_RegCallback(&_checkKer, CHECK_UID);
+    while (!ts.IsEmpty())
+        ts.PopFront();
+    for (uint8_t r = 0; r < EVLOG_RULES; r++)
+    {
+        m[r].late = 0;
+        m[r].Set(r);
+    }
+
+    for (uint32_t i = 0; i < (nEvents / 10); i++)
+    {
+        uint32_t rnd = EvlRand();
+        uint8_t r = (rnd >> 8) % EVLOG_RULES, n = 1, libUID, event;
+        bool hold = false;
+
+        //  Mostly a few ms apart, now and then longer than any window
+        time += ((rnd % 500) == 0) ? 5000 : (rnd >> 16) % 30;
+        EvlSetTime(time);
+
+        rnd = EvlRand();
+        libUID = rnd % 4;
+        event = EVENT_STARTUP + (rnd >> 8) % 5;
+        //  Change a rule, possibly one that fired and wasn't scheduled yet
+        if ((rnd >> 16) % 100 == 0)
+        {
+            if ((rnd >> 24) & 1)
+                m[r].Set(r);
+            else
+            {
+                el.ClearRule(r);
+                el.SetRule(r, m[r].rule);
+                m[r].hits.clear();
+                m[r].pending = false;
+            }
+            sets++;
+        }
+        //  Events emitted while rule is being changed, enough to fire it
+        else if ((rnd >> 16) % 100 == 1)
+        {
+            _evlCheck::RuleHold(r);
+            libUID = m[r].rule.libUID;
+            event = m[r].rule.event;
+            n = m[r].rule.count;
+            hold = true;
+            held++;
+        }
+
+        for (uint8_t k = 0; k < n; k++)
+        {
+            EventLog::EmitEvent(libUID, 0, (Events)event);
+            for (uint8_t q = 0; q < EVLOG_RULES; q++)
+                if ((m[q].rule.libUID == libUID) &&
+                    (m[q].rule.event == event) && !(hold && (q == r)))
+                    m[q].Hit(time);
+        }
+        if (hold)
+            _evlCheck::RuleHold(r);
+        if (!ts.IsEmpty())
+        {
+            EvlFail("task scheduled from within EmitEvent()");
+            while (!ts.IsEmpty())
+                ts.PopFront();
+        }
+
+        //  Main loop doesn't get to run after every event
+        if ((EvlRand() % 4) != 0)
+            continue;
+
+        uint32_t expect = 0, got = el.ScheduleRules();
+
+        for (uint8_t q = 0; q < EVLOG_RULES; q++)
+            expect += m[q].pending;
+        if ((got != expect) || (ts.NumOfTasks() != expect))
+            EvlFail("rules fired a wrong number of times");
+        while (!ts.IsEmpty())
+        {
+            TaskEntry te = ts.PopFront();
+            uint8_t q = te.GetTaskUID();
+
+            if ((te.GetLibUID() != CHECK_UID) || (q >= EVLOG_RULES) ||
+                !m[q].pending || (te.GetArgN() != m[q].rule.argN) ||
+                memcmp(te.GetArgs(), m[q].rule.args, m[q].rule.argN))
+            {
+                EvlFail("wrong task scheduled by rule");
+                continue;
+            }
+            m[q].pending = false;
+            fired++;
+        }
+        //  Model starts over after a failure
+        for (uint8_t q = 0; q < EVLOG_RULES; q++)
+            m[q].pending = false;
+    }
+
+    for (uint8_t r = 0; r < EVLOG_RULES; r++)
+    {
+        el.ClearRule(r);
+        late += m[r].late;
+    }
+    if (el.ScheduleRules() != 0)
+        EvlFail("cleared rule scheduled a task");
+    while (!ts.IsEmpty())
+        ts.PopFront();
+
+    printf("Rules:                  %u events, %u tasks scheduled, %u hits "
+           "outside window, %u rules changed, %u held\n", nEvents / 10, fired,
+           late, sets, held);
+}
+
+/**
+ * Sections of the check, see top of the file
+ */
+struct _evlSection
+{
+    const char *name;
+    void (*run)(uint32_t nEvents);
+};
+static const _evlSection _sections[] =
+{
+    {"stress", EvlRunStress},
+    {"queries", EvlRunQueries},
+    {"suppress", EvlRunSuppress},
+    {"counters", EvlRunCounters},
+    {"rules", EvlRunRules},
+    //  Move the clock past 32 bits of ms
+    {"tiers", EvlRunTiers},
+    {"codec", EvlRunCodec},
+};
+
+int main(int argc, char **argv)
+{
+    const char *filter = 0;
+    uint32_t nEvents = 500000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i+1 < argc))
+            nEvents = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+            _rndState = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-f") && (i+1 < argc))
+            filter = argv[++i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n events] [-s seed] [-f section]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if ((_rndState == 0) || (nEvents == 0))
+    {
+        fprintf(stderr, "Seed and number of events must not be 0\n");
+        return 1;
+    }
+
+    //  Same initialization sequence as on the target (see main.cpp)
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    EventLog::GetI().InitSW();
+
+    for (uint8_t s = 0; s < sizeof(_sections)/sizeof(_sections[0]); s++)
+        if ((filter == 0) || (strstr(_sections[s].name, filter) != 0))
+            _sections[s].run(nEvents);
+
+    printf("Result:                 %s\n", _errors ? "FAIL" : "OK");
+
+    return (_errors == 0) ? 0 : 2;
+}
+
+#endif  /* __BOARD_HOST__ */
@@ -0,0 +1,431 @@
+/**
+ * evsBench.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Check and benchmark of the persistent event log store (host build only)
+ *  Flash region is backed by a file (see HAL_FLASH_HostOpen()). Pseudo-random
+ *  events are emitted and persisted from the "main loop" at random intervals,
+ *  then the file is closed and opened again to emulate a reboot, and entries
+ *  read back from the store are compared with the ones that were logged.
+ *  Power loss is emulated by a medium that stops programming or erasing part
+ *  way through; records written before it have to survive and appending has
+ *  to continue. Finally a long run checks that all sectors are erased equally
+ *  often. Reports time to mount and to append; exit status is non-zero on
+ *  any mismatch.
+ *
+ *  Usage: evsBench [-n events] [-f flashFile] [-s seed] [-v]
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "init/eventLog.h"
+#include "init/evlogCodec.h"
+#include "init/evlogStore.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+static bool _verbose = false;
+static uint32_t _errors = 0;
+
+static inline uint64_t EvsNowNs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/**
+ * Small xorshift PRNG -> same stream on every platform for a given seed
+ */
+static uint32_t _rndState;
+static uint32_t EvsRand()
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    return _rndState;
+}
+
+/**
+ * Report failed check
+ */
+static void EvsFail(const char *what)
+{
+    _errors++;
+    printf("FAILED: %s\n", what);
+}
+
+///-----------------------------------------------------------------------------
+///         Medium losing power part way through an operation
+///-----------------------------------------------------------------------------
+//  Bytes left to program before "power loss", -1 for unlimited
+static int32_t _tearBytes = -1;
+//  Next erase stops half way through the sector
+static bool _tearErase = false;
+
+static bool EvsTearErase(uint32_t sector)
+{
+    if (!_tearErase)
+        return HAL_FLASH_Erase(sector);
+
+    //  First half of the sector erased, then the power went out: erase all
+    //  of it and program old content back into the second half
+    static uint32_t old[HAL_FLASH_SECTOR_SIZE / 8];
+    uint32_t half = sector * HAL_FLASH_SECTOR_SIZE + HAL_FLASH_SECTOR_SIZE / 2;
+
+    HAL_FLASH_Read(half, old, sizeof(old));
+    HAL_FLASH_Erase(sector);
+    HAL_FLASH_Program(half, old, sizeof(old));
+    _tearErase = false;
+
+    return false;
+}
+
+static bool EvsTearProgram(uint32_t offset, const uint32_t *src, uint32_t len)
+{
+    if (_tearBytes < 0)
+        return HAL_FLASH_Program(offset, src, len);
+
+    //  Whole words are programmed up to the power loss
+    uint32_t n = ((uint32_t)_tearBytes < len) ? (_tearBytes & ~0x03) : len;
+    if (n > 0)
+        HAL_FLASH_Program(offset, src, n);
+    _tearBytes = -1;
+
+    return n == len;
+}
+
+static const struct _evsMedium _tearMedium =
+{
+    HAL_FLASH_SECTOR_SIZE,
+    HAL_FLASH_SECTORS,
+    EvsTearErase,
+    EvsTearProgram,
+    HAL_FLASH_Read
+};
+
+///-----------------------------------------------------------------------------
+///         Reading the store back
+///-----------------------------------------------------------------------------
+
+/**
+ * Read all records from the store
+ * @param entries [out] decoded entries of EVLOG_REC_BLOCK records
+ * @param raw [out] all records, as type followed by data
+ * @return number of EVLOG_REC_BOOT records
+ */
+static uint32_t EvsReadAll(std::vector<struct _eventEntry> &entries,
+                           std::vector<std::vector<uint8_t> > *raw)
+{
+    struct _evsCursor cur = EVS_Begin();
+    struct _eventEntry dec[EVLOG_BLOCK_SIZE];
+    uint8_t rec[255], type, len;
+    uint32_t boots = 0;
+
+    entries.clear();
+    if (raw)
+        raw->clear();
+
+    while (EVS_Next(cur, type, rec, len))
+    {
+        if (raw)
+        {
+            raw->push_back(std::vector<uint8_t>(1, type));
+            raw->back().insert(raw->back().end(), rec, rec + len);
+        }
+
+        if (type == EVLOG_REC_BOOT)
+            boots++;
+        else if (type == EVLOG_REC_BLOCK)
+        {
+            uint32_t n = EVC_DecodeBlock(rec, len, dec, EVLOG_BLOCK_SIZE);
+            entries.insert(entries.end(), dec, dec + n);
+        }
+    }
+
+    return boots;
+}
+
+static bool EvsSame(const struct _eventEntry &a, const struct _eventEntry &b)
+{
+    return (a.timestamp == b.timestamp) && (a.libUID == b.libUID) &&
+           (a.taskID == b.taskID) && (a.event == b.event);
+}
+
+/**
+ * "Reboot": close flash file, open it again and mount the store
+ * @return time spent in EVS_Mount() in ns
+ */
+static uint64_t EvsReboot(const char *path)
+{
+    uint64_t t0;
+
+    HAL_FLASH_HostClose();
+    if (!HAL_FLASH_HostOpen(path))
+    {
+        EvsFail("can't reopen flash file");
+        return 0;
+    }
+
+    t0 = EvsNowNs();
+    if (EVS_Mount(&EVS_FlashMedium) != STATUS_OK)
+        EvsFail("mount after reboot");
+    return EvsNowNs() - t0;
+}
+
+///-----------------------------------------------------------------------------
+///         Test phases
+///-----------------------------------------------------------------------------
+
+/**
+ * Log events, persist them and read them back after a reboot
+ */
+static void EvsRunLog(uint32_t nEvents, const char *path)
+{
+    EventLog &el = EventLog::GetI();
+    std::vector<struct _eventEntry> logged, stored;
+    struct _evIter it = el.Begin();
+    struct _eventEntry e;
+    uint64_t tPersist = 0, tMount;
+    uint32_t calls = 0, boots;
+    struct _evsStats st;
+
+    for (uint32_t i = 0; i < nEvents; i++)
+    {
+        //  Mostly short gaps, sometimes a few seconds of silence
+        HAL_TS_SimTick((EvsRand() % 8) ? (EvsRand() % 100) : (EvsRand() % 5000));
+        EventLog::EmitEvent(EvsRand() % NUM_OF_MODULES, EvsRand() % 12,
+                            (Events)(1 + EvsRand() % 5));
+
+        while (el.Next(it, e))
+            logged.push_back(e);
+
+        if ((EvsRand() % 16) == 0)
+        {
+            uint64_t t0 = EvsNowNs();
+            if (el.Persist(false) != STATUS_OK)
+                EvsFail("persist");
+            tPersist += EvsNowNs() - t0;
+            calls++;
+        }
+    }
+    if (el.Persist(true) != STATUS_OK)
+        EvsFail("persist all");
+
+    tMount = EvsReboot(path);
+    boots = EvsReadAll(stored, 0);
+    EVS_GetStats(st);
+
+    //  Store keeps the newest entries, all of them unchanged
+    if (stored.empty() || (stored.size() > logged.size()))
+        EvsFail("number of stored entries");
+    else
+    {
+        uint32_t skip = logged.size() - stored.size();
+
+        for (uint32_t i = 0; i < stored.size(); i++)
+            if (!EvsSame(stored[i], logged[skip + i]))
+            {
+                if (_verbose)
+                    printf("entry %u: stored %llu/%d/%d/%d logged %llu\n", i,
+                           (unsigned long long)stored[i].timestamp,
+                           stored[i].libUID, stored[i].taskID, stored[i].event,
+                           (unsigned long long)logged[skip + i].timestamp);
+                EvsFail("stored entry differs from logged one");
+                break;
+            }
+    }
+
+    printf("Events logged:          %zu\n", logged.size());
+    printf("Entries in store:       %zu in %u segments (%.2f bytes/entry)\n",
+           stored.size(), st.segments,
+           stored.empty() ? 0.0 : (double)(((st.segments - 1) *
+           HAL_FLASH_SECTOR_SIZE) + st.used) / stored.size());
+    printf("Startup records:        %u\n", boots);
+    printf("Persist() calls:        %u, %.1f us on average\n", calls,
+           calls ? (double)tPersist / calls / 1000.0 : 0.0);
+    printf("Mount after reboot:     %.1f us\n", (double)tMount / 1000.0);
+}
+
+/**
+ * Emulate power loss while appending records and while opening a segment
+ */
+static void EvsRunPowerLoss(const char *path, uint32_t rounds)
+{
+    std::vector<std::vector<uint8_t> > before, after;
+    std::vector<struct _eventEntry> entries;
+    uint8_t data[255];
+    uint32_t torn = 0;
+
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        uint8_t len = 1 + EvsRand() % 200;
+
+        for (uint32_t i = 0; i < len; i++)
+            data[i] = (uint8_t)EvsRand();
+
+        EvsReadAll(entries, &before);
+
+        //  Every 8th round the erase of the next segment is cut instead
+        EVS_Mount(&_tearMedium);
+        if ((r % 8) == 7)
+        {
+            struct _evsStats st;
+
+            //  Fill up the newest segment, so the next record opens a new one
+            EVS_GetStats(st);
+            while (HAL_FLASH_SECTOR_SIZE - st.used >= 4 + 256)
+            {
+                EVS_Append(0x10, data, 255);
+                EVS_GetStats(st);
+            }
+            EvsReadAll(entries, &before);
+            _tearErase = true;
+        }
+        else
+            _tearBytes = EvsRand() % (4 + len);
+
+        if (EVS_Append(0x11, data, len) == STATUS_OK)
+        {
+            //  Nothing was cut, record is complete
+            before.push_back(std::vector<uint8_t>(1, 0x11));
+            before.back().insert(before.back().end(), data, data + len);
+        }
+        else
+            torn++;
+        _tearBytes = -1;
+        _tearErase = false;
+
+        EvsReboot(path);
+        EvsReadAll(entries, &after);
+
+        //  Records written before power loss survive (except the oldest ones
+        //  if a segment was reused)
+        if ((after.size() > before.size()) ||
+            !std::equal(after.begin(), after.end(),
+                        before.end() - after.size()))
+        {
+            if (_verbose)
+                printf("round %u: %zu records before, %zu after\n", r,
+                       before.size(), after.size());
+            EvsFail("records lost or damaged after power loss");
+            return;
+        }
+
+        //  And appending carries on
+        if (EVS_Append(0x12, data, len) != STATUS_OK)
+            EvsFail("append after power loss");
+        EvsReadAll(entries, &after);
+        if (after.empty() || (after.back().size() != (uint32_t)len + 1) ||
+            (after.back()[0] != 0x12))
+        {
+            if (_verbose)
+                printf("round %u: %zu records, last %zu bytes type %u\n", r,
+                       after.size(), after.empty() ? 0 : after.back().size(),
+                       after.empty() ? 0 : after.back()[0]);
+            EvsFail("record appended after power loss not found");
+            return;
+        }
+    }
+
+    printf("Power loss rounds:      %u (%u records cut)\n", rounds, torn);
+}
+
+/**
+ * Fill the store many times over and check spread of erases among sectors
+ */
+static void EvsRunWear(uint32_t nRecords)
+{
+    uint8_t data[255];
+    uint32_t lo = 0xFFFFFFFF, hi = 0, e0[HAL_FLASH_SECTORS];
+    uint64_t t0, tAppend;
+    struct _evsStats st;
+
+    memset(data, 0x5A, sizeof(data));
+    for (uint32_t i = 0; i < HAL_FLASH_SECTORS; i++)
+        e0[i] = HAL_FLASH_HostErases(i);
+
+    t0 = EvsNowNs();
+    for (uint32_t i = 0; i < nRecords; i++)
+        if (EVS_Append(0x20, data, 16 + EvsRand() % 64) != STATUS_OK)
+        {
+            EvsFail("append");
+            return;
+        }
+    tAppend = EvsNowNs() - t0;
+
+    for (uint32_t i = 0; i < HAL_FLASH_SECTORS; i++)
+    {
+        uint32_t n = HAL_FLASH_HostErases(i) - e0[i];
+
+        lo = (n < lo) ? n : lo;
+        hi = (n > hi) ? n : hi;
+    }
+    EVS_GetStats(st);
+
+    if ((hi - lo) > 1)
+        EvsFail("sectors not erased evenly");
+
+    //  Counts in headers can be apart by more, cut erases count as the worst
+    printf("Wear:                   %u records, %u-%u erases per sector "
+           "(headers %u-%u)\n", nRecords, lo, hi, st.minErases, st.maxErases);
+    printf("Append:                 %.2f us per record\n",
+           (double)tAppend / nRecords / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = "/tmp/evsBench.flash";
+    uint32_t nEvents = 20000;
+
+    _rndState = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i+1 < argc))
+            nEvents = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-f") && (i+1 < argc))
+            path = argv[++i];
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+            _rndState = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-v"))
+            _verbose = true;
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n events] [-f flashFile] [-s seed] "
+                    "[-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (_rndState == 0)
+        _rndState = 1;
+
+    TaskScheduler::GetI().InitHW(1);
+    EventLog::GetI().InitSW();
+
+    //  Start from an empty store in a fresh file
+    if (!HAL_FLASH_HostOpen(path) || (EVS_Mount(&EVS_FlashMedium) != STATUS_OK)
+        || (EVS_Format() != STATUS_OK))
+    {
+        fprintf(stderr, "Can't set up flash file %s\n", path);
+        return 1;
+    }
+
+    EvsRunLog(nEvents, path);
+    EvsRunPowerLoss(path, 200);
+    EvsRunWear(20000);
+
+    HAL_FLASH_HostClose();
+    printf("Result:                 %s\n", _errors ? "FAIL" : "OK");
+
+    return (_errors == 0) ? 0 : 2;
+}
+
+#endif  /* __BOARD_HOST__ */
@@ -0,0 +1,303 @@
+/**
+ * fmtBench.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Check and benchmark of the fast formatter (host build only)
+ *  Every case is a format string with a generator of arguments. For each
+ *  case, output of FF_Snprintf is compared with vsnprintf from the C library
+ *  (what SerialPort::Send used so far) over pseudo-random arguments, output is
+ *  also formatted into a ring buffer across its wrap-around point and with
+ *  CR-LF expansion. Then both formatters are timed on the same arguments.
+ *  Output is CSV (case,ns_ff,ns_libc,speedup,mismatches); exit status is
+ *  non-zero on any mismatch.
+ *  @note UARTvprintf from TivaWare can't be built on host; it has no float
+ *  support and the firmware moved off it together with the TX ring buffer.
+ *
+ *  Usage: fmtBench [-n iterations] [-s seed] [-v]
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "serialPort/fastFormat.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+static inline uint64_t FmtNowNs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/**
+ * Small xorshift PRNG -> same stream on every platform for a given seed
+ */
+static uint32_t _rndState;
+static uint32_t FmtRand()
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    return _rndState;
+}
+
+/**
+ * Arguments of a single call, each case picks what it needs
+ */
+struct _fmtArgs
+{
+    int32_t     i;
+    uint32_t    u;
+    int64_t     ll;
+    double      d;
+    const char  *s;
+};
+
+typedef int (*_fmtFunc)(char*, uint16_t, const char*, ...);
+
+/**
+ * Benchmark case: format string and the way it's called
+ */
+struct _fmtCase
+{
+    const char  *name;
+    const char  *fmt;
+    uint8_t     args;       //  Kind of arguments, see FmtCall()
+};
+
+#define FA_INT      0   //  i
+#define FA_UINT     1   //  u
+#define FA_LL       2   //  ll
+#define FA_DBL      3   //  d
+#define FA_STR      4   //  s
+#define FA_MIX      5   //  u, i, s, d (as used by statistics printouts)
+#define FA_STAR     6   //  width, precision, d
+
+static const struct _fmtCase _cases[] =
+{
+    { "int",        "%d",                               FA_INT  },
+    { "int_flags",  "[%+6d|%-6d|%06d|% d|%.4d]",         FA_INT  },
+    { "uint",       "%u ms",                            FA_UINT },
+    { "hex",        "%x %08X %#x %#o",                  FA_UINT },
+    { "int64",      "%lld %llu",                        FA_LL   },
+    { "float2",     "%.2f",                             FA_DBL  },
+    { "float_def",  "%f %10.3f %-+9.1f %.0f",           FA_DBL  },
+    { "exp",        "%e %.3E %g %.4G %#g",              FA_DBL  },
+    { "string",     "<%s|%10s|%-8.3s>",                 FA_STR  },
+    { "star",       "%*.*f",                            FA_STAR },
+    { "stats_line", "\t[%u] Module %d raised event %s during task %.2f \n",
+                                                        FA_MIX  },
+};
+static const uint32_t _nCases = sizeof(_cases) / sizeof(_cases[0]);
+
+/**
+ * Generate pseudo-random arguments; values cover signs, magnitudes and
+ * rounding corner cases
+ */
+static void FmtGen(struct _fmtArgs &a)
+{
+    static const char *strs[] = { "", "a", "EVENT_OK", "Printing at T+4s",
+                                  "a somewhat longer string of text" };
+    static const double specials[] = { 0.0, -0.0, 0.5, 1.5, 2.5, -0.125,
+                                       0.005, 9.995, 99.5, 1e-5, 123456789.0,
+                                       1e18, 5e-300 };
+    uint32_t r = FmtRand();
+
+    a.u = FmtRand() >> (r & 31);
+    a.i = (int32_t)a.u * ((r & 0x20) ? -1 : 1);
+    a.ll = ((int64_t)FmtRand() << 32 | FmtRand()) >> ((r >> 6) & 63);
+    a.s = strs[(r >> 12) % 5];
+
+    switch ((r >> 16) % 4)
+    {
+    case 0:
+        a.d = specials[(r >> 20) % (sizeof(specials) / sizeof(specials[0]))];
+        break;
+    case 1:
+        //  Values the way they come from float sensors
+        a.d = (float)((int32_t)FmtRand() % 2000000) / 1000.0f;
+        break;
+    case 2:
+        a.d = (double)(int32_t)FmtRand() / (double)(FmtRand() | 1);
+        break;
+    default:
+        a.d = (double)(int32_t)FmtRand() * 1e-3;
+        break;
+    }
+}
+
+/**
+ * Format a case with given formatter
+ */
+static int FmtCall(_fmtFunc f, char *dst, uint16_t size,
+                   const struct _fmtCase &c, const struct _fmtArgs &a)
+{
+    switch (c.args)
+    {
+    case FA_INT:
+        return f(dst, size, c.fmt, a.i, a.i, a.i, a.i, a.i);
+    case FA_UINT:
+        return f(dst, size, c.fmt, a.u, a.u, a.u, a.u);
+    case FA_LL:
+        return f(dst, size, c.fmt, (long long)a.ll, (unsigned long long)a.ll);
+    case FA_DBL:
+        return f(dst, size, c.fmt, a.d, a.d, a.d, a.d, a.d);
+    case FA_STR:
+        return f(dst, size, c.fmt, a.s, a.s, a.s);
+    case FA_MIX:
+        return f(dst, size, c.fmt, a.u, a.i, a.s, a.d);
+    default:
+        return f(dst, size, c.fmt, (int)(a.u % 12), (int)(a.u % 7), a.d);
+    }
+}
+
+/**
+ * Library snprintf with the signature of FF_Snprintf
+ */
+static int FmtLibc(char *dst, uint16_t size, const char *fmt, ...)
+{
+    va_list ap;
+    int len;
+
+    va_start(ap, fmt);
+    len = vsnprintf(dst, size, fmt, ap);
+    va_end(ap);
+
+    return len;
+}
+
+/**
+ * Format into a ring of 64 bytes starting close to its end, the way
+ * SerialPort::Send formats into TX ring buffer
+ */
+static uint32_t FmtRing(char *dst, uint16_t start, const char *fmt, ...)
+{
+    uint8_t ring[64];
+    struct _ffOut out;
+    va_list ap;
+
+    out.buf = ring;
+    out.mask = sizeof(ring) - 1;
+    out.start = start;
+    out.cap = sizeof(ring);
+    out.crlf = true;
+    out.len = 0;
+
+    va_start(ap, fmt);
+    FF_VFormat(out, fmt, ap);
+    va_end(ap);
+
+    for (uint32_t i = 0; (i < out.len) && (i < out.cap); i++)
+        dst[i] = ring[(start + i) & out.mask];
+    dst[(out.len < out.cap) ? out.len : out.cap] = '\0';
+
+    return out.len;
+}
+
+/**
+ * Check ring output (with CR-LF expansion) against expected text
+ */
+static bool FmtRingCheck(const char *exp, const struct _fmtArgs &a,
+                         uint16_t start, bool verbose)
+{
+    char got[128], crlf[256];
+    uint32_t n = 0, len;
+
+    for (const char *p = exp; *p != '\0'; p++)
+    {
+        if (*p == '\n')
+            crlf[n++] = '\r';
+        crlf[n++] = *p;
+    }
+    crlf[n] = '\0';
+
+    len = FmtRing(got, start, "%s|%d\n%u\n", exp, a.i, a.u);
+    snprintf(crlf + n, sizeof(crlf) - n, "|%d\r\n%u\r\n", a.i, a.u);
+    if ((len == strlen(crlf)) && !strncmp(got, crlf, 64))
+        return true;
+
+    if (verbose)
+        printf("ring mismatch at %u:\n  got: %s\n  exp: %.64s\n", start, got,
+               crlf);
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t nIter = 20000, errors = 0;
+    bool verbose = false;
+    std::vector<struct _fmtArgs> args;
+
+    _rndState = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i+1 < argc))
+            nIter = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+            _rndState = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n iterations] [-s seed] [-v]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (_rndState == 0)
+        _rndState = 1;
+
+    args.resize(nIter);
+    for (uint32_t i = 0; i < nIter; i++)
+        FmtGen(args[i]);
+
+    printf("case,ns_ff,ns_libc,speedup,mismatches\n");
+    for (uint32_t c = 0; c < _nCases; c++)
+    {
+        char exp[256], got[256];
+        uint32_t mismatches = 0;
+        uint64_t t0, tFF, tLibc;
+        volatile int sink = 0;
+
+        for (uint32_t i = 0; i < nIter; i++)
+        {
+            int le = FmtCall(FmtLibc, exp, sizeof(exp), _cases[c], args[i]),
+                lg = FmtCall(FF_Snprintf, got, sizeof(got), _cases[c], args[i]);
+
+            if ((le != lg) || strcmp(exp, got))
+            {
+                if (verbose && (mismatches < 5))
+                    printf("%s:\n  got: %s\n  exp: %s\n", _cases[c].name, got,
+                           exp);
+                mismatches++;
+            }
+            else if (!FmtRingCheck(exp, args[i], (uint16_t)(i % 64), verbose))
+                mismatches++;
+        }
+
+        t0 = FmtNowNs();
+        for (uint32_t i = 0; i < nIter; i++)
+            sink += FmtCall(FF_Snprintf, got, sizeof(got), _cases[c], args[i]);
+        tFF = FmtNowNs() - t0;
+
+        t0 = FmtNowNs();
+        for (uint32_t i = 0; i < nIter; i++)
+            sink += FmtCall(FmtLibc, exp, sizeof(exp), _cases[c], args[i]);
+        tLibc = FmtNowNs() - t0;
+
+        printf("%s,%.1f,%.1f,%.2f,%u\n", _cases[c].name, (double)tFF / nIter,
+               (double)tLibc / nIter, (double)tLibc / (double)(tFF | 1),
+               mismatches);
+        errors += mismatches;
+    }
+
+    return (errors == 0) ? 0 : 2;
+}
+
+#endif  /* __BOARD_HOST__ */
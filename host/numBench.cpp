@@ -0,0 +1,637 @@
+/**
+ * numBench.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Check and benchmark of number parsing and formatting in libs/myLib (host
+ *  build only)
+ *  Correctness is checked against the C library: integers are formatted and
+ *  parsed back over the 32-bit range (every value with -e, otherwise with a
+ *  stride) and over pseudo-random 64-bit values; overflow and malformed input
+ *  go through a table of edge cases; parseFloat is compared bit-for-bit with
+ *  strtof, fmtFloat with snprintf("%.*f") and parseFixed with an integer
+ *  reference.
+ *  Then every conversion is timed against the previous implementation of
+ *  stoi/stof/itoa (kept below as reference) and the C library. Times are in
+ *  TSC cycles on x86 and in ns elsewhere. Output is CSV
+ *  (conversion,new,legacy,libc,speedup_vs_legacy), followed by the number of
+ *  wrong results of legacy functions on the same input; exit status is
+ *  non-zero on any mismatch of the new functions.
+ *
+ *  Usage: numBench [-n iterations] [-s seed] [-e] [-v]
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "libs/myLib.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static inline uint64_t NumNow()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+#endif
+}
+
+/**
+ * Small xorshift PRNG -> same stream on every platform for a given seed
+ */
+static uint32_t _rndState;
+static uint32_t NumRand()
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    return _rndState;
+}
+
+static uint64_t NumRand64()
+{
+    uint64_t v = ((uint64_t)NumRand() << 32) | NumRand();
+
+    //  Spread over all magnitudes
+    return v >> (NumRand() & 63);
+}
+
+static uint32_t _errors = 0;
+static bool _verbose = false;
+
+static void NumFail(const char *what, const char *in, const char *got,
+                    const char *exp)
+{
+    if (_verbose || (_errors < 10))
+        printf("%s(\"%s\"): got %s, expected %s\n", what, in, got, exp);
+    _errors++;
+}
+
+///-----------------------------------------------------------------------------
+///         Previous implementation, kept as reference
+///-----------------------------------------------------------------------------
+
+__attribute__((noinline)) static float LegacyStof(uint8_t *nums, uint8_t strLen)
+{
+    float retVal = 0, multiplier = 1;
+    uint8_t itB = 0, itE = 0;
+    int8_t i;
+
+    if (nums[0] == '-') itB = 1;
+    while((nums[itE] != '.') && (nums[itE] != '\0') && (itE < strLen)) itE++;
+    for (i = (itE - 1); i >= itB; i--)
+    {
+        if ((nums[i] < 48) || (nums[i] > 58)) continue;
+        retVal += ((int)nums[i] - 48) * multiplier;
+        multiplier *= 10;
+    }
+    multiplier = 0.1;
+    for (i = (itE + 1); i < strLen; i++)
+    {
+        if ((nums[i] < 48) || (nums[i] > 58)) continue;
+        retVal += (float)((int32_t)nums[i] - 48) * multiplier;
+        multiplier /= 10;
+    }
+    if (itB == 1) retVal *= (-1);
+
+    return retVal;
+}
+
+__attribute__((noinline)) static int32_t LegacyStoi(uint8_t *nums, uint8_t strLen)
+{
+    int32_t retVal = 0, multiplier = 1;
+    uint8_t itB = 0;
+    int8_t i;
+
+    if (nums[0] == '-') itB = 1;
+    for (i = (strLen - 1); i >= itB; i--)
+    {
+        if ((nums[i] < 48) || (nums[i] > 58)) continue;
+        retVal += ((int32_t)nums[i] - 48) * multiplier;
+        multiplier *= 10;
+    }
+    if (itB == 1) retVal *= (-1);
+
+    return retVal;
+}
+
+__attribute__((noinline)) static void LegacyItoa(int32_t num, uint8_t *str)
+{
+    uint8_t it = 0;
+
+    if (num < 0)
+    {
+        str[it++]= '-';
+        num = labs(num);
+    }
+    uint8_t digits = 1;
+    while ( (num / ((int32_t)powf(10.0f, (float)digits))) > 0)
+        digits++;
+    it += (digits -1);
+    while ((digits--) > 0)
+    {
+        str[it--] = (uint8_t)(48 + num % 10);
+        num /=10;
+    }
+}
+
+///-----------------------------------------------------------------------------
+///         Correctness checks
+///-----------------------------------------------------------------------------
+
+/**
+ * Format 32-bit value and parse it back, signed and unsigned
+ */
+static void NumCheck32(uint32_t u)
+{
+    char exp[24], got[24];
+    uint8_t n;
+    uint32_t pu = 0;
+    int32_t pi = 0;
+
+    n = fmtU32(u, got);
+    snprintf(exp, sizeof(exp), "%u", u);
+    if ((n != strlen(exp)) || strcmp(got, exp))
+        NumFail("fmtU32", exp, got, exp);
+    if ((parseU32(exp, n, &pu) != n) || (pu != u))
+    {
+        snprintf(got, sizeof(got), "%u", pu);
+        NumFail("parseU32", exp, got, exp);
+    }
+
+    n = fmtI32((int32_t)u, got);
+    snprintf(exp, sizeof(exp), "%d", (int32_t)u);
+    if ((n != strlen(exp)) || strcmp(got, exp))
+        NumFail("fmtI32", exp, got, exp);
+    if ((parseI32(exp, n, &pi) != n) || (pi != (int32_t)u))
+    {
+        snprintf(got, sizeof(got), "%d", pi);
+        NumFail("parseI32", exp, got, exp);
+    }
+}
+
+/**
+ * Format 64-bit value and parse it back, signed and unsigned
+ */
+static void NumCheck64(uint64_t u)
+{
+    char exp[24], got[24];
+    uint8_t n;
+    uint64_t pu = 0;
+    int64_t pi = 0;
+
+    n = fmtU64(u, got);
+    snprintf(exp, sizeof(exp), "%llu", (unsigned long long)u);
+    if ((n != strlen(exp)) || strcmp(got, exp))
+        NumFail("fmtU64", exp, got, exp);
+    if ((parseU64(exp, n, &pu) != n) || (pu != u))
+    {
+        snprintf(got, sizeof(got), "%llu", (unsigned long long)pu);
+        NumFail("parseU64", exp, got, exp);
+    }
+
+    n = fmtI64((int64_t)u, got);
+    snprintf(exp, sizeof(exp), "%lld", (long long)u);
+    if ((n != strlen(exp)) || strcmp(got, exp))
+        NumFail("fmtI64", exp, got, exp);
+    if ((parseI64(exp, n, &pi) != n) || (pi != (int64_t)u))
+    {
+        snprintf(got, sizeof(got), "%lld", (long long)pi);
+        NumFail("parseI64", exp, got, exp);
+    }
+}
+
+/**
+ * Edge cases of integer parsing: expected number of consumed characters
+ * (0 = rejected) for each width
+ */
+struct _numEdge
+{
+    const char  *str;
+    uint16_t    u32, i32, u64, i64;
+};
+
+static const struct _numEdge _edges[] =
+{
+    { "",                       0,  0,  0,  0  },
+    { "-",                      0,  0,  0,  0  },
+    { "+",                      0,  0,  0,  0  },
+    { ":",                      0,  0,  0,  0  },
+    { "/1",                     0,  0,  0,  0  },
+    { "--1",                    0,  0,  0,  0  },
+    { "-+1",                    0,  0,  0,  0  },
+    { "+-1",                    0,  0,  0,  0  },
+    { "12:",                    2,  2,  2,  2  },
+    { "12.5",                   2,  2,  2,  2  },
+    { "-7",                     0,  2,  0,  2  },
+    { "+7",                     2,  2,  2,  2  },
+    { "2147483647",             10, 10, 10, 10 },
+    { "2147483648",             10, 0,  10, 10 },
+    { "-2147483648",            0,  11, 0,  11 },
+    { "-2147483649",            0,  0,  0,  11 },
+    { "4294967295",             10, 0,  10, 10 },
+    { "4294967296",             0,  0,  10, 10 },
+    { "9223372036854775807",    0,  0,  19, 19 },
+    { "9223372036854775808",    0,  0,  19, 0  },
+    { "-9223372036854775808",   0,  0,  0,  20 },
+    { "-9223372036854775809",   0,  0,  0,  0  },
+    { "18446744073709551615",   0,  0,  20, 0  },
+    { "18446744073709551616",   0,  0,  0,  0  },
+    { "99999999999999999999",   0,  0,  0,  0  },
+    { "00000000000000000000000000000042", 32, 32, 32, 32 },
+    { "1234567812345678x",      0,  0,  16, 16 },
+};
+
+static void NumCheckEdges()
+{
+    char got[32], exp[32];
+
+    for (uint32_t i = 0; i < sizeof(_edges) / sizeof(_edges[0]); i++)
+    {
+        const struct _numEdge &e = _edges[i];
+        uint16_t len = strlen(e.str), n[4];
+        uint32_t u32;
+        int32_t i32;
+        uint64_t u64;
+        int64_t i64;
+
+        n[0] = parseU32(e.str, len, &u32);
+        n[1] = parseI32(e.str, len, &i32);
+        n[2] = parseU64(e.str, len, &u64);
+        n[3] = parseI64(e.str, len, &i64);
+
+        if ((n[0] != e.u32) || (n[1] != e.i32) || (n[2] != e.u64) ||
+            (n[3] != e.i64))
+        {
+            snprintf(got, sizeof(got), "%u/%u/%u/%u", n[0], n[1], n[2], n[3]);
+            snprintf(exp, sizeof(exp), "%u/%u/%u/%u", e.u32, e.i32, e.u64,
+                     e.i64);
+            NumFail("parse*", e.str, got, exp);
+        }
+        //  Accepted numbers must match the C library
+        if ((n[3] > 0) && (i64 != strtoll(e.str, 0, 10)))
+            NumFail("parseI64", e.str, "wrong value", "strtoll");
+        if ((n[2] > 0) && (u64 != strtoull(e.str, 0, 10)))
+            NumFail("parseU64", e.str, "wrong value", "strtoull");
+    }
+}
+
+/**
+ * Generate text of a decimal number: sign, up to 12 digits around optional
+ * decimal point and an optional exponent
+ */
+static void NumGenFloat(char *dst, bool exponent)
+{
+    uint32_t r = NumRand(), nDig = 1 + r % 12, dot = (r >> 4) % (nDig + 1);
+    char *p = dst;
+
+    if (r & 0x100)
+        *(p++) = '-';
+    for (uint32_t i = 0; i < nDig; i++)
+    {
+        if ((i == dot) && (r & 0x200))
+            *(p++) = '.';
+        *(p++) = (char)('0' + NumRand() % 10);
+    }
+    if (exponent && (r & 0x400))
+        p += sprintf(p, "e%d", (int)((r >> 12) % 90) - 48);
+    *p = '\0';
+}
+
+static void NumCheckFloat(uint32_t nIter)
+{
+    char str[48], exp[64], got[64];
+    float f, ref;
+
+    //  Decimal strings, including overflow into infinity and underflow
+    for (uint32_t i = 0; i < nIter; i++)
+    {
+        uint16_t n;
+
+        NumGenFloat(str, true);
+        ref = strtof(str, 0);
+        n = parseFloat(str, strlen(str), &f);
+        if ((n != strlen(str)) || memcmp(&f, &ref, sizeof(f)))
+        {
+            snprintf(got, sizeof(got), "%.9g (%u chars)", f, n);
+            snprintf(exp, sizeof(exp), "%.9g", ref);
+            NumFail("parseFloat", str, got, exp);
+        }
+    }
+
+    //  Shortest round-trip text of random floats
+    for (uint32_t i = 0; i < nIter; i++)
+    {
+        uint32_t bits = NumRand();
+
+        memcpy(&ref, &bits, sizeof(ref));
+        if (!isfinite(ref))
+            continue;
+        snprintf(str, sizeof(str), "%.9g", ref);
+        parseFloat(str, strlen(str), &f);
+        if (memcmp(&f, &ref, sizeof(f)))
+        {
+            snprintf(got, sizeof(got), "%.9g", f);
+            NumFail("parseFloat", str, got, str);
+        }
+    }
+
+    //  Fixed notation of floats the way sensors produce them and of any bits
+    for (uint32_t i = 0; i < nIter; i++)
+    {
+        uint32_t bits = NumRand();
+        uint8_t prec = NumRand() % 10;
+
+        if (i & 1)
+            ref = (float)((int32_t)bits % 2000000) / 1000.0f;
+        else
+            memcpy(&ref, &bits, sizeof(ref));
+
+        snprintf(exp, sizeof(exp), "%.*f", prec, (double)ref);
+        if (strlen(exp) > 51)
+            continue;
+        fmtFloat(ref, prec, got);
+        if (strcmp(got, exp))
+            NumFail("fmtFloat", exp, got, exp);
+    }
+
+    //  Ties
+    {
+        static const float ties[] = { 0.5f, 1.5f, 2.5f, -0.5f, 0.125f, 0.375f,
+                                      2.0625f, -0.0f, 16777216.0f, 3.0e38f };
+
+        for (uint32_t i = 0; i < sizeof(ties) / sizeof(ties[0]); i++)
+            for (uint8_t prec = 0; prec < 4; prec++)
+            {
+                snprintf(exp, sizeof(exp), "%.*f", prec, (double)ties[i]);
+                fmtFloat(ties[i], prec, got);
+                if (strcmp(got, exp))
+                    NumFail("fmtFloat", exp, got, exp);
+            }
+    }
+}
+
+/**
+ * parseFixed against integer arithmetic on the same digits
+ */
+static void NumCheckFixed(uint32_t nIter)
+{
+    static const int64_t pow10[] = { 1, 10, 100, 1000, 10000, 100000 };
+    char str[48], got[48], exp[48];
+
+    for (uint32_t i = 0; i < nIter; i++)
+    {
+        uint32_t r = NumRand(), ip = NumRand() % 100000;
+        uint8_t nFrac = r % 7, fracDigits = (r >> 3) % 6;
+        bool neg = (r >> 6) & 1;
+        char frac[8];
+        int64_t ref = ip * pow10[fracDigits];
+        int32_t val = 0;
+        uint16_t n;
+
+        for (uint8_t k = 0; k < nFrac; k++)
+            frac[k] = (char)('0' + NumRand() % 10);
+        frac[nFrac] = '\0';
+        for (uint8_t k = 0; k < fracDigits; k++)
+            if (k < nFrac)
+                ref += (frac[k] - '0') * pow10[fracDigits - 1 - k];
+        if ((nFrac > fracDigits) && (frac[fracDigits] >= '5'))
+            ref++;
+
+        snprintf(str, sizeof(str), "%s%u%s%s", neg ? "-" : "", ip,
+                 (nFrac > 0) ? "." : "", frac);
+        n = parseFixed(str, strlen(str), fracDigits, &val);
+        if (neg)
+            ref = -ref;
+
+        //  Out of range of int32_t must be rejected
+        if ((ref > INT32_MAX) || (ref < INT32_MIN))
+        {
+            if (n != 0)
+                NumFail("parseFixed", str, "accepted", "rejected");
+        }
+        else if ((n != strlen(str)) || (val != ref))
+        {
+            snprintf(got, sizeof(got), "%d", val);
+            snprintf(exp, sizeof(exp), "%lld", (long long)ref);
+            NumFail("parseFixed", str, got, exp);
+        }
+
+        //  And back to text
+        fmtFixed(ref, fracDigits, got);
+        if (fracDigits > 0)
+            snprintf(exp, sizeof(exp), "%s%lld.%0*lld",
+                     (ref < 0) ? "-" : "", (long long)(llabs(ref) /
+                     pow10[fracDigits]), fracDigits,
+                     (long long)(llabs(ref) % pow10[fracDigits]));
+        else
+            snprintf(exp, sizeof(exp), "%lld", (long long)ref);
+        if (strcmp(got, exp))
+            NumFail("fmtFixed", exp, got, exp);
+    }
+
+    //  Out of range
+    if (parseFixed("21474836.48", 11, 2, (int32_t*)got) != 0)
+        NumFail("parseFixed", "21474836.48", "accepted", "rejected");
+    if (parseFixed("-21474836.48", 12, 2, (int32_t*)got) != 12)
+        NumFail("parseFixed", "-21474836.48", "rejected", "accepted");
+    if (parseFixed(".", 1, 2, (int32_t*)got) != 0)
+        NumFail("parseFixed", ".", "accepted", "rejected");
+}
+
+///-----------------------------------------------------------------------------
+///         Benchmark
+///-----------------------------------------------------------------------------
+
+/**
+ * Time of one conversion, best of a few passes over the whole input
+ */
+#define NUM_TIME(RES, LOOP)                                 \
+    do {                                                    \
+        uint64_t best = ~0ull;                              \
+        for (int pass = 0; pass < 5; pass++)                \
+        {                                                   \
+            uint64_t t0 = NumNow();                         \
+            LOOP;                                           \
+            t0 = NumNow() - t0;                             \
+            if (t0 < best)                                  \
+                best = t0;                                  \
+        }                                                   \
+        RES = (double)best / nIter;                         \
+    } while (0)
+
+static void NumRow(const char *name, double tNew, double tLegacy, double tLibc)
+{
+    printf("%s,%.1f,%.1f,%.1f,%.2f\n", name, tNew, tLegacy, tLibc,
+           (tLegacy > 0) ? (tLegacy / tNew) : 0.0);
+}
+
+static void NumBench(uint32_t nIter)
+{
+    std::vector<int32_t> ints(nIter);
+    std::vector<float> floats(nIter);
+    std::vector<std::string> intStr(nIter), fltStr(nIter);
+    volatile int64_t sink = 0;
+    double tNew, tLegacy, tLibc;
+    uint32_t legacyWrong;
+    char buf[64];
+
+    for (uint32_t i = 0; i < nIter; i++)
+    {
+        ints[i] = (int32_t)(NumRand() >> (NumRand() & 31)) *
+                  ((NumRand() & 1) ? -1 : 1);
+        floats[i] = (float)((int32_t)NumRand() % 2000000) / 1000.0f;
+        snprintf(buf, sizeof(buf), "%d", ints[i]);
+        intStr[i] = buf;
+        //  Numbers as they come in through serial port, e.g. "-123.456"
+        snprintf(buf, sizeof(buf), "%.3f", floats[i]);
+        fltStr[i] = buf;
+    }
+
+    printf("conversion,new,legacy,libc,speedup_vs_legacy\n");
+
+    NUM_TIME(tNew, for (uint32_t i = 0; i < nIter; i++)
+                   { int32_t v = 0;
+                     parseI32(intStr[i].c_str(), intStr[i].size(), &v);
+                     sink += v; });
+    NUM_TIME(tLegacy, for (uint32_t i = 0; i < nIter; i++)
+                      sink += LegacyStoi((uint8_t*)intStr[i].c_str(),
+                                         intStr[i].size()));
+    NUM_TIME(tLibc, for (uint32_t i = 0; i < nIter; i++)
+                    sink += strtol(intStr[i].c_str(), 0, 10));
+    NumRow("parse_i32", tNew, tLegacy, tLibc);
+
+    NUM_TIME(tNew, for (uint32_t i = 0; i < nIter; i++)
+                   { float v = 0;
+                     parseFloat(fltStr[i].c_str(), fltStr[i].size(), &v);
+                     sink += (int64_t)v; });
+    NUM_TIME(tLegacy, for (uint32_t i = 0; i < nIter; i++)
+                      sink += (int64_t)LegacyStof((uint8_t*)fltStr[i].c_str(),
+                                                  fltStr[i].size()));
+    NUM_TIME(tLibc, for (uint32_t i = 0; i < nIter; i++)
+                    sink += (int64_t)strtof(fltStr[i].c_str(), 0));
+    NumRow("parse_float", tNew, tLegacy, tLibc);
+
+    NUM_TIME(tNew, for (uint32_t i = 0; i < nIter; i++)
+                   { int32_t v = 0;
+                     parseFixed(fltStr[i].c_str(), fltStr[i].size(), 3, &v);
+                     sink += v; });
+    NumRow("parse_fixed3", tNew, 0, 0);
+
+    NUM_TIME(tNew, for (uint32_t i = 0; i < nIter; i++)
+                   sink += fmtI32(ints[i], buf));
+    NUM_TIME(tLegacy, for (uint32_t i = 0; i < nIter; i++)
+                      { LegacyItoa(ints[i], (uint8_t*)buf); sink += buf[0]; });
+    NUM_TIME(tLibc, for (uint32_t i = 0; i < nIter; i++)
+                    sink += snprintf(buf, sizeof(buf), "%d", ints[i]));
+    NumRow("fmt_i32", tNew, tLegacy, tLibc);
+
+    NUM_TIME(tNew, for (uint32_t i = 0; i < nIter; i++)
+                   sink += fmtI64((int64_t)ints[i] * 1000003, buf));
+    NUM_TIME(tLibc, for (uint32_t i = 0; i < nIter; i++)
+                    sink += snprintf(buf, sizeof(buf), "%lld",
+                                     (long long)ints[i] * 1000003));
+    NumRow("fmt_i64", tNew, 0, tLibc);
+
+    NUM_TIME(tNew, for (uint32_t i = 0; i < nIter; i++)
+                   sink += fmtFloat(floats[i], 3, buf));
+    NUM_TIME(tLibc, for (uint32_t i = 0; i < nIter; i++)
+                    sink += snprintf(buf, sizeof(buf), "%.3f",
+                                     (double)floats[i]));
+    NumRow("fmt_float3", tNew, 0, tLibc);
+
+    /*
+     *  How often the old functions got the same input wrong
+     */
+    legacyWrong = 0;
+    for (uint32_t i = 0; i < nIter; i++)
+        if (LegacyStof((uint8_t*)fltStr[i].c_str(), fltStr[i].size()) !=
+            strtof(fltStr[i].c_str(), 0))
+            legacyWrong++;
+    printf("Legacy stof: %u of %u results differ from strtof\n", legacyWrong,
+           nIter);
+    legacyWrong = 0;
+    for (uint32_t i = 0; i < nIter; i++)
+    {
+        char ref[16];
+
+        memset(buf, 0, 16);
+        LegacyItoa(ints[i], (uint8_t*)buf);
+        snprintf(ref, sizeof(ref), "%d", ints[i]);
+        if (strcmp(buf, ref))
+            legacyWrong++;
+    }
+    printf("Legacy itoa: %u of %u results differ from snprintf\n",
+           legacyWrong, nIter);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t nIter = 200000;
+    bool exhaustive = false;
+
+    _rndState = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i+1 < argc))
+            nIter = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+            _rndState = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-e"))
+            exhaustive = true;
+        else if (!strcmp(argv[i], "-v"))
+            _verbose = true;
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n iterations] [-s seed] [-e] [-v]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (_rndState == 0)
+        _rndState = 1;
+    if (nIter == 0)
+        nIter = 1;
+
+    //  Whole 32-bit range, or a stride through it starting at random offset
+    {
+        uint32_t stride = exhaustive ? 1 : 4093, u = exhaustive ? 0 :
+                          NumRand() % stride;
+
+        do
+        {
+            NumCheck32(u);
+            u += stride;
+        } while (u >= stride);
+        NumCheck32(0);
+        NumCheck32(0xFFFFFFFF);
+        NumCheck32(0x80000000);
+    }
+    for (uint32_t i = 0; i < nIter; i++)
+        NumCheck64(NumRand64());
+    NumCheck64(0);
+    NumCheck64(~0ull);
+    NumCheck64(0x8000000000000000ull);
+    NumCheckEdges();
+    NumCheckFloat(nIter);
+    NumCheckFixed(nIter);
+
+    NumBench(nIter);
+    printf("%s\n", (_errors == 0) ? "OK" : "FAILED");
+
+    return (_errors == 0) ? 0 : 2;
+}
+
+#endif  /* __BOARD_HOST__ */
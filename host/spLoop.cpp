@@ -0,0 +1,535 @@
+/**
+ * spLoop.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  In-memory loopback for the serial binary protocol (host build only)
+ *  Builds a stream of command frames as a PC would send it, mixes in plain
+ *  text (debug output sharing the link) and corrupts a share of frames. Stream
+ *  is fed byte-by-byte into the frame decoder exactly as UART0RxIntHandler
+ *  does, decoded commands are executed on the task scheduler and replies are
+ *  decoded again on the "PC" side. Results are checked against the content of
+ *  the task scheduler, exit status is non-zero on any mismatch.
+ *  Event log is then read remotely page by page while new events come in,
+ *  and once more after it overflowed; entries and their sequence numbers are
+ *  checked against the log itself.
+ *
+ *  Usage: spLoop [-n commands] [-e corruptPct] [-s seed] [-v]
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "serialPort/serialProto.h"
+#include "init/eventLog.h"
+#include "init/evlogCodec.h"
+
+#include <stdio.h>
+#include <vector>
+
+//  Unique identifier of module whose tasks are scheduled remotely
+#define LOOP_UID        8
+//  UID that is never registered, commands using it have to be refused
+#define LOOP_BAD_UID    9
+
+//  Interface with task scheduler for loopback module (never executed)
+static _kernelEntry _loopKer;
+static void _LOOP_KernelCallback(void) {}
+
+//  Largest page of event log entries asked for with GETEVENTS
+#define LOOP_MAX_PAGE   80
+
+/**
+ * Event log entry together with its sequence number
+ */
+struct _loopEvent
+{
+    uint32_t            seq;
+    struct _eventEntry  entry;
+};
+
+//  Link in both directions
+static std::vector<uint8_t> _toMCU, _toPC;
+//  Bytes of equivalent plain-text commands, for comparison
+static uint32_t _textBytes = 0;
+
+/**
+ * Small xorshift PRNG -> same stream on every platform for a given seed
+ */
+static uint32_t _rndState;
+static uint32_t LoopRand(uint32_t lo, uint32_t hi)
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    if (hi <= lo)
+        return lo;
+    return lo + (_rndState % (hi - lo + 1));
+}
+
+/**
+ * Reply path of the dispatcher, i.e. SerialPort::SendRaw on target
+ */
+static void LoopSend(const uint8_t *data, uint16_t len)
+{
+    _toPC.insert(_toPC.end(), data, data + len);
+}
+
+/**
+ * State of the "PC" side
+ */
+struct _loopPC
+{
+    uint32_t corruptPct;
+    uint8_t  seq;
+    uint32_t sent;          //  Commands sent intact
+    uint32_t corrupted;     //  Commands corrupted on the link
+    uint32_t cmdBytes;      //  Bytes of command frames
+};
+
+/**
+ * Send command frame over the link, possibly corrupting it
+ * @return true if frame has been sent intact
+ */
+static bool LoopCommand(struct _loopPC &pc, uint8_t type,
+                        const uint8_t *payload, uint8_t len)
+{
+    uint8_t frame[SP_MAX_FRAME];
+    uint16_t n = SP_Encode(type, pc.seq, payload, len, frame);
+    bool ok = true;
+
+    //  Flip a bit anywhere past length byte, corrupted length would make
+    //  decoder swallow following frames and break bookkeeping below
+    if (LoopRand(0, 99) < pc.corruptPct)
+    {
+        frame[LoopRand(2, n - 1)] ^= (uint8_t)(1 << LoopRand(0, 7));
+        ok = false;
+        pc.corrupted++;
+    }
+    else
+        pc.sent++;
+
+    //  Plain-text debug output between frames
+    if (LoopRand(0, 3) == 0)
+    {
+        const char *txt = "[1234] Module 8 raised event OK during task 2\r\n";
+        _toMCU.insert(_toMCU.end(), txt, txt + strlen(txt));
+    }
+
+    _toMCU.insert(_toMCU.end(), frame, frame + n);
+    pc.cmdBytes += n;
+    pc.seq++;
+
+    return ok;
+}
+
+/**
+ * Feed everything sent by "PC" to the MCU side, byte by byte
+ */
+static void LoopDeliver(SPDecoder &dec)
+{
+    for (size_t i = 0; i < _toMCU.size(); i++)
+        if (dec.Feed(_toMCU[i]))
+            SP_Dispatch(dec.GetFrame(), LoopSend);
+    _toMCU.clear();
+}
+
+/**
+ * Parse replies received by "PC"
+ * @param acks number of ACK frames received
+ * @param nacks number of ACK frames with error status
+ * @param tasks content of TASKS frames
+ * @return number of TASKS frames received
+ */
+static uint32_t LoopReplies(SPDecoder &dec, uint32_t &acks,
+                            uint32_t &nacks,
+                            std::vector<struct _tsTaskInfo> &tasks)
+{
+    uint32_t taskFrames = 0;
+
+    for (size_t i = 0; i < _toPC.size(); i++)
+    {
+        if (!dec.Feed(_toPC[i]))
+            continue;
+
+        const struct _spFrame &f = dec.GetFrame();
+        const uint8_t *p = f.payload, *end = f.payload + f.len;
+        uint64_t v;
+
+        switch (f.type)
+        {
+        case SP_T_ACK:
+            acks++;
+            if (f.payload[1] != STATUS_OK)
+                nacks++;
+            break;
+        case SP_T_TASKS:
+            taskFrames++;
+            while (p < end)
+            {
+                struct _tsTaskInfo t;
+
+                memset(&t, 0, sizeof(t));
+                p += getVarint(p, end, &v);
+                t.PID = (uint16_t)v;
+                t.libUID = *(p++);
+                t.taskID = *(p++);
+                p += getVarint(p, end, &v);
+                t.timestamp = (uint32_t)v;
+                p += getVarint(p, end, &v);
+                t.period = (int32_t)unzigzag(v);
+                p += getVarint(p, end, &v);
+                t.repeats = (int32_t)unzigzag(v);
+                tasks.push_back(t);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    _toPC.clear();
+
+    return taskFrames;
+}
+
+/**
+ * Log [n] events of random modules, a few ms apart
+ */
+static void LoopEmit(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        HAL_TS_SimTick(LoopRand(0, 99));
+        EventLog::EmitEvent((uint8_t)LoopRand(0, NUM_OF_MODULES - 1),
+                            (int8_t)LoopRand(0, 11), (Events)LoopRand(1, 5));
+    }
+}
+
+/**
+ * Read event log remotely, page by page, until a page comes back empty
+ * @param seq [in/out] sequence number to start from; sequence number to
+ * continue from next time on return
+ * @param events [out] entries received
+ * @param lost [out] entries skipped by MCU because they had been overwritten
+ * @param newEvents number of events logged in between pages, up to 20 at a
+ * time
+ * @return number of errors in replies
+ */
+static uint32_t LoopReadLog(struct _loopPC &pc, SPDecoder &mcuDec,
+                            SPDecoder &pcDec, uint32_t &seq,
+                            std::vector<struct _loopEvent> &events,
+                            uint32_t &lost, uint32_t newEvents)
+{
+    uint8_t payload[10];
+    uint32_t errors = 0, got;
+
+    do
+    {
+        uint32_t expected = seq, next = seq, finals = 0;
+        uint32_t n = (newEvents < 20) ? newEvents : LoopRand(0, 20);
+        uint8_t len;
+
+        //  Log keeps growing while it's being read
+        LoopEmit(n);
+        newEvents -= n;
+
+        len = putVarint(seq, payload);
+        len += putVarint(LoopRand(1, LOOP_MAX_PAGE), payload + len);
+        LoopCommand(pc, SP_T_GETEVENTS, payload, len);
+        LoopDeliver(mcuDec);
+        got = 0;
+
+        for (size_t i = 0; i < _toPC.size(); i++)
+        {
+            if (!pcDec.Feed(_toPC[i]) || (pcDec.GetFrame().type != SP_T_EVENTS))
+                continue;
+
+            const struct _spFrame &f = pcDec.GetFrame();
+            const uint8_t *p = f.payload, *end = f.payload + f.len;
+            struct _eventEntry e[SP_MAX_PAYLOAD];
+            uint64_t v;
+            uint32_t n;
+
+            p += getVarint(p, end, &v);
+            //  Frame with only a sequence number closes the reply
+            if (p == end)
+            {
+                next = (uint32_t)v;
+                finals++;
+                continue;
+            }
+            //  Sequence numbers may only jump forward, over lost entries
+            if ((int32_t)((uint32_t)v - expected) < 0)
+                errors++;
+            else
+                lost += (uint32_t)v - expected;
+
+            n = EVC_DecodeBlock(p, end - p, e, SP_MAX_PAYLOAD);
+            for (uint32_t j = 0; j < n; j++)
+            {
+                struct _loopEvent ev;
+
+                ev.seq = (uint32_t)v + j;
+                ev.entry = e[j];
+                events.push_back(ev);
+            }
+            expected = (uint32_t)v + n;
+            got += n;
+        }
+        _toPC.clear();
+
+        if ((finals != 1) || ((got > 0) && (next != expected)))
+            errors++;
+        seq = next;
+    }
+    while ((got > 0) || (newEvents > 0));
+
+    return errors;
+}
+
+/**
+ * Compare entries read remotely with the content of the log
+ * @return number of entries of the log not received or received wrong
+ */
+static uint32_t LoopCompareLog(const std::vector<struct _loopEvent> &events,
+                               bool verbose)
+{
+    EventLog &el = EventLog::GetI();
+    struct _evIter it = el.Begin();
+    struct _eventEntry e;
+    uint32_t errors = 0;
+    size_t i = 0;
+
+    while (el.Next(it, e))
+    {
+        //  Log was read from an earlier point, skip what's been overwritten
+        while ((i < events.size()) && ((int32_t)(events[i].seq - (it.seq - 1)) < 0))
+            i++;
+
+        if ((i >= events.size()) || (events[i].seq != (it.seq - 1)) ||
+            (events[i].entry.timestamp != e.timestamp) ||
+            (events[i].entry.libUID != e.libUID) ||
+            (events[i].entry.taskID != e.taskID) ||
+            (events[i].entry.event != e.event))
+        {
+            if (verbose)
+                printf("Entry %u differs or missing\n", it.seq - 1);
+            errors++;
+        }
+        else
+            i++;
+    }
+    //  Everything received after the oldest entry has to be in the log
+    if (i != events.size())
+        errors++;
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t nCmd = 1000;
+    bool verbose = false;
+    struct _loopPC pc;
+    uint8_t payload[SP_MAX_PAYLOAD];
+    uint32_t expTasks = 0, errors = 0, acks = 0, nacks = 0, expNacks = 0;
+    std::vector<struct _tsTaskInfo> tasks, killed;
+    SPDecoder mcuDec, pcDec;
+
+    pc.corruptPct = 5;
+    pc.seq = 0;
+    pc.sent = pc.corrupted = pc.cmdBytes = 0;
+    _rndState = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && (i+1 < argc))
+            nCmd = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-e") && (i+1 < argc))
+            pc.corruptPct = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+            _rndState = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+        {
+            fprintf(stderr,
+                    "Usage: %s [-n commands] [-e corruptPct] [-s seed] [-v]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (_rndState == 0)
+        _rndState = 1;
+
+    _loopKer.callBackFunc = _LOOP_KernelCallback;
+    TS_RegCallback(&_loopKer, LOOP_UID);
+
+    /*
+     *  Schedule tasks remotely, each SYNC followed by its arguments
+     */
+    for (uint32_t i = 0; i < nCmd; i++)
+    {
+        uint8_t len = 2, argLen = (uint8_t)LoopRand(1, 16);
+        bool bad = (LoopRand(0, 49) == 0);
+        int64_t time = -(int64_t)LoopRand(1, 100000);
+        int32_t period = (LoopRand(0, 1) ? (int32_t)LoopRand(10, 60000) : 0),
+                rep = (period != 0) ? T_PERIODIC : 0;
+
+        payload[0] = bad ? LOOP_BAD_UID : LOOP_UID;
+        payload[1] = (uint8_t)LoopRand(0, 31);
+        len += putVarint(zigzag(time), payload + len);
+        len += putVarint(zigzag(period), payload + len);
+        len += putVarint(zigzag(rep), payload + len);
+        _textBytes += snprintf(0, 0, "SYNC %u %u %lld %d %d\r\n", payload[0],
+                               payload[1], (long long)time, period, rep);
+
+        //  Arguments are only sent for accepted tasks, otherwise they would be
+        //  appended to the previous one
+        if (LoopCommand(pc, SP_T_SYNC, payload, len))
+        {
+            if (bad)
+                expNacks++;
+            else
+                expTasks++;
+        }
+        if (!bad)
+        {
+            for (uint8_t j = 0; j < argLen; j++)
+                payload[j] = (uint8_t)LoopRand('a', 'z');
+            LoopCommand(pc, SP_T_ARGS, payload, argLen);
+            _textBytes += 7 + argLen;   //  "ARGS " + args + "\r\n"
+        }
+    }
+    LoopDeliver(mcuDec);
+    LoopReplies(pcDec, acks, nacks, tasks);
+
+    /*
+     *  Read back the whole queue and compare it with scheduler content
+     */
+    pc.corruptPct = 0;
+    LoopCommand(pc, SP_T_GETTASKS, 0, 0);
+    LoopDeliver(mcuDec);
+    tasks.clear();
+    uint32_t taskFrames = LoopReplies(pcDec, acks, nacks, tasks);
+
+    std::vector<struct _tsTaskInfo> local(TaskScheduler::GetI().NumOfTasks());
+    uint32_t total;
+    uint32_t nLocal = TaskScheduler::GetI().Snapshot(local.data(),
+                                                     local.size(), &total);
+
+    if ((nLocal != tasks.size()) || (nLocal != expTasks))
+    {
+        printf("Task count mismatch: expected %u, queue %u, reported %zu\n",
+               expTasks, nLocal, tasks.size());
+        errors++;
+    }
+    for (uint32_t i = 0; (i < nLocal) && (i < tasks.size()); i++)
+        if ((tasks[i].PID != local[i].PID) ||
+            (tasks[i].timestamp != local[i].timestamp) ||
+            (tasks[i].period != local[i].period) ||
+            (tasks[i].repeats != local[i].repeats) ||
+            (tasks[i].taskID != local[i].taskID))
+        {
+            if (verbose)
+                printf("Task %u differs (PID %u vs %u)\n", i,
+                       tasks[i].PID, local[i].PID);
+            errors++;
+        }
+
+    /*
+     *  Kill all tasks remotely by PID
+     */
+    for (uint32_t i = 0; i < tasks.size(); i++)
+    {
+        uint8_t len = putVarint(tasks[i].PID, payload);
+
+        LoopCommand(pc, SP_T_KILLPID, payload, len);
+        _textBytes += snprintf(0, 0, "KILL %u\r\n", tasks[i].PID);
+    }
+    LoopDeliver(mcuDec);
+    LoopReplies(pcDec, acks, nacks, killed);
+
+    if (TaskScheduler::GetI().NumOfTasks() != 0)
+    {
+        printf("%u tasks left after killing all of them\n",
+               TaskScheduler::GetI().NumOfTasks());
+        errors++;
+    }
+    //  Every intact command is acknowledged, except GETTASKS
+    if ((acks != pc.sent - 1) || (nacks != expNacks))
+    {
+        printf("ACKs: expected %u (%u refused), got %u (%u refused)\n",
+               pc.sent - 1, expNacks, acks, nacks);
+        errors++;
+    }
+    if (mcuDec.crcErrors != pc.corrupted)
+    {
+        printf("CRC errors: expected %u, detected %u\n", pc.corrupted,
+               mcuDec.crcErrors);
+        errors++;
+    }
+    if ((mcuDec.frames != pc.sent) || (pcDec.crcErrors != 0))
+    {
+        printf("Frames: sent %u, decoded %u; reply CRC errors %u\n", pc.sent,
+               mcuDec.frames, pcDec.crcErrors);
+        errors++;
+    }
+
+    /*
+     *  Stream event log to "PC" while events keep coming in, then let it
+     *  overflow and check that overwritten entries are reported as lost
+     */
+    std::vector<struct _loopEvent> events, late;
+    uint32_t evSeq = 0, lost = 0, lostLate = 0, evErrors;
+    //  Reading the log has no text equivalent, leave it out of comparison
+    uint32_t cmdBytes = pc.cmdBytes;
+
+    TaskScheduler::GetI().InitHW(1);
+    LoopEmit(200);
+    evErrors = LoopReadLog(pc, mcuDec, pcDec, evSeq, events, lost, 400);
+    evErrors += LoopCompareLog(events, verbose);
+    if (evSeq != EventLog::GetI().EndSeq())
+        evErrors++;
+
+    LoopEmit(2000);
+    evErrors += LoopReadLog(pc, mcuDec, pcDec, evSeq, late, lostLate, 0);
+    evErrors += LoopCompareLog(late, verbose);
+    if ((lostLate == 0) || (late.empty()) ||
+        ((late.size() + lostLate) != (evSeq - events.back().seq - 1)))
+        evErrors++;
+
+    //  Asking past the end (as after reboot of MCU) returns where log ends
+    std::vector<struct _loopEvent> none;
+    uint32_t from = evSeq + 100, noneLost = 0;
+
+    evErrors += LoopReadLog(pc, mcuDec, pcDec, from, none, noneLost, 0);
+    if (!none.empty() || (from != evSeq))
+        evErrors++;
+    pc.cmdBytes = cmdBytes;
+    if (evErrors > 0)
+    {
+        printf("Event log streaming: %u errors\n", evErrors);
+        errors += evErrors;
+    }
+
+    printf("Commands sent:          %u (%u corrupted on the link)\n",
+           pc.sent + pc.corrupted, pc.corrupted);
+    printf("Frames decoded:         %u, CRC errors %u, text bytes skipped %u\n",
+           mcuDec.frames, mcuDec.crcErrors, mcuDec.skipped);
+    printf("Tasks read back:        %zu in %u frames\n", tasks.size(),
+           taskFrames);
+    printf("Events streamed:        %zu (%u lost), then %zu after overflow "
+           "(%u lost)\n", events.size(), lost, late.size(), lostLate);
+    printf("Command bytes:          %u binary vs %u as text (x%.1f)\n",
+           pc.cmdBytes, _textBytes,
+           pc.cmdBytes ? (double)_textBytes / pc.cmdBytes : 0.0);
+    printf("Result:                 %s\n", errors ? "FAIL" : "OK");
+
+    return errors ? 1 : 0;
+}
+
+#endif  /* __BOARD_HOST__ */
@@ -0,0 +1,503 @@
+/**
+ * tsBench.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Microbenchmarks for hot paths of task scheduler data structures (host build
+ *  only). Every benchmark is run for a sweep of queue sizes, argument sizes
+ *  and/or distributions of task time stamps.
+ *  Results are printed to stdout as CSV, one line per benchmark case:
+ *      bench,queue,arg_bytes,dist,ops,ns_per_op,allocs_per_op
+ *  Column set and their order are kept stable so that outputs from different
+ *  releases can be compared directly. ns_per_op is the median of BENCH_REPS
+ *  repetitions.
+ *
+ *  Usage: tsBench [-q] [-f filter]
+ *      -q          quick run (smaller sweep, used for smoke-testing)
+ *      -f filter   run only benchmarks whose name contains 'filter'
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <new>
+
+//  Unique identifier of module serving benchmark tasks
+#define BENCH_UID       8
+//  Number of repetitions of each benchmark case (median is reported)
+#define BENCH_REPS      5
+//  Maximum supported queue size
+#define BENCH_MAX_N     4096
+//  Minimum number of operations in single repetition of queue benchmarks
+#define BENCH_MIN_OPS   8192
+
+/*******************************************************************************
+ *********             Allocation counting & timing                    *********
+ ******************************************************************************/
+static uint64_t _allocCnt = 0;
+
+void* operator new(size_t size)
+{
+    _allocCnt++;
+    void *p = malloc(size ? size : 1);
+    if (p == 0)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static inline uint64_t BenchNowNs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/**
+ * Result of single repetition of a benchmark case
+ */
+struct _benchRes
+{
+    uint64_t ns;        //  Time spent in measured section
+    uint64_t allocs;    //  Allocations made in measured section
+    uint32_t ops;       //  Number of operations in measured section
+};
+
+/*******************************************************************************
+ *********             Workload helpers                                *********
+ ******************************************************************************/
+//  Distributions of time stamps for tasks added to the queue
+enum BenchDist { DIST_ASC, DIST_DESC, DIST_RAND, DIST_SAME, DIST_COUNT };
+static const char *_distName[DIST_COUNT] = {"asc", "desc", "rand", "same"};
+
+static uint32_t _rndState = 1;
+static uint32_t BenchRand()
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+    return _rndState;
+}
+
+/**
+ * Generate time stamp of i-th task out of n for a given distribution.
+ * All time stamps are in the future (relative to current time) by at least 1s
+ */
+static uint32_t BenchTime(BenchDist dist, uint32_t i, uint32_t n)
+{
+    uint32_t base = (uint32_t)msSinceStartup + 1000;
+
+    switch (dist)
+    {
+    case DIST_ASC:  return base + i;
+    case DIST_DESC: return base + (n - i);
+    case DIST_RAND: return base + (BenchRand() % (n * 4));
+    default:        return base;
+    }
+}
+
+//  PIDs of tasks currently in the queue, in queue order
+static uint16_t _pids[BENCH_MAX_N];
+
+//  Module executing benchmark tasks - does nothing
+static _kernelEntry _benchKer;
+void _BENCH_KernelCallback(void)
+{
+    _benchKer.retVal = STATUS_OK;
+}
+
+/**
+ * Empty task queue
+ */
+static void BenchDrain()
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+
+    while (!ts.IsEmpty())
+        ts.PopFront();
+}
+
+/**
+ * Fill task queue with n tasks carrying argBytes of arguments. First 4 bytes
+ * of arguments hold task index (makes each task unique for removal by content)
+ * @param period period of tasks (0 for one-off tasks)
+ */
+static void BenchFill(uint32_t n, uint16_t argBytes, BenchDist dist,
+                      int32_t period = 0)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    uint8_t args[256] = {0};
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        memcpy(args, &i, sizeof(i));
+        ts.SyncTaskPer(BENCH_UID, (uint8_t)i, BenchTime(dist, i, n), period,
+                       T_PERIODIC);
+        if (argBytes > 0)
+            ts.AddArgs(args, argBytes);
+    }
+}
+
+/**
+ * Record PIDs of all tasks in the queue, then shuffle them
+ */
+static void BenchCollectPIDs(uint32_t n)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    struct _tsTaskInfo page[64];
+    struct _tsSnapCursor cursor;
+    uint32_t got = 0, pageN;
+
+    while ((pageN = ts.SnapshotPage(page, 64, cursor)) > 0)
+        for (uint32_t i = 0; (i < pageN) && (got < n); i++)
+            _pids[got++] = page[i].PID;
+
+    for (uint32_t i = n - 1; i > 0; i--)
+    {
+        uint32_t j = BenchRand() % (i + 1);
+        uint16_t tmp = _pids[i];
+        _pids[i] = _pids[j];
+        _pids[j] = tmp;
+    }
+}
+
+/*******************************************************************************
+ *********             Benchmarks                                      *********
+ ******************************************************************************/
+/**
+ * LinkedList::AddSort through TaskScheduler::SyncTaskPer + AddArgs
+ * ops = n inserts into queue growing from 0 to n
+ */
+static _benchRes BenchAddSort(uint32_t n, uint16_t argBytes, BenchDist dist)
+{
+    _benchRes r;
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    BenchFill(n, argBytes, dist);
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    BenchDrain();
+    return r;
+}
+
+/**
+ * LinkedList::RemoveEntry(PID) through TaskScheduler::RemoveTask(PID)
+ * ops = n removals in random order from queue of initial size n
+ */
+static _benchRes BenchRemovePID(uint32_t n, uint16_t argBytes, BenchDist dist)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    _benchRes r;
+
+    BenchFill(n, argBytes, dist);
+    BenchCollectPIDs(n);
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < n; i++)
+        ts.RemoveTask(_pids[i]);
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    BenchDrain();
+    return r;
+}
+
+/**
+ * LinkedList::RemoveEntry(TaskEntry) through TaskScheduler::RemoveTask(...)
+ * ops = n removals in random order from queue of initial size n
+ */
+static _benchRes BenchRemoveContent(uint32_t n, uint16_t argBytes,
+                                    BenchDist dist)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    uint8_t args[256] = {0};
+    _benchRes r;
+
+    BenchFill(n, argBytes, dist);
+    //  Reuse PID array as a shuffled array of task indexes
+    for (uint32_t i = 0; i < n; i++)
+        _pids[i] = (uint16_t)i;
+    for (uint32_t i = n - 1; i > 0; i--)
+    {
+        uint32_t j = BenchRand() % (i + 1);
+        uint16_t tmp = _pids[i];
+        _pids[i] = _pids[j];
+        _pids[j] = tmp;
+    }
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t idx = _pids[i];
+        memcpy(args, &idx, sizeof(idx));
+        ts.RemoveTask(BENCH_UID, (uint8_t)idx, args, argBytes);
+    }
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    BenchDrain();
+    return r;
+}
+
+/**
+ * LinkedList::PopFront through TaskScheduler::PopFront
+ * ops = n pops from queue of initial size n
+ */
+static _benchRes BenchPopFront(uint32_t n, uint16_t argBytes, BenchDist dist)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    _benchRes r;
+
+    BenchFill(n, argBytes, dist);
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < n; i++)
+        ts.PopFront();
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    return r;
+}
+
+/**
+ * TaskEntry::AddArg - appending argBytes of arguments in 4-byte chunks
+ * ops = n entries constructed, filled and destroyed
+ */
+static _benchRes BenchEntryAddArg(uint32_t n, uint16_t argBytes, BenchDist)
+{
+    uint8_t args[256] = {0};
+    _benchRes r;
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        TaskEntry te(BENCH_UID, 0, i);
+        for (uint16_t b = 0; b < argBytes; b += 4)
+            te.AddArg(args + b, (argBytes - b) < 4 ? (argBytes - b) : 4);
+    }
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    return r;
+}
+
+/**
+ * TaskEntry copy-constructor
+ * ops = n copies (and destructions) of an entry with argBytes of arguments
+ */
+static _benchRes BenchEntryCopy(uint32_t n, uint16_t argBytes, BenchDist)
+{
+    uint8_t args[256] = {0};
+    TaskEntry src(BENCH_UID, 0, 1000, 100, T_PERIODIC);
+    _benchRes r;
+
+    if (argBytes > 0)
+        src.AddArg(args, argBytes);
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        TaskEntry dst(src);
+        __asm__ __volatile__("" : : "r"(&dst) : "memory");
+    }
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    return r;
+}
+
+/**
+ * TaskEntry assignment operator
+ * ops = n assignments into a default-constructed entry
+ */
+static _benchRes BenchEntryAssign(uint32_t n, uint16_t argBytes, BenchDist)
+{
+    uint8_t args[256] = {0};
+    TaskEntry src(BENCH_UID, 0, 1000, 100, T_PERIODIC);
+    _benchRes r;
+
+    if (argBytes > 0)
+        src.AddArg(args, argBytes);
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        TaskEntry dst;
+        dst = src;
+        __asm__ __volatile__("" : : "r"(&dst) : "memory");
+    }
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    return r;
+}
+
+/**
+ * Full TS_GlobalCheck dispatch of periodic tasks (pop, profile, callback,
+ * reschedule) with a module that does nothing
+ * ops = n dispatches, all n tasks being due at the same time
+ */
+static _benchRes BenchDispatch(uint32_t n, uint16_t argBytes, BenchDist dist)
+{
+    _benchRes r;
+
+    //  Period longer than spread of time stamps => tasks are dispatched once
+    BenchFill(n, argBytes, dist, (int32_t)(n * 8 + 1000));
+    msSinceStartup += 1000 + n * 4;
+
+    uint64_t a0 = _allocCnt, t0 = BenchNowNs();
+    TS_GlobalCheck();
+    r.ns = BenchNowNs() - t0;
+    r.allocs = _allocCnt - a0;
+    r.ops = n;
+
+    BenchDrain();
+    return r;
+}
+
+/*******************************************************************************
+ *********             Benchmark driver                                *********
+ ******************************************************************************/
+typedef _benchRes ((*BenchFunc)(uint32_t, uint16_t, BenchDist));
+
+/**
+ * Description of a benchmark and parameters it's swept over
+ */
+struct _benchDesc
+{
+    const char *name;
+    BenchFunc   func;
+    bool        sweepQueue;     //  Sweep over queue sizes
+    bool        sweepArgs;      //  Sweep over argument sizes
+    bool        sweepDist;      //  Sweep over time stamp distributions
+};
+
+static const _benchDesc _benches[] =
+{
+    {"addsort",        BenchAddSort,       true,  true,  true },
+    {"remove_pid",     BenchRemovePID,     true,  false, true },
+    {"remove_content", BenchRemoveContent, true,  true,  false},
+    {"popfront",       BenchPopFront,      true,  true,  false},
+    {"entry_addarg",   BenchEntryAddArg,   false, true,  false},
+    {"entry_copy",     BenchEntryCopy,     false, true,  false},
+    {"entry_assign",   BenchEntryAssign,   false, true,  false},
+    {"dispatch",       BenchDispatch,      true,  true,  true },
+};
+
+static int BenchCmp(const void *a, const void *b)
+{
+    const _benchRes *ra = (const _benchRes*)a, *rb = (const _benchRes*)b;
+    double na = (double)ra->ns / ra->ops, nb = (double)rb->ns / rb->ops;
+    return (na > nb) - (na < nb);
+}
+
+/**
+ * Run single benchmark case BENCH_REPS times and print the median
+ * Small queues are processed several times in a single repetition to get
+ * at least BENCH_MIN_OPS operations per repetition
+ */
+static void BenchRun(const _benchDesc &b, uint32_t n, uint16_t argBytes,
+                     BenchDist dist)
+{
+    _benchRes res[BENCH_REPS];
+    uint32_t iters = (n < BENCH_MIN_OPS) ? (BENCH_MIN_OPS / n) : 1;
+
+    //  Warm-up run (populates allocator free lists, caches...)
+    b.func(n, argBytes, dist);
+    for (uint8_t i = 0; i < BENCH_REPS; i++)
+    {
+        res[i].ns = res[i].allocs = res[i].ops = 0;
+        for (uint32_t it = 0; it < iters; it++)
+        {
+            _benchRes r = b.func(n, argBytes, dist);
+            res[i].ns += r.ns;
+            res[i].allocs += r.allocs;
+            res[i].ops += r.ops;
+        }
+    }
+
+    qsort(res, BENCH_REPS, sizeof(res[0]), BenchCmp);
+    const _benchRes &m = res[BENCH_REPS / 2];
+
+    printf("%s,%u,%u,%s,%u,%.1f,%.3f\n", b.name,
+           b.sweepQueue ? n : 0, argBytes,
+           b.sweepDist ? _distName[dist] : "-", m.ops,
+           (double)m.ns / m.ops, (double)m.allocs / m.ops);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t queueFull[] = {16, 128, 1024, 4096},
+                          queueQuick[] = {16, 128};
+    static const uint16_t argsFull[] = {0, 4, 16, 64},
+                          argsQuick[] = {0, 16};
+    const uint32_t *queue = queueFull;
+    const uint16_t *argSz = argsFull;
+    uint8_t nQueue = 4, nArgs = 4;
+    const char *filter = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-q"))
+        {
+            queue = queueQuick;
+            argSz = argsQuick;
+            nQueue = nArgs = 2;
+        }
+        else if (!strcmp(argv[i], "-f") && (i+1 < argc))
+            filter = argv[++i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [-q] [-f filter]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    //  Same initialization sequence as on the target (see main.cpp)
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    _benchKer.callBackFunc = _BENCH_KernelCallback;
+    TS_RegCallback(&_benchKer, BENCH_UID);
+
+    printf("bench,queue,arg_bytes,dist,ops,ns_per_op,allocs_per_op\n");
+
+    for (uint8_t b = 0; b < sizeof(_benches)/sizeof(_benches[0]); b++)
+    {
+        const _benchDesc &bd = _benches[b];
+
+        if ((filter != 0) && (strstr(bd.name, filter) == 0))
+            continue;
+
+        for (uint8_t q = 0; q < (bd.sweepQueue ? nQueue : 1); q++)
+            for (uint8_t a = 0; a < (bd.sweepArgs ? nArgs : 1); a++)
+                for (uint8_t d = 0; d < (bd.sweepDist ? DIST_COUNT : 1); d++)
+                    BenchRun(bd, bd.sweepQueue ? queue[q] : BENCH_MIN_OPS,
+                             bd.sweepArgs ? argSz[a] : 0,
+                             bd.sweepDist ? (BenchDist)d : DIST_RAND);
+    }
+
+    return 0;
+}
+
+#endif  /* __BOARD_HOST__ */
@@ -0,0 +1,849 @@
+/**
+ * tsReplay.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Trace generator, replayer and comparator for task scheduler (host build
+ *  only). Works with binary traces described in taskScheduler/tsTrace.h. Trace
+ *  file is a "TSTR" magic followed by version byte and recorded stream.
+ *
+ *  Usage:
+ *   tsReplay -g <out.trc> [-n cmds] [-d seconds] [-m per oneShot kill] [-s seed]
+ *      Generate synthetic trace of remote commands: periodic tasks, one-off
+ *      tasks and kills of previously scheduled tasks mixed in given ratio
+ *   tsReplay <in.trc> [-r runtimeMs] [-o results.txt]
+ *      Feed recorded stream into task scheduler of this build and report
+ *      throughput and latency of scheduler API calls and dispatches. Runtime of
+ *      services is taken from dispatch records in the trace (average per
+ *      service) and defaults to -r when trace has none.
+ *   tsReplay -c <a.txt> <b.txt>
+ *      Compare results of two replays (e.g. of the same trace by two builds)
+ *   tsReplay -t [-n cmds] [-s seed]
+ *      Round-trip check (needs _TS_TRACE_): capture a random workload from the
+ *      scheduler, check that the stream decodes into exactly the calls made,
+ *      replay it and check that replay captures the same stream, then check
+ *      start times of tasks scheduled far from now. Returns non-zero on any
+ *      mismatch
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "taskScheduler/tsTrace.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+//  Trace file header
+static const char     _trcMagic[4] = {'T', 'S', 'T', 'R'};
+static const uint8_t  _trcVersion = 1;
+
+//  Maximum number of results stored in a result file
+#define REPLAY_MAX_KEYS     64
+
+static inline uint64_t ReplayNowNs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+static uint32_t _rndState = 1;
+static uint32_t ReplayRand(uint32_t lo, uint32_t hi)
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    if (hi <= lo)
+        return lo;
+    return lo + (_rndState % (hi - lo + 1));
+}
+
+/*******************************************************************************
+ *********             Trace generator                                 *********
+ ******************************************************************************/
+/**
+ * Write one record into trace file
+ */
+static void GenWrite(FILE *f, struct _tsTraceRec &rec, uint64_t &lastT)
+{
+    uint8_t buf[TS_TRACE_MAX_REC];
+    uint32_t n = TS_TraceEncode(rec, lastT, buf);
+
+    fwrite(buf, 1, n, f);
+}
+
+/**
+ * Generate synthetic trace of remote commands
+ * @param pct percentage of periodic tasks, one-off tasks and kills
+ */
+static int Generate(const char *path, uint32_t cmds, uint32_t durationS,
+                    const uint32_t pct[3])
+{
+    FILE *f = fopen(path, "wb");
+    uint64_t lastT = 0, now = 0;
+    uint16_t nextPID = 1;
+    std::vector<uint16_t> live;
+    uint8_t args[16];
+    //  Modules that receive tasks; avoid task scheduler itself
+    static const uint8_t uids[] = {0, 1, 2, 3, 4, 5, 6, 8, 9};
+
+    if (f == 0)
+    {
+        perror(path);
+        return 1;
+    }
+    fwrite(_trcMagic, 1, sizeof(_trcMagic), f);
+    fwrite(&_trcVersion, 1, 1, f);
+
+    for (uint32_t i = 0; i < cmds; i++)
+    {
+        struct _tsTraceRec rec;
+        uint32_t dice = ReplayRand(0, pct[0] + pct[1] + pct[2] - 1);
+
+        memset(&rec, 0, sizeof(rec));
+        now += ReplayRand(0, 2 * (durationS * 1000 / cmds));
+        rec.time = now;
+
+        if ((dice >= pct[0] + pct[1]) && !live.empty())
+        {
+            //  Kill a periodic task scheduled earlier
+            uint32_t k = ReplayRand(0, live.size() - 1);
+            rec.type = TS_TRACE_KILLPID;
+            rec.PID = live[k];
+            live[k] = live.back();
+            live.pop_back();
+            GenWrite(f, rec, lastT);
+            continue;
+        }
+
+        rec.type = TS_TRACE_SYNC;
+        rec.libUID = uids[ReplayRand(0, sizeof(uids) - 1)];
+        rec.taskID = (uint8_t)ReplayRand(0, 3);
+        rec.PID = nextPID++;
+        if (dice < pct[0])
+        {
+            //  Periodic task, indefinite or with a number of repeats
+            rec.tsTime = -(int64_t)ReplayRand(0, 1000);
+            rec.period = (int32_t)ReplayRand(100, 10000);
+            rec.repeats = ReplayRand(0, 1) ? T_PERIODIC :
+                                             (int32_t)ReplayRand(1, 20);
+            live.push_back(rec.PID);
+        }
+        else
+            //  One-off task executed a bit later
+            rec.tsTime = -(int64_t)ReplayRand(0, 5000);
+        GenWrite(f, rec, lastT);
+
+        //  Arguments of the new task
+        rec.type = TS_TRACE_ARGS;
+        rec.argN = (uint16_t)ReplayRand(0, sizeof(args));
+        for (uint16_t b = 0; b < rec.argN; b++)
+            args[b] = (uint8_t)ReplayRand(0, 255);
+        rec.args = args;
+        if (rec.argN > 0)
+            GenWrite(f, rec, lastT);
+    }
+
+    fclose(f);
+    printf("Generated %u commands over %.1f s into %s\n", cmds,
+           (double)now / 1000.0, path);
+    return 0;
+}
+
+/*******************************************************************************
+ *********             Replay                                          *********
+ ******************************************************************************/
+//  Kernel interfaces of replay modules (one per UID)
+static _kernelEntry _repKer[NUM_OF_MODULES];
+//  Runtime model: accumulated runtime & number of runs per module service
+static uint64_t _rtSum[NUM_OF_MODULES][256];
+static uint32_t _rtCnt[NUM_OF_MODULES][256];
+static uint32_t _rtDefault = 1;
+//  Wall-clock latencies (ns) of dispatches, per-call timestamp mark
+static std::vector<uint32_t> _latDispatch;
+static uint64_t _markNs;
+
+/**
+ * Service executed by replay module: measures time since scheduler loop
+ * started (or since previous service returned), then "runs" for as long as
+ * the same service did in recorded trace
+ */
+static void ReplayService(uint8_t uid)
+{
+    uint64_t t = ReplayNowNs();
+    uint8_t svc = _repKer[uid].serviceID;
+
+    _latDispatch.push_back((uint32_t)(t - _markNs));
+
+    if (_rtCnt[uid][svc] > 0)
+        msSinceStartup += _rtSum[uid][svc] / _rtCnt[uid][svc];
+    else
+        msSinceStartup += _rtDefault;
+
+    _repKer[uid].retVal = STATUS_OK;
+    _markNs = ReplayNowNs();
+}
+
+template<uint8_t UID>
+void _REPLAY_KernelCallback(void)
+{
+    ReplayService(UID);
+}
+
+//  Table of callbacks, one for each module UID
+typedef void ((*ReplayCb)(void));
+static const ReplayCb _repCb[NUM_OF_MODULES] =
+{
+    _REPLAY_KernelCallback<0>, _REPLAY_KernelCallback<1>,
+    _REPLAY_KernelCallback<2>, _REPLAY_KernelCallback<3>,
+    _REPLAY_KernelCallback<4>, _REPLAY_KernelCallback<5>,
+    _REPLAY_KernelCallback<6>, _REPLAY_KernelCallback<7>,
+    _REPLAY_KernelCallback<8>, _REPLAY_KernelCallback<9>,
+};
+
+#if defined(_TS_TRACE_)
+//  Stream captured from the scheduler of this build, 0 while not capturing
+static std::vector<uint8_t> *_capture = 0;
+
+/**
+ * Drain trace FIFO of the scheduler into capture buffer (or discard it)
+ */
+static void ReplayDrain()
+{
+    uint8_t chunk[256];
+    uint16_t n;
+
+    while ((n = TS_TraceFetch(chunk, sizeof(chunk))) > 0)
+        if (_capture != 0)
+            _capture->insert(_capture->end(), chunk, chunk + n);
+}
+#endif  /* _TS_TRACE_ */
+
+/**
+ * Dispatch all tasks due until time t (or already due if services overran t),
+ * jumping internal clock from one start time to the next
+ */
+static void ReplayRunUntil(uint64_t t)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+
+    while (!ts.IsEmpty())
+    {
+        uint64_t next = TS_TimeExpand(ts.PeekFront().GetTimeStamp(),
+                                      msSinceStartup);
+
+        if ((next > t) && (next > msSinceStartup))
+            break;
+        if (next > msSinceStartup)
+            msSinceStartup = next;
+
+        _markNs = ReplayNowNs();
+        TS_GlobalCheck();
+#if defined(_TS_TRACE_)
+        ReplayDrain();
+#endif
+    }
+    if (msSinceStartup < t)
+        msSinceStartup = t;
+}
+
+/**
+ * Collection of latency samples and helpers to summarize them
+ */
+struct _latStat
+{
+    _latStat(const char *n): name(n) {};
+
+    const char *name;
+    std::vector<uint32_t> ns;
+
+    void Print(FILE *f)
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < ns.size(); i++)
+            sum += ns[i];
+        std::sort(ns.begin(), ns.end());
+
+        fprintf(f, "%s_calls=%zu\n", name, ns.size());
+        if (ns.empty())
+            return;
+        fprintf(f, "%s_ns_mean=%.1f\n", name, (double)sum / ns.size());
+        fprintf(f, "%s_ns_p50=%u\n", name, ns[ns.size() / 2]);
+        fprintf(f, "%s_ns_p99=%u\n", name, ns[(ns.size() * 99) / 100]);
+        fprintf(f, "%s_ns_max=%u\n", name, ns.back());
+    }
+};
+
+/**
+ * Read whole trace file into memory and check its header
+ */
+static bool ReplayLoad(const char *path, std::vector<uint8_t> &buf)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t chunk[4096];
+    size_t n;
+
+    if (f == 0)
+    {
+        perror(path);
+        return false;
+    }
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buf.insert(buf.end(), chunk, chunk + n);
+    fclose(f);
+
+    if ((buf.size() < 5) || memcmp(&buf[0], _trcMagic, 4) ||
+        (buf[4] != _trcVersion))
+    {
+        fprintf(stderr, "%s: not a task scheduler trace\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Build runtime model of services from dispatches recorded in stream
+ * @return number of bytes of stream that could be decoded
+ */
+static uint32_t ReplayModel(const uint8_t *buf, uint32_t len,
+                            uint32_t &recDispatch, int64_t &recLate)
+{
+    struct _tsTraceRec rec;
+    uint64_t lastT = 0;
+    uint32_t off, n;
+
+    memset(_rtSum, 0, sizeof(_rtSum));
+    memset(_rtCnt, 0, sizeof(_rtCnt));
+    recDispatch = 0;
+    recLate = 0;
+    for (off = 0; (n = TS_TraceDecode(buf + off, len - off, lastT, rec));
+         off += n)
+        if ((rec.type == TS_TRACE_DISPATCH) && (rec.libUID < NUM_OF_MODULES))
+        {
+            _rtSum[rec.libUID][rec.taskID] += rec.runtime;
+            _rtCnt[rec.libUID][rec.taskID]++;
+            recLate += rec.late;
+            recDispatch++;
+        }
+
+    return off;
+}
+
+/**
+ * Initialize task scheduler and register replay modules
+ */
+static void ReplaySetup()
+{
+    //  Same initialization sequence as on the target (see main.cpp)
+    HAL_BOARD_CLOCK_Init();
+    TaskScheduler::GetI().InitHW(1);
+    for (uint8_t uid = 0; uid < NUM_OF_MODULES; uid++)
+        if (uid != TASKSCHED_UID)
+        {
+            _repKer[uid].callBackFunc = _repCb[uid];
+            TS_RegCallback(&_repKer[uid], uid);
+        }
+}
+
+/**
+ * Feed API calls recorded in stream into task scheduler
+ * @param tBase time at which replay of the stream starts (stream times are
+ * relative to it)
+ * @param lat latency samples of sync, args and kill calls
+ * @return number of records fed
+ */
+static uint32_t ReplayFeed(const uint8_t *buf, uint32_t len, uint64_t tBase,
+                           _latStat *lat[3])
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    struct _tsTraceRec rec;
+    uint64_t lastT = tBase, t0;
+    uint32_t off, n, records = 0;
+    uint16_t PID;
+    //  Recorded PID -> PID assigned by scheduler in this replay
+    static uint16_t pidMap[65536];
+
+    for (off = 0; (n = TS_TraceDecode(buf + off, len - off, lastT, rec));
+         off += n)
+    {
+        records++;
+        //  Arguments belong to the task synced just before them, it must not
+        //  be dispatched before they're appended
+        if (rec.type != TS_TRACE_ARGS)
+            ReplayRunUntil(rec.time);
+
+        switch (rec.type)
+        {
+        case TS_TRACE_SYNC:
+            t0 = ReplayNowNs();
+            PID = ts.SyncTaskPer(rec.libUID, rec.taskID, rec.tsTime,
+                                 rec.period, rec.repeats);
+            lat[0]->ns.push_back((uint32_t)(ReplayNowNs() - t0));
+            pidMap[rec.PID] = PID;
+            break;
+        case TS_TRACE_ARGS:
+            t0 = ReplayNowNs();
+            ts.AddArgs((void*)rec.args, rec.argN);
+            lat[1]->ns.push_back((uint32_t)(ReplayNowNs() - t0));
+            break;
+        case TS_TRACE_KILLPID:
+            t0 = ReplayNowNs();
+            ts.RemoveTask(pidMap[rec.PID]);
+            lat[2]->ns.push_back((uint32_t)(ReplayNowNs() - t0));
+            break;
+        case TS_TRACE_KILLMATCH:
+            t0 = ReplayNowNs();
+            ts.RemoveTask(rec.libUID, rec.taskID, (void*)rec.args, rec.argN);
+            lat[2]->ns.push_back((uint32_t)(ReplayNowNs() - t0));
+            break;
+        default:
+            //  Recorded dispatches only feed the runtime model
+            break;
+        }
+    }
+
+    return records;
+}
+
+static int Replay(const char *path, const char *outPath)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    std::vector<uint8_t> buf;
+    uint32_t off, records, recDispatch;
+    int64_t recLate;
+    _latStat latSync("sync"), latArgs("args"), latKill("kill"),
+             latDisp("dispatch");
+    _latStat *lat[3] = {&latSync, &latArgs, &latKill};
+
+    if (!ReplayLoad(path, buf))
+        return 1;
+
+    //  First pass: build runtime model from recorded dispatches
+    off = 5 + ReplayModel(&buf[5], buf.size() - 5, recDispatch, recLate);
+    if (off != buf.size())
+        fprintf(stderr, "Warning: %zu trailing bytes couldn't be decoded\n",
+                buf.size() - off);
+
+    ReplaySetup();
+
+    //  Second pass: feed API calls into task scheduler
+    uint64_t wall0 = ReplayNowNs();
+    records = ReplayFeed(&buf[5], off - 5, 0, lat);
+    uint64_t wallNs = ReplayNowNs() - wall0;
+    latDisp.ns = _latDispatch;
+
+    uint64_t opsNs = 0, ops = 0;
+    _latStat *all[] = {&latSync, &latArgs, &latKill, &latDisp};
+    for (uint8_t i = 0; i < 4; i++)
+        for (size_t j = 0; j < all[i]->ns.size(); j++, ops++)
+            opsNs += all[i]->ns[j];
+
+    FILE *out = stdout;
+    if ((outPath != 0) && ((out = fopen(outPath, "w")) == 0))
+    {
+        perror(outPath);
+        return 1;
+    }
+    fprintf(out, "trace_records=%u\n", records);
+    fprintf(out, "recorded_dispatches=%u\n", recDispatch);
+    fprintf(out, "recorded_late_ms_mean=%.2f\n",
+            recDispatch ? (double)recLate / recDispatch : 0.0);
+    fprintf(out, "simulated_ms=%llu\n", (unsigned long long)msSinceStartup);
+    fprintf(out, "tasks_left=%u\n", ts.NumOfTasks());
+    fprintf(out, "wall_ms=%.3f\n", (double)wallNs / 1e6);
+    fprintf(out, "ops_per_s=%.0f\n", opsNs ? (double)ops * 1e9 / opsNs : 0.0);
+    for (uint8_t i = 0; i < 4; i++)
+        all[i]->Print(out);
+
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
+
+/*******************************************************************************
+ *********             Round-trip check of trace capture               *********
+ ******************************************************************************/
+#if defined(_TS_TRACE_)
+static uint32_t _checkErrors = 0;
+
+static void CheckFail(const char *what, uint32_t index)
+{
+    if (_checkErrors++ < 10)
+        printf("FAILED: %s (record %u)\n", what, index);
+}
+
+/**
+ * Decode whole stream into records; arguments stay in the stream
+ * @param lastT time of the record preceding the stream
+ */
+static void CheckDecode(const std::vector<uint8_t> &buf, uint64_t lastT,
+                        std::vector<_tsTraceRec> &recs)
+{
+    struct _tsTraceRec rec;
+    uint32_t off, n;
+
+    for (off = 0; (n = TS_TraceDecode(&buf[off], buf.size() - off, lastT,
+                                      rec)); off += n)
+        recs.push_back(rec);
+    if (off != buf.size())
+        CheckFail("captured stream doesn't decode", recs.size());
+}
+
+/**
+ * Compare two records, b is expected to be tBase ms later than a and its PID
+ * to be pidMap[PID of a]
+ */
+static bool CheckSame(const _tsTraceRec &a, const _tsTraceRec &b,
+                      uint64_t tBase, std::vector<uint16_t> &pidMap)
+{
+    if ((a.type != b.type) || (a.time + tBase != b.time) || (a.libUID != b.libUID) ||
+        (a.taskID != b.taskID) || (a.tsTime != b.tsTime) ||
+        (a.period != b.period) || (a.repeats != b.repeats) ||
+        (a.late != b.late) || (a.runtime != b.runtime) ||
+        (a.argN != b.argN) || memcmp(a.args, b.args, a.argN))
+        return false;
+
+    if (pidMap.size() <= a.PID)
+        pidMap.resize(a.PID + 1, 0);
+    if (a.type == TS_TRACE_SYNC)
+        pidMap[a.PID] = b.PID;
+
+    return (a.PID == 0) || (pidMap[a.PID] == b.PID);
+}
+
+/**
+ * Check that start times further than 32 bits of ms from now are resolved
+ * against the 64-bit clock: times in the past run ASAP, times too far in the
+ * future are clamped to TS_MAX_DELAY_MS from now
+ */
+static void CheckStartTime()
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    const int64_t far = 3000000000LL;
+    int64_t now, times[3];
+    uint32_t expect[3];
+
+    while (!ts.IsEmpty())
+        ts.PopFront();
+    msSinceStartup = (1ULL << 32) + far;
+    now = (int64_t)msSinceStartup;
+
+    //  Relative delay, absolute time in the past and far in the future
+    times[0] = -far;        expect[0] = (uint32_t)(now + TS_MAX_DELAY_MS);
+    times[1] = now - far;   expect[1] = (uint32_t)now;
+    times[2] = now + far;   expect[2] = (uint32_t)(now + TS_MAX_DELAY_MS);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        ts.SyncTask(0, i, times[i]);
+        if (ts.PeekFront().GetTimeStamp() != expect[i])
+            CheckFail("start time far from now", i);
+        ts.PopFront();
+    }
+    ReplayDrain();
+}
+
+/**
+ * Capture a pseudo-random workload from the scheduler of this build, check
+ * that the captured stream decodes into exactly the calls and dispatches that
+ * were made, then replay it and check that replay captures the same stream
+ * (with PIDs the replaying scheduler assigned)
+ * @return non-zero on any mismatch
+ */
+static int Check(uint32_t cmds)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    std::vector<uint8_t> first, second;
+    std::vector<_tsTraceRec> expected, recs, recs2;
+    std::vector<std::vector<uint8_t> > argStore(cmds);
+    std::vector<uint16_t> live, pidMap;
+    _latStat latSync("sync"), latArgs("args"), latKill("kill");
+    _latStat *lat[3] = {&latSync, &latArgs, &latKill};
+    static const uint8_t uids[] = {0, 1, 2, 3, 4, 5, 6, 8, 9};
+    uint64_t now = 0;
+    uint32_t recDispatch, nDispatch = 0;
+    int64_t recLate;
+
+    ReplaySetup();
+    //  Services take 0 or 1 ms to run, workload stays well below 100% load so
+    //  that the scheduler always catches up with due tasks
+    for (uint8_t uid = 0; uid < NUM_OF_MODULES; uid++)
+        for (uint16_t svc = 0; svc < 256; svc++)
+        {
+            _rtSum[uid][svc] = (uid + svc) % 2;
+            _rtCnt[uid][svc] = 1;
+        }
+
+    //  Capture: drive the scheduler and note every call made
+    ReplayDrain();
+    _capture = &first;
+    for (uint32_t i = 0; i < cmds; i++)
+    {
+        struct _tsTraceRec rec;
+        uint32_t dice = ReplayRand(0, 99);
+        std::vector<uint8_t> &args = argStore[i];
+
+        now += ReplayRand(0, 20);
+        ReplayRunUntil(now);
+        ReplayDrain();
+
+        memset(&rec, 0, sizeof(rec));
+        rec.time = msSinceStartup;
+        rec.libUID = uids[ReplayRand(0, sizeof(uids) - 1)];
+        rec.taskID = (uint8_t)ReplayRand(0, 3);
+        args.resize(ReplayRand(1, 8));
+        for (uint32_t b = 0; b < args.size(); b++)
+            args[b] = (uint8_t)ReplayRand(0, 255);
+
+        if ((dice < 15) && !live.empty())
+        {
+            uint32_t k = ReplayRand(0, live.size() - 1);
+
+            rec.type = TS_TRACE_KILLPID;
+            rec.libUID = rec.taskID = 0;
+            rec.PID = live[k];
+            live[k] = live.back();
+            live.pop_back();
+            ts.RemoveTask(rec.PID);
+            expected.push_back(rec);
+        }
+        else if (dice < 20)
+        {
+            rec.type = TS_TRACE_KILLMATCH;
+            rec.argN = args.size();
+            rec.args = &args[0];
+            ts.RemoveTask(rec.libUID, rec.taskID, &args[0], args.size());
+            expected.push_back(rec);
+        }
+        else
+        {
+            rec.type = TS_TRACE_SYNC;
+            if (dice < 50)
+            {
+                rec.tsTime = -(int64_t)ReplayRand(0, 100);
+                rec.period = (int32_t)ReplayRand(5, 500);
+                rec.repeats = (ReplayRand(0, 9) == 0) ? T_PERIODIC :
+                                                        (int32_t)ReplayRand(1, 5);
+                rec.PID = ts.SyncTaskPer(rec.libUID, rec.taskID, rec.tsTime,
+                                         rec.period, rec.repeats);
+                live.push_back(rec.PID);
+            }
+            else
+            {
+                rec.tsTime = -(int64_t)ReplayRand(0, 300);
+                rec.PID = ts.SyncTask(rec.libUID, rec.taskID, rec.tsTime);
+            }
+            expected.push_back(rec);
+
+            rec.type = TS_TRACE_ARGS;
+            rec.argN = args.size();
+            rec.args = &args[0];
+            rec.libUID = rec.taskID = 0;
+            rec.PID = 0;
+            rec.tsTime = rec.period = rec.repeats = 0;
+            ts.AddArgs(&args[0], args.size());
+            expected.push_back(rec);
+        }
+        ReplayDrain();
+    }
+    ReplayRunUntil(now + 1000);
+    ReplayDrain();
+    _capture = 0;
+    if (TS_TraceDropped() > 0)
+        CheckFail("trace FIFO dropped records", 0);
+
+    //  Captured stream holds exactly the calls made, in order, with
+    //  dispatches in between
+    CheckDecode(first, 0, recs);
+    for (uint32_t i = 0, e = 0; i < recs.size(); i++)
+    {
+        const _tsTraceRec &r = recs[i];
+
+        if (r.type == TS_TRACE_DISPATCH)
+        {
+            nDispatch++;
+            if ((r.libUID >= NUM_OF_MODULES) ||
+                (r.runtime != _rtSum[r.libUID][r.taskID]) || (r.late < 0))
+                CheckFail("dispatch record", i);
+            continue;
+        }
+        if ((e >= expected.size()) ||
+            !CheckSame(expected[e++], r, 0, pidMap))
+            CheckFail("captured call differs from the one made", i);
+    }
+    if (recs.size() - nDispatch != expected.size())
+        CheckFail("number of captured calls", recs.size());
+
+    //  Replay from an empty queue, continuing the clock where capture stopped
+    //  (recorded stream can't go back in time). PIDs continue from capture
+    //  run as well, so every PID has to be mapped
+    while (!ts.IsEmpty())
+        ts.PopFront();
+    uint64_t tBase = msSinceStartup;
+    ReplayModel(&first[0], first.size(), recDispatch, recLate);
+    if (recDispatch != nDispatch)
+        CheckFail("runtime model", 0);
+    _capture = &second;
+    ReplayFeed(&first[0], first.size(), tBase, lat);
+    ReplayRunUntil(tBase + now + 1000);
+    ReplayDrain();
+    _capture = 0;
+
+    CheckDecode(second, recs.empty() ? 0 : recs.back().time, recs2);
+    pidMap.clear();
+    if (recs2.size() != recs.size())
+        CheckFail("number of records after replay", recs2.size());
+    for (uint32_t i = 0; (i < recs.size()) && (i < recs2.size()); i++)
+        if (!CheckSame(recs[i], recs2[i], tBase, pidMap))
+            CheckFail("replayed record differs", i);
+    CheckStartTime();
+
+    printf("Captured %zu records (%u dispatches, %zu bytes), replayed %zu\n",
+           recs.size(), nDispatch, first.size(), recs2.size());
+    printf("Result:                 %s\n", _checkErrors ? "FAILED" : "OK");
+
+    return (_checkErrors > 0) ? 1 : 0;
+}
+#endif  /* _TS_TRACE_ */
+
+/*******************************************************************************
+ *********             Comparison of two results                       *********
+ ******************************************************************************/
+struct _result
+{
+    char   key[64];
+    double val;
+};
+
+static uint32_t CompareLoad(const char *path, _result *res)
+{
+    FILE *f = fopen(path, "r");
+    char line[128];
+    uint32_t n = 0;
+
+    if (f == 0)
+    {
+        perror(path);
+        return 0;
+    }
+    while ((n < REPLAY_MAX_KEYS) && fgets(line, sizeof(line), f))
+    {
+        char *eq = strchr(line, '=');
+        if ((eq == 0) || ((eq - line) >= (long)sizeof(res[n].key)))
+            continue;
+        *eq = 0;
+        strcpy(res[n].key, line);
+        res[n].val = atof(eq + 1);
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static int Compare(const char *pathA, const char *pathB)
+{
+    _result a[REPLAY_MAX_KEYS], b[REPLAY_MAX_KEYS];
+    uint32_t nA = CompareLoad(pathA, a), nB = CompareLoad(pathB, b);
+
+    if ((nA == 0) || (nB == 0))
+        return 1;
+
+    printf("%-24s %14s %14s %9s\n", "metric", "A", "B", "B/A-1");
+    for (uint32_t i = 0; i < nA; i++)
+        for (uint32_t j = 0; j < nB; j++)
+        {
+            if (strcmp(a[i].key, b[j].key))
+                continue;
+            if (a[i].val != 0)
+                printf("%-24s %14.1f %14.1f %+8.1f%%\n", a[i].key, a[i].val,
+                       b[j].val, 100.0 * (b[j].val / a[i].val - 1.0));
+            else
+                printf("%-24s %14.1f %14.1f %9s\n", a[i].key, a[i].val,
+                       b[j].val, "-");
+        }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *usage =
+        "Usage: %s -g <out.trc> [-n cmds] [-d seconds] [-m per oneShot kill] "
+        "[-s seed]\n"
+        "       %s <in.trc> [-r runtimeMs] [-o results.txt]\n"
+        "       %s -c <a.txt> <b.txt>\n"
+        "       %s -t [-n cmds] [-s seed]\n";
+
+    if ((argc >= 4) && !strcmp(argv[1], "-c"))
+        return Compare(argv[2], argv[3]);
+
+    if ((argc >= 2) && !strcmp(argv[1], "-t"))
+    {
+        uint32_t cmds = 2000;
+
+        for (int i = 2; i < argc; i++)
+        {
+            if (!strcmp(argv[i], "-n") && (i+1 < argc))
+                cmds = strtoul(argv[++i], 0, 10);
+            else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+                _rndState = strtoul(argv[++i], 0, 10);
+        }
+#if defined(_TS_TRACE_)
+        if ((cmds > 0) && (_rndState != 0))
+            return Check(cmds);
+#else
+        fprintf(stderr, "Round-trip check needs a build with _TS_TRACE_\n");
+        return 1;
+#endif
+    }
+
+    if ((argc >= 3) && !strcmp(argv[1], "-g"))
+    {
+        uint32_t cmds = 10000, durationS = 3600, pct[3] = {30, 50, 20};
+
+        for (int i = 3; i < argc; i++)
+        {
+            if (!strcmp(argv[i], "-n") && (i+1 < argc))
+                cmds = strtoul(argv[++i], 0, 10);
+            else if (!strcmp(argv[i], "-d") && (i+1 < argc))
+                durationS = strtoul(argv[++i], 0, 10);
+            else if (!strcmp(argv[i], "-s") && (i+1 < argc))
+                _rndState = strtoul(argv[++i], 0, 10);
+            else if (!strcmp(argv[i], "-m") && (i+3 < argc))
+                for (uint8_t k = 0; k < 3; k++)
+                    pct[k] = strtoul(argv[++i], 0, 10);
+            else
+                break;
+        }
+        if ((cmds == 0) || (_rndState == 0) || (pct[0] + pct[1] + pct[2] == 0))
+        {
+            fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+            return 1;
+        }
+        return Generate(argv[2], cmds, durationS, pct);
+    }
+
+    if ((argc >= 2) && (argv[1][0] != '-'))
+    {
+        const char *out = 0;
+
+        for (int i = 2; i < argc; i++)
+        {
+            if (!strcmp(argv[i], "-r") && (i+1 < argc))
+                _rtDefault = strtoul(argv[++i], 0, 10);
+            else if (!strcmp(argv[i], "-o") && (i+1 < argc))
+                out = argv[++i];
+        }
+        return Replay(argv[1], out);
+    }
+
+    fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+}
+
+#endif  /* __BOARD_HOST__ */
@@ -0,0 +1,262 @@
+/**
+ * tsSim.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Discrete-event simulator for the task scheduler (host build only)
+ *  Instead of waiting for SysTick to tick in real time, the simulator moves
+ *  internal time of the task scheduler straight to the starting time of the
+ *  next task in the queue and lets TS_GlobalCheck() dispatch it. Tasks are
+ *  executed by a synthetic module whose services "run" for a configurable
+ *  amount of time (simulated by moving the clock forward during the service
+ *  call). Per-service profiler statistics are reported at the end of
+ *  simulation.
+ *
+ *  Usage: tsSim [-n tasks] [-d seconds] [-p minPer maxPer] [-r minRT maxRT]
+ *               [-o oneShotPct] [-s seed] [-v]
+ */
+#include "hwconfig.h"
+
+#if defined(__BOARD_HOST__)     //  Compile only in host builds
+
+#include "HAL/hal.h"
+#include "taskScheduler/taskScheduler.h"
+#include "init/eventLog.h"
+
+#include <stdio.h>
+#include <time.h>
+
+//  Unique identifier of synthetic module as registered in task scheduler
+#define SIM_UID         8
+//  Synthetic module accepts any service ID, runtime of a service call is
+//  passed to it as argument
+//  Number of distinct services tasks are spread over (each one is profiled)
+#define SIM_SERVICES    32
+
+/**
+ * Simulation parameters, all times in ms unless noted otherwise
+ */
+struct _simConfig
+{
+    uint32_t tasks;         //  Number of tasks to schedule at startup
+    uint32_t durationS;     //  Simulated time (in seconds)
+    uint32_t minPeriod;     //  Period range for periodic tasks
+    uint32_t maxPeriod;
+    uint32_t minRT;         //  Runtime range of synthetic services
+    uint32_t maxRT;
+    uint32_t oneShotPct;    //  Percentage of tasks which are one-off tasks
+    uint32_t seed;          //  Seed for pseudo-random workload generator
+    bool     verbose;       //  Print profiler data for every task
+};
+
+//  Interface with task scheduler for synthetic module
+static _kernelEntry _simKer;
+//  Number of service calls executed by synthetic module
+static uint64_t _simCalls = 0;
+
+/**
+ * Small xorshift PRNG -> same workload on every platform for a given seed
+ */
+static uint32_t _rndState;
+static uint32_t SimRand(uint32_t lo, uint32_t hi)
+{
+    _rndState ^= _rndState << 13;
+    _rndState ^= _rndState >> 17;
+    _rndState ^= _rndState << 5;
+
+    if (hi <= lo)
+        return lo;
+    return lo + (_rndState % (hi - lo + 1));
+}
+
+/**
+ * Callback routine of synthetic module
+ * args[] = runtime(uint16_t)
+ * Service "runs" by moving internal clock of task scheduler forward
+ */
+void _SIM_KernelCallback(void)
+{
+    uint16_t runtime = 0;
+
+    if (_simKer.argN >= sizeof(uint16_t))
+        memcpy(&runtime, _simKer.args, sizeof(uint16_t));
+
+    msSinceStartup += runtime;
+    _simCalls++;
+
+    _simKer.retVal = STATUS_OK;
+    EventLog::EmitEvent(SIM_UID, _simKer.serviceID, EVENT_OK);
+}
+
+/**
+ * Parse command line arguments into configuration structure
+ * @return true if arguments are valid, false otherwise
+ */
+static bool SimParseArgs(int argc, char **argv, struct _simConfig &cfg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+
+        if (!strcmp(a, "-n") && (i+1 < argc))
+            cfg.tasks = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(a, "-d") && (i+1 < argc))
+            cfg.durationS = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(a, "-p") && (i+2 < argc))
+        {
+            cfg.minPeriod = strtoul(argv[++i], 0, 10);
+            cfg.maxPeriod = strtoul(argv[++i], 0, 10);
+        }
+        else if (!strcmp(a, "-r") && (i+2 < argc))
+        {
+            cfg.minRT = strtoul(argv[++i], 0, 10);
+            cfg.maxRT = strtoul(argv[++i], 0, 10);
+        }
+        else if (!strcmp(a, "-o") && (i+1 < argc))
+            cfg.oneShotPct = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(a, "-s") && (i+1 < argc))
+            cfg.seed = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(a, "-v"))
+            cfg.verbose = true;
+        else
+            return false;
+    }
+
+    //  Periods of 0 would turn periodic tasks into one-off tasks
+    if ((cfg.minPeriod == 0) || (cfg.maxPeriod < cfg.minPeriod))
+        return false;
+    if ((cfg.maxRT < cfg.minRT) || (cfg.maxRT > 0xFFFF) || (cfg.seed == 0))
+        return false;
+
+    return true;
+}
+
+/**
+ * Populate task scheduler with pseudo-random workload
+ */
+static void SimPopulate(const struct _simConfig &cfg)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+
+    for (uint32_t i = 0; i < cfg.tasks; i++)
+    {
+        uint16_t runtime = (uint16_t)SimRand(cfg.minRT, cfg.maxRT);
+        uint32_t period = SimRand(cfg.minPeriod, cfg.maxPeriod);
+        //  Spread first execution over the first period to avoid a burst
+        uint32_t start = 1 + SimRand(0, period);
+
+        if (SimRand(0, 99) < cfg.oneShotPct)
+            ts.SyncTask(SIM_UID, (uint8_t)(i % SIM_SERVICES), start);
+        else
+            ts.SyncTaskPer(SIM_UID, (uint8_t)(i % SIM_SERVICES), start, period,
+                           T_PERIODIC);
+
+        ts.AddArg<uint16_t>(runtime);
+    }
+}
+
+/**
+ * Walk over profiling table and print statistics of synthetic services
+ */
+static void SimReport(const struct _simConfig &cfg, double wallS)
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    uint32_t Ntasks = ts.NumOfTasks();
+    uint64_t runs = 0, missCnt = 0, missTot = 0, accRT = 0;
+    uint16_t maxRT = 0;
+
+    for (uint16_t i = 0; i < TS_PROF_SLOTS; i++)
+    {
+        uint8_t libUID, serviceID;
+        Performance perf;
+
+        if (!TS_ProfFetch(i, libUID, serviceID, perf) || (libUID != SIM_UID))
+            continue;
+
+        runs += perf.taskRuns;
+        missCnt += perf.startTimeMissCnt;
+        missTot += perf.startTimeMissTot;
+        accRT += (uint64_t)perf.accRT * 1000 + perf.msAcc;
+        if (perf.maxRT > maxRT)
+            maxRT = perf.maxRT;
+
+        if (cfg.verbose)
+            printf("svc %3u: runs %u, missed %u (avg %.1f ms), max RT %u ms\n",
+                   serviceID, perf.taskRuns, perf.startTimeMissCnt,
+                   perf.startTimeMissCnt ?
+                       (double)perf.startTimeMissTot /
+                       perf.startTimeMissCnt : 0.0,
+                   perf.maxRT);
+    }
+
+    printf("Simulated %.1f s in %.3f s of wall time (x%.0f)\n",
+           (double)msSinceStartup / 1000.0, wallS,
+           wallS > 0 ? ((double)msSinceStartup / 1000.0) / wallS : 0.0);
+    printf("Service calls:          %llu\n", (unsigned long long)_simCalls);
+    printf("Tasks still queued:     %u\n", Ntasks);
+    printf("Profiled runs:          %llu (%u not profiled)\n",
+           (unsigned long long)runs, TS_ProfDropped());
+    printf("Missed start times:     %llu (%.2f%%)\n",
+           (unsigned long long)missCnt, runs ? 100.0 * missCnt / runs : 0.0);
+    printf("Avg. start time miss:   %.2f ms\n",
+           missCnt ? (double)missTot / missCnt : 0.0);
+    printf("Avg. service runtime:   %.2f ms\n",
+           runs ? (double)accRT / runs : 0.0);
+    printf("Max. service runtime:   %u ms\n", maxRT);
+    printf("CPU utilization:        %.2f%%\n", msSinceStartup ?
+           100.0 * (double)accRT / (double)msSinceStartup : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    struct _simConfig cfg = {500, 86400, 1000, 60000, 0, 5, 10, 1, false};
+    struct timespec t0, t1;
+
+    if (!SimParseArgs(argc, argv, cfg))
+    {
+        fprintf(stderr, "Usage: %s [-n tasks] [-d seconds] [-p minPer maxPer] "
+                "[-r minRT maxRT] [-o oneShotPct] [-s seed] [-v]\n", argv[0]);
+        return 1;
+    }
+    _rndState = cfg.seed;
+
+    //  Same initialization sequence as on the target (see main.cpp)
+    TaskScheduler &ts = TaskScheduler::GetI();
+    HAL_BOARD_CLOCK_Init();
+    EventLog::GetI().InitSW();
+    EventLog::GetI().RecordEvents(true);
+    ts.InitHW(1);
+
+    _simKer.callBackFunc = _SIM_KernelCallback;
+    TS_RegCallback(&_simKer, SIM_UID);
+
+    SimPopulate(cfg);
+
+    const uint64_t endT = (uint64_t)cfg.durationS * 1000;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    //  Event loop: jump to the start time of the first task in the queue and
+    //  let task scheduler dispatch everything that's due at that time
+    while (!ts.IsEmpty())
+    {
+        uint64_t next = TS_TimeExpand(ts.PeekFront().GetTimeStamp(),
+                                      msSinceStartup);
+
+        if (next > endT)
+            break;
+        if (next > msSinceStartup)
+            msSinceStartup = next;
+
+        TS_GlobalCheck();
+    }
+    if (msSinceStartup < endT)
+        msSinceStartup = endT;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    SimReport(cfg, (double)(t1.tv_sec - t0.tv_sec) +
+                   (double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+    return 0;
+}
+
+#endif  /* __BOARD_HOST__ */
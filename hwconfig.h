@@ -15,8 +15,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-//  Define platform in use in hal.h
+//  Define platform in use in hal.h; host (PC) builds of the kernel define
+//  __BOARD_HOST__ on the compiler command line instead (see host/Makefile)
+#if !defined(__BOARD_HOST__)
 #define __BOARD_TM4C1294NCPDT__
+#endif
 
 /*
  * Compile all libraries in debug mode, allowing them to print debug data to
@@ -32,6 +35,8 @@
  */
 #define __HAL_USE_TASKSCH__
 #define __HAL_USE_EVENTLOG__
+//  Persistent copy of event log in on-chip flash, needs __HAL_USE_EVENTLOG__
+#define __HAL_USE_EVLOGSTORE__
 
 //  Define number of modules in the kernel (used to initialize memory space)
 #define NUM_OF_MODULES  10
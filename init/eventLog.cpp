@@ -5,6 +5,9 @@
  *      Author: Vedran
  */
 #include "eventLog.h"
+#include "evlogCodec.h"
+#include "evlogStore.h"
+#include "HAL/hal.h"
 
 //  Enable debug information printed on serial port
 //#define __DEBUG_SESSION__
@@ -14,6 +17,9 @@
 //  Simplify emitting events
 #define EMIT_EV(X, Y)  EventLog::EmitEvent(EVLOG_UID, X, Y)
 
+//  Lengths of windows of rolling rates kept by event counters
+static const uint32_t _evStatWinMs[EVLOG_STAT_WINDOWS] = EVLOG_STAT_WIN_MS;
+
 /**
  * Callback routine to invoke service offered by this module from task scheduler
  * @note It is assumed that once this function is called task scheduler has
@@ -37,14 +43,34 @@ void _EVLOG_KernelCallback()
     {
     /*
      * Drop all data in event log before given timestamp (in milliseconds)
-     * First 4 bytes contain time in ms as given by the task scheduler
-     * args[] = timestamp(uint32_t)
+     * as given by the task scheduler. 4-byte timestamp holds lower 32 bits of
+     * a time within 2^31 ms of now
+     * args[] = timestamp(uint64_t) or timestamp(uint32_t)
      * retVal one of myLib.h STATUS_* error codes
      */
     case EVLOG_DROP:
         {
-            uint32_t timestamp;
-            memcpy(&timestamp, __evlog._evlogKer.args, sizeof(uint32_t));
+            uint64_t timestamp;
+
+            if (__evlog._evlogKer.argN >= sizeof(uint64_t))
+                memcpy(&timestamp, __evlog._evlogKer.args, sizeof(uint64_t));
+            else if (__evlog._evlogKer.argN >= sizeof(uint32_t))
+            {
+                uint64_t now = TS_GetTimeMS();
+                uint32_t ts32;
+
+                memcpy(&ts32, __evlog._evlogKer.args, sizeof(uint32_t));
+                timestamp = TS_TimeExpand(ts32, now);
+                //  Time before startup of task scheduler wraps around, it
+                //  drops nothing
+                if (timestamp > now + 0x7FFFFFFFull)
+                    timestamp = 0;
+            }
+            else
+            {
+                __evlog._evlogKer.retVal = STATUS_ARG_ERR;
+                break;
+            }
 
             __evlog._evlogKer.retVal = __evlog.DropBefore(timestamp);
         }
@@ -80,6 +106,64 @@ void _EVLOG_KernelCallback()
                 EventLog::SoftReboot(__evlog._evlogKer.args[1]);
         }
         break;
+    /*
+     * Set rate limit of an event type of a module
+     * args[] = libUID|event|periodMs(uint16_t)|burst
+     * retVal one of myLib.h STATUS_* error codes
+     */
+    case EVLOG_RATELIMIT:
+        {
+            uint16_t periodMs;
+
+            if (__evlog._evlogKer.argN < 5)
+            {
+                __evlog._evlogKer.retVal = STATUS_ARG_ERR;
+                break;
+            }
+            memcpy(&periodMs, __evlog._evlogKer.args + 2, sizeof(uint16_t));
+
+            __evlog._evlogKer.retVal =
+                    __evlog.SetRateLimit(__evlog._evlogKer.args[0],
+                                         (Events)__evlog._evlogKer.args[1],
+                                         periodMs, __evlog._evlogKer.args[4]);
+        }
+        break;
+    /*
+     * Set reactive rule, or clear it if only its index is given
+     * args[] = index|libUID|event|count|windowMs(uint32_t)|svcUID|serviceID|
+     *          args of the service (up to EVLOG_RULE_ARGS bytes)
+     * retVal one of myLib.h STATUS_* error codes
+     */
+    case EVLOG_RULE:
+        {
+            struct _evRule rule;
+
+            if (__evlog._evlogKer.argN == 1)
+            {
+                __evlog._evlogKer.retVal =
+                        __evlog.ClearRule(__evlog._evlogKer.args[0]);
+                break;
+            }
+            if ((__evlog._evlogKer.argN < 10) ||
+                (__evlog._evlogKer.argN > (10 + EVLOG_RULE_ARGS)))
+            {
+                __evlog._evlogKer.retVal = STATUS_ARG_ERR;
+                break;
+            }
+            rule.libUID = __evlog._evlogKer.args[1];
+            rule.event = __evlog._evlogKer.args[2];
+            rule.count = __evlog._evlogKer.args[3];
+            memcpy(&rule.windowMs, __evlog._evlogKer.args + 4,
+                   sizeof(uint32_t));
+            rule.svcUID = __evlog._evlogKer.args[8];
+            rule.serviceID = __evlog._evlogKer.args[9];
+            rule.argN = __evlog._evlogKer.argN - 10;
+            memcpy(rule.args, __evlog._evlogKer.args + 10, rule.argN);
+
+            __evlog._evlogKer.retVal =
+                    __evlog.SetRule(__evlog._evlogKer.args[0], rule);
+        }
+        break;
     default:
         break;
     }
@@ -148,7 +232,16 @@ void EventLog::RecordEvents(bool enable)
  * Interface for logging events
  * Called by all system modules when they want to log an event. Function
  * constructs event entry from provided arguments, appends current timestamp to
- * it and saves it in linked list stored in EventLog class.
+ * it and saves it in the staging ring, from where it's encoded into blocks of
+ * the log. When the log is full the oldest block is overwritten.
+ * Safe to call from interrupts and from code they interrupt: state of the
+ * module is replaced by compare-and-swap (retried if another context updated
+ * it in the meantime) and staging slots are reserved the same way.
+ * Repeated events and events over the rate limit of their type are dropped
+ * but counted, the count is logged as EVENT_SUPPRESSED entry in front of the
+ * next event of that type. Events of unknown modules aren't rate limited.
+ * Counters of events (see GetStat()) are updated first, so they include
+ * dropped events and events emitted while recording is disabled.
  * @param libUID ID of module which emitted event
  * @param taskID ID of task which was being executed when event occurred
  * @param event One of EVENT_* enums from header file, describing event
@@ -157,80 +250,102 @@ void EventLog::EmitEvent(uint8_t libUID, int8_t taskID, Events event)
 {
     //  Get reference of singleton
     EventLog &el = EventLog::GetI();
+    bool prioInv = false, drop = false;
+    uint16_t suppressed = 0;
+    uint32_t seq;
+    uint8_t idx;
+
+    //  Take time only once, it's the same for both entries
+    uint64_t now = TS_GetTimeMS();
+
+    if ((libUID < NUM_OF_MODULES) && (event < EVLOG_RL_EVENTS))
+    {
+        el._StatAdd(libUID, event, now);
+#if defined(__USE_TASK_SCHEDULER__)
+        el._RuleHit(libUID, event, now);
+#endif
+    }
 
     //  If event logger is not enabled stop here
     if (!el._enSig)
         return;
 
-    //  Check if log is over its allowed size, remove all log entries if log is full
-    if (el._entryvCount > MAX_LOG_ENTRIES)
-        el.DropBefore(0xFFFFFFFF);
-
-    //  Allocate new memory for linked least
-    static volatile struct _eventEntry *lastEntry = 0;
-    volatile struct _eventEntry *eventInst = new struct _eventEntry,
-                                *prioInvEvent = 0;
-
-    //  Populate event instance with event data
-    eventInst->libUID = libUID;
-    eventInst->taskID = taskID;
-    eventInst->timestamp = msSinceStartup;
-    eventInst->event = event;
-    eventInst->next = 0;
-
-    //  Prevent repeated logging of same events within a module
-    //  Check if the same event for this module has already been logged on the
-    //  last function call, if so add this event only if enough time has
-    //  passed between those two events
-    if ((el._lastEvent[libUID].event == event) &&
-        ((eventInst->timestamp-el._lastEvent[libUID].timestamp) < REP_TIME_DIFF_MS))
-    {
-        //  If there wasn't enough time remove the object from heap and stop here
-        delete eventInst;
-        return;
-    }
-
-    //  If current event is the new highest priority one, save it       OR
-    //  If it's a startup event, save it as new high prio. one thereby resetting
-    //  the highest priority entry for this module
-    if ((event >= el._highestPrioEv[libUID].event) || (event == EVENT_STARTUP))
-    {
-        el._highestPrioEv[libUID] = *((struct _eventEntry *)eventInst);
-        el._prioInvOcc[libUID] = false;
-    }
-    else
+    //  Events of unknown modules (or if more than EVLOG_WRITERS contexts are
+    //  emitting at once) are logged without updating state of the module
+    if ((libUID < NUM_OF_MODULES) && el._ModAlloc(idx))
     {
-        //  If there is higher priority event than this already logged, module
-        //  experienced priority inversion. Add original event in the list, but
-        //  also add priority inversion event after it.
-        prioInvEvent = new struct _eventEntry;
-        prioInvEvent->libUID = libUID;
-        prioInvEvent->taskID = taskID;
-        prioInvEvent->timestamp = msSinceStartup;
-        prioInvEvent->event = EVENT_PRIOINV;
-        prioInvEvent->next = 0;
-        el._prioInvOcc[libUID] = true;
-    }
+        struct _evModState &st = el._modPool[idx];
+        uint32_t cur;
 
-    //  Adding event to a linked list of EventLog
-    //  If it's not first entry update 'next' pointer of previous entry
-    if (el._entryVectorHead == 0)
-        el._entryVectorHead = eventInst;
-    else
-        lastEntry->next = eventInst;
+        do
+        {
+            cur = el._modCur[libUID];
+            el._ModRead(libUID, st);
 
-    //  Save current entry to be used as new 'previous' entry in next run
-    lastEntry = eventInst;
-    el._lastEvent[libUID] = *((struct _eventEntry *)eventInst);
-    el._entryvCount++;
+            //  Prevent repeated logging of same events within a module
+            //  Check if the same event for this module has already been logged
+            //  on the last function call, if so add this event only if enough
+            //  time has passed between those two events
+            drop = (st.last.event == event) &&
+                   ((now - st.last.timestamp) < REP_TIME_DIFF_MS);
+            //  Events set by event log itself aren't rate limited or counted
+            if (event >= EVLOG_RL_EVENTS)
+            {
+                if (drop)
+                {
+                    el._ModFree(idx);
+                    return;
+                }
+            }
+            else if (drop || !el._RateTake(libUID, event, st, now))
+            {
+                //  Only the count of dropped events is updated (and published
+                //  by the loop condition), rest of module state stays as it is
+                drop = true;
+                if (st.suppressed[event] < 0xFFFF)
+                    st.suppressed[event]++;
+                continue;
+            }
+            else
+            {
+                //  Report events dropped before this one
+                suppressed = st.suppressed[event];
+                st.suppressed[event] = 0;
+            }
 
-    //  Check if there's an event for priority inversion that needs to be added
-    if (prioInvEvent != 0)
-    {
-        lastEntry->next = prioInvEvent;
-        lastEntry = prioInvEvent;
-        el._entryvCount++;
+            st.last.libUID = libUID;
+            st.last.taskID = taskID;
+            st.last.timestamp = now;
+            st.last.event = event;
+
+            //  If current event is the new highest priority one, save it   OR
+            //  If it's a startup event, save it as new high prio. one thereby
+            //  resetting the highest priority entry for this module
+            prioInv = (event < st.highest.event) && (event != EVENT_STARTUP);
+            if (!prioInv)
+                st.highest = st.last;
+            //  If there is higher priority event than this already logged,
+            //  module experienced priority inversion. Add original event in
+            //  the list, but also add priority inversion event after it.
+            st.prioInv = prioInv;
+        } while (!el._ModPublish(libUID, cur, idx));
+
+        if (drop)
+            return;
+#if defined(__USE_TASK_SCHEDULER__)
+        if (prioInv)
+            el._RuleHit(libUID, EVENT_PRIOINV, now);
+#endif
     }
+
+    seq = el._Reserve((prioInv ? 2 : 1) + ((suppressed > 0) ? 1 : 0), now);
+    if (suppressed > 0)
+        el._Commit(seq++, libUID, event, EVENT_SUPPRESSED, now, suppressed);
+    el._Commit(seq, libUID, taskID, event, now, 0);
+    if (prioInv)
+        el._Commit(seq + 1, libUID, taskID, EVENT_PRIOINV, now, 0);
+
+    el._Encode();
 }
 
 /**
@@ -238,83 +353,92 @@ void EventLog::EmitEvent(uint8_t libUID, int8_t taskID, Events event)
  * @param timestamp Time in ms (as reported by task scheduler module) before
  * which all events are to be erased from event log
  * @return One of myLib.h STATUS_* error codes
+ * @note Only one context may drop or reset the log at a time
  */
-uint32_t EventLog::DropBefore(uint32_t timestamp)
+uint32_t EventLog::DropBefore(uint64_t timestamp)
 {
-    uint32_t retVal = STATUS_OK;
-    //  Delete dynamically allocated list
-   volatile struct _eventEntry *node = _entryVectorHead;
-
-   //   Loop through the list and delete everything with time before timestamp
-   while (node != 0)
-   {
-       //   Check if end condition has been reached
-       if (node->timestamp > timestamp)
-           break;
+    struct _evIter pos = Seek(timestamp + 1);
+    uint32_t kept = KeptBegin(), sum = SummaryBegin(), cur;
+    struct _eventEntry entry;
+    struct _evSummary summary;
 
-       //   Save pointer to next element
-       volatile struct _eventEntry *tmp = node->next;
-       //   Delete current element
-       delete node;
-       //    Set next as new current element
-       node = tmp;
-       //   Decrease number of entries in list
-       _entryvCount--;
-   }
+    //  Older tiers are in time order too; summary is dropped once its whole
+    //  time bucket is before [timestamp]
+    cur = kept;
+    while (KeptNext(cur, entry) && (entry.timestamp <= timestamp))
+        kept = cur;
+    cur = sum;
+    while (SummaryNext(cur, summary) &&
+           (((summary.bucket + 1ull) * EVLOG_SUM_BUCKET_MS) <=
+            (timestamp + 1)))
+        sum = cur;
 
-   _entryVectorHead = node;
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+    _start = pos;
+    _keptStart = kept;
+    _sumStart = sum;
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
 
-   return retVal;
+    return STATUS_OK;
 }
 
 /**
  * Perform full reset of event log, clear all logs, reset all saved states that
  * are usually not deleter with DropBefore() function call
  * @return One of myLib.h STATUS_* error codes
+ * @note Only one context may drop or reset the log at a time
  */
 uint32_t EventLog::Reset()
 {
     uint32_t retVal = STATUS_OK;
+    uint8_t idx;
+
+    //  Empty the log by moving its start behind the last entry; sequence
+    //  numbers keep running so that iterators obtained before reset don't
+    //  return new entries twice
+    _Encode();
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+    _start.block = _head;
+    _start.offset = _blkLen[_head & (EVLOG_BLOCKS - 1)];
+    _start.index = _blkCnt[_head & (EVLOG_BLOCKS - 1)];
+    _start.time = _headTime;
+    _start.seq = _blkFirst[_head & (EVLOG_BLOCKS - 1)] + _start.index;
+    _keptStart = _keptHead;
+    _sumStart = _sumHead;
+    _overwritten = 0;
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
 
-    //  Delete dynamically allocated list
-   volatile struct _eventEntry *node = _entryVectorHead;
-
-   //   Loop through the list until node is null pointer
-   while (node != 0)
-   {
-       //   Save pointer to next element
-       volatile struct _eventEntry *tmp = node->next;
-       //   Delete current element
-       delete node;
-       //    Set next as new current element
-       node = tmp;
-       //   Decrease number of entries in list
-       _entryvCount--;
-   }
-
-   //   If we've reached end of the list but number of items in the list is !=0
-   //   we have memory leakage, raise event
-   if(_entryvCount != 0)
-   {
-       EMIT_EV(-1, EVENT_ERROR);
-       retVal = STATUS_PROG_ERR;
-   }
-
-   //   Construct empty task entry for resetting event arrays
-   struct _eventEntry empty;
-   empty.event = EVENT_UNINITIALIZED;
-   empty.timestamp = 0;
-   empty.libUID = -1;
-   empty.taskID = -1;
-   //   Reset also arrays keeping events when main log is deleted
-   for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
-   {
-       _lastEvent[i] = empty;
-       _highestPrioEv[i] = empty;
-       _prioInvOcc[i] = false;
-   }
-
-   return retVal;
+    //   Reset also states of modules kept when entries are deleted
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+    {
+        if (!_ModAlloc(idx))
+        {
+            retVal = STATUS_PROG_ERR;
+            continue;
+        }
+
+        struct _evModState &st = _modPool[idx];
+        st.last.event = EVENT_UNINITIALIZED;
+        st.last.timestamp = 0;
+        st.last.libUID = -1;
+        st.last.taskID = -1;
+        st.highest = st.last;
+        st.prioInv = false;
+        for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+        {
+            st.bucket[j] = 0;
+            st.suppressed[j] = 0;
+            _StatClear(i, j);
+        }
+
+        while (!_ModPublish(i, _modCur[i], idx));
+    }
+
+    return retVal;
 }
 
 /**
@@ -327,57 +451,1376 @@ void EventLog::SoftReboot(uint8_t libUID)
     EmitEvent(libUID, -1, EVENT_INITIALIZED);
 }
 
+/**
+ * Set rate limit of an event type of a module
+ * Module can log up to [burst] events of the type at once, after that one
+ * every [periodMs] ms. Events over the limit are dropped and counted.
+ * @param libUID ID of module
+ * @param event type of event (can't be EVENT_PRIOINV or EVENT_SUPPRESSED)
+ * @param periodMs time in ms to regain one event, 0 to disable rate limiting
+ * @param burst highest number of events logged at once, at least 1
+ * @return One of myLib.h STATUS_* error codes
+ */
+uint32_t EventLog::SetRateLimit(uint8_t libUID, Events event,
+                                uint16_t periodMs, uint8_t burst)
+{
+    if ((libUID >= NUM_OF_MODULES) || (event >= EVLOG_RL_EVENTS) ||
+        (burst == 0))
+        return STATUS_ARG_ERR;
+
+    _rlPeriod[libUID][event] = periodMs;
+    _rlBurst[libUID][event] = burst;
+
+    return STATUS_OK;
+}
+
+/**
+ * Log counts of dropped events that haven't been reported yet
+ * Counts are otherwise logged only in front of the next event of the same
+ * type. Reporting a count takes an event from the bucket of its type, so
+ * calling this often (e.g. from main loop) logs no more than rate limit
+ * allows. Count of the event logged last by a module holds only its repeats
+ * (anything else is dropped as a repeat before the rate limit is checked),
+ * so it's reported no sooner than REP_TIME_DIFF_MS after that event, when
+ * the event itself would be logged again.
+ * @return number of EVENT_SUPPRESSED entries logged
+ */
+uint32_t EventLog::FlushSuppressed()
+{
+    uint32_t logged = 0;
+
+    if (!_enSig)
+        return 0;
+
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+    {
+        uint16_t counts[EVLOG_RL_EVENTS];
+        uint32_t cur, seq, n = 0;
+        uint64_t now = TS_GetTimeMS();
+        uint8_t idx;
+
+        //  Peek at current state first to skip modules with nothing to report
+        for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+            n |= _modPool[_modCur[i] & 0xFF].suppressed[e];
+        if ((n == 0) || !_ModAlloc(idx))
+            continue;
+
+        struct _evModState &st = _modPool[idx];
+        do
+        {
+            cur = _modCur[i];
+            _ModRead(i, st);
+            n = 0;
+
+            for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+            {
+                counts[e] = 0;
+                if ((st.suppressed[e] == 0) ||
+                    ((st.last.event == e) &&
+                     ((now - st.last.timestamp) < REP_TIME_DIFF_MS)) ||
+                    !_RateTake(i, e, st, now))
+                    continue;
+                counts[e] = st.suppressed[e];
+                st.suppressed[e] = 0;
+                n++;
+            }
+            if (n == 0)
+            {
+                _ModFree(idx);
+                break;
+            }
+        } while (!_ModPublish(i, cur, idx));
+        if (n == 0)
+            continue;
+
+        seq = _Reserve(n, now);
+        for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+            if (counts[e] > 0)
+                _Commit(seq++, i, e, EVENT_SUPPRESSED, now, counts[e]);
+        logged += n;
+    }
+    _Encode();
+
+    return logged;
+}
+
+#if defined(__USE_TASK_SCHEDULER__)
+/**
+ * Set reactive rule
+ * Once module [rule.libUID] emits [rule.event] [rule.count] times within
+ * [rule.windowMs] ms, service [rule.serviceID] of module [rule.svcUID] is
+ * scheduled to run as soon as possible by the next ScheduleRules(). Events
+ * are counted from scratch after the rule fires, and from the moment it's
+ * set. Events are counted whether they're logged or not; priority inversions
+ * only while recording is enabled.
+ * @note Call from main loop; EmitEvent() can run meanwhile and skips the rule
+ * while it's being changed
+ * @param index index of rule, below EVLOG_RULES; replaces rule set there
+ * @param rule rule to set
+ * @return One of myLib.h STATUS_* error codes
+ */
+uint32_t EventLog::SetRule(uint8_t index, const struct _evRule &rule)
+{
+    if ((index >= EVLOG_RULES) || (rule.libUID >= NUM_OF_MODULES) ||
+        (rule.event >= EVENT_SUPPRESSED) || (rule.count == 0) ||
+        (rule.count > EVLOG_RULE_HITS) || (rule.argN > EVLOG_RULE_ARGS) ||
+        !TaskScheduler::ValidKernModule(rule.svcUID))
+        return STATUS_ARG_ERR;
+
+    ClearRule(index);
+
+    _ruleVer[index]++;
+    HAL_BOARD_MemBarrier();
+    _rules[index] = rule;
+    _ruleArm[index] = _ruleHead[index];
+    HAL_BOARD_MemBarrier();
+    _ruleVer[index]++;
+    HAL_BOARD_MemBarrier();
+
+    _ruleMap[rule.libUID][rule.event] |= (1u << index);
+
+    return STATUS_OK;
+}
+
+/**
+ * Clear reactive rule, see SetRule()
+ * @note Call from main loop
+ * @param index index of rule, below EVLOG_RULES
+ * @return One of myLib.h STATUS_* error codes
+ */
+uint32_t EventLog::ClearRule(uint8_t index)
+{
+    uint32_t pending;
+
+    if (index >= EVLOG_RULES)
+        return STATUS_ARG_ERR;
+
+    //  Contexts that found the rule in the map already see it as being changed
+    _ruleVer[index]++;
+    HAL_BOARD_MemBarrier();
+    _ruleMap[_rules[index].libUID][_rules[index].event] &= ~(1u << index);
+    _rules[index].count = 0;
+    //  Rule that fired but wasn't scheduled yet no longer schedules anything
+    do
+    {
+        pending = _rulePending;
+    } while (!HAL_BOARD_AtomicCAS(&_rulePending, pending,
+                                  pending & ~(1u << index)));
+    HAL_BOARD_MemBarrier();
+    _ruleVer[index]++;
+
+    return STATUS_OK;
+}
+
+/**
+ * Schedule services of reactive rules that fired since the last call
+ * EmitEvent() only marks rules that fire: adding a task allocates a node of
+ * the task queue and enters a critical section of task scheduler, neither of
+ * which is allowed in interrupts or while interrupts are masked (e.g. in
+ * TaskScheduler::Reset()). Rule that fired several times since the last call
+ * schedules its service once.
+ * @note Call from main loop, e.g. after TS_GlobalCheck()
+ * @return number of tasks scheduled
+ */
+uint32_t EventLog::ScheduleRules()
+{
+    uint32_t pending, n = 0;
+
+    do
+    {
+        pending = _rulePending;
+    } while ((pending != 0) &&
+             !HAL_BOARD_AtomicCAS(&_rulePending, pending, 0));
+
+    //  Rules are only changed from main loop, so they can't change meanwhile;
+    //  context preempted while counting an event can mark a rule after it
+    //  has been cleared
+    for (uint8_t r = 0; pending != 0; r++, pending >>= 1)
+    {
+        if (((pending & 0x01) == 0) || (_rules[r].count == 0))
+            continue;
+
+        TaskEntry te(_rules[r].svcUID, _rules[r].serviceID,
+                     (uint32_t)TS_GetTimeMS());
+        if (_rules[r].argN > 0)
+            te.AddArg(_rules[r].args, _rules[r].argN);
+        TaskScheduler::GetI().SyncTask(te);
+        n++;
+    }
+
+    return n;
+}
+#endif  /* __USE_TASK_SCHEDULER__ */
+
+#if defined(__HAL_USE_EVLOGSTORE__)
+
+#if (EVC_MAX_HEADER + EVLOG_BLOCK_SIZE) > 255
+#error "EVLOG_BLOCK_SIZE is too big for a record of persistent store"
+#endif
+
+/**
+ * Write entries logged since the last call to persistent store
+ * Every completed block is written as a single record. Block that's still
+ * being filled is written only if [all] is set; entries added to it later go
+ * into another record, starting with its own sync point.
+ * @param all write also entries of the block being filled (e.g. before reset)
+ * @return One of myLib.h STATUS_* error codes
+ * @note Writing flash stalls the CPU, call only from main loop. Store must be
+ * mounted with EVS_Mount() first.
+ */
+uint32_t EventLog::Persist(bool all)
+{
+    uint8_t rec[EVC_MAX_HEADER + EVLOG_BLOCK_SIZE];
+    struct _evIter &it = _persist;
+    uint32_t retVal;
+
+    //  Mark startup, so logs of two runs aren't taken as one
+    if (!_persistBoot)
+    {
+        if ((retVal = EVS_Append(EVLOG_REC_BOOT, 0, 0)) != STATUS_OK)
+            return retVal;
+        _persistBoot = true;
+    }
+
+    _Encode();
+
+    while (true)
+    {
+        uint32_t slot = it.block & (EVLOG_BLOCKS - 1), oldest = _Oldest(), head;
+        uint8_t len, n = 0, used, m;
+        struct _eventEntry entry;
+        uint64_t time;
+
+        //  Entries were overwritten before they could be written
+        if ((int32_t)(it.block - oldest) < 0)
+        {
+            it = _evIter();
+            it.block = oldest;
+            continue;
+        }
+
+        //  Length of a block is final once it's no longer the head, so head
+        //  is read first (see Next())
+        head = _head;
+        HAL_BOARD_MemBarrier();
+        len = _blkLen[slot];
+        if (_blkSeq[slot] != it.block)
+        {
+            if ((int32_t)(it.block - _Oldest()) >= 0)
+                break;
+            continue;
+        }
+        if ((it.block == head) && !all)
+            break;
+        if (it.offset >= len)
+        {
+            if (it.block == head)
+                break;
+            it.block++;
+            it.offset = 0;
+            it.index = 0;
+            continue;
+        }
+
+        //  Record has to decode on its own, part of a block gets a sync point
+        if (it.offset > 0)
+            n = EVC_PutHeader(rec, it.time);
+        memcpy(rec + n, _blk[slot] + it.offset, len - it.offset);
+        HAL_BOARD_MemBarrier();
+        if (_blkSeq[slot] != it.block)
+            continue;
+        n += len - it.offset;
+
+        if ((retVal = EVS_Append(EVLOG_REC_BLOCK, rec, n)) != STATUS_OK)
+            return retVal;
+
+        //  Rest of the block continues from time of the last entry written
+        time = it.time;
+        for (used = EVC_GetHeader(rec, rec + n, time); (used > 0) && (used < n);
+             used += m)
+        {
+            if ((m = EVC_GetEntry(rec + used, rec + n, time, entry)) == 0)
+                break;
+            time = entry.timestamp;
+            it.index++;
+        }
+        it.offset = len;
+        it.time = time;
+    }
+
+    return STATUS_OK;
+}
+
+#endif  /* __HAL_USE_EVLOGSTORE__ */
+
 ///-----------------------------------------------------------------------------
 ///         Functions for accessing event log                           [PUBLIC]
 ///-----------------------------------------------------------------------------
 
 /**
- * Return number of events currently in the log
+ * Return number of events currently in the log, including those still in
+ * staging ring
  * @return
  */
 uint16_t EventLog::EventCount()
 {
-    return _entryvCount;
+    uint32_t head = _head, oldest = _Oldest(), n = _reserve - _stageRead;
+    struct _evIter start = _start;
+
+    if ((int32_t)(start.block - oldest) >= 0)
+    {
+        oldest = start.block;
+        n -= start.index;
+    }
+    for (uint32_t b = oldest; (int32_t)(head - b) >= 0; b++)
+        n += _blkCnt[b & (EVLOG_BLOCKS - 1)];
+
+    return (uint16_t)n;
 }
 
 /**
- * Get first node of the linked list containing event log
+ * Return number of events that were overwritten because the log was full
  * @return
  */
-volatile struct _eventEntry* EventLog::GetHead()
+uint32_t EventLog::Overwritten()
+{
+    return _overwritten;
+}
+
+/**
+ * Get iterator pointing to the oldest event in the log
+ * @return iterator to pass to Next()
+ */
+struct _evIter EventLog::Begin()
+{
+    struct _evIter it;
+    uint32_t oldest;
+
+    //  Bring in events still waiting in staging ring
+    _Encode();
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+    it = _start;
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+
+    oldest = _Oldest();
+    if ((int32_t)(it.block - oldest) < 0)
+    {
+        it = _evIter();
+        it.block = oldest;
+    }
+
+    return it;
+}
+
+/**
+ * Decode the event iterator points to and advance iterator
+ * Iteration stops at the end of the log, or at a block that's being
+ * overwritten by an interrupted context.
+ * @param it iterator obtained from Begin()
+ * @param entry [out] copy of the event
+ * @return true if an event was decoded, false if iterator reached the end of
+ * the log
+ */
+bool EventLog::Next(struct _evIter &it, struct _eventEntry &entry)
+{
+    uint8_t buf[EVC_MAX_HEADER + EVC_MAX_ENTRY];
+
+    while (true)
+    {
+        uint32_t oldest = _Oldest(), slot = it.block & (EVLOG_BLOCKS - 1), head;
+        uint32_t first;
+        uint8_t len, n, used = 0;
+        uint64_t time = it.time;
+
+        //  Block was overwritten in the meantime, skip to the oldest one left
+        if ((int32_t)(it.block - oldest) < 0)
+        {
+            it = _evIter();
+            it.block = oldest;
+            continue;
+        }
+        if (_blkSeq[slot] != it.block)
+        {
+            //  Either being overwritten right now, or overwritten since
+            //  _Oldest() was read
+            if ((int32_t)(it.block - _Oldest()) >= 0)
+                return false;
+            continue;
+        }
+
+        //  Length of a block is final once it's no longer the head, so head
+        //  is read first
+        head = _head;
+        HAL_BOARD_MemBarrier();
+        len = _blkLen[slot];
+        if (it.offset >= len)
+        {
+            if (it.block == head)
+                return false;
+            it.block++;
+            it.offset = 0;
+            it.index = 0;
+            continue;
+        }
+
+        n = ((uint32_t)(len - it.offset) < sizeof(buf)) ? (len - it.offset)
+                                                        : sizeof(buf);
+        first = _blkFirst[slot];
+        memcpy(buf, _blk[slot] + it.offset, n);
+        HAL_BOARD_MemBarrier();
+        //  Block got overwritten while it was being copied
+        if (_blkSeq[slot] != it.block)
+            continue;
+
+        if ((it.offset == 0) && ((used = EVC_GetHeader(buf, buf + n, time)) == 0))
+            n = 0;
+        if ((n == 0) || ((n = EVC_GetEntry(buf + used, buf + n, time, entry)) == 0))
+        {
+            //  Malformed block, skip the rest of it
+            it.offset = len;
+            continue;
+        }
+
+        it.offset += used + n;
+        it.index++;
+        it.time = entry.timestamp;
+        it.seq = first + it.index;
+        return true;
+    }
+}
+
+/**
+ * Get iterator pointing to the first event at or after given time
+ * Blocks are found by binary search over their sync points, so only a single
+ * block is decoded regardless of the size of the log.
+ * @param time time in ms since startup
+ * @return iterator to pass to Next(), at the end of the log if all events
+ * are older than [time]
+ */
+struct _evIter EventLog::Seek(uint64_t time)
+{
+    struct _evIter it = Begin(), cur;
+    struct _eventEntry entry;
+    uint32_t lo = it.block, hi = _head;
+    uint64_t t;
+
+    //  Find the last block whose first entry is before [time]; event looked
+    //  for is either in that block or the first one of the next block. Blocks
+    //  that can't be read are being overwritten, so they're older than any
+    //  block still in the log
+    while (lo != hi)
+    {
+        uint32_t mid = hi - (hi - lo) / 2;
+
+        if (!_BlockTime(mid, t) || (t < time))
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    if (lo != it.block)
+    {
+        it = _evIter();
+        it.block = lo;
+    }
+
+    //  Walk through the block up to the first event that's not older
+    cur = it;
+    while (Next(cur, entry) && (entry.timestamp < time))
+        it = cur;
+
+    return it;
+}
+
+/**
+ * Decode the next event selected by the filter and advance iterator
+ * Blocks holding no entries of selected modules or events are skipped as a
+ * whole, and iteration stops at the first event after [filter.to]. Start
+ * from Seek(filter.from) to skip older events without decoding them.
+ * @param it iterator obtained from Begin() or Seek()
+ * @param entry [out] copy of the event
+ * @param filter selection of events to return
+ * @return true if an event was decoded, false if there are no more events
+ * selected by the filter
+ */
+bool EventLog::Next(struct _evIter &it, struct _eventEntry &entry,
+                    const struct _evFilter &filter)
+{
+    while (true)
+    {
+        uint32_t slot = it.block & (EVLOG_BLOCKS - 1);
+
+        //  Head block is still being filled so it's always decoded, summary
+        //  of other blocks is valid only if the block wasn't overwritten
+        //  while it was being read
+        if ((it.offset == 0) && (it.block != _head))
+        {
+            uint32_t mods = _blkMods[slot];
+            uint8_t events = _blkEvents[slot];
+
+            HAL_BOARD_MemBarrier();
+            if ((_blkSeq[slot] == it.block) &&
+                (((mods & filter.modules) == 0) ||
+                 ((events & filter.events) == 0)))
+            {
+                it.block++;
+                continue;
+            }
+        }
+
+        if (!Next(it, entry) || (entry.timestamp > filter.to))
+            return false;
+
+        if ((entry.timestamp >= filter.from) &&
+            (EVLOG_MODULE(entry.libUID) & filter.modules) &&
+            (EVLOG_EVENT(entry.event) & filter.events))
+            return true;
+    }
+}
+
+/**
+ * Get iterator pointing to the entry with given sequence number
+ * Like Seek(), blocks are found by binary search over the sequence number of
+ * their first entry.
+ * @param seq sequence number of entry
+ * @return iterator to pass to Next(); if the entry is no longer in the log,
+ * iterator points to the oldest entry (sequence numbers reported by Next()
+ * then show how many were lost). At the end of the log if [seq] is past the
+ * last entry.
+ */
+struct _evIter EventLog::SeekSeq(uint32_t seq)
+{
+    struct _evIter it = Begin(), cur;
+    struct _eventEntry entry;
+    uint32_t lo = it.block, hi = _head, first;
+
+    //  Find the last block whose first entry is not after [seq]; blocks that
+    //  can't be read are being overwritten (see Seek())
+    while (lo != hi)
+    {
+        uint32_t mid = hi - (hi - lo) / 2;
+
+        if (!_BlockFirst(mid, first) || ((int32_t)(first - seq) <= 0))
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    if (lo != it.block)
+    {
+        it = _evIter();
+        it.block = lo;
+    }
+
+    //  Walk through the block up to the entry itself
+    cur = it;
+    while (Next(cur, entry) && ((int32_t)(cur.seq - 1 - seq) < 0))
+        it = cur;
+
+    return it;
+}
+
+/**
+ * Return sequence number the next logged entry will get
+ * Entries lost in staging ring (see Overwritten()) never get a sequence
+ * number, so gaps between sequence numbers only show entries overwritten in
+ * blocks.
+ * @return sequence number of the next entry
+ */
+uint32_t EventLog::EndSeq()
+{
+    uint32_t head, slot, seq;
+
+    _Encode();
+
+    //  Retry if a new block was started while reading
+    do
+    {
+        head = _head;
+        slot = head & (EVLOG_BLOCKS - 1);
+        HAL_BOARD_MemBarrier();
+        seq = _blkFirst[slot] + _blkCnt[slot];
+        HAL_BOARD_MemBarrier();
+    } while ((_head != head) || (_blkSeq[slot] != head));
+
+    return seq;
+}
+
+/**
+ * Get iterator pointing to the oldest entry kept in full after its block was
+ * overwritten (see EVLOG_KEEP_EVENTS)
+ * @return iterator to pass to KeptNext()
+ */
+uint32_t EventLog::KeptBegin()
+{
+    uint32_t head = _keptHead, start = _keptStart;
+
+    if ((head - start) > EVLOG_KEPT)
+        start = head - EVLOG_KEPT;
+
+    return start;
+}
+
+/**
+ * Copy the kept entry iterator points to and advance iterator
+ * Kept entries are all older than the entries in blocks.
+ * @param it iterator obtained from KeptBegin()
+ * @param entry [out] copy of the entry
+ * @return true if an entry was copied, false at the end of kept entries
+ */
+bool EventLog::KeptNext(uint32_t &it, struct _eventEntry &entry)
+{
+    uint32_t version, head;
+
+    do
+    {
+        //  Can't wait for folding preempted by this context to finish
+        if ((version = _foldVersion) & 1)
+            return false;
+        HAL_BOARD_MemBarrier();
+
+        //  Skip entries overwritten in the meantime
+        head = _keptHead;
+        if ((head - it) > EVLOG_KEPT)
+            it = head - EVLOG_KEPT;
+        if (it == head)
+            return false;
+
+        entry = _kept[it & (EVLOG_KEPT - 1)];
+        HAL_BOARD_MemBarrier();
+    } while (_foldVersion != version);
+
+    it++;
+    return true;
+}
+
+/**
+ * Get iterator pointing to the oldest summary of overwritten entries
+ * @return iterator to pass to SummaryNext()
+ */
+uint32_t EventLog::SummaryBegin()
+{
+    uint32_t head = _sumHead, start = _sumStart;
+
+    if ((head - start) > EVLOG_SUMMARIES)
+        start = head - EVLOG_SUMMARIES;
+
+    return start;
+}
+
+/**
+ * Copy the summary iterator points to and advance iterator
+ * Summaries come in order of their time buckets; the last one can still grow
+ * as more blocks are overwritten.
+ * @param it iterator obtained from SummaryBegin()
+ * @param sum [out] copy of the summary
+ * @return true if a summary was copied, false at the end of summaries
+ */
+bool EventLog::SummaryNext(uint32_t &it, struct _evSummary &sum)
+{
+    uint32_t version, head;
+
+    do
+    {
+        //  Can't wait for folding preempted by this context to finish
+        if ((version = _foldVersion) & 1)
+            return false;
+        HAL_BOARD_MemBarrier();
+
+        //  Skip summaries overwritten in the meantime
+        head = _sumHead;
+        if ((head - it) > EVLOG_SUMMARIES)
+            it = head - EVLOG_SUMMARIES;
+        if (it == head)
+            return false;
+
+        sum = _sum[it & (EVLOG_SUMMARIES - 1)];
+        HAL_BOARD_MemBarrier();
+    } while (_foldVersion != version);
+
+    it++;
+    return true;
+}
+
+/**
+ * Read counter of events of one type emitted by a module
+ * Rate over each window is estimated from the number of events in the
+ * current window and in the previous one, weighted by how much of the
+ * previous window is still within the last [length] ms.
+ * @param libUID ID of module
+ * @param event type of event (can't be EVENT_PRIOINV or EVENT_SUPPRESSED)
+ * @param stat [out] state of the counter
+ * @return false if there's no counter for given module and event
+ * @note Call from main loop, not from interrupts
+ */
+bool EventLog::GetStat(uint8_t libUID, Events event, struct _evStat &stat)
 {
-    return _entryVectorHead;
+    struct _evCounter c;
+    uint64_t now = TS_GetTimeMS();
+    uint32_t version;
+
+    if ((libUID >= NUM_OF_MODULES) || (event >= EVLOG_RL_EVENTS))
+        return false;
+
+    //  Counter can only change under the reader if an interrupt updates it
+    do
+    {
+        version = _stat[libUID][event].version;
+        HAL_BOARD_MemBarrier();
+        memcpy(&c, (const void*)&_stat[libUID][event], sizeof(c));
+        HAL_BOARD_MemBarrier();
+    } while ((version & 1) || (_stat[libUID][event].version != version));
+
+    stat.count = c.count + c.pending;
+    stat.first = c.first;
+    stat.last = c.last;
+    for (uint8_t w = 0; w < EVLOG_STAT_WINDOWS; w++)
+    {
+        uint64_t len = _evStatWinMs[w], idx = now / len, left;
+
+        //  Part of the previous window still within the last [len] ms
+        left = len - (now % len);
+        if (idx == c.window[w])
+            stat.rate[w] = c.winCur[w] +
+                           (uint32_t)((c.winPrev[w] * left) / len);
+        else if (idx == (c.window[w] + 1ull))
+            stat.rate[w] = (uint32_t)((c.winCur[w] * left) / len);
+        else
+            stat.rate[w] = 0;
+    }
+
+    return true;
 }
 
 struct _eventEntry EventLog::GetLastEvAt(uint8_t index)
 {
-        return _lastEvent[index];
+        struct _evModState st;
+        _ModRead(index, st);
+        return st.last;
 }
 struct _eventEntry EventLog::GetHigPrioEvAt(uint8_t index)
 {
-        return _highestPrioEv[index];
+        struct _evModState st;
+        _ModRead(index, st);
+        return st.highest;
 }
 bool EventLog::GetPrioInvAt(uint8_t index)
 {
-        return _prioInvOcc[index];
+        struct _evModState st;
+        _ModRead(index, st);
+        return st.prioInv;
+}
+///-----------------------------------------------------------------------------
+///                      Event storage                                 [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Reserve [n] consecutive slots at the end of staging ring
+ * @param now [out] time of the reservation; taken between reading and
+ * swapping the sequence number, so reservation order is also time order
+ * @return sequence number of the first reserved slot
+ */
+uint32_t EventLog::_Reserve(uint8_t n, uint64_t &now)
+{
+    uint32_t seq;
+
+    do
+    {
+        seq = _reserve;
+        now = TS_GetTimeMS();
+    } while (!HAL_BOARD_AtomicCAS(&_reserve, seq, seq + n));
+
+    return seq;
+}
+
+/**
+ * Write entry into a reserved slot and mark it as complete
+ */
+void EventLog::_Commit(uint32_t seq, uint8_t libUID, int8_t taskID,
+                       Events event, uint64_t now, uint16_t count)
+{
+    uint32_t slot = seq & (EVLOG_STAGE - 1);
+    struct _eventEntry &entry = _ring[slot];
+
+    //  Invalidate the slot first: seq+1 belongs to another slot, so nobody
+    //  reading this slot can be waiting for it
+    _stamp[slot] = seq + 1;
+    HAL_BOARD_MemBarrier();
+
+    entry.libUID = libUID;
+    entry.taskID = taskID;
+    entry.timestamp = now;
+    entry.count = count;
+    entry.event = event;
+
+    HAL_BOARD_MemBarrier();
+    _stamp[slot] = seq;
+}
+
+/**
+ * Move completed entries from staging ring into blocks, in order
+ * Only one context encodes at a time. If it's already taken (by the code this
+ * interrupt preempted), staged entries are left for it to pick up once it
+ * resumes, so nobody ever waits.
+ */
+void EventLog::_Encode()
+{
+    uint32_t seq;
+
+    do
+    {
+        if (!HAL_BOARD_AtomicCAS(&_encoding, 0, 1))
+            return;
+
+        while ((seq = _stageRead) != _reserve)
+        {
+            uint32_t slot = seq & (EVLOG_STAGE - 1);
+            struct _eventEntry entry;
+
+            if (_stamp[slot] == seq)
+            {
+                HAL_BOARD_MemBarrier();
+                entry = _ring[slot];
+                HAL_BOARD_MemBarrier();
+                if (_stamp[slot] == seq)
+                    _EncodeEntry(entry);
+                else
+                    _overwritten++;
+            }
+            //  Still being written by an interrupted context, which encodes
+            //  it once it's done
+            else if ((int32_t)(seq - (_reserve - EVLOG_STAGE)) >= 0)
+                break;
+            //  More than EVLOG_STAGE events came in before it was encoded
+            else
+                _overwritten++;
+
+            _stageRead = seq + 1;
+        }
+
+        HAL_BOARD_MemBarrier();
+        _encoding = 0;
+
+        //  Check for entries completed after the loop above gave up but
+        //  before encoding was released
+        seq = _stageRead;
+    } while ((seq != _reserve) && (_stamp[seq & (EVLOG_STAGE - 1)] == seq));
+}
+
+/**
+ * Append entry to the head block, starting a new block (and overwriting the
+ * oldest one) if it doesn't fit
+ */
+void EventLog::_EncodeEntry(const struct _eventEntry &orig)
+{
+    uint8_t buf[EVC_MAX_HEADER + EVC_MAX_ENTRY], n = 0;
+    uint32_t slot = _head & (EVLOG_BLOCKS - 1);
+    uint8_t len = _blkLen[slot];
+    struct _eventEntry entry = orig;
+
+    //  Deltas are unsigned; reservation order is time order so this only
+    //  matters if time was set back
+    if (entry.timestamp < _headTime)
+        entry.timestamp = _headTime;
+
+    if (len > 0)
+        n = EVC_PutEntry(buf, entry, _headTime);
+    if ((len == 0) || ((len + n) > EVLOG_BLOCK_SIZE))
+    {
+        if (len > 0)
+        {
+            uint32_t seq = _head + 1;
+
+            //  Entries of the overwritten block are lost unless they've been
+            //  dropped already
+            slot = seq & (EVLOG_BLOCKS - 1);
+            if ((seq >= EVLOG_BLOCKS) &&
+                ((int32_t)(seq - EVLOG_BLOCKS - _start.block) >= 0))
+            {
+                _overwritten += _blkCnt[slot];
+                if ((seq - EVLOG_BLOCKS) == _start.block)
+                    _overwritten -= _start.index;
+
+                //  Keep what's important of them in older tiers
+                _Fold(seq - EVLOG_BLOCKS);
+            }
+
+            //  Invalidate the slot while it's reset, see _Commit()
+            _blkSeq[slot] = seq + 1;
+            HAL_BOARD_MemBarrier();
+            _blkFirst[slot] = _blkFirst[_head & (EVLOG_BLOCKS - 1)] +
+                              _blkCnt[_head & (EVLOG_BLOCKS - 1)];
+            _blkLen[slot] = 0;
+            _blkCnt[slot] = 0;
+            _blkMods[slot] = 0;
+            _blkEvents[slot] = 0;
+            HAL_BOARD_MemBarrier();
+            _blkSeq[slot] = seq;
+            _head = seq;
+            len = 0;
+        }
+
+        //  Every block starts with a sync point, its first entry has dt = 0
+        n = EVC_PutHeader(buf, entry.timestamp);
+        n += EVC_PutEntry(buf + n, entry, entry.timestamp);
+    }
+
+    memcpy(_blk[slot] + len, buf, n);
+    _blkMods[slot] |= EVLOG_MODULE(entry.libUID);
+    _blkEvents[slot] |= EVLOG_EVENT(entry.event);
+    HAL_BOARD_MemBarrier();
+    _blkCnt[slot]++;
+    _blkLen[slot] = len + n;
+    _headTime = entry.timestamp;
+}
+
+/**
+ * Fold entries of a block that's about to be overwritten into older tiers
+ * Entries dropped by DropBefore() or Reset() are skipped.
+ * @param block sequence number of the block, not older than _start.block
+ */
+void EventLog::_Fold(uint32_t block)
+{
+    uint32_t slot = block & (EVLOG_BLOCKS - 1);
+    const uint8_t *blk = _blk[slot], *end = blk + _blkLen[slot];
+    uint16_t skip = (block == _start.block) ? _start.index : 0, i = 0;
+    struct _eventEntry entry;
+    uint8_t used, n;
+    uint64_t time;
+
+    _foldVersion++;
+    HAL_BOARD_MemBarrier();
+
+    for (used = EVC_GetHeader(blk, end, time); (used > 0) && ((blk + used) < end);
+         used += n, i++)
+    {
+        if ((n = EVC_GetEntry(blk + used, end, time, entry)) == 0)
+            break;
+        time = entry.timestamp;
+        if (i >= skip)
+            _FoldEntry(entry);
+    }
+
+    HAL_BOARD_MemBarrier();
+    _foldVersion++;
+}
+
+/**
+ * Add entry to the summary of its module and time bucket, and keep it in full
+ * if it's one of EVLOG_KEEP_EVENTS
+ */
+void EventLog::_FoldEntry(const struct _eventEntry &entry)
+{
+    uint32_t bucket = (uint32_t)(entry.timestamp / EVLOG_SUM_BUCKET_MS);
+    uint32_t seq = _sumHead, start = SummaryBegin(), total;
+    struct _evSummary *sum = 0;
+
+    if (EVLOG_EVENT(entry.event) & EVLOG_KEEP_EVENTS)
+    {
+        _kept[_keptHead & (EVLOG_KEPT - 1)] = entry;
+        _keptHead++;
+    }
+
+    //  Entries are folded in time order, so summary of the module (if there
+    //  is one) is among the newest ones, all in the same bucket
+    while ((seq != start) && (sum == 0))
+    {
+        struct _evSummary &s = _sum[(--seq) & (EVLOG_SUMMARIES - 1)];
+
+        if (s.bucket != bucket)
+            break;
+        if (s.libUID == entry.libUID)
+            sum = &s;
+    }
+    if (sum == 0)
+    {
+        sum = &_sum[_sumHead & (EVLOG_SUMMARIES - 1)];
+        memset(sum, 0, sizeof(struct _evSummary));
+        sum->bucket = bucket;
+        sum->libUID = entry.libUID;
+        _sumHead++;
+    }
+
+    //  Summary entries count events they report as dropped
+    total = sum->counts[entry.event] +
+            ((entry.event == EVENT_SUPPRESSED) ? entry.count : 1);
+    sum->counts[entry.event] = (total > 0xFFFF) ? 0xFFFF : total;
+    if ((entry.event < EVENT_PRIOINV) && (entry.event > sum->highest))
+        sum->highest = entry.event;
+}
+
+/**
+ * Sequence number of the oldest block still in the log
+ */
+uint32_t EventLog::_Oldest()
+{
+    uint32_t head = _head;
+
+    return (head < EVLOG_BLOCKS) ? 0 : (head - EVLOG_BLOCKS + 1);
+}
+
+/**
+ * Read time of the first entry in a block from its sync point
+ * @return false if block is empty or no longer in the log
+ */
+bool EventLog::_BlockTime(uint32_t block, uint64_t &time)
+{
+    uint32_t slot = block & (EVLOG_BLOCKS - 1);
+    uint8_t buf[EVC_MAX_HEADER], len;
+
+    if (_blkSeq[slot] != block)
+        return false;
+    len = _blkLen[slot];
+    if (len > EVC_MAX_HEADER)
+        len = EVC_MAX_HEADER;
+
+    memcpy(buf, _blk[slot], len);
+    HAL_BOARD_MemBarrier();
+
+    return (_blkSeq[slot] == block) &&
+           (EVC_GetHeader(buf, buf + len, time) > 0);
+}
+
+/**
+ * Read sequence number of the first entry in a block
+ * @return false if block is no longer in the log
+ */
+bool EventLog::_BlockFirst(uint32_t block, uint32_t &first)
+{
+    uint32_t slot = block & (EVLOG_BLOCKS - 1);
+
+    if (_blkSeq[slot] != block)
+        return false;
+    first = _blkFirst[slot];
+    HAL_BOARD_MemBarrier();
+
+    return (_blkSeq[slot] == block);
+}
+
+/**
+ * Take an unused record of module state from the pool
+ * @param idx [out] index of the record in _modPool
+ * @return false if all records are in use
+ */
+bool EventLog::_ModAlloc(uint8_t &idx)
+{
+    uint32_t mask;
+
+    do
+    {
+        mask = _modFree;
+        if (mask == 0)
+            return false;
+        for (idx = 0; (mask & (1u << idx)) == 0; idx++);
+    } while (!HAL_BOARD_AtomicCAS(&_modFree, mask, mask & ~(1u << idx)));
+
+    return true;
+}
+
+/**
+ * Return record of module state to the pool
+ */
+void EventLog::_ModFree(uint8_t idx)
+{
+    uint32_t mask;
+
+    do
+    {
+        mask = _modFree;
+    } while (!HAL_BOARD_AtomicCAS(&_modFree, mask, mask | (1u << idx)));
 }
+
+/**
+ * Copy current state of a module
+ * Record is only reused after it stops being current, so the copy is
+ * consistent if the module still points to the same record after copying
+ */
+void EventLog::_ModRead(uint8_t libUID, struct _evModState &st)
+{
+    uint32_t cur;
+
+    do
+    {
+        cur = _modCur[libUID];
+        HAL_BOARD_MemBarrier();
+        st = _modPool[cur & 0xFF];
+        HAL_BOARD_MemBarrier();
+    } while (_modCur[libUID] != cur);
+}
+
+/**
+ * Make record [idx] the current state of a module, unless the module has been
+ * updated since [cur] was read. Replaced record goes back to the pool.
+ * @return true if record was published
+ */
+bool EventLog::_ModPublish(uint8_t libUID, uint32_t cur, uint8_t idx)
+{
+    //  Counter in the upper bits tells apart a record that has been replaced
+    //  and later reused as current again
+    HAL_BOARD_MemBarrier();
+    if (!HAL_BOARD_AtomicCAS(&_modCur[libUID], cur,
+                             ((cur & 0xFFFFFF00) + 0x100) | idx))
+        return false;
+
+    _ModFree(cur & 0xFF);
+    return true;
+}
+
+/**
+ * Count an event in the counter of its module and type
+ * Only one context updates a counter at a time. An interrupt finding it taken
+ * (by the code it preempted) adds the event to pending ones, which the
+ * preempted context counts before it's done, so nobody ever waits.
+ */
+void EventLog::_StatAdd(uint8_t libUID, uint8_t event, uint64_t now)
+{
+    struct _evCounter &c = _stat[libUID][event];
+    uint32_t version, pending, n = 1;
+
+    do
+    {
+        version = c.version;
+        if ((version & 1) ||
+            !HAL_BOARD_AtomicCAS(&c.version, version, version + 1))
+        {
+            do
+            {
+                pending = c.pending;
+            } while (!HAL_BOARD_AtomicCAS(&c.pending, pending, pending + n));
+            return;
+        }
+        HAL_BOARD_MemBarrier();
+
+        //  Take events left by interrupts
+        do
+        {
+            pending = c.pending;
+        } while (!HAL_BOARD_AtomicCAS(&c.pending, pending, 0));
+        n += pending;
+
+        if (n > 0)
+        {
+            if (c.count == 0)
+                c.first = now;
+            c.count += n;
+            c.last = now;
+
+            //  Move to the window [now] falls into, previous one is kept only
+            //  if it's the one right before it
+            for (uint8_t w = 0; w < EVLOG_STAT_WINDOWS; w++)
+            {
+                uint32_t idx = (uint32_t)(now / _evStatWinMs[w]);
+
+                if (idx != c.window[w])
+                {
+                    c.winPrev[w] = (idx == (c.window[w] + 1)) ? c.winCur[w] : 0;
+                    c.winCur[w] = 0;
+                    c.window[w] = idx;
+                }
+                c.winCur[w] += n;
+            }
+        }
+
+        HAL_BOARD_MemBarrier();
+        c.version = version + 2;
+        n = 0;
+
+        //  Check for events left by interrupts after they were taken above
+    } while (c.pending != 0);
+}
+
+/**
+ * Reset counter of events of a module and type
+ * @note Called from main loop only, so counter can't be taken by a context
+ * this one preempted
+ */
+void EventLog::_StatClear(uint8_t libUID, uint8_t event)
+{
+    struct _evCounter &c = _stat[libUID][event];
+    uint32_t version, pending;
+
+    do
+    {
+        version = c.version & ~1u;
+    } while (!HAL_BOARD_AtomicCAS(&c.version, version, version + 1));
+    HAL_BOARD_MemBarrier();
+
+    do
+    {
+        pending = c.pending;
+    } while (!HAL_BOARD_AtomicCAS(&c.pending, pending, 0));
+    c.count = 0;
+    c.first = 0;
+    c.last = 0;
+    for (uint8_t w = 0; w < EVLOG_STAT_WINDOWS; w++)
+    {
+        c.window[w] = 0;
+        c.winCur[w] = 0;
+        c.winPrev[w] = 0;
+    }
+
+    HAL_BOARD_MemBarrier();
+    c.version = version + 2;
+}
+
+/**
+ * Take an event from the token bucket of an event type of a module
+ * Bucket is kept as the time at which it's full again; every event moves it
+ * [period] ms further, and an event fits as long as that time isn't more
+ * than [burst - 1] periods ahead.
+ * @param st state of the module, bucket in it is updated
+ * @return false if event is over the rate limit
+ */
+bool EventLog::_RateTake(uint8_t libUID, uint8_t event,
+                         struct _evModState &st, uint64_t now)
+{
+    uint64_t period = _rlPeriod[libUID][event], full = st.bucket[event];
+
+    if (period == 0)
+        return true;
+    if (full < now)
+        full = now;
+    if ((full - now) > (period * (_rlBurst[libUID][event] - 1)))
+        return false;
+
+    st.bucket[event] = full + period;
+    return true;
+}
+
+#if defined(__USE_TASK_SCHEDULER__)
+/**
+ * Count event against reactive rules matching it and mark those that fire,
+ * for ScheduleRules() to schedule their services
+ * Each matching event takes the next place in history of the rule. Rule
+ * fires when the event [count - 1] places back is recent enough; only the
+ * context that moves _ruleArm[] past the counted events marks it, so events
+ * emitted at once by several contexts can fire the rule only once.
+ */
+void EventLog::_RuleHit(uint8_t libUID, uint8_t event, uint64_t now)
+{
+    uint8_t mask = _ruleMap[libUID][event];
+
+    for (uint8_t r = 0; mask != 0; r++, mask >>= 1)
+    {
+        struct _evRule rule;
+        uint32_t version, hit, arm, pending;
+        int32_t age;
+
+        if ((mask & 0x01) == 0)
+            continue;
+
+        //  Take a copy of the rule, skip it if it's being changed
+        if ((version = _ruleVer[r]) & 1)
+            continue;
+        HAL_BOARD_MemBarrier();
+        rule = _rules[r];
+        HAL_BOARD_MemBarrier();
+        if ((_ruleVer[r] != version) || (rule.libUID != libUID) ||
+            (rule.event != event) || (rule.count == 0))
+            continue;
+
+        do
+        {
+            hit = _ruleHead[r];
+        } while (!HAL_BOARD_AtomicCAS(&_ruleHead[r], hit, hit + 1));
+        _ruleHits[r][hit & (EVLOG_RULE_HITS - 1)] = (uint32_t)now;
+        HAL_BOARD_MemBarrier();
+
+        //  Event preempted while taking its place can leave a newer time
+        //  behind, such window reads as negative and doesn't fire the rule
+        age = (int32_t)((uint32_t)now -
+                        _ruleHits[r][(hit + 1 - rule.count) &
+                                     (EVLOG_RULE_HITS - 1)]);
+        if ((rule.windowMs > 0) &&
+            ((age < 0) || ((uint32_t)age > rule.windowMs)))
+            continue;
+
+        //  Events counted by a context that fired the rule in the meantime
+        //  can't fire it again
+        do
+        {
+            arm = _ruleArm[r];
+            if ((int32_t)(hit + 1 - arm) < rule.count)
+                break;
+        } while (!HAL_BOARD_AtomicCAS(&_ruleArm[r], arm, hit + 1));
+        if ((int32_t)(hit + 1 - arm) < rule.count)
+            continue;
+
+        do
+        {
+            pending = _rulePending;
+        } while (!HAL_BOARD_AtomicCAS(&_rulePending, pending,
+                                      pending | (1u << r)));
+    }
+}
+#endif  /* __USE_TASK_SCHEDULER__ */
+
 ///-----------------------------------------------------------------------------
 ///                      Class constructor & destructor              [PROTECTED]
 ///-----------------------------------------------------------------------------
 
-EventLog::EventLog() : _entryVectorHead(0), _entryvCount(0), _enSig(true)
+EventLog::EventLog() : _reserve(0), _stageRead(0), _encoding(0), _head(0),
+                       _headTime(0), _overwritten(0), _keptHead(0),
+                       _keptStart(0), _sumHead(0), _sumStart(0),
+                       _foldVersion(0), _enSig(true), _modFree(0)
 {
-    for (int i = 0; i < NUM_OF_MODULES; i++)
+    //  No slot holds a complete entry yet, only block 0 is in the log
+    for (uint32_t i = 0; i < EVLOG_STAGE; i++)
+        _stamp[i] = i + 1;
+    for (uint32_t i = 0; i < EVLOG_BLOCKS; i++)
+    {
+        _blkSeq[i] = (i == 0) ? 0 : (i + 1);
+        _blkLen[i] = 0;
+        _blkCnt[i] = 0;
+        _blkMods[i] = 0;
+        _blkEvents[i] = 0;
+        _blkFirst[i] = 0;
+    }
+#if defined(__HAL_USE_EVLOGSTORE__)
+    _persistBoot = false;
+#endif
+    for (uint8_t i = 0; i < NUM_OF_MODULES; i++)
+        for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+        {
+            _rlPeriod[i][j] = EVLOG_RL_PERIOD_MS;
+            _rlBurst[i][j] = EVLOG_RL_BURST;
+        }
+    memset((void*)_stat, 0, sizeof(_stat));
+#if defined(__USE_TASK_SCHEDULER__)
+    memset(_rules, 0, sizeof(_rules));
+    memset((void*)_ruleVer, 0, sizeof(_ruleVer));
+    memset((void*)_ruleHead, 0, sizeof(_ruleHead));
+    memset((void*)_ruleArm, 0, sizeof(_ruleArm));
+    memset((void*)_ruleHits, 0, sizeof(_ruleHits));
+    memset((void*)_ruleMap, 0, sizeof(_ruleMap));
+    _rulePending = 0;
+#endif
+
+    for (int i = 0; i < EVLOG_MOD_POOL; i++)
     {
-        _lastEvent[i].libUID = -1;
-        _highestPrioEv[i].libUID = -1;
-        _prioInvOcc[i] = false;
+        _modPool[i].last.event = EVENT_UNINITIALIZED;
+        _modPool[i].last.timestamp = 0;
+        _modPool[i].last.libUID = -1;
+        _modPool[i].last.taskID = -1;
+        _modPool[i].highest = _modPool[i].last;
+        _modPool[i].prioInv = false;
+        for (uint8_t j = 0; j < EVLOG_RL_EVENTS; j++)
+        {
+            _modPool[i].bucket[j] = 0;
+            _modPool[i].suppressed[j] = 0;
+        }
+
+        //  First NUM_OF_MODULES records are initial states of modules
+        if (i < NUM_OF_MODULES)
+            _modCur[i] = i;
+        else
+            _modFree |= (1u << i);
     }
 }
 
 EventLog::~EventLog()
 {
-    Reset();
 }
 
 #endif  /* __HAL_USE_EVENTLOG__ */
@@ -9,14 +9,16 @@
  *  that tasks get scheduled in advanced and the issuer of the task doesn't
  *  wait until the task is completed, there is generally no way of telling how
  *  did the task perform. Event logger then provides a way of reporting the
- *  execution outcome by collecting system-wide events into a single linked list,
- *  noting which module emitted the event, at what time and during execution of
- *  which task. Event log is deleted after reaching certain size but most
+ *  execution outcome by collecting system-wide events into a fixed-capacity
+ *  ring of compactly encoded blocks, noting which module emitted the event, at
+ *  what time and during execution of which task. The ring is allocated
+ *  statically and its oldest block is overwritten once it's full, but most
  *  important information(highest-priority event since startup, last emitted
  *  event and appearance of priority inversion) about events from each module
- *  get remembered even after dropping the log.
+ *  gets remembered even after entries are gone, and overwritten entries are
+ *  summarised into older tiers of the log.
  *
- *  @version 1.2.1
+ *  @version 1.12.1
  *  V1.0.0 - 2.7.2017
  *  +Support 6 events that can be emitted by different libraries
  *  +Integrated with task scheduler for remote emptying of log
@@ -40,6 +42,80 @@
  *  V1.2.1 - 2.9.2017
  *  +Added interface for soft-reboot of kernel module
  *  +Moved soft reboot of all other modules to event logger kernel callback
+ *  V1.3.0 - 18.10.2026
+ *  +Log is kept in a statically allocated ring of EVLOG_CAPACITY entries
+ *  instead of a heap-allocated linked list. Emitting is O(1) and doesn't use
+ *  heap; when the ring is full the oldest entry is overwritten instead of
+ *  dropping the whole log
+ *  +Log is read through an iterator (Begin()/Next()) which copies entries out
+ *  and stays valid while new events are logged; replaces GetHead()
+ *  V1.4.0 - 18.10.2026
+ *  +EmitEvent() is safe to call from several contexts at once (main loop,
+ *  kernel callbacks, interrupts) without masking interrupts. Ring slots are
+ *  reserved with atomic compare-and-swap and published through a per-slot
+ *  commit stamp; readers skip slots still being written.
+ *  +Per-module state (last event, highest-priority event, priority inversion)
+ *  is kept as a single record replaced atomically, so the three always agree
+ *  with each other
+ *  V1.5.0 - 18.10.2026
+ *  +Entries are kept in compact form (see evlogCodec.h): blocks starting with
+ *  an absolute time sync point, followed by entries of 3-4 bytes holding
+ *  packed module/task/event and a time delta. Same RAM holds several times
+ *  more events; the oldest block is overwritten once the log is full.
+ *  +Ring of fixed-size slots from V1.4.0 is kept as a small staging area that
+ *  takes new events lock-free; whichever context gets to it first moves
+ *  staged events into blocks (single encoder at a time, never waits)
+ *  V1.6.0 - 18.10.2026
+ *  +Queries: Seek() finds the first entry at or after given time by binary
+ *  search over block sync points, Next() with a _evFilter returns only
+ *  entries of selected modules/events within a time range. Each block keeps
+ *  bitmaps of modules and events it holds, so blocks without a match are
+ *  skipped without decoding them.
+ *  +DropBefore() seeks to the first kept entry instead of walking the log
+ *  V1.7.0 - 18.10.2026
+ *  +Persist() appends encoded blocks to persistent store (evlogStore.h) as
+ *  records of type EVLOG_REC_BLOCK, so the log survives a reboot. Each
+ *  record decodes on its own with EVC_DecodeBlock(). First record written
+ *  after startup is EVLOG_REC_BOOT, which separates logs of two runs.
+ *  V1.8.0 - 18.10.2026
+ *  +Every entry gets a running sequence number (counting from startup, kept
+ *  across Reset()), reported by the iterator. SeekSeq() finds an entry by its
+ *  sequence number and EndSeq() returns the number of the next entry, so a
+ *  reader can fetch the log incrementally and tell which entries it missed
+ *  (see SP_T_GETEVENTS in serialProto.h).
+ *  V1.9.0 - 18.10.2026
+ *  +Each event type of a module is rate limited by a token bucket (rate and
+ *  burst set with SetRateLimit()), so a module flooding the log with
+ *  alternating events can't push everything else out of it
+ *  +Events dropped by rate limiting or as repeated events are counted, and
+ *  logged as a single EVENT_SUPPRESSED entry in front of the next event of
+ *  the same type let through, or by FlushSuppressed()
+ *  +Repeats of the last event of a module are reported by FlushSuppressed()
+ *  no sooner than REP_TIME_DIFF_MS after it, so a module repeating one event
+ *  doesn't add an EVENT_SUPPRESSED entry every rate limit period
+ *  V1.10.0 - 18.10.2026
+ *  +Counters of events of each type of each module: number of events, time
+ *  of the first and the last one and rolling rates over EVLOG_STAT_WIN_MS
+ *  windows. Updated in O(1) for every emitted event, also when recording is
+ *  disabled or the event is dropped, so health of modules can be tracked
+ *  without keeping the events themselves (see GetStat())
+ *  V1.11.0 - 18.10.2026
+ *  +Tiered retention: before the oldest block is overwritten its entries are
+ *  folded into summaries, one per module and EVLOG_SUM_BUCKET_MS long time
+ *  bucket (number of entries of each type, highest priority event). Entries
+ *  of events in EVLOG_KEEP_EVENTS (errors, hangs, priority inversions) are
+ *  also kept in full in a separate ring, so they outlive OK events. Read with
+ *  KeptBegin()/KeptNext() and SummaryBegin()/SummaryNext()
+ *  V1.12.0 - 18.10.2026
+ *  +Reactive rules (SetRule(), EVLOG_RULE service): once a module emits an
+ *  event a given number of times within a time window, a service of another
+ *  module is scheduled, without a round-trip to the PC. Rules matching an
+ *  event are looked up in a bitmask table, so emitting costs the same
+ *  regardless of the number of rules. EmitEvent() only marks rules that fire,
+ *  their services are scheduled by ScheduleRules() called from main loop, as
+ *  adding a task allocates and unmasks interrupts
+ *  V1.12.1 - 18.10.2026
+ *  +DropBefore() takes 64-bit time, EVLOG_DROP service also accepts it
  */
 #include "hwconfig.h"
 #if !defined(ROVERKERNEL_INIT_EVENTLOG_H_) \
@@ -62,14 +138,83 @@
     #define EVLOG_DROP           0
     #define EVLOG_REBOOT         1
     #define EVLOG_SOFT_REBOOT    2
+    #define EVLOG_RATELIMIT      3
+    #define EVLOG_RULE           4
 #endif
 
 //  Defines minimum time difference between two same events of a single module
 //  to be logged - prevents unnecessary logging of same events happening fast
 #define REP_TIME_DIFF_MS    300000      //  5 minutes
-//  After reaching max number of entries log is dropped to save memory
-//  max 200*(64+8+8+8)=17600bytes on the heap
-#define MAX_LOG_ENTRIES     100
+//  Default rate limit of each event type of a module: bucket holds up to
+//  EVLOG_RL_BURST events and refills with one every EVLOG_RL_PERIOD_MS. Can be
+//  changed with EventLog::SetRateLimit()
+#define EVLOG_RL_PERIOD_MS  1000
+#define EVLOG_RL_BURST      8
+//  Event types that are rate limited and counted, i.e. all but those set by
+//  event log
+#define EVLOG_RL_EVENTS     EVENT_PRIOINV
+//  Event counters keep rolling rates over windows of these lengths (in ms)
+#define EVLOG_STAT_WINDOWS  2
+#define EVLOG_STAT_WIN_MS   { 60000, 3600000 }      //  1 minute, 1 hour
+//  Log is kept in EVLOG_BLOCKS blocks of EVLOG_BLOCK_SIZE bytes, oldest block
+//  is overwritten once the log is full. Entry takes 3-4 bytes, block also
+//  starts with a sync point of up to 10 bytes. Must be a power of 2
+#define EVLOG_BLOCKS        32
+#define EVLOG_BLOCK_SIZE    64
+//  Slots of staging ring which takes events before they're encoded into
+//  blocks; 20 bytes each. Must be a power of 2
+#define EVLOG_STAGE         16
+
+//  Highest number of contexts that can be emitting events at the same time
+//  (main loop plus nested interrupts that emit events)
+#define EVLOG_WRITERS       4
+
+#if ((EVLOG_BLOCKS & (EVLOG_BLOCKS - 1)) != 0) || \
+    ((EVLOG_STAGE & (EVLOG_STAGE - 1)) != 0)
+#error "EVLOG_BLOCKS and EVLOG_STAGE must be powers of 2"
+#endif
+#if EVLOG_BLOCK_SIZE > 255
+#error "EVLOG_BLOCK_SIZE must not exceed 255 bytes"
+#endif
+//  Each module owns one record of its state, every writer can hold a spare one
+#define EVLOG_MOD_POOL      (NUM_OF_MODULES + EVLOG_WRITERS)
+#if EVLOG_MOD_POOL > 32
+#error "NUM_OF_MODULES + EVLOG_WRITERS must not exceed 32"
+#endif
+
+//  Older tiers of the log, filled from blocks about to be overwritten: ring
+//  of EVLOG_KEPT entries of events in EVLOG_KEEP_EVENTS, and ring of
+//  EVLOG_SUMMARIES summaries of EVLOG_SUM_BUCKET_MS long time buckets. Ring
+//  sizes must be powers of 2
+#define EVLOG_KEPT          32
+#define EVLOG_SUMMARIES     64
+#define EVLOG_SUM_BUCKET_MS 600000      //  10 minutes
+#define EVLOG_KEEP_EVENTS   (EVLOG_EVENT(EVENT_HANG) | \
+                             EVLOG_EVENT(EVENT_ERROR) | \
+                             EVLOG_EVENT(EVENT_PRIOINV))
+#if ((EVLOG_KEPT & (EVLOG_KEPT - 1)) != 0) || \
+    ((EVLOG_SUMMARIES & (EVLOG_SUMMARIES - 1)) != 0)
+#error "EVLOG_KEPT and EVLOG_SUMMARIES must be powers of 2"
+#endif
+
+//  Reactive rules (see EventLog::SetRule()): number of rules (at most 8),
+//  highest number of events a rule can count (power of 2) and bytes of
+//  arguments passed to the scheduled service (short enough to be kept inside
+//  the task, see TE_ARGS_INLINE)
+#if defined(__USE_TASK_SCHEDULER__)
+#define EVLOG_RULES         8
+#define EVLOG_RULE_HITS     8
+#define EVLOG_RULE_ARGS     3
+#if (EVLOG_RULES > 8) || ((EVLOG_RULE_HITS & (EVLOG_RULE_HITS - 1)) != 0)
+#error "EVLOG_RULES must not exceed 8, EVLOG_RULE_HITS must be a power of 2"
+#endif
+#endif  /* __USE_TASK_SCHEDULER__ */
+
+//  Types of records written to persistent store
+#if defined(__HAL_USE_EVLOGSTORE__)
+#define EVLOG_REC_BLOCK     0x01    //  Encoded entries, see evlogCodec.h
+#define EVLOG_REC_BOOT      0x02    //  Startup of the system, no data
+#endif
 
 /**
  * Events that modules can transmit
@@ -77,6 +222,9 @@
  * a module has emitted a higher priority event (such as EVENT_ERROR) followed by
  * a lower priority event (such as EVENT_OK) without going through process of
  * reinitialization.
+ * Suppressed event is also set only by EventLogger, it reports how many
+ * events of a module were dropped by rate limiting or as repeated events.
+ * Its taskID holds the type of dropped events and count their number.
  */
 enum Events {EVENT_UNINITIALIZED,   //Module is not yet initialized
              EVENT_STARTUP,         //Module is in startup sequence
@@ -84,22 +232,141 @@ enum Events {EVENT_UNINITIALIZED,   //Module is not yet initialized
              EVENT_OK,              //Module performed request
              EVENT_HANG,            //Module is hanging in communication with HW
              EVENT_ERROR,           //Module experienced error
-             EVENT_PRIOINV };       //Priority inversion event
+             EVENT_PRIOINV,         //Priority inversion event
+             EVENT_SUPPRESSED };    //Summary of dropped events
 
 /**
  * Single event entry in event log
- * Event log implemented as a linked list, 'next' points to next element in list
  */
 struct _eventEntry
 {
         uint64_t timestamp; //  Time in ms since startup when event was emitted
         int8_t libUID;      //  Module that emitted event
         int8_t taskID;      //  Task within module that emitted event
+        uint16_t count;     //  Number of dropped events (EVENT_SUPPRESSED)
         Events  event;      //  Emitted event
+};
 
-        volatile struct _eventEntry *next;
+/**
+ * State of a single module as tracked by event log
+ */
+struct _evModState
+{
+    struct _eventEntry  last;       //  Last recorded event
+    struct _eventEntry  highest;    //  Highest priority event since startup
+    bool                prioInv;    //  Priority inversion has occurred
+    //  Token bucket of each event type, holding time at which it's full again
+    uint64_t            bucket[EVLOG_RL_EVENTS];
+    //  Events of each type dropped since they were last reported
+    uint16_t            suppressed[EVLOG_RL_EVENTS];
 };
 
+/**
+ * Counter of events of one type emitted by a module
+ */
+struct _evStat
+{
+    uint32_t    count;                      //  Number of events since startup
+    uint64_t    first;                      //  Time of the first event
+    uint64_t    last;                       //  Time of the last event
+    //  Events within the last window of each EVLOG_STAT_WIN_MS length
+    uint32_t    rate[EVLOG_STAT_WINDOWS];
+};
+
+/**
+ * Summary of entries of a module within a time bucket, see
+ * EventLog::SummaryNext()
+ */
+struct _evSummary
+{
+    uint32_t    bucket;             //  Covers bucket * EVLOG_SUM_BUCKET_MS ms
+                                    //  up to the next bucket
+    int8_t      libUID;             //  Module that emitted events
+    uint8_t     highest;            //  Highest priority event (see Events)
+    //  Number of entries of each type; for EVENT_SUPPRESSED number of events
+    //  reported as dropped
+    uint16_t    counts[EVENT_SUPPRESSED + 1];
+};
+
+#if defined(__USE_TASK_SCHEDULER__)
+/**
+ * Reactive rule, see EventLog::SetRule()
+ * Once module [libUID] emits [event] [count] times within [windowMs] ms,
+ * service [serviceID] of module [svcUID] is scheduled to run as soon as
+ * possible with [argN] bytes of [args] as arguments.
+ */
+struct _evRule
+{
+    uint32_t    windowMs;           //  0 = no time limit
+    uint8_t     libUID;
+    uint8_t     event;              //  Any of Events but EVENT_SUPPRESSED
+    uint8_t     count;              //  1 up to EVLOG_RULE_HITS
+    uint8_t     svcUID;
+    uint8_t     serviceID;
+    uint8_t     argN;
+    uint8_t     args[EVLOG_RULE_ARGS];
+};
+#endif  /* __USE_TASK_SCHEDULER__ */
+
+/**
+ * Counter of events as kept by event log
+ * Version is odd while the counter is being updated; events emitted by
+ * interrupts in the meantime are added to pending and counted by the
+ * interrupted context once it's done. Rates are kept as number of events in
+ * the current window of each length and in the one before it.
+ */
+struct _evCounter
+{
+    volatile uint32_t   version;
+    volatile uint32_t   pending;
+    uint32_t            count;
+    uint64_t            first;
+    uint64_t            last;
+    uint32_t            window[EVLOG_STAT_WINDOWS]; //  Index (time / length)
+    uint32_t            winCur[EVLOG_STAT_WINDOWS];
+    uint32_t            winPrev[EVLOG_STAT_WINDOWS];
+};
+
+/**
+ * Position in event log, used to walk through entries with EventLog::Begin()
+ * and EventLog::Next()
+ * Blocks are addressed by a running sequence number, so iterator stays valid
+ * while new events are logged. If the block it points to gets overwritten,
+ * iteration continues from the oldest entry still in the log.
+ */
+struct _evIter
+{
+    _evIter(): block(0), offset(0), index(0), time(0), seq(0) {};
+
+    uint32_t block;                 //  Sequence number of the block
+    uint16_t offset;                //  Offset of the next entry, 0 = header
+    uint16_t index;                 //  Number of entries before it in block
+    uint64_t time;                  //  Time of the previous entry
+    uint32_t seq;                   //  Sequence number of the next entry,
+                                    //  valid after Next() returned an entry
+};
+
+/**
+ * Selection of entries returned by EventLog::Next()
+ * Entry matches if its time is within [from, to] and bits of both its module
+ * (EVLOG_MODULE()) and its event (EVLOG_EVENT()) are set. Default filter
+ * matches every entry.
+ */
+struct _evFilter
+{
+    _evFilter(): from(0), to(~0ull), modules(0xFFFFFFFFul), events(0xFF) {};
+
+    uint64_t from;                  //  Earliest time, see EventLog::Seek()
+    uint64_t to;                    //  Latest time, iteration stops after it
+    uint32_t modules;               //  Bitmap of EVLOG_MODULE(libUID)
+    uint8_t  events;                //  Bitmap of EVLOG_EVENT(event)
+};
+
+//  Bit of a module and of an event in _evFilter and in block bitmaps; modules
+//  with libUID >= 31 share the top bit
+#define EVLOG_MODULE(X)     (1ul << (((uint8_t)(X) < 31) ? (uint8_t)(X) : 31))
+#define EVLOG_EVENT(X)      ((uint8_t)(1u << (X)))
+
 /**
  * EventLog class definition
  * Object provides system-wide monitoring of events occurring in different
@@ -108,6 +375,10 @@ struct _eventEntry
 class EventLog
 {
     friend void _EVLOG_KernelCallback(void);
+#if defined(__BOARD_HOST__)
+    //  Host checks (host/evlCheck.cpp) inspect internal state
+    friend struct _evlCheck;
+#endif
 
     public:
         //  Functions for returning static instance
@@ -119,12 +390,41 @@ class EventLog
         //  Functions for manipulating event log
         void            RecordEvents(bool enable);
         static void     EmitEvent(uint8_t libUID, int8_t taskID, Events event);
-        uint32_t        DropBefore(uint32_t timestamp);
+        uint32_t        DropBefore(uint64_t timestamp);
         uint32_t        Reset();
         static void     SoftReboot(uint8_t libUID);
+        uint32_t        SetRateLimit(uint8_t libUID, Events event,
+                                     uint16_t periodMs, uint8_t burst);
+        uint32_t        FlushSuppressed();
+#if defined(__USE_TASK_SCHEDULER__)
+        uint32_t        SetRule(uint8_t index, const struct _evRule &rule);
+        uint32_t        ClearRule(uint8_t index);
+        uint32_t        ScheduleRules();
+#endif
+#if defined(__HAL_USE_EVLOGSTORE__)
+        uint32_t        Persist(bool all);
+#endif
         //  Functions for accessing event log
         uint16_t                        EventCount();
-        volatile struct _eventEntry*    GetHead();
+        uint32_t                        Overwritten();
+        struct _evIter                  Begin();
+        bool                            Next(struct _evIter &it,
+                                             struct _eventEntry &entry);
+        struct _evIter                  Seek(uint64_t time);
+        bool                            Next(struct _evIter &it,
+                                             struct _eventEntry &entry,
+                                             const struct _evFilter &filter);
+        struct _evIter                  SeekSeq(uint32_t seq);
+        uint32_t                        EndSeq();
+        uint32_t                        KeptBegin();
+        bool                            KeptNext(uint32_t &it,
+                                                 struct _eventEntry &entry);
+        uint32_t                        SummaryBegin();
+        bool                            SummaryNext(uint32_t &it,
+                                                    struct _evSummary &sum);
+        bool                            GetStat(uint8_t libUID,
+                                                Events event,
+                                                struct _evStat &stat);
         struct _eventEntry              GetLastEvAt(uint8_t index);
         struct _eventEntry              GetHigPrioEvAt(uint8_t index);
         bool                            GetPrioInvAt(uint8_t index);
@@ -135,18 +435,108 @@ class EventLog
         EventLog(EventLog &arg) {}              //  No definition - forbid this
         void operator=(EventLog const &arg) {}  //  No definition - forbid this
 
-        //  Head of linked list with events
-        volatile struct _eventEntry *_entryVectorHead;
-        //  Number of events in linked list
-        uint16_t                     _entryvCount;
+        uint32_t        _Reserve(uint8_t n, uint64_t &now);
+        void            _Commit(uint32_t seq, uint8_t libUID, int8_t taskID,
+                                Events event, uint64_t now, uint16_t count);
+        void            _Encode();
+        void            _EncodeEntry(const struct _eventEntry &entry);
+        uint32_t        _Oldest();
+        bool            _BlockTime(uint32_t block, uint64_t &time);
+        bool            _BlockFirst(uint32_t block, uint32_t &first);
+        void            _Fold(uint32_t block);
+        void            _FoldEntry(const struct _eventEntry &entry);
+        bool            _ModAlloc(uint8_t &idx);
+        void            _ModFree(uint8_t idx);
+        void            _ModRead(uint8_t libUID, struct _evModState &st);
+        bool            _ModPublish(uint8_t libUID, uint32_t cur, uint8_t idx);
+        bool            _RateTake(uint8_t libUID, uint8_t event,
+                                  struct _evModState &st, uint64_t now);
+        void            _StatAdd(uint8_t libUID, uint8_t event, uint64_t now);
+        void            _StatClear(uint8_t libUID, uint8_t event);
+#if defined(__USE_TASK_SCHEDULER__)
+        void            _RuleHit(uint8_t libUID, uint8_t event, uint64_t now);
+#endif
+
+        //  Staging ring, entry with sequence number N is stored at
+        //  _ring[N & (EVLOG_STAGE-1)]. _stamp[] of a slot equals N once
+        //  entry N has been completely written into it
+        struct _eventEntry           _ring[EVLOG_STAGE];
+        volatile uint32_t            _stamp[EVLOG_STAGE];
+        //  Sequence number of the next entry to be reserved
+        volatile uint32_t            _reserve;
+        //  Sequence number of the next entry to be encoded into blocks
+        uint32_t                     _stageRead;
+        //  Non-zero while a context is encoding staged entries
+        volatile uint32_t            _encoding;
+
+        //  Blocks of encoded entries, block with sequence number N is stored
+        //  in _blk[N & (EVLOG_BLOCKS-1)]. _blkSeq[] of a slot equals N while
+        //  it holds block N, _blkLen[] is the number of valid bytes in it
+        uint8_t                      _blk[EVLOG_BLOCKS][EVLOG_BLOCK_SIZE];
+        volatile uint32_t            _blkSeq[EVLOG_BLOCKS];
+        volatile uint8_t             _blkLen[EVLOG_BLOCKS];
+        volatile uint8_t             _blkCnt[EVLOG_BLOCKS];
+        //  Bitmaps of modules and events with entries in the block
+        volatile uint32_t            _blkMods[EVLOG_BLOCKS];
+        volatile uint8_t             _blkEvents[EVLOG_BLOCKS];
+        //  Sequence number of the first entry in the block
+        volatile uint32_t            _blkFirst[EVLOG_BLOCKS];
+        //  Sequence number of the block being filled, and time of the last
+        //  entry encoded into it
+        volatile uint32_t            _head;
+        uint64_t                     _headTime;
+        //  Position of the oldest entry not dropped by DropBefore() or Reset()
+        struct _evIter               _start;
+        //  Number of entries overwritten because the log was full
+        volatile uint32_t            _overwritten;
+        //  Older tiers, entry/summary with sequence number N is stored at
+        //  index N & (size-1). Head is the sequence number of the next one
+        //  to be written, start of the first one not dropped by DropBefore()
+        //  or Reset(). _foldVersion is odd while entries are being folded
+        //  into them, readers retry if it changed while they were copying
+        struct _eventEntry           _kept[EVLOG_KEPT];
+        volatile uint32_t            _keptHead;
+        uint32_t                     _keptStart;
+        struct _evSummary            _sum[EVLOG_SUMMARIES];
+        volatile uint32_t            _sumHead;
+        uint32_t                     _sumStart;
+        volatile uint32_t            _foldVersion;
         //  Enable signal for event logger; events are logged only when _enSig=true
         bool                         _enSig;
-        //  Last recorded event for each module
-        struct _eventEntry  _lastEvent[NUM_OF_MODULES];
-        //  Highest priority event for each module since last EVENT_STARTUP
-        struct _eventEntry  _highestPrioEv[NUM_OF_MODULES];
-        //  Goes true whenever a priority inversion has occurred in a module
-        bool                _prioInvOcc[NUM_OF_MODULES];
+        //  Records of module states; _modCur[] holds index of the current
+        //  record of each module in its low 8 bits and a counter of updates
+        //  above them, _modFree is a bitmask of unused records
+        struct _evModState           _modPool[EVLOG_MOD_POOL];
+        volatile uint32_t            _modCur[NUM_OF_MODULES];
+        volatile uint32_t            _modFree;
+        //  Rate limit of each event type of each module: one event every
+        //  _rlPeriod[] ms (0 = no limit), up to _rlBurst[] at once
+        uint16_t                     _rlPeriod[NUM_OF_MODULES][EVLOG_RL_EVENTS];
+        uint8_t                      _rlBurst[NUM_OF_MODULES][EVLOG_RL_EVENTS];
+        //  Counters of events of each type of each module
+        struct _evCounter            _stat[NUM_OF_MODULES][EVLOG_RL_EVENTS];
+#if defined(__USE_TASK_SCHEDULER__)
+        //  Reactive rules; _ruleMap[][] is a bitmask of rules matching each
+        //  event type of each module, _ruleVer[] is odd while a rule is being
+        //  changed. Times of matching events are kept in _ruleHits[][], event
+        //  N at index N & (EVLOG_RULE_HITS-1) where N is counted by
+        //  _ruleHead[]. Rule counts events from _ruleArm[] on, firing moves
+        //  it past the events that fired the rule
+        struct _evRule               _rules[EVLOG_RULES];
+        volatile uint32_t            _ruleVer[EVLOG_RULES];
+        volatile uint32_t            _ruleHead[EVLOG_RULES];
+        volatile uint32_t            _ruleArm[EVLOG_RULES];
+        volatile uint32_t            _ruleHits[EVLOG_RULES][EVLOG_RULE_HITS];
+        volatile uint8_t             _ruleMap[NUM_OF_MODULES][EVENT_SUPPRESSED];
+        //  Bitmask of rules that fired and wait for ScheduleRules()
+        volatile uint32_t            _rulePending;
+#endif
+#if defined(__HAL_USE_EVLOGSTORE__)
+        //  Position of the first entry not yet written to persistent store,
+        //  and whether startup record was written already
+        struct _evIter               _persist;
+        bool                         _persistBoot;
+#endif
 
     //  Interface with task scheduler - provides memory space and function
     //  to call in order for task scheduler to request service from this module
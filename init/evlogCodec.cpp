@@ -0,0 +1,134 @@
+/**
+ *  evlogCodec.cpp
+ *
+ *  Created on: 18.10.2026.
+ */
+#include "evlogCodec.h"
+
+#if defined(__HAL_USE_EVENTLOG__)   //  Compile only if module is enabled
+
+//  libUID value in the packed byte telling that full libUID follows
+#define EVC_UID_ESC         0x1F
+
+/**
+ * Write block header (sync point)
+ * @param dst destination, at least EVC_MAX_HEADER bytes long
+ * @param time absolute time of the first entry in block
+ * @return number of bytes written
+ */
+uint8_t EVC_PutHeader(uint8_t *dst, uint64_t time)
+{
+    return putVarint(time, dst);
+}
+
+/**
+ * Read block header (sync point)
+ * @param time [out] absolute time of the first entry in block
+ * @return number of bytes read, 0 if header is truncated
+ */
+uint8_t EVC_GetHeader(const uint8_t *src, const uint8_t *end, uint64_t &time)
+{
+    return getVarint(src, end, &time);
+}
+
+/**
+ * Encode a single entry
+ * @param dst destination, at least EVC_MAX_ENTRY bytes long
+ * @param entry entry to encode; its time must not be before [prevTime]
+ * @param prevTime time of the previous entry in block (or of the block header)
+ * @return number of bytes written
+ */
+uint8_t EVC_PutEntry(uint8_t *dst, const struct _eventEntry &entry,
+                     uint64_t prevTime)
+{
+    uint8_t uid = (uint8_t)entry.libUID, n = 0;
+
+    dst[n++] = (uint8_t)((entry.event << 5) |
+                         ((uid < EVC_UID_ESC) ? uid : EVC_UID_ESC));
+    if (uid >= EVC_UID_ESC)
+        dst[n++] = uid;
+    dst[n++] = (uint8_t)entry.taskID;
+    n += putVarint(entry.timestamp - prevTime, dst + n);
+    if (entry.event == EVENT_SUPPRESSED)
+        n += putVarint(entry.count, dst + n);
+
+    return n;
+}
+
+/**
+ * Decode a single entry
+ * @param prevTime time of the previous entry in block (or of the block header)
+ * @param entry [out] decoded entry
+ * @return number of bytes read, 0 if entry is truncated or malformed
+ */
+uint8_t EVC_GetEntry(const uint8_t *src, const uint8_t *end, uint64_t prevTime,
+                     struct _eventEntry &entry)
+{
+    const uint8_t *p = src;
+    uint64_t dt, count;
+    uint8_t n;
+
+    if ((end - p) < 3)
+        return 0;
+    if ((*p >> 5) > EVENT_SUPPRESSED)
+        return 0;
+
+    entry.event = (Events)(*p >> 5);
+    entry.libUID = (int8_t)(*(p++) & EVC_UID_ESC);
+    if (entry.libUID == EVC_UID_ESC)
+    {
+        if ((end - p) < 3)
+            return 0;
+        entry.libUID = (int8_t)*(p++);
+    }
+    entry.taskID = (int8_t)*(p++);
+
+    if ((n = getVarint(p, end, &dt)) == 0)
+        return 0;
+    entry.timestamp = prevTime + dt;
+    p += n;
+
+    entry.count = 0;
+    if (entry.event == EVENT_SUPPRESSED)
+    {
+        if (((n = getVarint(p, end, &count)) == 0) || (count > 0xFFFF))
+            return 0;
+        entry.count = (uint16_t)count;
+        p += n;
+    }
+
+    return (uint8_t)(p - src);
+}
+
+/**
+ * Decode a complete block
+ * @param blk block, starting with its header
+ * @param len number of valid bytes in block
+ * @param dst [out] decoded entries
+ * @param maxN capacity of [dst]
+ * @return number of decoded entries; decoding stops at the first malformed
+ * entry
+ */
+uint32_t EVC_DecodeBlock(const uint8_t *blk, uint16_t len,
+                         struct _eventEntry *dst, uint32_t maxN)
+{
+    const uint8_t *p = blk, *end = blk + len;
+    uint64_t time;
+    uint32_t n = 0;
+    uint8_t used;
+
+    if ((len == 0) || ((used = EVC_GetHeader(p, end, time)) == 0))
+        return 0;
+    p += used;
+
+    while ((p < end) && (n < maxN) &&
+           ((used = EVC_GetEntry(p, end, time, dst[n])) > 0))
+    {
+        time = dst[n++].timestamp;
+        p += used;
+    }
+
+    return n;
+}
+
+#endif  /* __HAL_USE_EVENTLOG__ */
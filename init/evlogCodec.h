@@ -0,0 +1,49 @@
+/**
+ *  evlogCodec.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Compact encoding of event log entries
+ *  @version 1.1
+ *  V1.0
+ *  +Entries are stored in blocks. Every block starts with the absolute time of
+ *  its first entry (sync point) followed by entries encoded as a packed
+ *  module/event byte, task byte and time delta from the previous entry. An
+ *  entry usually takes 3-4 bytes instead of 16, and any block can be decoded
+ *  on its own. Codec has no hardware dependencies so blocks dumped from the
+ *  target can be decoded on host with the same functions.
+ *  V1.1 - 18.10.2026
+ *  +EVENT_SUPPRESSED entries carry the number of dropped events
+ *
+ *  Block layout:
+ *      time(v) | entry | entry | ...
+ *  Entry layout:
+ *      event(3 bits) << 5 | libUID(5 bits) | [libUID] | taskID | dt(v) |
+ *      [count(v)]
+ *  libUID >= 31 is stored as 31 followed by full libUID byte. time is ms since
+ *  startup, dt is ms since previous entry in the block (0 for the first one).
+ *  count is only present in EVENT_SUPPRESSED entries.
+ *  (v) marks varints, see putVarint() in myLib.h
+ */
+#include "hwconfig.h"
+#include "libs/myLib.h"
+#include "init/eventLog.h"
+
+#if !defined(ROVERKERNEL_INIT_EVLOGCODEC_H_) && defined(__HAL_USE_EVENTLOG__)
+#define ROVERKERNEL_INIT_EVLOGCODEC_H_
+
+//  Longest encoded block header (sync point) and entry
+#define EVC_MAX_HEADER      10
+#define EVC_MAX_ENTRY       16
+
+extern uint8_t  EVC_PutHeader(uint8_t *dst, uint64_t time);
+extern uint8_t  EVC_GetHeader(const uint8_t *src, const uint8_t *end,
+                              uint64_t &time);
+extern uint8_t  EVC_PutEntry(uint8_t *dst, const struct _eventEntry &entry,
+                             uint64_t prevTime);
+extern uint8_t  EVC_GetEntry(const uint8_t *src, const uint8_t *end,
+                             uint64_t prevTime, struct _eventEntry &entry);
+extern uint32_t EVC_DecodeBlock(const uint8_t *blk, uint16_t len,
+                                struct _eventEntry *dst, uint32_t maxN);
+
+#endif /* ROVERKERNEL_INIT_EVLOGCODEC_H_ */
@@ -0,0 +1,357 @@
+/**
+ *  evlogStore.cpp
+ *
+ *  Created on: 18.10.2026.
+ */
+#include "evlogStore.h"
+
+#if defined(__HAL_USE_EVLOGSTORE__)   //  Compile only if module is enabled
+
+#include "HAL/hal.h"
+#include "serialPort/serialProto.h"
+
+//  First word of a valid segment header ("EVLG")
+#define EVS_MAGIC           0x474C5645
+
+//  Bytes taken by a record with [len] bytes of data
+#define _EVS_REC_SIZE(len)  (EVS_REC_HEADER + (((len) + 3) & ~0x03))
+
+/**
+ * Board flash region (see HAL_FLASH_* in HAL)
+ */
+const struct _evsMedium EVS_FlashMedium =
+{
+    HAL_FLASH_SECTOR_SIZE,
+    HAL_FLASH_SECTORS,
+    HAL_FLASH_Erase,
+    HAL_FLASH_Program,
+    HAL_FLASH_Read
+};
+
+//  Medium in use, 0 until EVS_Mount()
+static const struct _evsMedium *_med = 0;
+//  Newest segment: index of its sector, its sequence number (0 if store is
+//  empty) and offset where the next record goes
+static uint32_t _headIdx = 0;
+static uint32_t _headSeq = 0;
+static uint32_t _offset = 0;
+//  Newest segment ends with a damaged record, next record opens new segment
+static bool _sealed = false;
+//  Highest erase count seen, given to sectors whose header got lost
+static uint32_t _maxErases = 0;
+
+///-----------------------------------------------------------------------------
+///         Segment and record headers                                 [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Read and validate header of a segment
+ * @param idx index of segment (sector)
+ * @param seq [out] sequence number of segment
+ * @param erases [out] erase count of sector
+ * @return false if header isn't valid (segment is free)
+ */
+static bool _EVS_ReadHeader(uint32_t idx, uint32_t &seq, uint32_t &erases)
+{
+    uint32_t hdr[EVS_SEG_HEADER / 4];
+
+    _med->read(idx * _med->sectorSize, hdr, EVS_SEG_HEADER);
+    //  Check word is programmed last, an erased one means header got cut
+    if ((hdr[0] != EVS_MAGIC) || (hdr[3] != ~(hdr[0] ^ hdr[1] ^ hdr[2])) ||
+        (hdr[3] == 0xFFFFFFFF) || (hdr[1] == 0))
+        return false;
+
+    seq = hdr[1];
+    erases = hdr[2];
+    return true;
+}
+
+/**
+ * Read record from a segment and check it
+ * @param idx index of segment (sector)
+ * @param offset offset of record in segment
+ * @param hdr [out] record header
+ * @param data [out] record data, 255 bytes; 0 to only check record header
+ * @return size of the record in segment, 0 if there's no valid record
+ */
+static uint32_t _EVS_ReadRecord(uint32_t idx, uint32_t offset, uint8_t *hdr,
+                                uint8_t *data)
+{
+    uint32_t base = idx * _med->sectorSize + offset, size;
+    uint16_t crc;
+
+    if ((offset + EVS_REC_HEADER) > _med->sectorSize)
+        return 0;
+    _med->read(base, hdr, EVS_REC_HEADER);
+
+    size = _EVS_REC_SIZE(hdr[1]);
+    if ((hdr[0] == EVS_TYPE_ERASED) || ((offset + size) > _med->sectorSize))
+        return 0;
+    if (data == 0)
+        return size;
+
+    _med->read(base + EVS_REC_HEADER, data, hdr[1]);
+    crc = SP_Crc16(0xFFFF, hdr, 2);
+    crc = SP_Crc16(crc, data, hdr[1]);
+    if ((hdr[2] != (uint8_t)(crc & 0xFF)) || (hdr[3] != (uint8_t)(crc >> 8)))
+        return 0;
+
+    return size;
+}
+
+/**
+ * Erase the sector following the newest segment and start a new segment in it
+ * @return One of myLib.h STATUS_* error codes
+ */
+static uint32_t _EVS_Open()
+{
+    uint32_t idx = (_headSeq == 0) ? 0 : ((_headIdx + 1) % _med->sectors);
+    uint32_t hdr[EVS_SEG_HEADER / 4], seq, erases;
+
+    //  Erase count is carried over in header; if the header got lost (power
+    //  loss during erase) assume the worst
+    if (!_EVS_ReadHeader(idx, seq, erases))
+        erases = _maxErases;
+    erases++;
+
+    if (!_med->erase(idx))
+        return STATUS_PROG_ERR;
+
+    hdr[0] = EVS_MAGIC;
+    hdr[1] = _headSeq + 1;
+    hdr[2] = erases;
+    hdr[3] = ~(hdr[0] ^ hdr[1] ^ hdr[2]);
+    if (!_med->program(idx * _med->sectorSize, hdr, EVS_SEG_HEADER))
+        return STATUS_PROG_ERR;
+
+    _headIdx = idx;
+    _headSeq++;
+    _offset = EVS_SEG_HEADER;
+    _sealed = false;
+    if (erases > _maxErases)
+        _maxErases = erases;
+
+    return STATUS_OK;
+}
+
+///-----------------------------------------------------------------------------
+///         Store API                                                   [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Find the end of the log on a medium
+ * Reads header of every segment, then hops over record headers in the newest
+ * one. Only the last record of it is read in full, to check whether it was
+ * cut by power loss.
+ * @param medium medium to use (e.g. &EVS_FlashMedium)
+ * @return One of myLib.h STATUS_* error codes
+ */
+uint32_t EVS_Mount(const struct _evsMedium *medium)
+{
+    uint32_t seq, erases, offset, last = 0, size;
+    uint8_t hdr[EVS_REC_HEADER], data[255];
+
+    if ((medium == 0) || (medium->sectors == 0) ||
+        (medium->sectorSize < (EVS_SEG_HEADER + _EVS_REC_SIZE(255))))
+        return STATUS_ARG_ERR;
+
+    _med = medium;
+    _headIdx = 0;
+    _headSeq = 0;
+    _offset = EVS_SEG_HEADER;
+    _sealed = false;
+    _maxErases = 0;
+
+    for (uint32_t i = 0; i < _med->sectors; i++)
+    {
+        if (!_EVS_ReadHeader(i, seq, erases))
+            continue;
+
+        if (seq > _headSeq)
+        {
+            _headSeq = seq;
+            _headIdx = i;
+        }
+        if (erases > _maxErases)
+            _maxErases = erases;
+    }
+    if (_headSeq == 0)
+        return STATUS_OK;
+
+    //  Walk record headers up to erased flash
+    for (offset = EVS_SEG_HEADER;
+         (offset + EVS_REC_HEADER) <= _med->sectorSize; offset += size)
+    {
+        if ((size = _EVS_ReadRecord(_headIdx, offset, hdr, 0)) == 0)
+        {
+            //  Erased flash is the end of log, anything else is a damaged
+            //  record header
+            _sealed = ((hdr[0] & hdr[1] & hdr[2] & hdr[3]) != 0xFF);
+            break;
+        }
+        last = offset;
+    }
+    _offset = offset;
+
+    //  Only the record written last can be damaged by power loss
+    if (!_sealed && (last > 0) &&
+        (_EVS_ReadRecord(_headIdx, last, hdr, data) == 0))
+        _sealed = true;
+
+    return STATUS_OK;
+}
+
+/**
+ * Erase the whole medium, dropping all records
+ * @note Erase counts of sectors are lost
+ * @return One of myLib.h STATUS_* error codes
+ */
+uint32_t EVS_Format()
+{
+    if (_med == 0)
+        return STATUS_PROG_ERR;
+
+    for (uint32_t i = 0; i < _med->sectors; i++)
+        if (!_med->erase(i))
+            return STATUS_PROG_ERR;
+
+    return EVS_Mount(_med);
+}
+
+/**
+ * Append record to the store
+ * If newest segment is full, segment after it is erased (dropping the oldest
+ * records) and record is written there.
+ * @param type type of record, anything but EVS_TYPE_ERASED
+ * @param data data of record (can be 0 if len is 0)
+ * @param len length of data
+ * @return One of myLib.h STATUS_* error codes
+ */
+uint32_t EVS_Append(uint8_t type, const uint8_t *data, uint8_t len)
+{
+    uint32_t buf[_EVS_REC_SIZE(255) / 4], size = _EVS_REC_SIZE(len), retVal;
+    uint8_t *rec = (uint8_t*)buf;
+    uint16_t crc;
+
+    if ((_med == 0) || (type == EVS_TYPE_ERASED))
+        return STATUS_ARG_ERR;
+
+    if ((_headSeq == 0) || _sealed || ((_offset + size) > _med->sectorSize))
+        if ((retVal = _EVS_Open()) != STATUS_OK)
+            return retVal;
+
+    rec[0] = type;
+    rec[1] = len;
+    if (len > 0)
+        memcpy(rec + EVS_REC_HEADER, data, len);
+    memset(rec + EVS_REC_HEADER + len, 0xFF, size - EVS_REC_HEADER - len);
+    crc = SP_Crc16(0xFFFF, rec, 2);
+    crc = SP_Crc16(crc, rec + EVS_REC_HEADER, len);
+    rec[2] = (uint8_t)(crc & 0xFF);
+    rec[3] = (uint8_t)(crc >> 8);
+
+    //  Header goes first, so a partly written record is caught by its CRC
+    if (!_med->program(_headIdx * _med->sectorSize + _offset, buf, size))
+    {
+        _sealed = true;
+        return STATUS_PROG_ERR;
+    }
+    _offset += size;
+
+    return STATUS_OK;
+}
+
+/**
+ * Get cursor pointing to the oldest record in store
+ * @return cursor to pass to EVS_Next()
+ */
+struct _evsCursor EVS_Begin()
+{
+    struct _evsCursor cur;
+
+    cur.seq = 1;
+    if ((_med != 0) && (_headSeq > _med->sectors))
+        cur.seq = _headSeq - _med->sectors + 1;
+    cur.offset = EVS_SEG_HEADER;
+
+    return cur;
+}
+
+/**
+ * Read the record cursor points to and advance cursor
+ * Damaged records end their segment, reading continues in the next one.
+ * @param cur cursor obtained from EVS_Begin()
+ * @param type [out] type of record
+ * @param data [out] data of record, must have room for 255 bytes
+ * @param len [out] length of data
+ * @return true if record was read, false at the end of store
+ */
+bool EVS_Next(struct _evsCursor &cur, uint8_t &type, uint8_t *data,
+              uint8_t &len)
+{
+    uint8_t hdr[EVS_REC_HEADER];
+    uint32_t seq, erases, size, idx;
+
+    if ((_med == 0) || (_headSeq == 0))
+        return false;
+
+    //  Segment cursor points to was reused in the meantime
+    if ((_headSeq - cur.seq) >= _med->sectors)
+        cur = EVS_Begin();
+
+    while ((int32_t)(_headSeq - cur.seq) >= 0)
+    {
+        idx = (_headIdx + _med->sectors - (_headSeq - cur.seq)) % _med->sectors;
+        size = 0;
+
+        if (((cur.seq != _headSeq) || (cur.offset < _offset)) &&
+            _EVS_ReadHeader(idx, seq, erases) && (seq == cur.seq))
+            size = _EVS_ReadRecord(idx, cur.offset, hdr, data);
+
+        if (size > 0)
+        {
+            type = hdr[0];
+            len = hdr[1];
+            cur.offset += size;
+            return true;
+        }
+        if (cur.seq == _headSeq)
+            break;
+
+        cur.seq++;
+        cur.offset = EVS_SEG_HEADER;
+    }
+
+    return false;
+}
+
+/**
+ * Get state of the store
+ * @param stats [out] state of the store
+ */
+void EVS_GetStats(struct _evsStats &stats)
+{
+    uint32_t seq, erases;
+
+    stats.segments = 0;
+    stats.used = (_headSeq > 0) ? _offset : 0;
+    stats.minErases = 0xFFFFFFFF;
+    stats.maxErases = 0;
+    if (_med == 0)
+        return;
+
+    for (uint32_t i = 0; i < _med->sectors; i++)
+    {
+        if (!_EVS_ReadHeader(i, seq, erases))
+            erases = 0;
+        else if ((_headSeq - seq) < _med->sectors)
+            stats.segments++;
+
+        if (erases < stats.minErases)
+            stats.minErases = erases;
+        if (erases > stats.maxErases)
+            stats.maxErases = erases;
+    }
+}
+
+#endif  /* __HAL_USE_EVLOGSTORE__ */
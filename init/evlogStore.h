@@ -0,0 +1,91 @@
+/**
+ *  evlogStore.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Persistent, log-structured store for event log records
+ *  @version 1.0
+ *  V1.0
+ *  +Records (up to 255 bytes each) are appended to segments, one segment per
+ *  erase sector of the medium. Segments are filled in a circle, so every
+ *  sector is erased equally often (wear leveling); once all are used the one
+ *  holding the oldest records is erased and reused.
+ *  +Mounting reads only segment headers and hops over record headers of the
+ *  newest segment to find the end of the log; records are never decoded.
+ *  +Medium is pluggable (struct _evsMedium): EVS_FlashMedium uses HAL_FLASH_*
+ *  which is on-chip flash on TM4C1294 and a file on host.
+ *
+ *  Segment layout:
+ *      magic | seq | erases | check | record | record | ... | 0xFF...
+ *  All header fields are uint32_t, seq is a running segment number (newest
+ *  segment has the highest), erases counts erases of the sector and check is
+ *  ~(magic ^ seq ^ erases), programmed last. Segment with invalid header is
+ *  free.
+ *  Record layout (padded with 0xFF to a multiple of 4 bytes):
+ *      type | len | CRC16(LSB, MSB) | data[len]
+ *  CRC16 is CRC-CCITT (see SP_Crc16()) over type, len and data. Header is
+ *  written first, so a record cut by power loss fails its CRC; the segment is
+ *  then closed and writing continues in the next one.
+ *  @note Not reentrant, use from a single context (main loop)
+ */
+#include "hwconfig.h"
+#include "libs/myLib.h"
+
+#if !defined(ROVERKERNEL_INIT_EVLOGSTORE_H_) && defined(__HAL_USE_EVLOGSTORE__)
+#define ROVERKERNEL_INIT_EVLOGSTORE_H_
+
+//  Bytes of segment header and record header
+#define EVS_SEG_HEADER      16
+#define EVS_REC_HEADER      4
+//  Type of record can't be 0xFF, that's erased flash
+#define EVS_TYPE_ERASED     0xFF
+
+/**
+ * Storage medium: [sectors] erase sectors of [sectorSize] bytes each.
+ * Offsets are from the start of the medium. program() is called with offset
+ * and length that are multiples of 4, and programs each word at most once
+ * after its sector was erased.
+ */
+struct _evsMedium
+{
+    uint32_t    sectorSize;
+    uint32_t    sectors;
+    bool        (*erase)(uint32_t sector);
+    bool        (*program)(uint32_t offset, const uint32_t *src, uint32_t len);
+    void        (*read)(uint32_t offset, void *dst, uint32_t len);
+};
+
+/**
+ * Position of a record in store, used to read records oldest first with
+ * EVS_Begin() and EVS_Next()
+ */
+struct _evsCursor
+{
+    _evsCursor(): seq(0), offset(0) {};
+
+    uint32_t seq;                   //  Sequence number of the segment
+    uint32_t offset;                //  Offset of the record in segment
+};
+
+/**
+ * State of the store
+ */
+struct _evsStats
+{
+    uint32_t    segments;           //  Segments holding records
+    uint32_t    used;               //  Bytes used in the newest segment
+    uint32_t    minErases;          //  Lowest erase count of a segment
+    uint32_t    maxErases;          //  Highest erase count of a segment
+};
+
+extern const struct _evsMedium EVS_FlashMedium;
+
+extern uint32_t EVS_Mount(const struct _evsMedium *medium);
+extern uint32_t EVS_Format();
+extern uint32_t EVS_Append(uint8_t type, const uint8_t *data, uint8_t len);
+extern struct _evsCursor EVS_Begin();
+extern bool     EVS_Next(struct _evsCursor &cur, uint8_t &type, uint8_t *data,
+                         uint8_t &len);
+extern void     EVS_GetStats(struct _evsStats &stats);
+
+#endif /* ROVERKERNEL_INIT_EVLOGSTORE_H_ */
@@ -39,159 +39,812 @@ int32_t min(int32_t arg1, int32_t arg2)
 	return ((arg1 < arg2) ? arg1 : arg2);
 }
 
+///-----------------------------------------------------------------------------
+///         Parsing of numbers from text
+///-----------------------------------------------------------------------------
+
+//  True if character is a decimal digit, single comparison
+#define _IS_DIGIT(C)    ((uint8_t)((C) - '0') <= 9)
+
+//  Inline even when called from several places, parsing is dominated by the
+//  cost of the call otherwise
+#if defined(__GNUC__) || defined(__TI_GNU_ATTRIBUTE_SUPPORT__)
+#define _ALWAYS_INLINE_ inline __attribute__((always_inline))
+#define _NOINLINE_      __attribute__((noinline))
+#else
+#define _ALWAYS_INLINE_ inline
+#define _NOINLINE_
+#endif
+
+//  Powers of 10 that are exactly representable as float/double
+static const float _pow10f[11] =
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+static const double _pow10d[23] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const uint32_t _pow10u[9] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+/**
+ * Check whether 8 bytes (loaded little-endian) are all decimal digits
+ */
+static inline bool _isDigits8(uint64_t v)
+{
+    return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
 /**
- * For a given string containing a number, this function will attempt to
- * 	convert that string to a corresponding float value and return it when done.
- * 	@param nums string containing a number
- * 	@param strLen length of nums variable
- * 	@return float value of number in nums string
+ * Convert 8 decimal digits (loaded little-endian) to a number with three
+ * multiplications instead of eight
  */
-float stof (uint8_t *nums, uint8_t strLen)
+static inline uint32_t _digits8(uint64_t v)
 {
-	float retVal = 0, 		//Value to return
-		  multiplier = 1;	//Digit multiplier
-	uint8_t itB = 0, 		//Beginning of a whole part, iterator
-			itE = 0;		//End of whole part, iterator
-	int8_t i;				//Loop variable
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
 
-	//  Check if we're dealing with negative number, and adjust beginning iterator
-	if (nums[0] == '-') itB = 1;
+    return (uint32_t)v;
+}
 
-	//  Find position of decimal dot, and save it in ending iterator variable
-	while((nums[itE] != '.') && (nums[itE] != '\0') && (itE < strLen)) itE++;
+/**
+ * Load 1 to 8 characters into 8 bytes (as if loaded little-endian) aligned to
+ * the end and padded with '0' in front, e.g. "123" -> "00000123". Uses at most
+ * two overlapping loads instead of a loop over characters.
+ */
+static inline uint64_t _loadDigits8(const char *str, uint16_t n)
+{
+    uint64_t v;
 
-	/*
-	 * Loop from the dot to the beginning of string (to the left) taking each
-	 * 	digit and adding it to the float after applying correct multiplier.
-	 * 	Increase multiplier every time iterator move a digit to the left.
-	 */
-	for (i = (itE - 1); i >= itB; i--)
-	{
-		//  Precaution
-		if ((nums[i] < 48) || (nums[i] > 58)) continue;
+    if (n >= 4)
+    {
+        uint32_t first, last;
 
-		retVal += ((int)nums[i] - 48) * multiplier;
-		multiplier *= 10;
-	}
+        //  Overlapping bytes of both loads hold the same characters
+        memcpy(&first, str, 4);
+        memcpy(&last, str + n - 4, 4);
+        v = ((uint64_t)last << 32) | ((uint64_t)first << (8 * (8 - n)));
+    }
+    else
+        v = ((uint64_t)(uint8_t)str[n - 1] << 56) |
+            ((uint64_t)(uint8_t)str[n >> 1] << (8 * (8 - n + (n >> 1)))) |
+            ((uint64_t)(uint8_t)str[0] << (8 * (8 - n)));
+
+    return v | ((0x3030303030303030ULL >> (8 * n - 8)) >> 8);
+}
+
+/**
+ * Parse unsigned decimal digits, 8 at a time where possible
+ * @param str text, [len] bytes are read even if it's null-terminated before
+ * @param val parsed number
+ * @return number of digits consumed, 0 if there are no digits or number
+ * doesn't fit into 64 bits
+ */
+static uint16_t _parseDigits(const char *str, uint16_t len, uint64_t *val)
+{
+    uint64_t v = 0;
+    uint16_t i = 0;
+
+    while ((uint16_t)(len - i) >= 8)
+    {
+        uint64_t chunk;
+
+        memcpy(&chunk, str + i, 8);
+        if (!_isDigits8(chunk))
+            break;
+        //  UINT64_MAX = 184467440737 * 10^8 + 9551615
+        chunk = _digits8(chunk);
+        if ((v > 184467440737ULL) || ((v == 184467440737ULL) && (chunk > 9551615)))
+            return 0;
+        v = v * 100000000 + chunk;
+        i += 8;
+    }
+    for (; (i < len) && _IS_DIGIT(str[i]); i++)
+    {
+        uint8_t d = (uint8_t)(str[i] - '0');
+
+        if ((v > 1844674407370955161ULL) || ((v == 1844674407370955161ULL) && (d > 5)))
+            return 0;
+        v = v * 10 + d;
+    }
 
-	//  Prepare multiplier for calculating decimal part
-	multiplier = 0.1;
+    *val = v;
+    return i;
+}
 
-	/*
-	 * Loop from the dot to the end of the string (to the right) taking each
-	 * 	digit and adding it to the float after applying correct multiplier.
-	 * 	Decrease multiplier every time iterator moves a digit to the right.
-	 */
-	for (i = (itE + 1); i < strLen; i++)
-	{
-		//  Precaution
-		if ((nums[i] < 48) || (nums[i] > 58)) continue;
+/**
+ * Parse unsigned decimal digits into 32-bit number one by one. Up to 9 digits
+ * can't overflow, so the loop has no range checks and longer numbers are
+ * checked once at the end.
+ * @return number of digits consumed, 0 if there are none or number doesn't
+ * fit into 32 bits
+ */
+static uint16_t _parseDigits32Loop(const char *str, uint16_t len,
+                                   uint32_t *val)
+{
+    uint16_t n, k;
+    uint32_t v = 0;
+    uint64_t w = 0;
 
-		retVal += (float)((int32_t)nums[i] - 48) * multiplier;
-		multiplier /= 10;
-	}
+    for (n = 0; (n < len) && _IS_DIGIT(str[n]); n++)
+        v = v * 10 + (str[n] - '0');
 
-	//  Apply correct sign to the float variable
-	if (itB == 1) retVal *= (-1);
+    if (n > 9)
+    {
+        //  Leading zeros don't count towards the range, 11 significant
+        //  digits never fit
+        for (k = 0; str[k] == '0'; k++);
+        if ((n - k) > 10)
+            return 0;
+        for (; k < n; k++)
+            w = w * 10 + (str[k] - '0');
+        if (w > 0xFFFFFFFF)
+            return 0;
+    }
 
-	return retVal;
+    *val = v;
+    return n;
 }
 
 /**
- * For a given string containing a number, this function will attempt to
- * 	convert that string to a corresponding integer value and return it when done.
- * 	@param nums string containing a number
- * 	@param strLen length of nums variable
- * 	@return int32_t value of number in nums string
+ * Parse unsigned decimal digits into 32-bit number. Text made of up to 16
+ * digits only (usual case for a field of a command) is converted without a
+ * loop, 8 digits at a time; anything else goes through _parseDigits32Loop().
+ * @return number of digits consumed, 0 if there are none or number doesn't
+ * fit into 32 bits
  */
-int32_t stoi (uint8_t *nums, uint8_t strLen)
+static _ALWAYS_INLINE_ uint16_t _parseDigits32(const char *str, uint16_t len,
+                                               uint32_t *val)
 {
-	int32_t retVal = 0, 		//Value to return
-			 multiplier = 1;	//Digit multiplier
-	uint8_t itB = 0; 			//Beginning of a number, iterator
-	int8_t i;					//Loop variable
+    uint64_t hi, lo;
 
-	//  Check if we're dealing with negative number, and adjust beginning iterator
-	if (nums[0] == '-') itB = 1;
+    if ((len > 0) && (len <= 8))
+    {
+        lo = _loadDigits8(str, len);
+        if (_isDigits8(lo))
+        {
+            *val = _digits8(lo);
+            return len;
+        }
+    }
+    else if ((len > 8) && (len <= 16))
+    {
+        memcpy(&hi, str, 8);
+        lo = _loadDigits8(str + 8, len - 8);
+        if (_isDigits8(hi) && _isDigits8(lo))
+        {
+            hi = (uint64_t)_digits8(hi) * _pow10u[len - 8] + _digits8(lo);
+            if (hi > 0xFFFFFFFF)
+                return 0;
+            *val = (uint32_t)hi;
+            return len;
+        }
+    }
 
-	/*
-	 * Loop from the dot to the beginning of string (to the left) taking each
-	 * 	digit and adding it to the float after applying correct multiplier.
-	 * 	Increase multiplier every time iterator move a digit to the left.
-	 */
-	for (i = (strLen - 1); i >= itB; i--)
-	{
-		//  Precaution
-		if ((nums[i] < 48) || (nums[i] > 58)) continue;
+    return _parseDigits32Loop(str, len, val);
+}
 
-		retVal += ((int32_t)nums[i] - 48) * multiplier;
-		multiplier *= 10;
-	}
+/**
+ * Parse unsigned 32-bit integer
+ * @param str text holding a number, optionally with leading '+'
+ * @param len length of [str]; parsing also stops at first non-digit
+ * @param val parsed number, untouched on error
+ * @return number of characters consumed, 0 if there are no digits or number
+ * is out of range
+ */
+uint16_t parseU32(const char *str, uint16_t len, uint32_t *val)
+{
+    uint16_t i = ((len > 0) && (str[0] == '+')) ? 1 : 0;
+    uint16_t n = _parseDigits32(str + i, len - i, val);
 
-	//  Apply correct sign to the variable
-	if (itB == 1) retVal *= (-1);
+    return (n > 0) ? (n + i) : 0;
+}
 
-	return retVal;
+/**
+ * Parse signed 32-bit integer, see parseU32()
+ */
+uint16_t parseI32(const char *str, uint16_t len, int32_t *val)
+{
+    uint16_t i = ((len > 0) && ((str[0] == '-') || (str[0] == '+'))) ? 1 : 0;
+    bool neg = (i > 0) && (str[0] == '-');
+    uint32_t v;
+    uint16_t n = _parseDigits32(str + i, len - i, &v);
+
+    if ((n == 0) || (v > ((uint32_t)INT32_MAX + neg)))
+        return 0;
+
+    *val = neg ? (int32_t)(0 - v) : (int32_t)v;
+    return n + i;
 }
 
-int32_t stoiv (volatile uint8_t *nums, volatile uint8_t strLen)
+/**
+ * Parse unsigned 64-bit integer, see parseU32()
+ */
+uint16_t parseU64(const char *str, uint16_t len, uint64_t *val)
 {
-    int32_t retVal = 0,         //  Value to return
-             multiplier = 1;    //  Digit multiplier
-    uint8_t itB = 0;            //  Beginning of a number, iterator
-    int8_t i;                   //  Loop variable
+    uint16_t i = ((len > 0) && (str[0] == '+')) ? 1 : 0;
+    uint16_t n = _parseDigits(str + i, len - i, val);
 
-    //  Check if we're dealing with negative number, and adjust beginning iterator
-    if (nums[0] == '-') itB = 1;
+    return (n > 0) ? (n + i) : 0;
+}
 
-    /*
-     * Loop from the dot to the beginning of string (to the left) taking each
-     *  digit and adding it to the float after applying correct multiplier.
-     *  Increase multiplier every time iterator move a digit to the left.
-     */
-    for (i = (strLen - 1); i >= itB; i--)
+/**
+ * Parse signed 64-bit integer, see parseU32()
+ */
+uint16_t parseI64(const char *str, uint16_t len, int64_t *val)
+{
+    uint16_t i = ((len > 0) && ((str[0] == '-') || (str[0] == '+'))) ? 1 : 0;
+    bool neg = (i > 0) && (str[0] == '-');
+    uint64_t v;
+    uint16_t n = _parseDigits(str + i, len - i, &v);
+
+    if ((n == 0) || (v > ((uint64_t)INT64_MAX + neg)))
+        return 0;
+
+    *val = neg ? (int64_t)(0 - v) : (int64_t)v;
+    return n + i;
+}
+
+/**
+ * Parse decimal number into fixed-point integer, e.g. "-12.345" with 2
+ * fractional digits gives -1235. Extra fractional digits are rounded (half
+ * away from zero).
+ * @param str text holding a number, [+-]digits[.digits]
+ * @param len length of [str]; parsing also stops at first invalid character
+ * @param fracDigits number of fractional digits in result (at most 9)
+ * @param val parsed number, untouched on error
+ * @return number of characters consumed, 0 if there are no digits or number
+ * is out of range
+ */
+uint16_t parseFixed(const char *str, uint16_t len, uint8_t fracDigits,
+                    int32_t *val)
+{
+    bool neg = false;
+    uint16_t i = 0, start;
+    uint64_t v = 0;
+    uint8_t f = 0;
+
+    if ((len > 0) && ((str[0] == '-') || (str[0] == '+')))
     {
-        //  Precaution
-        if ((nums[i] < 48) || (nums[i] > 58)) continue;
+        neg = (str[0] == '-');
+        i++;
+    }
+    start = i;
+
+    //  Integer part, stop early once it's out of range anyway
+    for (; (i < len) && _IS_DIGIT(str[i]); i++)
+        if ((v = v * 10 + (str[i] - '0')) > 0xFFFFFFFF)
+            return 0;
+    //  Fractional part, digits beyond fracDigits only affect rounding
+    if ((i < len) && (str[i] == '.'))
+        for (i++; (i < len) && _IS_DIGIT(str[i]); i++)
+        {
+            if (f < fracDigits)
+                v = v * 10 + (str[i] - '0');
+            else if ((f == fracDigits) && (str[i] >= '5'))
+                v++;
+            f++;
+        }
+    if ((i == start) || ((i == start + 1) && (str[start] == '.')))
+        return 0;
+
+    //  Missing fractional digits
+    for (; f < fracDigits; f++)
+        v *= 10;
+    if (v > ((uint64_t)INT32_MAX + neg))
+        return 0;
+
+    *val = neg ? (int32_t)(0 - (uint32_t)v) : (int32_t)v;
+    return i;
+}
 
-        retVal += ((int32_t)nums[i] - 48) * multiplier;
-        multiplier *= 10;
+/**
+ * Parse floating-point number that doesn't take the fast path of parseFloat()
+ * (more than 7 digits or an exponent). Numbers with up to 7 significant digits
+ * and small exponents are converted with a single correctly rounded float
+ * operation; the rest goes through double (up to 19 significant digits are
+ * taken into account).
+ */
+static _NOINLINE_ uint16_t _parseFloatLong(const char *str, uint16_t len,
+                                           float *val)
+{
+    bool neg = false;
+    uint16_t i = 0, digits = 0;
+    uint64_t m = 0;
+    int32_t exp = 0;
+    double d;
+
+    if ((len > 0) && ((str[0] == '-') || (str[0] == '+')))
+    {
+        neg = (str[0] == '-');
+        i++;
+    }
+
+    //  Mantissa, digits beyond 19th only move the exponent
+    for (; (i < len) && _IS_DIGIT(str[i]); i++, digits++)
+    {
+        if (m < 1000000000000000000ULL)
+            m = m * 10 + (str[i] - '0');
+        else
+            exp++;
+    }
+    if ((i < len) && (str[i] == '.'))
+        for (i++; (i < len) && _IS_DIGIT(str[i]); i++, digits++)
+            if (m < 1000000000000000000ULL)
+            {
+                m = m * 10 + (str[i] - '0');
+                exp--;
+            }
+    if (digits == 0)
+        return 0;
+
+    //  Exponent is only taken if it has digits
+    if ((i < len) && ((str[i] | 0x20) == 'e'))
+    {
+        uint16_t j = i + 1;
+        bool eneg = false;
+        int32_t e = 0;
+
+        if ((j < len) && ((str[j] == '-') || (str[j] == '+')))
+            eneg = (str[j++] == '-');
+        if ((j < len) && _IS_DIGIT(str[j]))
+        {
+            for (; (j < len) && _IS_DIGIT(str[j]); j++)
+                if (e < 100000)
+                    e = e * 10 + (str[j] - '0');
+            exp += eneg ? -e : e;
+            i = j;
+        }
     }
 
-    //  Apply correct sign to the variable
-    if (itB == 1) retVal *= (-1);
+    if ((m <= (1 << 24)) && (exp >= -10) && (exp <= 10))
+    {
+        //  Both operands are exact, result is correctly rounded
+        float f = (float)m;
+
+        f = (exp < 0) ? (f / _pow10f[-exp]) : (f * _pow10f[exp]);
+        *val = neg ? -f : f;
+        return i;
+    }
+
+    d = (double)m;
+    if (m == 0)
+        exp = 0;
+    //  Bring the exponent into range of exact powers in as few steps as
+    //  possible; out-of-range values end up as 0 or infinity
+    while ((exp > 22) && (d < 1e300))
+    {
+        d *= 1e22;
+        exp -= 22;
+    }
+    while ((exp < -22) && (d > 1e-300))
+    {
+        d /= 1e22;
+        exp += 22;
+    }
+    if ((exp > 22) || (exp < -22))
+        d = (exp > 0) ? (d * 1e22) : 0;
+    else
+        d = (exp < 0) ? (d / _pow10d[-exp]) : (d * _pow10d[exp]);
+
+    *val = neg ? -(float)d : (float)d;
+    return i;
+}
+
+/**
+ * Parse floating-point number, [+-]digits[.digits][(e|E)[+-]digits]
+ * Numbers of up to 7 digits without exponent (e.g. "-123.456", as they come
+ * through serial port) are parsed in 32 bits and converted with a single
+ * correctly rounded float division. Anything else goes through
+ * _parseFloatLong(), kept out of line so this path stays short.
+ * @param str text holding a number
+ * @param len length of [str]; parsing stops at first invalid character
+ * @param val parsed number, untouched on error
+ * @return number of characters consumed, 0 if there are no digits
+ */
+uint16_t parseFloat(const char *str, uint16_t len, float *val)
+{
+    bool neg = false;
+    uint16_t i = 0, j, k, digits;
+    uint32_t m = 0;
+    float f;
+
+    if ((len > 0) && ((str[0] == '-') || (str[0] == '+')))
+    {
+        neg = (str[0] == '-');
+        i++;
+    }
+
+    //  7 digits and their power of 10 are exact in float. Longer numbers
+    //  overflow [m] but are parsed again by _parseFloatLong()
+    for (j = i; (j < len) && _IS_DIGIT(str[j]); j++)
+        m = m * 10 + (str[j] - '0');
+    digits = j - i;
+    //  k is the start of fractional digits
+    k = j;
+    if ((j < len) && (str[j] == '.'))
+        for (k = ++j; (j < len) && _IS_DIGIT(str[j]); j++)
+            m = m * 10 + (str[j] - '0');
+    digits += j - k;
+
+    if ((digits == 0) || (digits > 7) ||
+        ((j < len) && ((str[j] | 0x20) == 'e')))
+        return _parseFloatLong(str, len, val);
+
+    f = (float)m / _pow10f[j - k];
+    *val = neg ? -f : f;
+    return j;
+}
+
+/**
+ * Length of text for legacy wrappers, whose callers may pass size of a buffer
+ * holding null-terminated text; parse functions read all [strLen] bytes
+ */
+static inline uint16_t _textLen(const uint8_t *nums, uint16_t strLen)
+{
+    const uint8_t *end = (const uint8_t*)memchr(nums, 0, strLen);
+
+    return (end != 0) ? (uint16_t)(end - nums) : strLen;
+}
+
+/**
+ * Parse floating-point number from text, kept for compatibility
+ * @param nums text holding a number
+ * @param strLen length of [nums], or size of buffer if text is null-terminated
+ * @return parsed number, 0 if text doesn't start with a number
+ */
+float stof (uint8_t *nums, uint16_t strLen)
+{
+    float retVal = 0;
+
+    parseFloat((const char*)nums, _textLen(nums, strLen), &retVal);
+
+    return retVal;
+}
+
+/**
+ * Parse integer from text, kept for compatibility
+ * @param nums text holding a number
+ * @param strLen length of [nums], or size of buffer if text is null-terminated
+ * @return parsed number, 0 if text doesn't start with a number or it's out of
+ * range
+ */
+int32_t stoi (uint8_t *nums, uint16_t strLen)
+{
+    int32_t retVal = 0;
+
+    parseI32((const char*)nums, _textLen(nums, strLen), &retVal);
+
+    return retVal;
+}
+
+/**
+ * Same as stoi(), for buffers shared with interrupts; buffer must not change
+ * while it's being parsed
+ */
+int32_t stoiv (volatile uint8_t *nums, volatile uint16_t strLen)
+{
+    int32_t retVal = 0;
+
+    parseI32((const char*)nums, _textLen((const uint8_t*)nums, strLen),
+             &retVal);
 
     return retVal;
 }
+
+///-----------------------------------------------------------------------------
+///         Formatting of numbers as text
+///-----------------------------------------------------------------------------
+
+//  Pairs of decimal digits, "00" to "99"
+static const char _digits2[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+/**
+ * Write decimal digits of a 32-bit number backwards, two at a time
+ * @return pointer to the first digit
+ */
+static char* _utoaRev32(uint32_t val, char *end)
+{
+    while (val >= 100)
+    {
+        uint32_t q = val / 100;
+
+        end -= 2;
+        memcpy(end, _digits2 + 2 * (val - q * 100), 2);
+        val = q;
+    }
+    if (val >= 10)
+    {
+        end -= 2;
+        memcpy(end, _digits2 + 2 * val, 2);
+    }
+    else
+        *(--end) = (char)('0' + val);
+
+    return end;
+}
+
+/**
+ * Write decimal digits of a number backwards, ending right before [end].
+ * 64-bit numbers are split into 9-digit chunks so that only 32-bit divisions
+ * are done per digit.
+ * @return pointer to the first digit
+ */
+char* utoaRev(uint64_t val, char *end)
+{
+    while (val > 0xFFFFFFFF)
+    {
+        uint64_t q = val / 1000000000;
+        char *p = _utoaRev32((uint32_t)(val - q * 1000000000), end);
+
+        while (p > (end - 9))
+            *(--p) = '0';
+        end = p;
+        val = q;
+    }
+
+    return _utoaRev32((uint32_t)val, end);
+}
+
 /**
- * Convert any integer number to string
+ * Write unsigned 64-bit integer as null-terminated decimal text
+ * @param dst destination, at least 21 bytes long
+ * @return length of text (without terminator)
+ */
+uint8_t fmtU64(uint64_t val, char *dst)
+{
+    char tmp[20], *s = utoaRev(val, tmp + sizeof(tmp));
+    uint8_t n = (uint8_t)(tmp + sizeof(tmp) - s);
+
+    memcpy(dst, s, n);
+    dst[n] = '\0';
+
+    return n;
+}
+
+/**
+ * Write signed 64-bit integer as null-terminated decimal text
+ * @param dst destination, at least 21 bytes long
+ * @return length of text (without terminator)
+ */
+uint8_t fmtI64(int64_t val, char *dst)
+{
+    if (val < 0)
+    {
+        *dst = '-';
+        return fmtU64(0 - (uint64_t)val, dst + 1) + 1;
+    }
+
+    return fmtU64((uint64_t)val, dst);
+}
+
+/**
+ * Write unsigned 32-bit integer as null-terminated decimal text
+ * @param dst destination, at least 11 bytes long
+ * @return length of text (without terminator)
+ */
+uint8_t fmtU32(uint32_t val, char *dst)
+{
+    return fmtU64(val, dst);
+}
+
+/**
+ * Write signed 32-bit integer as null-terminated decimal text
+ * @param dst destination, at least 12 bytes long
+ * @return length of text (without terminator)
+ */
+uint8_t fmtI32(int32_t val, char *dst)
+{
+    return fmtI64(val, dst);
+}
+
+/**
+ * Write fixed-point number as null-terminated decimal text, e.g. -1235 with
+ * 2 fractional digits is written as "-12.35"
+ * @param fracDigits number of fractional digits in [val] (at most 9)
+ * @param dst destination, at least 23 bytes long
+ * @return length of text (without terminator)
+ */
+uint8_t fmtFixed(int64_t val, uint8_t fracDigits, char *dst)
+{
+    char tmp[24], *end = tmp + sizeof(tmp), *s;
+    uint64_t v = (val < 0) ? (0 - (uint64_t)val) : (uint64_t)val;
+    uint8_t n = 0;
+
+    s = utoaRev(v, end);
+    //  At least one digit in front of decimal point
+    while ((end - s) <= fracDigits)
+        *(--s) = '0';
+
+    if (val < 0)
+        dst[n++] = '-';
+    memcpy(dst + n, s, (end - s) - fracDigits);
+    n += (end - s) - fracDigits;
+    if (fracDigits > 0)
+    {
+        dst[n++] = '.';
+        memcpy(dst + n, end - fracDigits, fracDigits);
+        n += fracDigits;
+    }
+    dst[n] = '\0';
+
+    return n;
+}
+
+/**
+ * Write float in fixed notation with [prec] fractional digits, rounded the
+ * way printf("%.*f") does it (round half to even on exact binary value)
+ * @param prec number of fractional digits (at most 9)
+ * @param dst destination, at least 52 bytes long
+ * @return length of text (without terminator)
+ */
+uint8_t fmtFloat(float val, uint8_t prec, char *dst)
+{
+    double d = val, ip;
+    uint64_t fixed;
+    uint8_t n = 0;
+
+    if (prec > 9)
+        prec = 9;
+    if (signbit(val))
+    {
+        dst[n++] = '-';
+        d = -d;
+    }
+    if (!isfinite(d))
+    {
+        memcpy(dst + n, isnan(d) ? "nan" : "inf", 4);
+        return n + 3;
+    }
+
+    if (d >= 16777216.0)
+    {
+        /*
+         *  Floats from 2^24 up are integers: mantissa shifted by exponent.
+         *  Build it in a 128-bit number and take 9 decimal digits at a time.
+         */
+        uint32_t w[4] = { 0, 0, 0, 0 }, m;
+        int e;
+        char tmp[40], *end = tmp + sizeof(tmp), *s = end;
+        uint8_t i;
+
+        m = (uint32_t)ldexp(frexp(d, &e), 24);
+        e -= 24;
+        w[e / 32] = m << (e % 32);
+        if ((e % 32) > 8)
+            w[e / 32 + 1] = m >> (32 - (e % 32));
+
+        while ((w[0] | w[1] | w[2] | w[3]) != 0)
+        {
+            uint64_t rem = 0;
+            char *p;
+
+            for (i = 4; i-- > 0;)
+            {
+                rem = (rem << 32) | w[i];
+                w[i] = (uint32_t)(rem / 1000000000);
+                rem -= (uint64_t)w[i] * 1000000000;
+            }
+            p = utoaRev(rem, s);
+            //  Inner chunks are zero-padded to 9 digits
+            if ((w[0] | w[1] | w[2] | w[3]) != 0)
+                while (p > (s - 9))
+                    *(--p) = '0';
+            s = p;
+        }
+
+        memcpy(dst + n, s, end - s);
+        n += end - s;
+        if (prec > 0)
+        {
+            dst[n++] = '.';
+            memset(dst + n, '0', prec);
+            n += prec;
+        }
+        dst[n] = '\0';
+        return n;
+    }
+
+    /*
+     *  Fractional part has at most 24 significant bits and 10^prec is 2^prec
+     *  times at most 21 bits, so the scaled fraction and the remainder below
+     *  are exact in double and ties are seen as ties
+     */
+    ip = floor(d);
+    d = (d - ip) * _pow10d[prec];
+    fixed = (uint64_t)d;
+    d -= (double)fixed;
+    if ((d > 0.5) || ((d == 0.5) && ((fixed & 1) ||
+                                     ((prec == 0) && ((uint64_t)ip & 1)))))
+        fixed++;
+    fixed += (uint64_t)ip * (uint64_t)_pow10d[prec];
+
+    //  Negative zero after rounding keeps its sign, like printf
+    return n + fmtFixed((int64_t)fixed, prec, dst + n);
+}
+
+/**
+ * Convert integer to null-terminated text, kept for compatibility
  * @param num input number to convert
- * @param str char array to store convert integer to
+ * @param str char array to store converted integer to (at least 12 bytes)
  */
 void itoa (int32_t num, uint8_t *str)
 {
-    uint8_t it = 0;
+    fmtI32(num, (char*)str);
+}
 
-    if (num < 0)
+/**
+ * Write integer as a varint (7 bits per byte, LSB first, MSB set on all but
+ * the last byte), so small numbers take fewer bytes
+ * @param val number to encode
+ * @param dst destination buffer, at least 10 bytes long
+ * @return number of bytes written into dst
+ */
+uint8_t putVarint(uint64_t val, uint8_t *dst)
+{
+    uint8_t n = 0;
+
+    while (val >= 0x80)
     {
-        str[it++]= '-';
-        num = labs(num);
+        dst[n++] = (uint8_t)(val | 0x80);
+        val >>= 7;
     }
+    dst[n++] = (uint8_t)val;
 
-    uint8_t digits = 1;
+    return n;
+}
 
-    //  Find length of the string
-    while ( (num / ((int32_t)powf(10.0f, (float)digits))) > 0)
-        digits++;
+/**
+ * Read varint from [src] without going past [end]
+ * @param val decoded number
+ * @return number of bytes consumed, 0 if varint is incomplete or malformed
+ */
+uint8_t getVarint(const uint8_t *src, const uint8_t *end, uint64_t *val)
+{
+    uint8_t n = 0;
+    uint8_t shift = 0;
 
-    //  We'll start adding digits from the right to the left of the number,
-    //  adjust iterator accordingly
-    it += (digits -1);
-    //  Convert digits to string (48 is ASCII offset for digit)
-    while ((digits--) > 0)
+    *val = 0;
+    while ((src + n) < end)
     {
-        str[it--] = (uint8_t)(48 + num % 10);
-        num /=10;
+        uint8_t b = src[n++];
+
+        *val |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+            return n;
+
+        shift += 7;
+        if (shift > 63)
+            return 0;
     }
+
+    return 0;
 }
 
+/**
+ * Map signed integer to unsigned one so that numbers close to zero (including
+ * negative ones) become small numbers which encode into short varints
+ */
+uint64_t zigzag(int64_t val)
+{
+    return ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+}
+
+/**
+ * Inverse of zigzag()
+ */
+int64_t unzigzag(uint64_t val)
+{
+    return (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+}
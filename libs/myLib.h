@@ -33,13 +33,37 @@ float   finterpolatef(float x1, float y1, float x2, float y2, float _x);
 int32_t min(int32_t arg1, int32_t arg2);
 
 /*		Functions for converting string to number		*/
-float   stof (uint8_t *nums, uint8_t strLen);
-int32_t stoi (uint8_t *nums, uint8_t strLen);
-int32_t stoiv (volatile uint8_t *nums, volatile uint8_t strLen);
+//  [str] has to hold [len] readable bytes: digits are loaded several at a time,
+//  so bytes up to [len] may be read even though parsing stops at the first
+//  invalid character (e.g. '\0'). Legacy stoi()/stoiv()/stof() also accept
+//  size of a buffer holding null-terminated text.
+uint16_t parseU32(const char *str, uint16_t len, uint32_t *val);
+uint16_t parseI32(const char *str, uint16_t len, int32_t *val);
+uint16_t parseU64(const char *str, uint16_t len, uint64_t *val);
+uint16_t parseI64(const char *str, uint16_t len, int64_t *val);
+uint16_t parseFixed(const char *str, uint16_t len, uint8_t fracDigits,
+                    int32_t *val);
+uint16_t parseFloat(const char *str, uint16_t len, float *val);
+float   stof (uint8_t *nums, uint16_t strLen);
+int32_t stoi (uint8_t *nums, uint16_t strLen);
+int32_t stoiv (volatile uint8_t *nums, volatile uint16_t strLen);
 
 /*      Functions to convert number to string           */
+char*   utoaRev(uint64_t val, char *end);
+uint8_t fmtU32(uint32_t val, char *dst);
+uint8_t fmtI32(int32_t val, char *dst);
+uint8_t fmtU64(uint64_t val, char *dst);
+uint8_t fmtI64(int64_t val, char *dst);
+uint8_t fmtFixed(int64_t val, uint8_t fracDigits, char *dst);
+uint8_t fmtFloat(float val, uint8_t prec, char *dst);
 void    itoa (int32_t num, uint8_t *str);
 
+/*      Variable-length encoding of integers (varints)  */
+uint8_t putVarint(uint64_t val, uint8_t *dst);
+uint8_t getVarint(const uint8_t *src, const uint8_t *end, uint64_t *val);
+uint64_t zigzag(int64_t val);
+int64_t unzigzag(uint64_t val);
+
 #ifdef __cplusplus
 }
 #endif
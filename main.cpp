@@ -13,9 +13,13 @@
  *  0) Printing in16_t number
  *  1) Printing a string not longer than 20 char
  *  2) Printing a float
- * Statistics module provides 2 services:
+ * Statistics module provides 5 services:
  *  0) Print statistics on all currently scheduled tasks (run time, period...)
  *  1) Print content of event logger
+ *  2) Print statistics of all services executed so far
+ *  3) Print content of event log stored in flash (includes runs before the
+ *      last reboot)
+ *  4) Print counters of events emitted by each module
  *
  * Code in main() shows how to initialize the system and schedule 6 tasks for
  * execution. Tasks are scheduled as follows:
@@ -33,7 +37,12 @@
 #include "HAL/hal.h"
 #include "taskScheduler/taskScheduler.h"
 #include "serialPort/uartHW.h"
+#include "serialPort/deferredLog.h"
 #include "init/eventLog.h"
+#include "init/evlogCodec.h"
+#if defined(__HAL_USE_EVLOGSTORE__)
+#include "init/evlogStore.h"
+#endif
 
 
 ///-----------------------------------------------------------------------------
@@ -48,12 +57,75 @@
 #define STATISTICS_T_TSCH   0  //  Print out event log data for TestModule
 #define STATISTICS_T_EVLOG  1  //  Print out execution statistics for periodic
                                //  tasks in task scheduler
+#define STATISTICS_T_PROF   2  //  Print out statistics of all services
+#define STATISTICS_T_EVSTORE 3 //  Print out event log stored in flash
+#define STATISTICS_T_EVCOUNT 4 //  Print out counters of events of modules
 
 
 //  Interface with task scheduler - provides memory space and function
 //  to call in order for task scheduler to request service from this module
 _kernelEntry _kerInterface;
 
+/**
+ * Print profiling statistics of a single service
+ * @param perf snapshot of statistics as returned by TS_ProfFind/TS_ProfFetch
+ */
+static void STAT_PrintPerf(const Performance &perf)
+{
+    DEBUG_WRITE("\tSo far service has completed %u runs with ",
+            perf.taskRuns);
+
+    //  Calculate average runtime
+    float runTim = (float)(perf.accRT);
+    runTim += ((float)perf.msAcc)/1000.0f;
+
+    if (perf.taskRuns > 0)
+        runTim = runTim / ((float)perf.taskRuns);
+    else
+        runTim = 0.0;
+
+    DEBUG_WRITE("average runtime of %.2f ms \n", runTim);
+
+    DEBUG_WRITE("\tStart time was missed on %u runs by ",
+                perf.startTimeMissCnt);
+
+    //  Calculate average time by the which the deadline was missed
+    float missTime = 0.0;
+    if (perf.startTimeMissCnt > 0)
+        missTime = ((float)perf.startTimeMissTot) /
+                   ((float)perf.startTimeMissCnt);
+    DEBUG_WRITE("%.2f ms on average.\n\n", missTime);
+}
+
+//  Names of events as printed out
+static const char evName[][15] =
+{
+    {"UNINITIALIZED\0"},
+    {"STARTUP\0"},
+    {"INITIALIZED\0"},
+    {"OK\0"},
+    {"HANG\0"},
+    {"ERROR\0"},
+    {"PRIOINVERSION\0"},
+    {"SUPPRESSED\0"}
+};
+
+/**
+ * Print a single entry of the event log
+ * @param ev entry to print
+ */
+static void STAT_PrintEvent(const struct _eventEntry &ev)
+{
+    //  Summary of dropped events keeps their type in taskID
+    if ((ev.event == EVENT_SUPPRESSED) &&
+        ((uint8_t)ev.taskID < EVENT_SUPPRESSED))
+        DLOG(EL_SUPPRESSED, (uint32_t)ev.timestamp, ev.libUID, ev.count,
+             evName[ev.taskID]);
+    else
+        DLOG(EL_EVENT, (uint32_t)ev.timestamp, ev.libUID, evName[ev.event],
+             ev.taskID);
+}
+
 /**
  * Callback routine to invoke service offered by this module from task scheduler
  * @note It is assumed that once this function is called task scheduler has
@@ -61,16 +133,9 @@ _kernelEntry _kerInterface;
  */
 void STATISTICS_KerCallback(void)
 {
-    static const char evName[][15] =
-    {
-        {"UNINITIALIZED\0"},
-        {"STARTUP\0"},
-        {"INITIALIZED\0"},
-        {"OK\0"},
-        {"HANG\0"},
-        {"ERROR\0"},
-        {"PRIOINVERSION\0"}
-    };
+    //  Dumps are longer than TX buffer, wait for the line instead of dropping
+    SerialPort::GetI().SetTxPolicy(TX_BLOCK, TX_DEF_TIMEOUT);
+
     /*
      *  Data in args[] contains bytes that constitute arguments for function
      *  calls. The exact representation(i.e. whether bytes represent ints, floats)
@@ -86,52 +151,68 @@ void STATISTICS_KerCallback(void)
      */
     case STATISTICS_T_TSCH:
         {
-            uint32_t Ntasks = TaskScheduler::GetI().NumOfTasks();
-
-            //  Loop through all tasks currently in the list
-            for (uint8_t i = 0; i < Ntasks; i++)
+            struct _tsTaskInfo tasks[8];
+            struct _tsSnapCursor cursor;
+            uint32_t Ntasks;
+
+            //  Copy tasks out of the queue a page at a time, printing is slow
+            //  and queue can change while it's being printed
+            while ((Ntasks = TaskScheduler::GetI().SnapshotPage(tasks, 8,
+                                                                cursor)) > 0)
             {
-                const TaskEntry *task = TaskScheduler::GetI().FetchNextTask(i==0);
-                if (task == 0)
-                    break;
+                for (uint32_t i = 0; i < Ntasks; i++)
+                {
+                    const struct _tsTaskInfo &task = tasks[i];
 
-                //  Print current time
-                DEBUG_WRITE("[%d] ", msSinceStartup);
+                    //  Print current time
+                    DEBUG_WRITE("[%u] ", (uint32_t)TS_GetTimeMS());
 
-                DEBUG_WRITE("Performance for service %d from module %d:\n", \
-                            task->GetTaskUID(), task->GetLibUID());
+                    DEBUG_WRITE("Performance for service %d from module %d:\n", \
+                                task.taskID, task.libUID);
 
-                DEBUG_WRITE("\tTask running under PID: %d, period %d ms\n", \
-                            (uint16_t)task->GetPID(), task->GetPeriod());
+                    DEBUG_WRITE("\tTask running under PID: %d, period %d ms\n", \
+                                task.PID, task.period);
 
-                DEBUG_WRITE("\tNext execution of the task at: %d ms\n", \
-                            (uint32_t)task->GetTimeStamp());
+                    DEBUG_WRITE("\tNext execution of the task at: %u ms\n", \
+                                task.timestamp);
 
 
-                DEBUG_WRITE("\tSo far task has completed %u runs with ",
-                        task->Perf.taskRuns);
-
-                //  Calculate average runtime
-                float runTim = (float)(task->Perf.accRT);
-                runTim += ((float)task->Perf.msAcc)/1000.0f;
-
-                if (task->Perf.taskRuns > 0)
-                    runTim = runTim / ((float)task->Perf.taskRuns);
-                else
-                    runTim = 0.0;
+                    //  Statistics are kept per service, across all tasks
+                    //  using it
+                    Performance perf;
+                    if (TS_ProfFind(task.libUID, task.taskID, perf))
+                        STAT_PrintPerf(perf);
+                    else
+                        DEBUG_WRITE("\tService hasn't been executed yet\n\n");
+                }
+            }
+        }
+        break;
+    /*
+     *  Print statistics of all services executed since startup (or since last
+     *  TASKSCHED_T_PROF_RESET), including one-off and already killed tasks
+     *  args[] = none
+     *  retVal none
+     */
+    case STATISTICS_T_PROF:
+        {
+            uint8_t libUID, serviceID;
+            Performance perf;
 
-                DEBUG_WRITE("average runtime of %d.%d ms \n", _FTOI_(runTim));
+            //  Print current time
+            DEBUG_WRITE("[%u] ", (uint32_t)TS_GetTimeMS());
+            DEBUG_WRITE("Service statistics:\n");
 
-                DEBUG_WRITE("\tStart time was missed on %d runs by ",
-                            (uint32_t)(task->Perf.startTimeMissCnt));
+            for (uint16_t i = 0; i < TS_PROF_SLOTS; i++)
+            {
+                if (!TS_ProfFetch(i, libUID, serviceID, perf))
+                    continue;
 
-                //  Calculate average time by the which the deadline was missed
-                float missTime = 0.0;
-                if (task->Perf.startTimeMissCnt > 0)
-                    missTime = ((float)task->Perf.startTimeMissTot) /
-                               ((float)task->Perf.startTimeMissCnt);
-                DEBUG_WRITE("%d.%d ms on average.\n\n", _FTOI_(missTime));
+                DEBUG_WRITE("Service %d from module %d:\n", serviceID, libUID);
+                STAT_PrintPerf(perf);
             }
+            DEBUG_WRITE("Dispatches not profiled (table full): %u\n\n",
+                        TS_ProfDropped());
         }
         break;
     /*
@@ -142,24 +223,113 @@ void STATISTICS_KerCallback(void)
     case STATISTICS_T_EVLOG:
         {
             //  Print current time
-            DEBUG_WRITE("[%d] ", msSinceStartup);
+            DEBUG_WRITE("[%u] ", (uint32_t)TS_GetTimeMS());
             DEBUG_WRITE("Event logger data dump:\n");
 
-            //  Loop through linked list of events and send them one by one
-            volatile struct _eventEntry* node = EventLog::GetI().GetHead();
-            while(node != 0)
+            //  Summaries of overwritten entries come first, they're the oldest
+            uint32_t old = EventLog::GetI().SummaryBegin();
+            struct _evSummary sum;
+            while (EventLog::GetI().SummaryNext(old, sum))
             {
+                DEBUG_WRITE("\tModule %d from %u ms, highest %s:", sum.libUID,
+                            sum.bucket * EVLOG_SUM_BUCKET_MS,
+                            evName[sum.highest]);
+                for (uint8_t e = 0; e <= EVENT_SUPPRESSED; e++)
+                    if (sum.counts[e] > 0)
+                        DEBUG_WRITE(" %s %u", evName[e], sum.counts[e]);
+                DEBUG_WRITE("\n");
+            }
+
+            //  Then overwritten entries kept in full, then the log itself
+            struct _eventEntry ev;
+            old = EventLog::GetI().KeptBegin();
+            while (EventLog::GetI().KeptNext(old, ev))
+                STAT_PrintEvent(ev);
+
+            //  Loop through events, oldest first, and send them one by one
+            struct _evIter it = EventLog::GetI().Begin();
+            while (EventLog::GetI().Next(it, ev))
+                STAT_PrintEvent(ev);
+        }
+        break;
+#if defined(__HAL_USE_EVLOGSTORE__)
+    /*
+     *  Print out content of the event log stored in flash, oldest first,
+     *  including runs before the last reboot
+     *  args[] = none
+     *  retVal none
+     */
+    case STATISTICS_T_EVSTORE:
+        {
+            static uint8_t rec[255];
+            struct _evsCursor cur = EVS_Begin();
+            struct _eventEntry ev;
+            uint8_t type, len, used, n;
+            uint64_t time;
 
-                DEBUG_WRITE("\t[%d] Module ", node->timestamp);
-                DEBUG_WRITE("%d raised event ", (uint16_t)node->libUID);
-                DEBUG_WRITE("%s", evName[node->event]);
-                DEBUG_WRITE(" during task %d \n", node->taskID);
+            //  Print current time
+            DEBUG_WRITE("[%u] ", (uint32_t)TS_GetTimeMS());
+            DEBUG_WRITE("Stored event log:\n");
 
-                node = node->next;
+            while (EVS_Next(cur, type, rec, len))
+            {
+                if (type == EVLOG_REC_BOOT)
+                    DEBUG_WRITE("\t--- startup ---\n");
+                if (type != EVLOG_REC_BLOCK)
+                    continue;
+
+                //  Every record decodes on its own, starting at its sync point
+                for (used = EVC_GetHeader(rec, rec + len, time);
+                     (used > 0) && (used < len); used += n)
+                {
+                    if ((n = EVC_GetEntry(rec + used, rec + len, time, ev)) == 0)
+                        break;
+                    time = ev.timestamp;
+                    STAT_PrintEvent(ev);
+                }
             }
         }
         break;
+#endif  /* __HAL_USE_EVLOGSTORE__ */
+    /*
+     *  Print out counters of events emitted by modules; they're kept even
+     *  while recording of events is disabled
+     *  args[] = libUID (optional, all modules if not given)
+     *  retVal none
+     */
+    case STATISTICS_T_EVCOUNT:
+        {
+            uint8_t from = 0, to = NUM_OF_MODULES;
+            struct _evStat st;
+
+            if (_kerInterface.argN > 0)
+            {
+                from = _kerInterface.args[0];
+                to = from + 1;
+            }
+
+            //  Print current time
+            DEBUG_WRITE("[%u] ", (uint32_t)TS_GetTimeMS());
+            DEBUG_WRITE("Event counters:\n");
+
+            for (uint8_t i = from; i < to; i++)
+                for (uint8_t e = 0; e < EVLOG_RL_EVENTS; e++)
+                {
+                    if (!EventLog::GetI().GetStat(i, (Events)e, st) ||
+                        (st.count == 0))
+                        continue;
+
+                    DEBUG_WRITE("\tModule %d %s: %u events, first at %u ms, "
+                                "last at %u ms\n", i, evName[e], st.count,
+                                (uint32_t)st.first, (uint32_t)st.last);
+                    DEBUG_WRITE("\t\t%u in the last minute, %u in the last "
+                                "hour\n", st.rate[0], st.rate[1]);
+                }
+        }
+        break;
     }
+
+    SerialPort::GetI().SetTxPolicy(TX_DEF_POLICY, TX_DEF_TIMEOUT);
 }
 
 /**
@@ -177,13 +347,21 @@ void STAT_InitSW()
 
 
 
+/**
+ * Send a batch of deferred log records out through serial port
+ */
+void DLOG_Sink(const uint8_t *frame, uint16_t len)
+{
+    SerialPort::GetI().SendRaw(frame, len);
+}
+
 /**
  * main.c
  */
 int main(void)
 {
     //  Grab reference to task scheduler object
-    volatile TaskScheduler& ts = TaskScheduler::GetI();
+    TaskScheduler& ts = TaskScheduler::GetI();
 
     //  Initialize board and FPU
     HAL_BOARD_CLOCK_Init();
@@ -191,12 +369,21 @@ int main(void)
     //  Initialize serial port
     SerialPort::GetI().InitHW();
     DEBUG_WRITE("Initialized Uart... \n");
+    //  Deferred log records are sent as frames of serial protocol
+    DLog_SetSink(DLOG_Sink);
 
     //  Run initialization of event logger
     EventLog::GetI().InitSW();
     //  Start logging events
     EventLog::GetI().RecordEvents(true);
     DEBUG_WRITE("Initialized event logger... \n");
+#if defined(__HAL_USE_EVLOGSTORE__)
+    //  Find the end of event log kept in flash; entries from before this
+    //  startup stay there and new ones get appended after them
+    bool evsMounted = (EVS_Mount(&EVS_FlashMedium) == STATUS_OK);
+    if (evsMounted)
+        DEBUG_WRITE("Mounted event log in flash... \n");
+#endif
 
     //  Initialize hardware used by task scheduler, set time step to be 1ms.
     //  Time step gives minimum time resolution when specifying execution time.
@@ -260,6 +447,21 @@ int main(void)
     DEBUG_WRITE("Entering task scheduler... \n");
 
     while(1)
+    {
         //  Run task scheduler loop
         TS_GlobalCheck();
+        //  Process data received on serial port
+        SerialPort::GetI().Poll();
+        //  Send out log records that have been waiting for too long
+        DLog_Flush(false);
+        //  Report events dropped by rate limiting of event log
+        EventLog::GetI().FlushSuppressed();
+        //  Schedule services of reactive rules that fired
+        EventLog::GetI().ScheduleRules();
+#if defined(__HAL_USE_EVLOGSTORE__)
+        //  Copy completed blocks of event log to flash, if it's mounted
+        if (evsMounted)
+            EventLog::GetI().Persist(false);
+#endif
+    }
 }
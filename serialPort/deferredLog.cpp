@@ -0,0 +1,559 @@
+/**
+ * deferredLog.cpp
+ *
+ *  Created on: 18. 10. 2026.
+ */
+#include "deferredLog.h"
+#include "serialProto.h"
+#include "taskScheduler/taskScheduler.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+//  Upper bound on size of encoded arguments of a single record
+#define DLOG_MAX_REC        128
+//  Upper bound on number of arguments (including '*') of a single format
+#define DLOG_MAX_ARGS       8
+
+//  Kinds of arguments, in the way they are taken from the argument list
+#define DLOG_A_END          0
+#define DLOG_A_INT          1
+#define DLOG_A_LONG         2
+#define DLOG_A_LLONG        3
+#define DLOG_A_UINT         4
+#define DLOG_A_ULONG        5
+#define DLOG_A_ULLONG       6
+#define DLOG_A_PTR          7
+#define DLOG_A_DOUBLE       8
+#define DLOG_A_STR          9
+#define DLOG_A_BAD          10
+
+//  Format table, built from logFormats.h
+#define DLOG_FMT(NAME, LVL, FMT) {LVL, FMT},
+const struct _dlogFmt DLog_Formats[DLOG_NUM_FMT] =
+{
+#include "logFormats.h"
+};
+#undef DLOG_FMT
+
+/**
+ * Single conversion specification found in a format string
+ */
+struct _dlogSpec
+{
+    const char  *start;     //  Points to '%'
+    uint8_t     len;        //  Length of specification, including conversion
+    char        conv;       //  Conversion character
+    char        lenMod;     //  0, 'h' (h), 'H' (hh), 'l' (l) or 'L' (ll)
+    uint8_t     stars;      //  Number of '*' in width and precision
+};
+
+//  Argument kinds of every format, terminated with DLOG_A_END (or DLOG_A_BAD)
+static uint8_t _dlogArgs[DLOG_NUM_FMT][DLOG_MAX_ARGS + 1];
+static bool    _dlogParsed = false;
+
+///-----------------------------------------------------------------------------
+///                      Format string parsing                         [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Find next conversion specification in format string (%% is skipped)
+ * @param fmt position in format string to search from
+ * @param spec found specification
+ * @return position in format string after found specification, 0 if there are
+ * no more specifications
+ */
+static const char* _DLogNextSpec(const char *fmt, struct _dlogSpec &spec)
+{
+    while (*fmt != '\0')
+    {
+        if (*(fmt++) != '%')
+            continue;
+        if (*fmt == '%')
+        {
+            fmt++;
+            continue;
+        }
+
+        spec.start = fmt - 1;
+        spec.lenMod = 0;
+        spec.stars = 0;
+
+        //  Flags, width and precision
+        while (((*fmt >= '0') && (*fmt <= '9')) || (*fmt == '.') ||
+               (*fmt == '-') || (*fmt == '+') || (*fmt == ' ') ||
+               (*fmt == '#') || (*fmt == '*'))
+            if (*(fmt++) == '*')
+                spec.stars++;
+        //  Length modifier
+        if (*fmt == 'h' || *fmt == 'l')
+        {
+            spec.lenMod = *(fmt++);
+            if (*fmt == spec.lenMod)
+            {
+                spec.lenMod = (spec.lenMod == 'h') ? 'H' : 'L';
+                fmt++;
+            }
+        }
+        if (*fmt == '\0')
+            return 0;
+
+        spec.conv = *(fmt++);
+        spec.len = (uint8_t)(fmt - spec.start);
+        return fmt;
+    }
+
+    return 0;
+}
+
+/**
+ * Build list of argument kinds for every entry of the format table, so that
+ * format strings don't have to be scanned on every call
+ */
+static void _DLogParseTable()
+{
+    for (uint16_t id = 0; id < DLOG_NUM_FMT; id++)
+    {
+        const char *fmt = DLog_Formats[id].fmt;
+        struct _dlogSpec spec;
+        uint8_t n = 0, kind;
+
+        while ((fmt = _DLogNextSpec(fmt, spec)) != 0)
+        {
+            switch (spec.conv)
+            {
+            case 'd':
+            case 'i':
+                kind = (spec.lenMod == 'L') ? DLOG_A_LLONG :
+                       (spec.lenMod == 'l') ? DLOG_A_LONG : DLOG_A_INT;
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                kind = (spec.lenMod == 'L') ? DLOG_A_ULLONG :
+                       (spec.lenMod == 'l') ? DLOG_A_ULONG : DLOG_A_UINT;
+                break;
+            case 'p':
+                kind = DLOG_A_PTR;
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                kind = DLOG_A_DOUBLE;
+                break;
+            case 's':
+                kind = DLOG_A_STR;
+                break;
+            default:
+                kind = DLOG_A_BAD;
+                break;
+            }
+
+            if ((kind == DLOG_A_BAD) || ((n + spec.stars + 1) > DLOG_MAX_ARGS))
+            {
+                n = 0;
+                kind = DLOG_A_BAD;
+                break;
+            }
+            for (uint8_t i = 0; i < spec.stars; i++)
+                _dlogArgs[id][n++] = DLOG_A_INT;
+            _dlogArgs[id][n++] = kind;
+        }
+        _dlogArgs[id][n] = (kind == DLOG_A_BAD) ? DLOG_A_BAD : DLOG_A_END;
+    }
+
+    _dlogParsed = true;
+}
+
+/**
+ * Encode arguments according to list of their kinds
+ * @param kinds list of argument kinds, terminated with DLOG_A_END
+ * @param ap arguments
+ * @param dst destination buffer, at least DLOG_MAX_REC bytes long
+ * @return number of bytes written into dst, 0xFFFF if arguments don't fit or
+ * format string contains unsupported conversion
+ */
+static uint16_t _DLogEncodeArgs(const uint8_t *kinds, va_list ap, uint8_t *dst)
+{
+    uint16_t n = 0;
+
+    for (; *kinds != DLOG_A_END; kinds++)
+    {
+        //  Worst case is a string
+        if ((n + 1 + DLOG_MAX_STR) > DLOG_MAX_REC)
+            return 0xFFFF;
+
+        switch (*kinds)
+        {
+        case DLOG_A_INT:
+            n += putVarint(zigzag(va_arg(ap, int)), dst + n);
+            break;
+        case DLOG_A_LONG:
+            n += putVarint(zigzag(va_arg(ap, long)), dst + n);
+            break;
+        case DLOG_A_LLONG:
+            n += putVarint(zigzag(va_arg(ap, long long)), dst + n);
+            break;
+        case DLOG_A_UINT:
+            n += putVarint(va_arg(ap, unsigned int), dst + n);
+            break;
+        case DLOG_A_ULONG:
+            n += putVarint(va_arg(ap, unsigned long), dst + n);
+            break;
+        case DLOG_A_ULLONG:
+            n += putVarint(va_arg(ap, unsigned long long), dst + n);
+            break;
+        case DLOG_A_PTR:
+            n += putVarint((uintptr_t)va_arg(ap, void*), dst + n);
+            break;
+        case DLOG_A_DOUBLE:
+            {
+                //  Floats are promoted to double when passed through '...'
+                float f = (float)va_arg(ap, double);
+
+                memcpy(dst + n, &f, sizeof(f));
+                n += sizeof(f);
+            }
+            break;
+        case DLOG_A_STR:
+            {
+                const char *s = va_arg(ap, const char*);
+                uint8_t len = 0;
+
+                if (s != 0)
+                    while ((len < DLOG_MAX_STR) && (s[len] != '\0'))
+                        len++;
+                n += putVarint(len, dst + n);
+                memcpy(dst + n, s, len);
+                n += len;
+            }
+            break;
+        default:
+            return 0xFFFF;
+        }
+    }
+
+    return n;
+}
+
+///-----------------------------------------------------------------------------
+///                      Recording                                      [PUBLIC]
+///-----------------------------------------------------------------------------
+
+//  Where complete SP_T_LOG frames are sent to
+static void (*_dlogSink)(const uint8_t*, uint16_t) = 0;
+//  Batch being filled, payload is placed straight into frame buffer
+static uint8_t  _dlogFrame[SP_MAX_FRAME];
+static uint16_t _dlogLen = 0;       //  Length of payload, 0 if batch is empty
+static uint16_t _dlogRecs = 0;      //  Number of records in batch
+static uint64_t _dlogFirstT = 0;    //  Time of the first record in batch
+static uint64_t _dlogLastT = 0;     //  Time of the last record in batch
+static uint8_t  _dlogSeq = 0;
+static uint32_t _dlogDropped = 0;
+
+/**
+ * Move batch out into [dst] as a complete frame and start a new one
+ * @note Has to be called with interrupts disabled
+ * @return length of frame in dst
+ */
+static uint16_t _DLogTake(uint8_t *dst)
+{
+    uint16_t len = 0;
+
+    if (_dlogSink != 0)
+    {
+        memcpy(SP_PAYLOAD(dst), SP_PAYLOAD(_dlogFrame), _dlogLen);
+        len = SP_Frame(SP_T_LOG, _dlogSeq++, (uint8_t)_dlogLen, dst);
+    }
+    else
+        _dlogDropped += _dlogRecs;
+
+    _dlogLen = 0;
+    _dlogRecs = 0;
+
+    return len;
+}
+
+/**
+ * Set function used to send out complete batches (SP_T_LOG frames)
+ */
+void DLog_SetSink(void((*sink)(const uint8_t*, uint16_t)))
+{
+    _dlogSink = sink;
+    if (!_dlogParsed)
+        _DLogParseTable();
+}
+
+/**
+ * Append a record to the current batch. Called through DLOG() macro.
+ * @param id ID of format string (DLOG_ID_*)
+ * @note Must not be called from an interrupt that can preempt SysTick (time
+ * is read through a seqlock written by SysTick)
+ */
+void DLog_Emit(uint16_t id, ...)
+{
+    uint8_t args[DLOG_MAX_REC], frame[SP_MAX_FRAME];
+    uint16_t argLen, frameLen = 0;
+    uint64_t now = TS_GetTimeMS();
+    va_list ap;
+
+    if (id >= DLOG_NUM_FMT)
+        return;
+
+    if (!_dlogParsed)
+        _DLogParseTable();
+
+    va_start(ap, id);
+    argLen = _DLogEncodeArgs(_dlogArgs[id], ap, args);
+    va_end(ap);
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    if (argLen == 0xFFFF)
+        _dlogDropped++;
+    else
+    {
+        uint8_t *payload = SP_PAYLOAD(_dlogFrame);
+
+        //  Batch is sent out once next record might not fit
+        if ((_dlogLen + 10 + 10 + argLen) > SP_MAX_PAYLOAD)
+            frameLen = _DLogTake(frame);
+
+        if (_dlogLen == 0)
+        {
+            payload[0] = (uint8_t)(DLog_TableCRC() & 0xFF);
+            payload[1] = (uint8_t)(DLog_TableCRC() >> 8);
+            _dlogLen = 2 + putVarint(now, payload + 2);
+            _dlogFirstT = _dlogLastT = now;
+        }
+
+        //  Record from an ISR may carry time older than the previous one
+        _dlogLen += putVarint(id, payload + _dlogLen);
+        _dlogLen += putVarint((now > _dlogLastT) ? (now - _dlogLastT) : 0,
+                              payload + _dlogLen);
+        memcpy(payload + _dlogLen, args, argLen);
+        _dlogLen += argLen;
+        _dlogRecs++;
+        if (now > _dlogLastT)
+            _dlogLastT = now;
+    }
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+
+    if (frameLen > 0)
+        _dlogSink(frame, frameLen);
+}
+
+/**
+ * Send out current batch if it's been waiting for too long
+ * @param force true to send batch regardless of its age
+ */
+void DLog_Flush(bool force)
+{
+    uint8_t frame[SP_MAX_FRAME];
+    uint16_t frameLen = 0;
+    uint64_t now = TS_GetTimeMS();
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    if ((_dlogLen > 0) && (force || ((now - _dlogFirstT) >= DLOG_FLUSH_MS)))
+        frameLen = _DLogTake(frame);
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+
+    if (frameLen > 0)
+        _dlogSink(frame, frameLen);
+}
+
+/**
+ * Return number of records that were dropped (no sink, unsupported format or
+ * arguments too long)
+ */
+uint32_t DLog_Dropped()
+{
+    return _dlogDropped;
+}
+
+///-----------------------------------------------------------------------------
+///                      Decoding                                       [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Return checksum of format table, used to detect firmware and decoder built
+ * from different tables
+ */
+uint16_t DLog_TableCRC()
+{
+    static uint16_t crc = 0;
+
+    if (crc == 0)
+    {
+        crc = 0xFFFF;
+        for (uint16_t i = 0; i < DLOG_NUM_FMT; i++)
+            crc = SP_Crc16(crc, (const uint8_t*)DLog_Formats[i].fmt,
+                           strlen(DLog_Formats[i].fmt) + 1);
+        //  0 is reserved for 'not computed yet'
+        if (crc == 0)
+            crc = 1;
+    }
+
+    return crc;
+}
+
+/**
+ * Rebuild text of all records in the payload of SP_T_LOG frame
+ * @param payload payload of SP_T_LOG frame
+ * @param len length of payload
+ * @param line called for every record with its time and text
+ * @return true if whole payload has been decoded, false if it's malformed or
+ * format table doesn't match the one used by the sender
+ */
+bool DLog_Decode(const uint8_t *payload, uint16_t len,
+                 void((*line)(uint64_t time, const char *text)))
+{
+    const uint8_t *p = payload + 2, *end = payload + len;
+    uint64_t time, v;
+    uint8_t n;
+
+//  Read next varint into 'v', bail out if payload is incomplete
+#define _DLOG_VARINT() \
+    if ((n = getVarint(p, end, &v)) == 0) return false; \
+    p += n;
+
+    if ((len < 3) ||
+        ((payload[0] | ((uint16_t)payload[1] << 8)) != DLog_TableCRC()))
+        return false;
+    _DLOG_VARINT();
+    time = v;
+
+    while (p < end)
+    {
+        char text[512], spec[32];
+        const char *lit;
+        struct _dlogSpec s;
+        uint16_t pos = 0;
+
+        _DLOG_VARINT();
+        if (v >= DLOG_NUM_FMT)
+            return false;
+        lit = DLog_Formats[v].fmt;
+        _DLOG_VARINT();
+        time += v;
+
+        while (true)
+        {
+            const char *next = _DLogNextSpec(lit, s);
+            const char *litEnd = (next != 0) ? s.start : lit + strlen(lit);
+            int star[2] = {0, 0}, w;
+
+            //  Copy literal text before specification, resolving %%
+            while ((lit < litEnd) && (pos < sizeof(text) - 1))
+            {
+                if ((lit[0] == '%') && (lit[1] == '%'))
+                    lit++;
+                text[pos++] = *(lit++);
+            }
+            if (next == 0)
+                break;
+            lit = next;
+
+            for (uint8_t i = 0; i < s.stars; i++)
+            {
+                _DLOG_VARINT();
+                star[i] = (int)unzigzag(v);
+            }
+            if (s.len >= sizeof(spec))
+                return false;
+            memcpy(spec, s.start, s.len);
+            spec[s.len] = '\0';
+
+            //  Print single argument with its original specification
+#define _DLOG_PRINT(X) \
+    ((s.stars == 0) ? snprintf(text + pos, sizeof(text) - pos, spec, X) : \
+     (s.stars == 1) ? snprintf(text + pos, sizeof(text) - pos, spec, star[0], X) : \
+     snprintf(text + pos, sizeof(text) - pos, spec, star[0], star[1], X))
+
+            switch (s.conv)
+            {
+            case 'd':
+            case 'i':
+                _DLOG_VARINT();
+                if (s.lenMod == 'L')
+                    w = _DLOG_PRINT((long long)unzigzag(v));
+                else if (s.lenMod == 'l')
+                    w = _DLOG_PRINT((long)unzigzag(v));
+                else
+                    w = _DLOG_PRINT((int)unzigzag(v));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                _DLOG_VARINT();
+                if (s.lenMod == 'L')
+                    w = _DLOG_PRINT((unsigned long long)v);
+                else if (s.lenMod == 'l')
+                    w = _DLOG_PRINT((unsigned long)v);
+                else
+                    w = _DLOG_PRINT((unsigned int)v);
+                break;
+            case 'p':
+                _DLOG_VARINT();
+                w = _DLOG_PRINT((void*)(uintptr_t)v);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                {
+                    float f;
+
+                    if ((end - p) < (int)sizeof(f))
+                        return false;
+                    memcpy(&f, p, sizeof(f));
+                    p += sizeof(f);
+                    w = _DLOG_PRINT((double)f);
+                }
+                break;
+            case 's':
+                {
+                    char str[DLOG_MAX_STR + 1];
+
+                    _DLOG_VARINT();
+                    if ((v > DLOG_MAX_STR) || ((uint64_t)(end - p) < v))
+                        return false;
+                    memcpy(str, p, (size_t)v);
+                    str[v] = '\0';
+                    p += v;
+                    w = _DLOG_PRINT(str);
+                }
+                break;
+            default:
+                return false;
+            }
+#undef _DLOG_PRINT
+
+            if (w > 0)
+                pos += ((pos + w) < (int)sizeof(text)) ? w :
+                                                         (sizeof(text) - 1 - pos);
+        }
+        text[pos] = '\0';
+
+        line(time, text);
+    }
+#undef _DLOG_VARINT
+
+    return true;
+}
@@ -0,0 +1,122 @@
+/**
+ *  deferredLog.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Deferred (binary) logging
+ *  @version 1.0
+ *  V1.0
+ *  +Call sites log through DLOG(NAME, args...) where NAME refers to an entry
+ *  in logFormats.h. Instead of formatting text on the MCU, a compact record
+ *  (format ID, time stamp and raw values of arguments) is appended to a
+ *  batch which is sent out as a single SP_T_LOG frame of the serial protocol
+ *  (see serialProto.h). Text is rebuilt on PC from the same format table
+ *  (host/dlogDecode.cpp).
+ *  +Log levels are filtered at compile time (DLOG_LEVEL), calls below the
+ *  level compile to nothing
+ *  +Without _DLOG_DEFERRED_, DLOG() formats text on the MCU through
+ *  DEBUG_WRITE using the same format table, so call sites don't depend on the
+ *  kind of console on the other side
+ *
+ *  Payload of SP_T_LOG frame:
+ *      tableCRC(uint16_t, LSB first) | baseTime(v) | record | record | ...
+ *  record:
+ *      ID(v) | timeDelta(v, ms since previous record or baseTime) | args
+ *  args, in order of conversions in format string:
+ *      %d %i:          zig-zag varint
+ *      %u %x %o %c %p: varint
+ *      %f %e %g:       float, 4 bytes LSB first
+ *      %s:             length(v) | characters (at most DLOG_MAX_STR)
+ *      * (width/prec): zig-zag varint
+ *
+ *  Usage:
+ *      DLog_SetSink(function sending bytes out, e.g. SerialPort::SendRaw)
+ *      DLOG(TM_PRINT_INT, 42);
+ *      ...
+ *      DLog_Flush(false);      // from the main loop
+ */
+#include "hwconfig.h"
+#include "libs/myLib.h"
+
+#ifndef ROVERKERNEL_SERIALPORT_DEFERREDLOG_H_
+#define ROVERKERNEL_SERIALPORT_DEFERREDLOG_H_
+
+//  Send records in binary form instead of formatting text on the MCU (always
+//  the case in host builds). Off by default: the other side of the link then
+//  has to run host/dlogDecode, a plain terminal only shows frames. Gains
+//  measured by dlogDecode -t are about 4x fewer bytes and 1.4x fewer cycles at
+//  the call site, short of 5-10x: arguments make up a large share of every
+//  line and travel anyway (32-bit values take up to 5 bytes, strings are sent
+//  whole), and text is already formatted straight into TX buffer without
+//  printf (see fastFormat.h), which costs little more than varint encoding
+//#define _DLOG_DEFERRED_
+
+//  Log levels
+#define DLOG_LVL_DEBUG      0
+#define DLOG_LVL_INFO       1
+#define DLOG_LVL_WARN       2
+#define DLOG_LVL_ERROR      3
+//  Records below this level are removed at compile time
+#define DLOG_LEVEL          DLOG_LVL_INFO
+
+//  Longest string argument that is recorded, rest is cut off
+#define DLOG_MAX_STR        32
+//  Batch is sent once its oldest record is this old (in ms)
+#define DLOG_FLUSH_MS       50
+
+/**
+ * Entry in format table
+ */
+struct _dlogFmt
+{
+    uint8_t     level;
+    const char  *fmt;
+};
+
+//  IDs of formats (DLOG_ID_<NAME>) and their levels (DLOG_LVL_<NAME>)
+#define DLOG_FMT(NAME, LVL, FMT) DLOG_ID_##NAME,
+enum
+{
+#include "logFormats.h"
+    DLOG_NUM_FMT
+};
+#undef DLOG_FMT
+#define DLOG_FMT(NAME, LVL, FMT) DLOG_LVL_##NAME = LVL,
+enum
+{
+#include "logFormats.h"
+    DLOG_LVL_DUMMY
+};
+#undef DLOG_FMT
+
+extern const struct _dlogFmt DLog_Formats[DLOG_NUM_FMT];
+
+/*
+ * Log a record, e.g. DLOG(TM_PRINT_INT, value). Extra trailing 0 is added so
+ * the macro also works with formats taking no arguments
+ */
+#define DLOG(...)           _DLOG(__VA_ARGS__, 0)
+#if defined(_DLOG_DEFERRED_) || defined(__BOARD_HOST__)
+#define _DLOG(NAME, ...)    do { if (DLOG_LVL_##NAME >= DLOG_LEVEL) \
+                                DLog_Emit(DLOG_ID_##NAME, __VA_ARGS__); \
+                            } while (0)
+#else
+#include "uartHW.h"
+#define _DLOG(NAME, ...)    do { if (DLOG_LVL_##NAME >= DLOG_LEVEL) \
+                                DEBUG_WRITE(DLog_Formats[DLOG_ID_##NAME].fmt, \
+                                            __VA_ARGS__); \
+                            } while (0)
+#endif
+
+//  Recording
+extern void     DLog_SetSink(void((*sink)(const uint8_t*, uint16_t)));
+extern void     DLog_Emit(uint16_t id, ...);
+extern void     DLog_Flush(bool force);
+extern uint32_t DLog_Dropped();
+
+//  Decoding of SP_T_LOG payload back into text
+extern uint16_t DLog_TableCRC();
+extern bool     DLog_Decode(const uint8_t *payload, uint16_t len,
+                            void((*line)(uint64_t time, const char *text)));
+
+#endif /* ROVERKERNEL_SERIALPORT_DEFERREDLOG_H_ */
@@ -0,0 +1,650 @@
+/**
+ * fastFormat.cpp
+ *
+ *  Created on: 18. 10. 2026.
+ */
+#include "fastFormat.h"
+
+#include <stddef.h>
+
+//  Flags of a conversion specification
+#define FF_F_LEFT       0x01    //  '-'
+#define FF_F_PLUS       0x02    //  '+'
+#define FF_F_SPACE      0x04    //  ' '
+#define FF_F_ALT        0x08    //  '#'
+#define FF_F_ZERO       0x10    //  '0'
+#define FF_F_UPPER      0x20    //  Upper-case conversion (X, E, G, F)
+
+//  Size of buffer holding a single converted number
+#define FF_BODY_LEN     72
+//  Precision of floats is clamped to this value to fit into the buffer
+#define FF_PREC_CLAMP   (FF_BODY_LEN - 24)
+
+static const char _ffHexL[] = "0123456789abcdef";
+static const char _ffHexU[] = "0123456789ABCDEF";
+static const uint32_t _ffPow10[10] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/**
+ * Parsed conversion specification
+ */
+struct _ffSpec
+{
+    uint8_t flags;
+    int     width;
+    int     prec;       //  -1 if not given
+};
+
+///-----------------------------------------------------------------------------
+///                      Output                                        [PRIVATE]
+///-----------------------------------------------------------------------------
+
+static inline void _FF_Raw(struct _ffOut &out, char c)
+{
+    if (out.len < out.cap)
+        out.buf[(out.start + out.len) & out.mask] = (uint8_t)c;
+    out.len++;
+}
+
+static inline void _FF_Put(struct _ffOut &out, char c)
+{
+    if ((c == '\n') && out.crlf)
+        _FF_Raw(out, '\r');
+    _FF_Raw(out, c);
+}
+
+static void _FF_Fill(struct _ffOut &out, char c, int n)
+{
+    while ((n--) > 0)
+        _FF_Raw(out, c);
+}
+
+/**
+ * Write a converted field, applying width
+ * @param prefix sign and/or base prefix (e.g. "-", "0x"), placed before zeros
+ * @param zeros number of zeros between prefix and body (integer precision)
+ * @param body converted value
+ */
+static void _FF_Field(struct _ffOut &out, const struct _ffSpec &spec,
+                      const char *prefix, int prefixLen, int zeros,
+                      const char *body, int bodyLen)
+{
+    int pad = spec.width - prefixLen - zeros - bodyLen;
+
+    if (!(spec.flags & (FF_F_LEFT | FF_F_ZERO)))
+        _FF_Fill(out, ' ', pad);
+    while ((prefixLen--) > 0)
+        _FF_Raw(out, *(prefix++));
+    if ((spec.flags & (FF_F_LEFT | FF_F_ZERO)) == FF_F_ZERO)
+        _FF_Fill(out, '0', pad);
+    _FF_Fill(out, '0', zeros);
+    while ((bodyLen--) > 0)
+        _FF_Put(out, *(body++));
+    if (spec.flags & FF_F_LEFT)
+        _FF_Fill(out, ' ', pad);
+}
+
+///-----------------------------------------------------------------------------
+///                      Integer conversion                            [PRIVATE]
+///-----------------------------------------------------------------------------
+//  Decimal conversion is shared with the rest of the code, see utoaRev()
+
+/**
+ * Convert unsigned integer to base 8 or 16, writing backwards from [end]
+ * @param shift 3 for octal, 4 for hexadecimal
+ * @return pointer to the first digit
+ */
+static char* _FF_Xtoa(uint64_t val, char *end, uint8_t shift, const char *digits)
+{
+    const uint8_t mask = (1 << shift) - 1;
+
+    do
+    {
+        *(--end) = digits[val & mask];
+        val >>= shift;
+    } while (val != 0);
+
+    return end;
+}
+
+///-----------------------------------------------------------------------------
+///                      Floating-point conversion                     [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Exact rounding error of a product, a * b - p where p is a * b computed in
+ * double (Dekker's algorithm)
+ */
+static double _FF_ProdErr(double a, double b, double p)
+{
+    const double split = 134217729.0;   //  2^27 + 1
+    double t, ah, al, bh, bl;
+
+    t = a * split;
+    ah = t - (t - a);
+    al = a - ah;
+    t = b * split;
+    bh = t - (t - b);
+    bl = b - bh;
+
+    return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+}
+
+/**
+ * Round non-negative val * 10^n to the nearest integer. Sign of the rounding
+ * error of the scaling decides values that end up exactly halfway, exact
+ * halves are rounded to even (the way printf does it).
+ * @param odd parity of the digit preceding the fraction if result is < 1
+ */
+static uint64_t _FF_ScaleRound(double val, int n, bool odd)
+{
+    //  Powers up to 1e22 are exact, dividing by them is more accurate than
+    //  multiplying by inexact negative powers
+    static const double pow10[22] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+        1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21
+    };
+    double s, err, d;
+    uint64_t i;
+
+    //  Very large and very small values are scaled in more steps (inexact)
+    while (n >= 22)
+    {
+        val *= 1e22;
+        n -= 22;
+    }
+    while (n <= -22)
+    {
+        val /= 1e22;
+        n += 22;
+    }
+
+    if (n >= 0)
+    {
+        s = val * pow10[n];
+        err = _FF_ProdErr(val, pow10[n], s);
+    }
+    else
+    {
+        double p;
+
+        s = val / pow10[-n];
+        p = s * pow10[-n];
+        err = (val - p) - _FF_ProdErr(s, pow10[-n], p);
+    }
+
+    i = (uint64_t)s;
+    d = s - (double)i;
+    if ((d > 0.5) ||
+        ((d == 0.5) && ((err > 0) ||
+                        ((err == 0) && ((i & 1) || ((i == 0) && odd))))))
+        i++;
+
+    return i;
+}
+
+/**
+ * Fixed notation (%f) of a non-negative finite value below 1.8e19
+ * @return length of text in dst
+ */
+static int _FF_Fixed(double val, int prec, bool alt, char *dst)
+{
+    int p = (prec > FF_MAX_PREC) ? FF_MAX_PREC : prec, n;
+    uint64_t ip = (uint64_t)val, frac;
+    char tmp[24], *s;
+
+    frac = _FF_ScaleRound(val - (double)ip, p, (p == 0) && (ip & 1));
+    if (frac >= _ffPow10[p])
+    {
+        frac -= _ffPow10[p];
+        ip++;
+    }
+
+    s = utoaRev(ip, tmp + sizeof(tmp));
+    n = (int)(tmp + sizeof(tmp) - s);
+    memcpy(dst, s, n);
+
+    if ((prec > 0) || alt)
+        dst[n++] = '.';
+    if (p > 0)
+    {
+        s = utoaRev((uint32_t)frac, dst + n + p);
+        while (s > (dst + n))
+            *(--s) = '0';
+        n += p;
+    }
+    memset(dst + n, '0', prec - p);
+
+    return n + prec - p;
+}
+
+/**
+ * Exponential notation (%e) of a non-negative finite value
+ * @param exp exponent of the printed value
+ * @return length of text in dst
+ */
+static int _FF_Exp(double val, int prec, uint8_t flags, char *dst, int &exp)
+{
+    int p = (prec > FF_MAX_PREC) ? FF_MAX_PREC : prec, n;
+    uint64_t m = 0, lim = (uint64_t)_ffPow10[p] * 10;
+    char tmp[24], *s;
+
+    exp = 0;
+    if (val != 0)
+    {
+        exp = (int)floor(log10(val));
+        m = _FF_ScaleRound(val, p - exp, false);
+        //  log10() can be off by one close to powers of 10
+        if (m >= lim)
+            m = _FF_ScaleRound(val, p - (++exp), false);
+        else if (m < _ffPow10[p])
+            m = _FF_ScaleRound(val, p - (--exp), false);
+        if (m >= lim)
+        {
+            m /= 10;
+            exp++;
+        }
+    }
+
+    s = utoaRev(m, tmp + sizeof(tmp));
+    while (s > (tmp + sizeof(tmp) - p - 1))
+        *(--s) = '0';
+    dst[0] = *(s++);
+    n = 1;
+    if ((prec > 0) || (flags & FF_F_ALT))
+        dst[n++] = '.';
+    memcpy(dst + n, s, p);
+    n += p;
+    memset(dst + n, '0', prec - p);
+    n += prec - p;
+
+    dst[n++] = (flags & FF_F_UPPER) ? 'E' : 'e';
+    dst[n++] = (exp < 0) ? '-' : '+';
+    s = utoaRev((exp < 0) ? -exp : exp, tmp + sizeof(tmp));
+    if ((tmp + sizeof(tmp) - s) < 2)
+        *(--s) = '0';
+    memcpy(dst + n, s, tmp + sizeof(tmp) - s);
+
+    return n + (int)(tmp + sizeof(tmp) - s);
+}
+
+/**
+ * Remove trailing zeros of fractional part (and decimal point if nothing is
+ * left after it), used by %g
+ * @return new length of text
+ */
+static int _FF_StripZeros(char *txt, int len)
+{
+    int e = 0, end, i;
+
+    while ((e < len) && (txt[e] != 'e') && (txt[e] != 'E'))
+        e++;
+    if (memchr(txt, '.', e) == 0)
+        return len;
+
+    end = e;
+    while (txt[end - 1] == '0')
+        end--;
+    if (txt[end - 1] == '.')
+        end--;
+    for (i = e; i < len; i++)
+        txt[end + i - e] = txt[i];
+
+    return len - (e - end);
+}
+
+/**
+ * Convert floating-point value, c is one of f F e E g G
+ */
+static void _FF_Float(struct _ffOut &out, struct _ffSpec &spec, char c,
+                      double val)
+{
+    char body[FF_BODY_LEN];
+    const char *sign = 0;
+    uint64_t bits;
+    int len, exp;
+
+    memcpy(&bits, &val, sizeof(bits));
+    if (bits >> 63)
+    {
+        sign = "-";
+        val = -val;
+    }
+    else if (spec.flags & FF_F_PLUS)
+        sign = "+";
+    else if (spec.flags & FF_F_SPACE)
+        sign = " ";
+    if ((c == 'F') || (c == 'E') || (c == 'G'))
+        spec.flags |= FF_F_UPPER;
+
+    if (spec.prec < 0)
+        spec.prec = 6;
+    else if (spec.prec > FF_PREC_CLAMP)
+        spec.prec = FF_PREC_CLAMP;
+
+    if (val != val)
+    {
+        memcpy(body, (spec.flags & FF_F_UPPER) ? "NAN" : "nan", 3);
+        len = 3;
+        spec.flags &= ~FF_F_ZERO;
+    }
+    else if ((val - val) != 0)
+    {
+        memcpy(body, (spec.flags & FF_F_UPPER) ? "INF" : "inf", 3);
+        len = 3;
+        spec.flags &= ~FF_F_ZERO;
+    }
+    else if ((c == 'f') || (c == 'F'))
+    {
+        if (val < 1.8e19)
+            len = _FF_Fixed(val, spec.prec, spec.flags & FF_F_ALT, body);
+        else
+            len = _FF_Exp(val, spec.prec, spec.flags, body, exp);
+    }
+    else if ((c == 'e') || (c == 'E'))
+        len = _FF_Exp(val, spec.prec, spec.flags, body, exp);
+    else
+    {
+        //  %g: precision is number of significant digits
+        int p = (spec.prec == 0) ? 1 : spec.prec;
+
+        len = _FF_Exp(val, p - 1, spec.flags, body, exp);
+        if ((exp < p) && (exp >= -4) && (val < 1.8e19))
+            len = _FF_Fixed(val, p - 1 - exp, spec.flags & FF_F_ALT, body);
+        if (!(spec.flags & FF_F_ALT))
+            len = _FF_StripZeros(body, len);
+    }
+
+    _FF_Field(out, spec, sign, (sign != 0) ? 1 : 0, 0, body, len);
+}
+
+///-----------------------------------------------------------------------------
+///                      Formatting                                     [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Format text into [out] according to printf-style format string
+ * @param out destination, len is advanced by the length of output
+ * @param fmt format string
+ * @param ap arguments
+ * @return total length of output (out.len), including what didn't fit
+ */
+uint32_t FF_VFormat(struct _ffOut &out, const char *fmt, va_list ap)
+{
+    while (*fmt != '\0')
+    {
+        struct _ffSpec spec;
+        char body[FF_BODY_LEN], *end = body + sizeof(body), *s = end, lenMod = 0;
+        const char *prefix = "";
+        int prefixLen = 0, zeros = 0;
+        uint64_t uval;
+
+        //  Copy literal text
+        if (*fmt != '%')
+        {
+            _FF_Put(out, *(fmt++));
+            continue;
+        }
+        fmt++;
+
+        //  Flags
+        spec.flags = 0;
+        for (;; fmt++)
+        {
+            if (*fmt == '-')        spec.flags |= FF_F_LEFT;
+            else if (*fmt == '+')   spec.flags |= FF_F_PLUS;
+            else if (*fmt == ' ')   spec.flags |= FF_F_SPACE;
+            else if (*fmt == '#')   spec.flags |= FF_F_ALT;
+            else if (*fmt == '0')   spec.flags |= FF_F_ZERO;
+            else                    break;
+        }
+        //  Width
+        spec.width = 0;
+        if (*fmt == '*')
+        {
+            spec.width = va_arg(ap, int);
+            if (spec.width < 0)
+            {
+                spec.flags |= FF_F_LEFT;
+                spec.width = -spec.width;
+            }
+            fmt++;
+        }
+        else
+            while ((*fmt >= '0') && (*fmt <= '9'))
+                spec.width = spec.width * 10 + (*(fmt++) - '0');
+        //  Precision
+        spec.prec = -1;
+        if (*fmt == '.')
+        {
+            fmt++;
+            spec.prec = 0;
+            if (*fmt == '*')
+            {
+                spec.prec = va_arg(ap, int);
+                if (spec.prec < 0)
+                    spec.prec = -1;
+                fmt++;
+            }
+            else
+                while ((*fmt >= '0') && (*fmt <= '9'))
+                    spec.prec = spec.prec * 10 + (*(fmt++) - '0');
+        }
+        //  Length modifier: H for hh, q for ll/j, z for z/t
+        switch (*fmt)
+        {
+        case 'h':
+            lenMod = (*(++fmt) == 'h') ? (fmt++, 'H') : 'h';
+            break;
+        case 'l':
+            lenMod = (*(++fmt) == 'l') ? (fmt++, 'q') : 'l';
+            break;
+        case 'j':
+            lenMod = 'q';
+            fmt++;
+            break;
+        case 'z':
+        case 't':
+            lenMod = 'z';
+            fmt++;
+            break;
+        case 'L':
+            lenMod = 'L';
+            fmt++;
+            break;
+        }
+
+        if (*fmt == '\0')
+            break;
+        if (spec.flags & FF_F_LEFT)
+            spec.flags &= ~FF_F_ZERO;
+
+        switch (*fmt)
+        {
+        case 'd':
+        case 'i':
+            {
+                int64_t val;
+
+                if (lenMod == 'H')
+                    val = (signed char)va_arg(ap, int);
+                else if (lenMod == 'h')
+                    val = (short)va_arg(ap, int);
+                else if (lenMod == 'l')
+                    val = va_arg(ap, long);
+                else if ((lenMod == 'q') || (lenMod == 'L'))
+                    val = va_arg(ap, long long);
+                else if (lenMod == 'z')
+                    val = va_arg(ap, ptrdiff_t);
+                else
+                    val = va_arg(ap, int);
+
+                if (val < 0)
+                {
+                    prefix = "-";
+                    uval = 0 - (uint64_t)val;
+                }
+                else
+                {
+                    uval = (uint64_t)val;
+                    if (spec.flags & FF_F_PLUS)
+                        prefix = "+";
+                    else if (spec.flags & FF_F_SPACE)
+                        prefix = " ";
+                }
+                prefixLen = (*prefix != '\0') ? 1 : 0;
+                if ((uval != 0) || (spec.prec != 0))
+                    s = utoaRev(uval, end);
+            }
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            if (lenMod == 'H')
+                uval = (unsigned char)va_arg(ap, unsigned int);
+            else if (lenMod == 'h')
+                uval = (unsigned short)va_arg(ap, unsigned int);
+            else if (lenMod == 'l')
+                uval = va_arg(ap, unsigned long);
+            else if ((lenMod == 'q') || (lenMod == 'L'))
+                uval = va_arg(ap, unsigned long long);
+            else if (lenMod == 'z')
+                uval = va_arg(ap, size_t);
+            else
+                uval = va_arg(ap, unsigned int);
+
+            if ((uval != 0) || (spec.prec != 0))
+            {
+                if (*fmt == 'u')
+                    s = utoaRev(uval, end);
+                else if (*fmt == 'o')
+                    s = _FF_Xtoa(uval, end, 3, _ffHexL);
+                else
+                    s = _FF_Xtoa(uval, end, 4, (*fmt == 'x') ? _ffHexL : _ffHexU);
+            }
+            if (!(spec.flags & FF_F_ALT))
+                break;
+            if ((*fmt == 'o') && ((s == end) || (*s != '0')))
+                *(--s) = '0';
+            else if (((*fmt == 'x') || (*fmt == 'X')) && (uval != 0))
+            {
+                prefix = (*fmt == 'x') ? "0x" : "0X";
+                prefixLen = 2;
+            }
+            break;
+        case 'p':
+            uval = (uintptr_t)va_arg(ap, void*);
+            spec.flags &= ~FF_F_ZERO;
+            if (uval == 0)
+            {
+                memcpy(body, "(nil)", 5);
+                _FF_Field(out, spec, "", 0, 0, body, 5);
+                fmt++;
+                continue;
+            }
+            s = _FF_Xtoa(uval, end, 4, _ffHexL);
+            prefix = "0x";
+            prefixLen = 2;
+            break;
+        case 'c':
+            body[0] = (char)va_arg(ap, int);
+            spec.flags &= ~FF_F_ZERO;
+            _FF_Field(out, spec, "", 0, 0, body, 1);
+            fmt++;
+            continue;
+        case 's':
+            {
+                const char *str = va_arg(ap, const char*);
+                int len = 0;
+
+                if (str == 0)
+                    str = "(null)";
+                if (spec.prec < 0)
+                    len = (int)strlen(str);
+                else
+                    while ((len < spec.prec) && (str[len] != '\0'))
+                        len++;
+                spec.flags &= ~FF_F_ZERO;
+                _FF_Field(out, spec, "", 0, 0, str, len);
+                fmt++;
+            }
+            continue;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            if (lenMod == 'L')
+                _FF_Float(out, spec, *fmt, (double)va_arg(ap, long double));
+            else
+                _FF_Float(out, spec, *fmt, va_arg(ap, double));
+            fmt++;
+            continue;
+        case 'n':
+            (void)va_arg(ap, void*);
+            fmt++;
+            continue;
+        case '%':
+            _FF_Raw(out, '%');
+            fmt++;
+            continue;
+        default:
+            //  Unknown conversion is printed as is
+            _FF_Raw(out, '%');
+            _FF_Put(out, *(fmt++));
+            continue;
+        }
+
+        //  Integer conversions end here; precision gives minimum number of
+        //  digits and disables zero padding
+        if (spec.prec >= 0)
+        {
+            spec.flags &= ~FF_F_ZERO;
+            if (spec.prec > (end - s))
+                zeros = spec.prec - (int)(end - s);
+        }
+        _FF_Field(out, spec, prefix, prefixLen, zeros, s, (int)(end - s));
+        fmt++;
+    }
+
+    return out.len;
+}
+
+/**
+ * Format text into linear buffer, always null-terminated if [size] > 0
+ * @return length of complete output (as snprintf)
+ */
+int FF_Vsnprintf(char *dst, uint16_t size, const char *fmt, va_list ap)
+{
+    struct _ffOut out;
+
+    out.buf = (uint8_t*)dst;
+    out.mask = 0xFFFF;
+    out.start = 0;
+    out.cap = (size > 0) ? (size - 1) : 0;
+    out.crlf = false;
+    out.len = 0;
+
+    FF_VFormat(out, fmt, ap);
+    if (size > 0)
+        dst[(out.len < out.cap) ? out.len : out.cap] = '\0';
+
+    return (int)out.len;
+}
+
+int FF_Snprintf(char *dst, uint16_t size, const char *fmt, ...)
+{
+    va_list ap;
+    int len;
+
+    va_start(ap, fmt);
+    len = FF_Vsnprintf(dst, size, fmt, ap);
+    va_end(ap);
+
+    return len;
+}
@@ -0,0 +1,71 @@
+/**
+ *  fastFormat.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Allocation-free printf-compatible formatter
+ *  @version 1.0
+ *  V1.0
+ *  +Formats straight into caller-provided memory, either a linear buffer or
+ *  free space of a ring buffer (wrap-around is handled while writing), so
+ *  SerialPort::Send() no longer needs an intermediate line buffer. Output
+ *  that doesn't fit is counted but not stored, so caller can make room and
+ *  format again.
+ *  +Integers are converted two digits at a time (utoaRev() from myLib),
+ *  64-bit values are split into 32-bit chunks so no 64-bit division is done
+ *  per digit
+ *  +Floats (%f %e %g) are formatted with requested precision and proper
+ *  rounding of negative numbers (replaces _FTOI_ macro)
+ *  +Optional LF -> CR-LF expansion while writing
+ *
+ *  Supported: flags - + space # 0, width and precision (including *),
+ *  length modifiers hh h l ll z j t L, conversions d i u x X o c s p f F e E
+ *  g G %. %n is not supported.
+ *  @note Precision of floats is limited to FF_MAX_PREC digits, extra digits
+ *  are printed as 0. Values of magnitude 1e19 and above are printed by %f in
+ *  exponential form.
+ */
+#include "hwconfig.h"
+#include "libs/myLib.h"
+
+#include <stdarg.h>
+
+#ifndef ROVERKERNEL_SERIALPORT_FASTFORMAT_H_
+#define ROVERKERNEL_SERIALPORT_FASTFORMAT_H_
+
+//  Highest precision of floating-point conversions that is computed exactly
+#define FF_MAX_PREC     9
+
+/*
+ * Let compiler check format string against arguments, F is position of the
+ * format string and A position of the first argument (implicit 'this' counts
+ * as the first parameter of member functions)
+ */
+#if defined(__GNUC__) || defined(__TI_GNU_ATTRIBUTE_SUPPORT__)
+#define _PRINTF_FMT_(F, A)  __attribute__((format(printf, F, A)))
+#else
+#define _PRINTF_FMT_(F, A)
+#endif
+
+/**
+ * Destination of formatted output
+ * Byte i of output is stored at buf[(start + i) & mask] for i < cap; the rest
+ * is only counted in len. For linear buffers use start = 0, mask = 0xFFFF.
+ */
+struct _ffOut
+{
+    uint8_t     *buf;
+    uint16_t    mask;
+    uint16_t    start;
+    uint16_t    cap;
+    bool        crlf;   //  Expand every \n into \r\n
+    uint32_t    len;    //  Length of complete output, even if it didn't fit
+};
+
+extern uint32_t FF_VFormat(struct _ffOut &out, const char *fmt, va_list ap);
+extern int      FF_Snprintf(char *dst, uint16_t size, const char *fmt, ...)
+                _PRINTF_FMT_(3, 4);
+extern int      FF_Vsnprintf(char *dst, uint16_t size, const char *fmt,
+                             va_list ap);
+
+#endif /* ROVERKERNEL_SERIALPORT_FASTFORMAT_H_ */
@@ -0,0 +1,44 @@
+/**
+ *  logFormats.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Table of format strings used by deferred logging (see deferredLog.h)
+ *  Every entry is DLOG_FMT(NAME, LEVEL, "format"). Position of the entry in
+ *  this file is the ID sent over the link instead of the text, so the same
+ *  table has to be compiled into firmware and into the host decoder
+ *  (host/dlogDecode.cpp). Decoder detects a mismatch through a checksum of the
+ *  table sent with every batch of records. Append new entries at the end.
+ *
+ *  Supported conversions: %d %i %u %x %X %o %c %p %s %f %F %e %E %g %G %%, with
+ *  flags, width, precision (including *) and h/hh/l/ll length modifiers.
+ *  @note No include guard on purpose, file is included several times with
+ *  different definitions of DLOG_FMT()
+ */
+
+//  Task scheduler
+DLOG_FMT(TS_NOW,            DLOG_LVL_DEBUG, "Now is %u \n")
+DLOG_FMT(TS_PROCESS,        DLOG_LVL_DEBUG, "Processing %d:%d at %u ms\n")
+DLOG_FMT(TS_PROCESS_ARGS,   DLOG_LVL_DEBUG, "-(%d)> %s\n")
+
+//  Event logger
+DLOG_FMT(EL_EVENT,          DLOG_LVL_INFO,
+         "\t[%u] Module %d raised event %s during task %d \n")
+
+//  Test module
+DLOG_FMT(TM_PRINT_INT,      DLOG_LVL_INFO,  "I'm service 0 printing int16_t: %d\n")
+DLOG_FMT(TM_PRINT_STR,      DLOG_LVL_INFO,  "I'm service 1 printing a string: %s\n")
+DLOG_FMT(TM_PRINT_STR_ERR,  DLOG_LVL_WARN,
+         "I'm service 1 printing a string but there was an error with you string\n")
+DLOG_FMT(TM_PRINT_FLOAT,    DLOG_LVL_INFO,  "I'm service 2 printing float: %.2f\n")
+
+//  Event logger, summary of dropped events
+DLOG_FMT(EL_SUPPRESSED,     DLOG_LVL_INFO,
+         "\t[%u] Module %d dropped %d events %s\n")
+
+//  Task scheduler, profiling statistics (TASKSCHED_T_PROF_REPORT)
+DLOG_FMT(TS_PROF,           DLOG_LVL_INFO,
+         "Service %d from module %d: %u runs, runtime %u.%03u s (max %u ms), "
+         "start missed %u times by %u ms\n")
+DLOG_FMT(TS_PROF_DROPPED,   DLOG_LVL_INFO,
+         "Dispatches not profiled (table full): %u\n")
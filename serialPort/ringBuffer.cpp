@@ -0,0 +1,97 @@
+/**
+ * ringBuffer.cpp
+ *
+ *  Created on: 18. 10. 2026.
+ */
+#include "ringBuffer.h"
+
+/**
+ * Create ring buffer on top of provided memory
+ * @param buf memory used to store data
+ * @param size size of [buf], has to be a power of 2 (at most 32768)
+ */
+RingBuffer::RingBuffer(uint8_t *buf, uint16_t size)
+    : _buf(buf), _mask(size - 1), _head(0), _tail(0)
+{
+}
+
+/**
+ * Append data to buffer (writer side); copies as much data as fits
+ * @param data data to append
+ * @param len length of [data]
+ * @return number of bytes written into buffer
+ */
+uint16_t RingBuffer::Write(const uint8_t *data, uint16_t len)
+{
+    uint16_t head = _head,
+             n = Free(),
+             first;
+
+    if (len < n)
+        n = len;
+
+    //  Copy in at most two pieces: up to the end of memory, then from start
+    first = Size() - (head & _mask);
+    if (first > n)
+        first = n;
+    memcpy(_buf + (head & _mask), data, first);
+    memcpy(_buf, data + first, n - first);
+
+    HAL_BOARD_MemBarrier();
+    _head = head + n;
+
+    return n;
+}
+
+/**
+ * Take data out of buffer (reader side)
+ * @param dst destination buffer
+ * @param maxLen size of [dst]
+ * @return number of bytes copied into dst
+ */
+uint16_t RingBuffer::Read(uint8_t *dst, uint16_t maxLen)
+{
+    uint16_t tail = _tail,
+             n = Used(),
+             first;
+
+    if (maxLen < n)
+        n = maxLen;
+
+    HAL_BOARD_MemBarrier();
+    first = Size() - (tail & _mask);
+    if (first > n)
+        first = n;
+    memcpy(dst, _buf + (tail & _mask), first);
+    memcpy(dst + first, _buf, n - first);
+
+    HAL_BOARD_MemBarrier();
+    _tail = tail + n;
+
+    return n;
+}
+
+/**
+ * Drop the oldest data from buffer (reader side)
+ * @param len number of bytes to drop
+ * @return number of bytes actually dropped
+ */
+uint16_t RingBuffer::Discard(uint16_t len)
+{
+    uint16_t n = Used();
+
+    if (len < n)
+        n = len;
+    _tail = _tail + n;
+
+    return n;
+}
+
+/**
+ * Drop all data from buffer, neither reader nor writer can be active
+ */
+void RingBuffer::Reset()
+{
+    _head = 0;
+    _tail = 0;
+}
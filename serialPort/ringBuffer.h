@@ -0,0 +1,140 @@
+/**
+ *  ringBuffer.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Byte ring buffer used for buffering data sent or received on serial port
+ *  @version 1.1
+ *  V1.0
+ *  +Fixed-size FIFO over caller-provided memory. Head is only moved by the
+ *  writer and tail only by the reader, so a single writer and a single reader
+ *  (e.g. main loop and an ISR) can use it concurrently without disabling
+ *  interrupts. Anything else (several writers, discarding data from writer's
+ *  side) has to be protected by the caller.
+ *  V1.1
+ *  +Writer can produce data in place (Memory()/Head()/Commit()), e.g. format
+ *  text straight into the buffer
+ *  @note Size of buffer has to be a power of 2, at most 32768 bytes
+ */
+#include "hwconfig.h"
+#include "HAL/hal.h"
+#include "libs/myLib.h"
+
+#ifndef ROVERKERNEL_SERIALPORT_RINGBUFFER_H_
+#define ROVERKERNEL_SERIALPORT_RINGBUFFER_H_
+
+class RingBuffer
+{
+    public:
+        RingBuffer(uint8_t *buf, uint16_t size);
+
+        uint16_t    Write(const uint8_t *data, uint16_t len);
+        uint16_t    Read(uint8_t *dst, uint16_t maxLen);
+        uint16_t    Discard(uint16_t len);
+        void        Reset();
+
+        ///---------------------------------------------------------------------
+        ///                      Inline functions                       [PUBLIC]
+        ///---------------------------------------------------------------------
+        /**
+         * Return total capacity of the buffer (in bytes)
+         */
+        inline uint16_t Size() const
+        {
+            return _mask + 1;
+        }
+        /**
+         * Return number of bytes waiting to be read
+         */
+        inline uint16_t Used() const
+        {
+            return (uint16_t)(_head - _tail);
+        }
+        /**
+         * Return number of bytes that can be written without overwriting data
+         */
+        inline uint16_t Free() const
+        {
+            return Size() - Used();
+        }
+        /**
+         * Check whether there is any data to read
+         */
+        inline bool IsEmpty() const
+        {
+            return (_head == _tail);
+        }
+        /**
+         * Append single byte (writer side)
+         * @return true if byte has been stored, false if buffer is full
+         */
+        inline bool Put(uint8_t byte)
+        {
+            uint16_t head = _head;
+
+            if ((uint16_t)(head - _tail) > _mask)
+                return false;
+
+            _buf[head & _mask] = byte;
+            //  Data has to be in memory before reader can see new head
+            HAL_BOARD_MemBarrier();
+            _head = head + 1;
+
+            return true;
+        }
+        /**
+         * Take single byte out of the buffer (reader side)
+         * @return true if byte has been read, false if buffer is empty
+         */
+        inline bool Get(uint8_t &byte)
+        {
+            uint16_t tail = _tail;
+
+            if (tail == _head)
+                return false;
+
+            HAL_BOARD_MemBarrier();
+            byte = _buf[tail & _mask];
+            //  Byte has to be read before writer can reuse its place
+            HAL_BOARD_MemBarrier();
+            _tail = tail + 1;
+
+            return true;
+        }
+
+        /**
+         * Writer-side access to free space, for producing data in place:
+         * byte i (i < Free()) is stored at Memory()[(Head() + i) & Mask()]
+         * and becomes visible to the reader once Commit() is called
+         */
+        inline uint8_t* Memory() const
+        {
+            return _buf;
+        }
+        inline uint16_t Mask() const
+        {
+            return _mask;
+        }
+        inline uint16_t Head() const
+        {
+            return _head;
+        }
+        /**
+         * Publish [len] bytes written in place after Head() (writer side)
+         */
+        inline void Commit(uint16_t len)
+        {
+            //  Data has to be in memory before reader can see new head
+            HAL_BOARD_MemBarrier();
+            _head = _head + len;
+        }
+
+    private:
+        uint8_t             *_buf;
+        uint16_t            _mask;
+        //  Free-running indexes, wrap-around is handled by 16-bit arithmetic
+        volatile uint16_t   _head;
+        volatile uint16_t   _tail;
+};
+
+#endif /* ROVERKERNEL_SERIALPORT_RINGBUFFER_H_ */
@@ -0,0 +1,411 @@
+/**
+ * serialProto.cpp
+ *
+ *  Created on: 18. 10. 2026.
+ */
+#include "serialProto.h"
+
+#if defined(__HAL_USE_TASKSCH__)
+#include "taskScheduler/taskScheduler.h"
+#endif
+#if defined(__HAL_USE_EVENTLOG__)
+#include "init/eventLog.h"
+#include "init/evlogCodec.h"
+#endif
+
+//  States of frame decoder
+#define SP_S_HUNT       0   //  Waiting for SOF
+#define SP_S_LEN        1
+#define SP_S_SEQ        2
+#define SP_S_TYPE       3
+#define SP_S_PAYLOAD    4
+#define SP_S_CRCL       5
+#define SP_S_CRCH       6
+
+//  Number of tasks sent in a single TASKS frame (worst case 20 bytes each)
+#define SP_TASKS_PER_FRAME  12
+//  Highest number of event log entries sent in reply to a single GETEVENTS
+#define SP_EVENTS_PER_REQ   64
+
+///-----------------------------------------------------------------------------
+///                      CRC & encoding                                 [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Update CRC-CCITT (poly 0x1021) with a block of data. Processes a byte at a
+ * time with shifts instead of a lookup table
+ * @param crc current value of CRC (0xFFFF for a new block)
+ * @param data data to process
+ * @param len length of [data]
+ * @return updated CRC
+ */
+uint16_t SP_Crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    while (len--)
+    {
+        uint16_t x = (crc >> 8) ^ *(data++);
+
+        x ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+/**
+ * Build a frame around the payload
+ * @param type type of frame (one of SP_T_*)
+ * @param seq sequence number
+ * @param payload payload of frame (can be 0 if len is 0)
+ * @param len length of payload
+ * @param dst destination buffer, at least len + SP_OVERHEAD bytes long
+ * @return length of encoded frame
+ */
+uint16_t SP_Encode(uint8_t type, uint8_t seq, const uint8_t *payload,
+                   uint8_t len, uint8_t *dst)
+{
+    if (len > 0)
+        memcpy(SP_PAYLOAD(dst), payload, len);
+
+    return SP_Frame(type, seq, len, dst);
+}
+
+/**
+ * Build a frame around the payload already placed at SP_PAYLOAD(dst), saves
+ * copying when payload is written straight into the frame buffer
+ * @param type type of frame (one of SP_T_*)
+ * @param seq sequence number
+ * @param len length of payload
+ * @param dst frame buffer, at least len + SP_OVERHEAD bytes long
+ * @return length of encoded frame
+ */
+uint16_t SP_Frame(uint8_t type, uint8_t seq, uint8_t len, uint8_t *dst)
+{
+    uint16_t crc;
+
+    dst[0] = SP_SOF;
+    dst[1] = len;
+    dst[2] = seq;
+    dst[3] = type;
+
+    crc = SP_Crc16(0xFFFF, dst + 1, len + 3);
+    dst[len + 4] = (uint8_t)(crc & 0xFF);
+    dst[len + 5] = (uint8_t)(crc >> 8);
+
+    return len + SP_OVERHEAD;
+}
+
+///-----------------------------------------------------------------------------
+///                      Streaming decoder                              [PUBLIC]
+///-----------------------------------------------------------------------------
+
+SPDecoder::SPDecoder() : frames(0), crcErrors(0), skipped(0),
+                         _state(SP_S_HUNT), _crc(0xFFFF), _idx(0)
+{
+    _frame.len = 0;
+}
+
+/**
+ * Feed next received byte into decoder
+ * @param byte received byte
+ * @return true if byte completed a valid frame (read it with GetFrame())
+ */
+bool SPDecoder::Feed(uint8_t byte)
+{
+    //  Every byte between SOF and CRC is covered by CRC
+    if ((_state != SP_S_HUNT) && (_state < SP_S_CRCL))
+        _crc = SP_Crc16(_crc, &byte, 1);
+
+    switch (_state)
+    {
+    case SP_S_HUNT:
+        if (byte == SP_SOF)
+        {
+            _crc = 0xFFFF;
+            _state = SP_S_LEN;
+        }
+        else
+            skipped++;
+        break;
+    case SP_S_LEN:
+        _frame.len = byte;
+        _state = SP_S_SEQ;
+        break;
+    case SP_S_SEQ:
+        _frame.seq = byte;
+        _state = SP_S_TYPE;
+        break;
+    case SP_S_TYPE:
+        _frame.type = byte;
+        _idx = 0;
+        _state = (_frame.len > 0) ? SP_S_PAYLOAD : SP_S_CRCL;
+        break;
+    case SP_S_PAYLOAD:
+        _frame.payload[_idx++] = byte;
+        if (_idx >= _frame.len)
+            _state = SP_S_CRCL;
+        break;
+    case SP_S_CRCL:
+        _idx = byte;
+        _state = SP_S_CRCH;
+        break;
+    case SP_S_CRCH:
+        _state = SP_S_HUNT;
+        if ((_idx | ((uint16_t)byte << 8)) == _crc)
+        {
+            frames++;
+            return true;
+        }
+        crcErrors++;
+        break;
+    default:
+        Reset();
+        break;
+    }
+
+    return false;
+}
+
+/**
+ * Drop partially received frame and wait for the next SOF
+ */
+void SPDecoder::Reset()
+{
+    _state = SP_S_HUNT;
+    _crc = 0xFFFF;
+    _idx = 0;
+}
+
+/**
+ * Return last frame completed by Feed()
+ */
+const struct _spFrame& SPDecoder::GetFrame() const
+{
+    return _frame;
+}
+
+#if defined(__HAL_USE_TASKSCH__)
+
+///-----------------------------------------------------------------------------
+///                      Command dispatcher                             [PUBLIC]
+///-----------------------------------------------------------------------------
+
+//  Buffer for reply frames, payload is written straight into it (dispatcher
+//  is only ever called from one context so a single buffer is enough)
+static uint8_t _spTx[SP_MAX_FRAME];
+
+/**
+ * Send reply frame whose payload has been placed at SP_PAYLOAD(_spTx)
+ */
+static inline void _SP_Reply(void((*send)(const uint8_t*, uint16_t)),
+                             uint8_t type, uint8_t seq, uint8_t len)
+{
+    send(_spTx, SP_Frame(type, seq, len, _spTx));
+}
+
+/**
+ * Acknowledge execution of a command
+ */
+static void _SP_Ack(void((*send)(const uint8_t*, uint16_t)),
+                    const struct _spFrame &frame, uint8_t status)
+{
+    SP_PAYLOAD(_spTx)[0] = frame.type;
+    SP_PAYLOAD(_spTx)[1] = status;
+    _SP_Reply(send, SP_T_ACK, frame.seq, 2);
+}
+
+/**
+ * Execute a command frame received from PC
+ * @param frame decoded command frame
+ * @param send function used to transmit encoded reply frames
+ */
+void SP_Dispatch(const struct _spFrame &frame,
+                 void((*send)(const uint8_t*, uint16_t)))
+{
+    TaskScheduler &ts = TaskScheduler::GetI();
+    const uint8_t *p = frame.payload,
+                  *end = frame.payload + frame.len;
+    uint64_t v[3];
+    uint8_t n;
+
+    switch (frame.type)
+    {
+    /*
+     *  Schedule a new task
+     *  payload = libUID | taskID | time(zz) | period(zz) | repeats(zz)
+     */
+    case SP_T_SYNC:
+        {
+            uint8_t libUID, taskID;
+
+            if (frame.len < 5)
+                break;
+            libUID = *(p++);
+            taskID = *(p++);
+            for (uint8_t i = 0; i < 3; i++)
+            {
+                if ((n = getVarint(p, end, &v[i])) == 0)
+                    break;
+                p += n;
+            }
+            if ((n == 0) || (p != end))
+                break;
+
+            if (!TaskScheduler::ValidKernModule(libUID))
+            {
+                _SP_Ack(send, frame, STATUS_ARG_ERR);
+                return;
+            }
+
+            if (unzigzag(v[1]) == 0)
+                ts.SyncTask(libUID, taskID, unzigzag(v[0]));
+            else
+                ts.SyncTaskPer(libUID, taskID, unzigzag(v[0]),
+                               (int32_t)unzigzag(v[1]),
+                               (int32_t)unzigzag(v[2]));
+            _SP_Ack(send, frame, STATUS_OK);
+        }
+        return;
+    /*
+     *  Append arguments to the task added by last SYNC
+     *  payload = args[len]
+     */
+    case SP_T_ARGS:
+        ts.AddArgs((void*)frame.payload, frame.len);
+        _SP_Ack(send, frame, STATUS_OK);
+        return;
+    /*
+     *  Remove task by its PID
+     *  payload = PID(v)
+     */
+    case SP_T_KILLPID:
+        if (((n = getVarint(p, end, &v[0])) == 0) || ((p + n) != end))
+            break;
+        _SP_Ack(send, frame,
+                ts.RemoveTask((uint16_t)v[0]) ? STATUS_OK : STATUS_ARG_ERR);
+        return;
+    /*
+     *  Remove task by its content
+     *  payload = libUID | taskID | args[len-2]
+     */
+    case SP_T_KILL:
+        if (frame.len < 2)
+            break;
+        ts.RemoveTask(p[0], p[1], (void*)(p + 2), frame.len - 2);
+        _SP_Ack(send, frame, STATUS_OK);
+        return;
+    /*
+     *  Report current time of task scheduler
+     *  payload = none
+     */
+    case SP_T_GETTIME:
+        {
+            n = putVarint(TS_GetTimeMS(), SP_PAYLOAD(_spTx));
+            _SP_Reply(send, SP_T_TIME, frame.seq, n);
+        }
+        return;
+    /*
+     *  Report all pending tasks, page by page, closed by an empty frame
+     *  payload = none
+     */
+    case SP_T_GETTASKS:
+        {
+            struct _tsTaskInfo tasks[SP_TASKS_PER_FRAME];
+            struct _tsSnapCursor cursor;
+            uint8_t *payload = SP_PAYLOAD(_spTx);
+            uint32_t Ntasks;
+
+            do
+            {
+                uint16_t len = 0;
+
+                Ntasks = ts.SnapshotPage(tasks, SP_TASKS_PER_FRAME, cursor);
+                for (uint32_t i = 0; i < Ntasks; i++)
+                {
+                    len += putVarint(tasks[i].PID, payload + len);
+                    payload[len++] = tasks[i].libUID;
+                    payload[len++] = tasks[i].taskID;
+                    len += putVarint(tasks[i].timestamp, payload + len);
+                    len += putVarint(zigzag(tasks[i].period), payload + len);
+                    len += putVarint(zigzag(tasks[i].repeats), payload + len);
+                }
+                _SP_Reply(send, SP_T_TASKS, frame.seq, (uint8_t)len);
+            }
+            while (Ntasks > 0);
+        }
+        return;
+#if defined(__HAL_USE_EVENTLOG__)
+    /*
+     *  Report event log entries starting with given sequence number, closed
+     *  by a frame holding the sequence number to continue from
+     *  payload = seq(v) | maxN(v)
+     */
+    case SP_T_GETEVENTS:
+        {
+            EventLog &el = EventLog::GetI();
+            struct _evIter it;
+            struct _eventEntry entry;
+            uint8_t *payload = SP_PAYLOAD(_spTx), buf[EVC_MAX_ENTRY];
+            uint32_t sent = 0, next = 0;
+            uint16_t len = 0;
+            uint64_t prev = 0;
+
+            for (uint8_t i = 0; i < 2; i++)
+            {
+                if ((n = getVarint(p, end, &v[i])) == 0)
+                    break;
+                p += n;
+            }
+            if ((n == 0) || (p != end))
+                break;
+            if (v[1] > SP_EVENTS_PER_REQ)
+                v[1] = SP_EVENTS_PER_REQ;
+
+            it = el.SeekSeq((uint32_t)v[0]);
+            while ((sent < v[1]) && el.Next(it, entry))
+            {
+                uint32_t seq = it.seq - 1;
+
+                //  Entry goes into the current frame if it fits and directly
+                //  follows the previous one, otherwise a new frame starts
+                //  with its own sequence number and sync point
+                n = EVC_PutEntry(buf, entry, prev);
+                if ((len > 0) &&
+                    ((seq != next) || ((len + n) > SP_MAX_PAYLOAD)))
+                {
+                    _SP_Reply(send, SP_T_EVENTS, frame.seq, (uint8_t)len);
+                    len = 0;
+                }
+                if (len == 0)
+                {
+                    len = putVarint(seq, payload);
+                    len += EVC_PutHeader(payload + len, entry.timestamp);
+                    n = EVC_PutEntry(buf, entry, entry.timestamp);
+                }
+                memcpy(payload + len, buf, n);
+                len += n;
+
+                prev = entry.timestamp;
+                next = seq + 1;
+                sent++;
+            }
+            if (len > 0)
+                _SP_Reply(send, SP_T_EVENTS, frame.seq, (uint8_t)len);
+
+            //  Nothing past [seq]: report where the log ends, which is lower
+            //  than [seq] if the log was restarted in the meantime
+            if (sent == 0)
+                next = el.EndSeq();
+            _SP_Reply(send, SP_T_EVENTS, frame.seq, putVarint(next, payload));
+        }
+        return;
+#endif  /* __HAL_USE_EVENTLOG__ */
+    default:
+        break;
+    }
+
+    //  Unknown command or malformed payload
+    _SP_Ack(send, frame, STATUS_ARG_ERR);
+}
+
+#endif  /* __HAL_USE_TASKSCH__ */
@@ -0,0 +1,137 @@
+/**
+ *  serialProto.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Framed binary protocol for remote control of the task scheduler over the
+ *  serial port
+ *  @version 1.1
+ *  V1.0
+ *  +Frame encoder, byte-by-byte streaming decoder and dispatcher mapping
+ *  command frames onto TaskScheduler API (SyncTask/SyncTaskPer, AddArgs,
+ *  RemoveTask) and telemetry replies. Codec has no hardware dependencies and
+ *  is built on host as well (see host/spLoop.cpp)
+ *  V1.1 - 18.10.2026
+ *  +GETEVENTS reads event log incrementally: PC asks for entries starting at
+ *  a sequence number and gets them in compact form (see evlogCodec.h), with
+ *  sequence numbers that reveal entries overwritten before they were read
+ *
+ *  Frame layout (all frames, both directions):
+ *      SOF(0xA5) | len | seq | type | payload[len] | CRC16(LSB, MSB)
+ *  len is the length of payload (0-255), seq is chosen by the sender of a
+ *  command and echoed in all replies to it. CRC16 is CRC-CCITT (poly 0x1021,
+ *  init 0xFFFF) over len, seq, type and payload. Decoder discards bytes until
+ *  it sees SOF so frames can share the link with plain-text debug output.
+ *
+ *  Payloads, integers marked (v) are varints, (zz) zig-zag encoded varints
+ *  (see putVarint() in myLib.h):
+ *   PC -> MCU
+ *      SYNC:       libUID | taskID | time(zz) | period(zz) | repeats(zz)
+ *                  period == 0 schedules one-off task, see SyncTaskPer()
+ *      ARGS:       args[len]                   append args to last SYNC task
+ *      KILLPID:    PID(v)
+ *      KILL:       libUID | taskID | args[len-2]
+ *      GETTIME:    (none)
+ *      GETTASKS:   (none)
+ *      GETEVENTS:  seq(v) | maxN(v)
+ *                  at most maxN event log entries, starting with sequence
+ *                  number seq (see EventLog::SeekSeq())
+ *   MCU -> PC
+ *      ACK:        type of command | status (STATUS_* from myLib.h)
+ *      TIME:       time(v), ms since startup
+ *      TASKS:      0 or more times: PID(v) | libUID | taskID | timestamp(v) |
+ *                  period(zz) | repeats(zz)
+ *                  Reply to GETTASKS is a sequence of TASKS frames, last one
+ *                  being empty
+ *      LOG:        batch of deferred log records, sent unsolicited with its
+ *                  own sequence number (see deferredLog.h)
+ *      EVENTS:     seq(v) | time(v) | entry | entry ...
+ *                  Entries with consecutive sequence numbers, first one
+ *                  being seq; the rest is a block as in evlogCodec.h (decode
+ *                  with EVC_DecodeBlock()). Reply to GETEVENTS is a sequence
+ *                  of EVENTS frames, a new one is started when the frame is
+ *                  full or entries were overwritten in between. Last frame
+ *                  holds only next(v): sequence number to ask for next time.
+ *                  If it's lower than requested seq the log was restarted.
+ */
+#include "hwconfig.h"
+#include "libs/myLib.h"
+
+#ifndef ROVERKERNEL_SERIALPORT_SERIALPROTO_H_
+#define ROVERKERNEL_SERIALPORT_SERIALPROTO_H_
+
+//  Start-of-frame marker
+#define SP_SOF              0xA5
+//  Maximum length of frame payload (in bytes)
+#define SP_MAX_PAYLOAD      255
+//  Bytes added to payload by framing (SOF, len, seq, type, CRC)
+#define SP_OVERHEAD         6
+//  Maximum length of an encoded frame
+#define SP_MAX_FRAME        (SP_MAX_PAYLOAD + SP_OVERHEAD)
+//  Location of payload within an encoded frame
+#define SP_PAYLOAD(X)       ((X) + 4)
+
+//  Command frames (PC -> MCU)
+#define SP_T_SYNC           0x01
+#define SP_T_ARGS           0x02
+#define SP_T_KILLPID        0x03
+#define SP_T_KILL           0x04
+#define SP_T_GETTIME        0x05
+#define SP_T_GETTASKS       0x06
+#define SP_T_GETEVENTS      0x07
+//  Reply/telemetry frames (MCU -> PC)
+#define SP_T_ACK            0x80
+#define SP_T_TIME           0x81
+#define SP_T_TASKS          0x82
+#define SP_T_LOG            0x83
+#define SP_T_EVENTS         0x84
+
+/**
+ * Single decoded frame
+ */
+struct _spFrame
+{
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;                        //  Length of payload
+    uint8_t payload[SP_MAX_PAYLOAD];
+};
+
+/**
+ * Streaming frame decoder
+ * Bytes are fed one at a time (e.g. straight from UART RX interrupt), once
+ * Feed() returns true a complete frame with valid CRC is available through
+ * GetFrame() until the next call to Feed()
+ */
+class SPDecoder
+{
+    public:
+        SPDecoder();
+
+        bool                    Feed(uint8_t byte);
+        void                    Reset();
+
+        const struct _spFrame&  GetFrame() const;
+
+        //  Statistics
+        uint32_t    frames;     //  Number of valid frames received
+        uint32_t    crcErrors;  //  Number of frames dropped due to bad CRC
+        uint32_t    skipped;    //  Number of bytes discarded outside frames
+
+    private:
+        uint8_t         _state;
+        uint16_t        _crc;
+        uint16_t        _idx;
+        struct _spFrame _frame;
+};
+
+extern uint16_t SP_Crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+extern uint16_t SP_Encode(uint8_t type, uint8_t seq, const uint8_t *payload,
+                          uint8_t len, uint8_t *dst);
+extern uint16_t SP_Frame(uint8_t type, uint8_t seq, uint8_t len, uint8_t *dst);
+
+//  Execute command frame, replies are passed to [send] as encoded frames
+extern void     SP_Dispatch(const struct _spFrame &frame,
+                            void((*send)(const uint8_t*, uint16_t)));
+
+#endif /* ROVERKERNEL_SERIALPORT_SERIALPROTO_H_ */
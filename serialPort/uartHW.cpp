@@ -17,8 +17,15 @@
 #include "driverlib/uart.h"
 #include "utils/uartstdio.h"
 
+#include <stdio.h>
+
 #include "uartHW.h"
 
+//  TX_BLOCK waits for the line in steps of UART FIFO size (in bytes) and
+//  duration of one step (in us, 10 bits per byte on the line)
+#define TX_WAIT_STEP    16
+#define TX_WAIT_US      ((TX_WAIT_STEP * 10 * 1000000UL) / COMM_BAUD)
+
 ///-----------------------------------------------------------------------------
 ///         Functions for returning static instance                     [PUBLIC]
 ///-----------------------------------------------------------------------------
@@ -42,21 +49,139 @@ SerialPort* SerialPort::GetP()
     return &(SerialPort::GetI());
 }
 
-SerialPort::SerialPort() {}
+SerialPort::SerialPort() : custHook(0), _protoEn(false),
+                           _rxRing(_rxMem, RX_RING_LEN), _rxEcho(RX_DEF_ECHO),
+                           _rxLineLen(0), _txRing(_txMem, TX_RING_LEN),
+                           _txClaimed(false)
+{
+    memset(&_rxStats, 0, sizeof(_rxStats));
+    memset(_lineCons, 0, sizeof(_lineCons));
+    memset(_frameCons, 0, sizeof(_frameCons));
+    memset(&_txStats, 0, sizeof(_txStats));
+    SetTxPolicy(TX_DEF_POLICY, TX_DEF_TIMEOUT);
+}
 SerialPort::~SerialPort() {}
 
+/**
+ * Format text straight into TX buffer and queue it for sending. Line endings
+ * are expanded to CR-LF. Message is queued as a whole, if it doesn't fit it's
+ * handled according to TX policy (see SetTxPolicy())
+ * @note Free space of TX buffer is claimed with interrupts disabled, text is
+ * formatted into it with interrupts enabled and only committed with them
+ * disabled again. Message sent while another one is being formatted (i.e.
+ * from an ISR) is dropped. Messages longer than TX buffer are cut off.
+ */
 void SerialPort::Send(const char* arg, ...)
 {
     va_list vaArgP;
+    uint32_t len;
+    uint16_t cap = 0;
+    bool masked = HAL_BOARD_InterruptMasked();
+    bool claimed;
 
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+    //  Claim free space of TX buffer, nothing else is written into it until
+    //  the message is committed. UART interrupt only reads data before it
+    claimed = !_txClaimed;
+    if (claimed)
+    {
+        _txClaimed = true;
+        cap = _txRing.Free();
+    }
+    if (!masked)
+        HAL_BOARD_InterruptEnable(true);
 
     //	Start the varargs processing.
     va_start(vaArgP, arg);
-
-    UARTvprintf(arg, vaArgP);
-
+    len = _TxFormat(arg, vaArgP, cap);
     //	We're finished with the varargs now.
     va_end(vaArgP);
+
+    //  Message didn't fit, make room for it and format it once more
+    if (claimed && (len > cap))
+    {
+        uint16_t need = (len < _txRing.Size()) ? (uint16_t)len : _txRing.Size();
+        bool room;
+
+        HAL_BOARD_InterruptEnable(false);
+        room = _TxMakeRoom(need, masked);
+        cap = _txRing.Free();
+        if (!masked)
+            HAL_BOARD_InterruptEnable(true);
+
+        if (room)
+        {
+            va_start(vaArgP, arg);
+            len = _TxFormat(arg, vaArgP, cap);
+            va_end(vaArgP);
+        }
+    }
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    if (claimed && ((len <= cap) || (cap == _txRing.Size())))
+    {
+        uint16_t n = (len < cap) ? (uint16_t)len : cap;
+
+        _txRing.Commit(n);
+        _txStats.queued += n;
+        _txStats.dropped += len - n;
+        if (_txRing.Used() > _txStats.highWater)
+            _txStats.highWater = _txRing.Used();
+    }
+    else
+        _txStats.dropped += len;
+    if (claimed)
+        _txClaimed = false;
+
+    //  Start transmission if UART is idle
+    _TxDrain();
+
+    //  Sensitive task done, enable interrupts again (unless caller had them
+    //  disabled)
+    if (!masked)
+        HAL_BOARD_InterruptEnable(true);
+}
+
+/**
+ * Send raw bytes, without any formatting (e.g. binary protocol frames)
+ * @param data bytes to send
+ * @param len number of bytes in [data]
+ */
+void SerialPort::SendRaw(const uint8_t *data, uint16_t len)
+{
+    _TxEnqueue(data, len);
+}
+
+/**
+ * Set policy for handling messages that don't fit into TX buffer
+ * @param policy one of TX_DROP_NEWEST, TX_DROP_OLDEST, TX_BLOCK
+ * @param timeoutMS (TX_BLOCK only) longest time to wait for space in buffer
+ */
+void SerialPort::SetTxPolicy(uint8_t policy, uint16_t timeoutMS)
+{
+    _txPolicy = policy;
+    //  Waiting is measured in bytes the line can send meanwhile (10 bits per
+    //  byte), counted in busy-wait steps so it also works when called with
+    //  interrupts disabled
+    _txWaitBytes = ((uint32_t)timeoutMS * (COMM_BAUD / 10)) / 1000;
+}
+
+/**
+ * Take a consistent copy of TX buffer statistics
+ * @param dst destination for copy of statistics
+ */
+void SerialPort::GetTxStats(struct _txStats &dst)
+{
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    dst = _txStats;
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
 }
 
 /**
@@ -113,27 +238,323 @@ void SerialPort::AddHook(void((*funPoint)(uint8_t*, uint16_t*)))
 }
 
 /**
- * Interrupt service routine for handling incoming data on UART (Tx)
- * @note IMPORTANT Custom hook HAS TO clear the buffer and bufLen variable
+ * Switch between binary protocol and plain-text mode of receiving data
+ * @param enable true: decode received data as frames and execute commands
+ *              false: echo received data, assemble it into lines and pass it
+ *              to custom hook
+ */
+void SerialPort::EnableProtocol(bool enable)
+{
+    _protoDec.Reset();
+    _protoEn = enable;
+}
+
+///-----------------------------------------------------------------------------
+///                      TX ring buffer handling                       [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Make room for [len] bytes in TX buffer according to the policy for full
+ * buffer: drop the oldest data (TX_DROP_OLDEST) or wait for the line
+ * (TX_BLOCK); nothing is done for TX_DROP_NEWEST
+ * @note Has to be called with interrupts disabled
+ * @param len number of bytes to make room for
+ * @param masked true if caller entered with interrupts already disabled, they
+ * are then kept disabled while waiting
+ * @return true if there's enough free space in the buffer
+ */
+bool SerialPort::_TxMakeRoom(uint16_t len, bool masked)
+{
+    if (_txRing.Free() >= len)
+        return true;
+
+    if (_txPolicy == TX_DROP_OLDEST)
+        _txStats.dropped += _txRing.Discard(len - _txRing.Free());
+    else if (_txPolicy == TX_BLOCK)
+    {
+        //  Move data into UART FIFO ourselves instead of waiting for
+        //  interrupt, this might be called from an ISR. Wait is bounded by
+        //  time, so a stalled line can't hold caller forever
+        uint32_t waited = 0;
+
+        _TxDrain();
+        while ((_txRing.Free() < len) && (waited < _txWaitBytes))
+        {
+            //  Let other interrupts run while waiting for the line
+            if (!masked)
+                HAL_BOARD_InterruptEnable(true);
+            HAL_DelayUS(TX_WAIT_US);
+            if (!masked)
+                HAL_BOARD_InterruptEnable(false);
+
+            waited += TX_WAIT_STEP;
+            _TxDrain();
+        }
+    }
+
+    return (_txRing.Free() >= len);
+}
+
+/**
+ * Format text into free space of TX buffer, without making it visible to the
+ * UART interrupt yet (see Send())
+ * @note Free space has to be claimed by the caller (see _txClaimed)
+ * @param cap number of bytes of free space to use, 0 only measures the text
+ * @return length of complete text, only what fits into [cap] is stored
+ */
+uint32_t SerialPort::_TxFormat(const char *fmt, va_list ap, uint16_t cap)
+{
+    struct _ffOut out;
+
+    out.buf = _txRing.Memory();
+    out.mask = _txRing.Mask();
+    out.start = _txRing.Head();
+    out.cap = cap;
+    out.crlf = true;
+    out.len = 0;
+
+    return FF_VFormat(out, fmt, ap);
+}
+
+/**
+ * Queue data for sending according to the policy for full buffer; message is
+ * either queued as a whole or dropped as a whole (unless policy is
+ * TX_DROP_OLDEST in which case it pushes old data out of the buffer)
+ * @param data data to send
+ * @param len length of [data]
+ */
+void SerialPort::_TxEnqueue(const uint8_t *data, uint16_t len)
+{
+    bool masked = HAL_BOARD_InterruptMasked();
+
+    //  Messages longer than whole buffer can only be queued in pieces
+    while (len > _txRing.Size())
+    {
+        _TxEnqueue(data, _txRing.Size());
+        data += _txRing.Size();
+        len -= _txRing.Size();
+    }
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    //  Free space might be claimed by Send() this call interrupted
+    if (!_txClaimed && _TxMakeRoom(len, masked))
+    {
+        _txRing.Write(data, len);
+        _txStats.queued += len;
+        if (_txRing.Used() > _txStats.highWater)
+            _txStats.highWater = _txRing.Used();
+    }
+    else
+        _txStats.dropped += len;
+
+    //  Start transmission if UART is idle
+    _TxDrain();
+
+    //  Sensitive task done, enable interrupts again (unless caller had them
+    //  disabled)
+    if (!masked)
+        HAL_BOARD_InterruptEnable(true);
+}
+
+/**
+ * Move as much data from TX buffer into UART FIFO as it can take. TX interrupt
+ * is kept enabled only while there's data left in the buffer
+ * @note Has to be called with interrupts disabled or from UART ISR
+ */
+void SerialPort::_TxDrain()
+{
+    uint8_t byte;
+
+    while (UARTSpaceAvail(UART0_BASE) && _txRing.Get(byte))
+        UARTCharPutNonBlocking(UART0_BASE, byte);
+
+    if (_txRing.IsEmpty())
+        UARTIntDisable(UART0_BASE, UART_INT_TX);
+    else
+        UARTIntEnable(UART0_BASE, UART_INT_TX);
+}
+
+/**
+ * Send reply frames produced by protocol dispatcher
+ */
+static void _SerialProtoSend(const uint8_t *data, uint16_t len)
+{
+    SerialPort::GetI().SendRaw(data, len);
+}
+
+///-----------------------------------------------------------------------------
+///                      Processing of received data                    [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Process everything received since last call: decode and execute protocol
+ * frames, or assemble text lines and hand them to consumers. Has to be called
+ * periodically from the main loop, keeps all the work out of UART interrupt
+ */
+void SerialPort::Poll()
+{
+    uint8_t byte;
+    uint16_t used = _rxRing.Used();
+
+    if (used > _rxStats.highWater)
+        _rxStats.highWater = used;
+
+    while (_rxRing.Get(byte))
+    {
+        if (!_protoEn)
+        {
+            _RxText(byte);
+            continue;
+        }
+
+        if (_protoDec.Feed(byte))
+        {
+            const struct _spFrame &frame = _protoDec.GetFrame();
+
+            SP_Dispatch(frame, _SerialProtoSend);
+            for (uint8_t i = 0; i < RX_MAX_CONSUMERS; i++)
+                if (_frameCons[i] != 0)
+                    _frameCons[i](frame);
+        }
+    }
+
+    //  Legacy hook gets all text received so far and has to consume it
+    if (!_protoEn && (custHook != 0) && (_rxLineLen > 0))
+        custHook(_rxLine, &_rxLineLen);
+}
+
+/**
+ * Register function to be called with every complete line of received text
+ * (without line terminator). Line is only valid during the call.
+ * @return true if registered, false if there's no free slot
+ */
+bool SerialPort::AddLineConsumer(void((*consumer)(const uint8_t*, uint16_t)))
+{
+    for (uint8_t i = 0; i < RX_MAX_CONSUMERS; i++)
+        if (_lineCons[i] == 0)
+        {
+            _lineCons[i] = consumer;
+            return true;
+        }
+
+    return false;
+}
+
+/**
+ * Register function to be called with every valid protocol frame received
+ * (after it's been executed). Frame is only valid during the call.
+ * @return true if registered, false if there's no free slot
+ */
+bool SerialPort::AddFrameConsumer(void((*consumer)(const struct _spFrame&)))
+{
+    for (uint8_t i = 0; i < RX_MAX_CONSUMERS; i++)
+        if (_frameCons[i] == 0)
+        {
+            _frameCons[i] = consumer;
+            return true;
+        }
+
+    return false;
+}
+
+/**
+ * Select how received text is echoed back
+ * @param mode one of RX_ECHO_OFF, RX_ECHO_ISR, RX_ECHO_POLL
+ */
+void SerialPort::SetEcho(uint8_t mode)
+{
+    _rxEcho = mode;
+}
+
+/**
+ * Take a consistent copy of receiving statistics
+ * @param dst destination for copy of statistics
+ */
+void SerialPort::GetRxStats(struct _rxStats &dst)
+{
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    dst = _rxStats;
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+}
+
+/**
+ * Append received byte to the line being assembled, pass line to consumers
+ * once it's complete (or full)
+ */
+void SerialPort::_RxText(uint8_t byte)
+{
+    bool eol = (byte == '\n') || (byte == '\r');
+
+    if (_rxEcho == RX_ECHO_POLL)
+        SendRaw(&byte, 1);
+
+    //  Custom hook takes over all received text, including line terminators
+    if (custHook != 0)
+    {
+        if (_rxLineLen < RX_LINE_LEN)
+            _rxLine[_rxLineLen++] = byte;
+        else
+            _rxStats.lineOverflows++;
+        return;
+    }
+
+    if (!eol)
+    {
+        _rxLine[_rxLineLen++] = byte;
+        if (_rxLineLen < RX_LINE_LEN)
+            return;
+        _rxStats.lineOverflows++;
+    }
+
+    //  Empty lines (e.g. \n following \r) are not passed on
+    if (_rxLineLen == 0)
+        return;
+
+    for (uint8_t i = 0; i < RX_MAX_CONSUMERS; i++)
+        if (_lineCons[i] != 0)
+            _lineCons[i](_rxLine, _rxLineLen);
+    _rxLineLen = 0;
+}
+
+/**
+ * Interrupt service routine for handling incoming data on UART (Rx) and
+ * draining TX buffer into UART FIFO (Tx). Received data is only stored into
+ * RX buffer, it's processed later by SerialPort::Poll()
  */
 void UART0RxIntHandler(void)
 {
-	static uint8_t txBuffer[TX_BUF_LEN];
-	static uint16_t txBufLen = 0;
+	SerialPort &sp = SerialPort::GetI();
+	uint32_t status = UARTIntStatus(UART0_BASE, true);
 
 	//Clear interrupt flag
-	UARTIntClear(UART0_BASE, UART_INT_RX);
+	UARTIntClear(UART0_BASE, status);
 
-	//Take all chars from Tx FIFO and put them in buffer
+	//  UART FIFO has room for more data from TX buffer
+	if (status & UART_INT_TX)
+	    sp._TxDrain();
+
+	//Take all chars from Rx FIFO and put them in buffer
 	while(UARTCharsAvail(UART0_BASE))
 	{
-		txBuffer[ txBufLen++ ] = UARTCharGet(UART0_BASE);
-		//	Add echo fo debugging purpose
-		UARTCharPut(UART0_BASE, txBuffer[ txBufLen-1 ]);
-	}
+	    uint8_t byte = (uint8_t)UARTCharGet(UART0_BASE);
 
-	if (SerialPort::GetP()->custHook != 0)
-	    SerialPort::GetP()->custHook(txBuffer, &txBufLen);
+	    if (!sp._rxRing.Put(byte))
+	    {
+	        sp._rxStats.overruns++;
+	        continue;
+	    }
+	    sp._rxStats.received++;
+
+	    //	Add echo fo debugging purpose
+	    if ((sp._rxEcho == RX_ECHO_ISR) && !sp._protoEn)
+	        sp.SendRaw(&byte, 1);
+	}
 }
 
 
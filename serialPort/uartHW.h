@@ -6,51 +6,158 @@
  *
  *  Debug bridge between PC<--(USB)-->TM4C
  *
+ *  Received bytes are only stored into RX ring buffer by UART interrupt and
+ *  processed by Poll(), which has to be called periodically from the main
+ *  loop. In text mode, Poll() assembles received bytes into lines and hands
+ *  every complete line to registered line consumers. Port can additionally
+ *  run framed binary protocol (see serialProto.h) used to schedule tasks
+ *  remotely. Once enabled through EnableProtocol(), received bytes are passed
+ *  to the frame decoder instead, every frame is executed and handed to
+ *  registered frame consumers. Consumers get a view into internal buffer which
+ *  is only valid during the call. Custom hook set through AddHook() takes
+ *  over all received text instead of line consumers; it's called from Poll()
+ *  and, as before, has to clear the buffer length once done.
+ *
+ *  Outgoing data is queued into a TX ring buffer which is drained into UART
+ *  FIFO by UART interrupt, so sending doesn't wait for the line. Send() formats
+ *  text straight into the TX buffer (see fastFormat.h) with interrupts enabled,
+ *  format string is checked against arguments at compile time. Policy for a full buffer is
+ *  chosen through SetTxPolicy():
+ *      TX_DROP_NEWEST  new message is dropped as a whole (default)
+ *      TX_DROP_OLDEST  oldest queued data is dropped to make space
+ *      TX_BLOCK        wait for space for at most given time, then drop
  */
 #ifndef UARTHW_H_
 #define UARTHW_H_
 #include "libs/myLib.h"
+#include "serialProto.h"
+#include "ringBuffer.h"
+#include "fastFormat.h"
 
 /*      Communication settings      */
 #define COMM_BAUD   115200
-#define TX_BUF_LEN  512
+//  Size of RX ring buffer (has to be a power of 2)
+#define RX_RING_LEN 512
+//  Longest line assembled from received text, longer lines are split
+#define RX_LINE_LEN 512
+//  Maximum number of line/frame consumers
+#define RX_MAX_CONSUMERS    4
+//  Size of TX ring buffer (has to be a power of 2)
+#define TX_RING_LEN 2048
+
+/*      Policies for full TX ring buffer    */
+#define TX_DROP_NEWEST  0
+#define TX_DROP_OLDEST  1
+#define TX_BLOCK        2
+//  Default policy: message that doesn't fit is dropped, sending never waits
+#define TX_DEF_POLICY   TX_DROP_NEWEST
+//  Longest wait for space (in ms) once TX_BLOCK is chosen, e.g. for long dumps
+#define TX_DEF_TIMEOUT  20
+
+/*      Echo of received text (never done in protocol mode)    */
+#define RX_ECHO_OFF     0
+#define RX_ECHO_ISR     1   //  Right away, from UART interrupt
+#define RX_ECHO_POLL    2   //  Once processed by Poll()
+#define RX_DEF_ECHO     RX_ECHO_POLL
 
 /*      Macro to short the expression needed to print to debug port     */
 #define DEBUG_WRITE(...) SerialPort::GetI().Send(__VA_ARGS__)
 
-/*      Macro for printing float numbers    */
-#define _FTOI_(X) (int32_t)(trunc(X)),(int32_t)fabs(trunc((X-trunc(X))*100))
 
+/*
+ * Function for receiving and processing incomming data - no need to call them
+ */
+
+extern "C"
+{
+    void UART0RxIntHandler(void);
+    extern uint32_t g_ui32SysClock;
+}
+
+
+/**
+ * Statistics of TX ring buffer (all counts in bytes)
+ */
+struct _txStats
+{
+    uint32_t queued;        //  Accepted into TX buffer
+    uint32_t dropped;       //  Dropped due to full TX buffer
+    uint16_t highWater;     //  Highest TX buffer usage seen
+};
+
+/**
+ * Statistics of receiving side (all counts in bytes)
+ */
+struct _rxStats
+{
+    uint32_t received;      //  Stored into RX buffer
+    uint32_t overruns;      //  Lost because RX buffer was full
+    uint32_t lineOverflows; //  Lines split because they exceeded RX_LINE_LEN
+    uint16_t highWater;     //  Highest RX buffer usage seen
+};
 
 /**
  * Interface to a UART-to-USB port, used for debugging
  */
 class SerialPort
 {
+    friend void UART0RxIntHandler(void);
+
     public:
         static SerialPort& GetI();
         static SerialPort* GetP();
 
         int8_t  InitHW();
-        void    Send(const char* arg, ...);
+        void    Send(const char* arg, ...) _PRINTF_FMT_(2, 3);
+        void    SendRaw(const uint8_t *data, uint16_t len);
         void    AddHook(void((*custHook)(uint8_t*, uint16_t*)));
+        void    EnableProtocol(bool enable);
+
+        void    Poll();
+        bool    AddLineConsumer(void((*consumer)(const uint8_t*, uint16_t)));
+        bool    AddFrameConsumer(void((*consumer)(const struct _spFrame&)));
+        void    SetEcho(uint8_t mode);
+        void    GetRxStats(struct _rxStats &dst);
+
+        void    SetTxPolicy(uint8_t policy, uint16_t timeoutMS = 0);
+        void    GetTxStats(struct _txStats &dst);
 
         void    ((*custHook)(uint8_t*, uint16_t*));  // Hook to user routine
     protected:
         SerialPort();
         ~SerialPort();
 
-};
+        void        _TxEnqueue(const uint8_t *data, uint16_t len);
+        bool        _TxMakeRoom(uint16_t len, bool masked);
+        uint32_t    _TxFormat(const char *fmt, va_list ap, uint16_t cap);
+        void        _TxDrain();
+        void        _RxText(uint8_t byte);
 
+        //  True if received data is decoded as binary protocol frames
+        bool        _protoEn;
+        SPDecoder   _protoDec;
 
-/*
- * Function for receiving and processing incomming data - no need to call them
- */
+        //  Received data waiting for Poll(), filled only by UART interrupt
+        uint8_t     _rxMem[RX_RING_LEN];
+        RingBuffer  _rxRing;
+        uint8_t     _rxEcho;
+        struct _rxStats _rxStats;
+        //  Line being assembled from received text
+        uint8_t     _rxLine[RX_LINE_LEN];
+        uint16_t    _rxLineLen;
+        //  Consumers of complete lines and frames
+        void        ((*_lineCons[RX_MAX_CONSUMERS])(const uint8_t*, uint16_t));
+        void        ((*_frameCons[RX_MAX_CONSUMERS])(const struct _spFrame&));
 
-extern "C"
-{
-    void UART0RxIntHandler(void);
-    extern uint32_t g_ui32SysClock;
-}
+        //  Outgoing data waiting for UART
+        uint8_t     _txMem[TX_RING_LEN];
+        RingBuffer  _txRing;
+        //  True while Send() formats text into free space of TX buffer
+        bool        _txClaimed;
+        uint8_t     _txPolicy;
+        //  How many bytes can be sent while waiting for space in TX_BLOCK mode
+        uint32_t    _txWaitBytes;
+        struct _txStats _txStats;
+};
 
 #endif /* UARTHW_H_ */
@@ -11,16 +11,15 @@
 
 //  Ever increasing variable, counts number of created tasks in order to uniquely
 //  identify each task in the system (never decreases, but overflows at 65536)
-static volatile uint16_t _pidCount = 1;
+static uint16_t _pidCount = 1;
 
 /*******************************************************************************
   *********         Linked list node - member functions                *********
  ******************************************************************************/
-_llnode::_llnode() : _prev(0), _next(0), data() {};
+_llnode::_llnode() : _next(0), data() {};
 
-_llnode::_llnode(volatile TaskEntry &arg, volatile _llnode *pre,
-                 volatile _llnode *nex)
-    : _prev(pre), _next(nex), data(arg) {};
+_llnode::_llnode(const TaskEntry &arg, _llnode *nex)
+    : _next(nex), data(arg) {};
 
 
 /*******************************************************************************
@@ -44,10 +43,9 @@ LinkedList::~LinkedList()
  * @param arg task to add to the list
  * @return pointer to the instance of task inside the list
  */
-volatile _llnode* LinkedList::AddSort(TaskEntry &arg) volatile
+_llnode* LinkedList::AddSort(TaskEntry &arg)
 {
-    volatile _llnode *tmp = new _llnode(arg),//  Create new node on the free store
-             *node = head;           //  Define starting node
+    _llnode *tmp = new _llnode(arg);    //  Create new node on the free store
 
     //  Update PID of a task -> only if it doesn't already have one
     if (tmp->data._PID == 0)
@@ -55,49 +53,70 @@ volatile _llnode* LinkedList::AddSort(TaskEntry &arg) volatile
         tmp->data._PID = _pidCount;
         _pidCount++;
     }
+
+    InsertSort(tmp);
+    return tmp;
+}
+
+/**
+ * Link already existing node into the list by keeping the list sorted (see
+ * AddSort). Used to reschedule a node taken out with PopNode() without
+ * copying its content into a new node.
+ * @param tmp node to link into the list, must not be in the list already
+ */
+void LinkedList::InsertSort(_llnode *tmp)
+{
+    _llnode *node = head,   //  Define starting node
+            *prev = 0;      //  Node after which new node is inserted
+
+    //  Most tasks are rescheduled into the future, check tail first to avoid
+    //  walking the list when new node ends up being the last one
+    if ((tail != 0) && !TS_TimeBefore(tmp->data._timestamp, tail->data._timestamp))
+    {
+        prev = tail;
+        node = 0;
+    }
     //  Find where to insert new node(worst-case: end of the list)
     while (node != 0)
     {
         //  Sorting logic - sorts list ascending, in case two tasks have the same
         //  time to be executed at, new task is added after the old on in the list
-        if (tmp->data._timestamp < node->data._timestamp) break;
+        if (TS_TimeBefore(tmp->data._timestamp, node->data._timestamp)) break;
         //  If sorting logic doesn't break the loop move to next element
+        prev = node;
         node = node->_next;
     }
 
     //  Increase size of complete list
     size++;
     //*************************************************INSERTION LOGIC**/
+    tmp->_next = node;
     //  a) Haven't  moved from start - we have new smallest node
-    if (node == head)   //  Insert before first element
-    {
-        //  Check if there're any elements at all in the list
-        if (head != 0)    // If yes update head_previous node
-            head->_prev = tmp;
-        else                    // If not update tail node as well
-            tail = tmp;
-
-        tmp->_next = head;  // Update next node (tmp will become head node)
-        head = tmp;         // Assign new head node
-        return head;
-    }
-    // b) Reached end of the list - insert node after last one
-    else if (node == 0)   //  Insert after last element
-    {
-        tail->_next = tmp;  // Update next element of current tail
-        tmp->_prev = tail;  // Update prev element of new tail element
-        tail = tmp;         // Assign new tail element
-        return tail;
-    }
-    // c) Inserting element in the middle, BEFORE some 'node'
+    if (prev == 0)
+        head = tmp;
+    // b) Inserting element after some 'prev' node
     else
-    {
-        tmp->_prev = node->_prev;
-        node->_prev->_next = tmp;
-        tmp->_next = node;
-        node->_prev = tmp;
-        return tmp;
-    }
+        prev->_next = tmp;
+    //  Check if new node became the last one
+    if (node == 0)
+        tail = tmp;
+}
+
+/**
+ * Unlink [node] from the list
+ * @param node node to unlink
+ * @param prev node preceding [node] in the list, 0 if [node] is the head
+ */
+void LinkedList::_Unlink(_llnode *node, _llnode *prev)
+{
+    if (prev != 0)
+        prev->_next = node->_next;
+    else
+        head = node->_next;
+    //  Check if the node was tail and update it
+    if (tail == node)
+        tail = prev;
+    size--;
 }
 
 /**
@@ -106,50 +125,24 @@ volatile _llnode* LinkedList::AddSort(TaskEntry &arg) volatile
  * @param arg
  * @return true if task was found and deleted, false otherwise
  */
-bool LinkedList::RemoveEntry(TaskEntry &arg) volatile
+bool LinkedList::RemoveEntry(TaskEntry &arg)
 {
-    volatile _llnode *node = head;           //  Define starting node
+    _llnode *node = head,           //  Define starting node
+            *prev = 0;
 
-    while (node != tail)
+    for (; node != 0; prev = node, node = node->_next)
     {
-        //  Check for matching libUID
-        if (node->data._libuid != arg._libuid)
-        {
-            node = node->_next;
-            continue;
-        }
-        //  Check for matching taskID
-        if (node->data._task != arg._task)
-        {
-            node = node->_next;
-            continue;
-        }
-        //  Check for matching length of arguments
-        if (node->data._argN != arg._argN)
-        {
-            node = node->_next;
+        //  Check for matching libUID, taskID and length of arguments
+        if ((node->data._libuid != arg._libuid) ||
+            (node->data._task != arg._task) ||
+            (node->data._argN != arg._argN))
             continue;
-        }
         //  Check if arguments match
-        for (uint16_t i = 0; i < arg._argN; i++)
-            if (node->data._args[i] != arg._args[i])
-            {
-                node = node->_next;
-                continue;
-            }
-        //  If we got to here we have a match, remove node but link _prev and
-        //  _next if they exists
-        if (node->_prev != 0)
-            node->_prev->_next = node->_next;
-        if (node->_next != 0)
-            node->_next->_prev = node->_prev;
-        //  Check if the node was head or tail and update those
-        if (head == node)
-            head = node->_next;
-        if (tail == node)
-            tail == node->_prev;
+        if (memcmp(node->data.GetArgs(), arg.GetArgs(), arg._argN) != 0)
+            continue;
+        //  If we got to here we have a match, remove node but link neighbours
+        _Unlink(node, prev);
         delete node;
-        size--;
         //  Node has been found and deleted, return true
         return true;
     }
@@ -158,32 +151,20 @@ bool LinkedList::RemoveEntry(TaskEntry &arg) volatile
     return false;
 }
 
-bool LinkedList::RemoveEntry(uint16_t PIDarg) volatile
+bool LinkedList::RemoveEntry(uint16_t PIDarg)
 {
-    volatile _llnode *node = head;           //  Define starting node
+    _llnode *node = head,           //  Define starting node
+            *prev = 0;
 
-    while (node != tail)
+    for (; node != 0; prev = node, node = node->_next)
     {
         //  Check for matching PID
         if (node->data._PID != PIDarg)
-        {
-            node = node->_next;
             continue;
-        }
-
-        //  If we got to here we have a match, remove node but link _prev and
-        //  _next if they exists
-        if (node->_prev != 0)
-            node->_prev->_next = node->_next;
-        if (node->_next != 0)
-            node->_next->_prev = node->_prev;
-        //  Check if the node was head or tail and update those
-        if (head == node)
-            head = node->_next;
-        if (tail == node)
-            tail == node->_prev;
+
+        //  If we got to here we have a match, remove node but link neighbours
+        _Unlink(node, prev);
         delete node;
-        size--;
         //  Node has been found and deleted, return true
         return true;
     }
@@ -199,7 +180,7 @@ bool LinkedList::RemoveEntry(uint16_t PIDarg) volatile
  * @return false: success
  *          true: otherwise
  */
-bool LinkedList::Drop() volatile
+bool LinkedList::Drop()
 {
     //  Check if list is already empty
     if (LinkedList::IsEmpty())
@@ -213,7 +194,7 @@ bool LinkedList::Drop() volatile
         if (head == tail)
             tail = 0;
         //  Move to next node before deleting
-        volatile _llnode *tmp = head->_next;
+        _llnode *tmp = head->_next;
         //  Delete head node
         delete head;
         //  Update head node
@@ -224,32 +205,36 @@ bool LinkedList::Drop() volatile
     return (size != 0);
 }
 
+/**
+ * Take first node out of the list without deleting it
+ * @return first node of the list (caller takes ownership), 0 if list is empty
+ */
+_llnode* LinkedList::PopNode()
+{
+    _llnode *node = head;
+
+    //  Check if list is empty
+    if (node == 0)
+        return 0;
+
+    _Unlink(node, 0);
+    node->_next = 0;
+    return node;
+}
+
 /**
  * Delete first element of the list and return its ->data content
  * @return ->data content of the first node of the list
  */
-TaskEntry LinkedList::PopFront() volatile
+TaskEntry LinkedList::PopFront()
 {
     //  Check if list is empty
     if (LinkedList::IsEmpty()) return nullNode;
-    //  Check if there's only one element in this list
-    if (head == tail) tail = 0;
     //  Extract data from node before it's deleted
-    TaskEntry retVal(head->data);
-    //  Move second node to the first position
-    //  If there's only one node next points to nullptr so it's safe
-    volatile _llnode *newHead = head->_next;
+    _llnode *node = PopNode();
+    TaskEntry retVal(node->data);
     //  Delete data from free store
-    delete head;
-    //  Assign new head node
-    head = newHead;
-    //  Check if head can be dereferenced (!=nullptr)
-    if (head != 0)
-        head->_prev = 0;
-    //  Decrease size of complete list
-    size--;
+    delete node;
     //  Return value stored in head node
     return retVal;
 }
-
-
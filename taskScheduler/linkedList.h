@@ -18,16 +18,15 @@ class _llnode
 {
     friend class LinkedList;
     friend class TaskScheduler;
+    friend void TS_GlobalCheck(void);
 
     private:
         _llnode();
-        _llnode(volatile TaskEntry  &arg,
-                volatile _llnode    *pre = 0,
-                volatile _llnode    *nex = 0);
+        _llnode(const TaskEntry &arg, _llnode *nex = 0);
 
-        volatile _llnode     *_prev,
-                             *_next;
-        volatile TaskEntry   data;
+        //  Singly linked - previous node is tracked while walking the list
+        _llnode     *_next;
+        TaskEntry   data;
 };
 
 /**
@@ -35,21 +34,28 @@ class _llnode
  * Linked list data container of sorted TaskEntry objects based on their
  * time stamp. Used only in TaskScheduler class to keep all pending task
  * requests ergo everything is private.
+ * @note List is not interrupt-safe on its own, TaskScheduler calls it only
+ * from within critical sections
  */
 class LinkedList
 {
     friend class TaskScheduler;
+    friend void TS_GlobalCheck(void);
 
     public:
         ~LinkedList();
     private:
         LinkedList();
 
-        volatile _llnode*   AddSort(TaskEntry &arg) volatile;
-        bool                RemoveEntry(TaskEntry &arg) volatile;
-        bool                RemoveEntry(uint16_t PIDarg) volatile;
-        bool                Drop() volatile;
-        TaskEntry           PopFront() volatile;
+        _llnode*    AddSort(TaskEntry &arg);
+        void        InsertSort(_llnode *tmp);
+        bool        RemoveEntry(TaskEntry &arg);
+        bool        RemoveEntry(uint16_t PIDarg);
+        bool        Drop();
+        _llnode*    PopNode();
+        TaskEntry   PopFront();
+
+        void        _Unlink(_llnode *node, _llnode *prev);
 
         ///---------------------------------------------------------------------
         ///                      Inline functions                       [PUBLIC]
@@ -59,7 +65,7 @@ class LinkedList
          * @return true: list is empty
          *        false: list contains data
          */
-        inline bool IsEmpty() volatile
+        inline bool IsEmpty() const
         {
             return (head == tail) && (head == 0);
         }
@@ -68,17 +74,16 @@ class LinkedList
          * remains in the list (it's not deleted as with PopFront)
          * @return reference to ->data content of first object of the list
          */
-        inline volatile TaskEntry& PeekFront() volatile
+        inline TaskEntry& PeekFront()
         {
             return head->data;
         }
 
     private:
-        //  Volatile pointers as they might change inside ISRs
-        volatile _llnode     * volatile head,
-                             * volatile tail;
-        const volatile TaskEntry   nullNode;
-        volatile uint32_t    size;
+        _llnode     *head,
+                    *tail;
+        const TaskEntry nullNode;
+        uint32_t    size;
 
 };
 
@@ -10,84 +10,101 @@
 ///-----------------------------------------------------------------------------
 ///                      Class constructors                             [PUBLIC]
 ///-----------------------------------------------------------------------------
-TaskEntry::TaskEntry() : _libuid(0), _task(0), _argN(0), _timestamp(0),
-        _args(0), _PID(0)
+TaskEntry::TaskEntry() : _timestamp(0), _period(0), _repeats(0), _argN(0),
+        _PID(0), _libuid(0), _task(0)
 {
+    _args.ptr = 0;
 }
 
 TaskEntry::TaskEntry(uint8_t uid, uint8_t task, uint32_t time,
                      int32_t period, int32_t repeats)
-            :_libuid(uid), _task(task), _timestamp(time),
-             _argN(0), _args(0), _period(period), _repeats(repeats), _PID(0)
+            : _timestamp(time), _period(period), _repeats(repeats), _argN(0),
+              _PID(0), _libuid(uid), _task(task)
 {
+    _args.ptr = 0;
 }
 
-TaskEntry::TaskEntry(const TaskEntry& arg) :  _argN(0), _args(0)
+TaskEntry::TaskEntry(const TaskEntry& arg) : _argN(0)
 {
-    *this = (const TaskEntry&)arg;
-}
-
-TaskEntry::TaskEntry(const volatile TaskEntry& arg) :  _argN(0), _args(0)
-{
-    *this = (const volatile TaskEntry&)arg;
+    _args.ptr = 0;
+    *this = arg;
 }
 
 TaskEntry::~TaskEntry()
 {
     //  If there's any dynamically allocated data release it
-    if (_args != 0)
-        delete [] _args;
+    _ReleaseArgs();
 }
 
 /**
  * Add argument(s) stored in a byte array [arg] of length [argLen]. Byte array
  * may contain data of any type, as long as receiver of that data knows how to
  * interpret bytes stored in the field.
- * Size of internal array holding bytes is dynamically reallocated every time
+ * Arguments shorter than TE_ARGS_INLINE are kept inside the object, otherwise
+ * size of internal array holding bytes is dynamically reallocated every time
  * this function is called in order to ensure there's enough space for all args.
  * @note This function doesn't have overflow protection. It will try to save all
  * provided arguments into and array, allocating as much space as it needs.
  * @param arg byte array of data to pass to the function
  * @param argLen length of byte array [arg] (in bytes)
  */
-void TaskEntry::AddArg(void* arg, uint16_t argLen) volatile
+void TaskEntry::AddArg(void* arg, uint16_t argLen)
 {
+    uint16_t newN = _argN + argLen;
+
+    //  Everything still fits in place (+1 space because argument array has to
+    //  be null-terminated), no need for dynamic memory
+    if (newN < TE_ARGS_INLINE)
+    {
+        memcpy(_args.buf + _argN, arg, argLen);
+        _args.buf[newN] = 0;
+        _argN = newN;
+        return;
+    }
+
     //  Allocate new memory to fit all the arguments +1 space because argument
     //  array has to be null-terminated
-    uint8_t *temp = new uint8_t[_argN+argLen+1];
+    uint8_t *temp = new uint8_t[newN+1];
 
-    //  Copy existing arguments from _args into a new memory location
-    memcpy((void*)temp, (void*)_args, _argN);
-    //  Delete data currently stored in pointer _args
-    delete [] _args;
+    //  Copy existing arguments into a new memory location and release them
+    memcpy(temp, GetArgs(), _argN);
+    _ReleaseArgs();
     //  Append new arguments to the new array of arguments
-    memcpy((void*)(temp+_argN), arg, argLen);
-    _argN += argLen;
+    memcpy(temp+_argN, arg, argLen);
+    _argN = newN;
     //  Null-terminate array
     temp[_argN] = 0;
     //  Save new array into a pointer in this object
-    _args = temp;
+    _args.ptr = temp;
 }
 
-uint8_t TaskEntry::GetLibUID() const volatile
+uint8_t TaskEntry::GetLibUID() const
+{
+    return _libuid;
+}
+uint8_t TaskEntry::GetTaskUID() const
+{
+    return _task;
+}
+uint16_t TaskEntry::GetPID() const
 {
-    return (uint8_t)_libuid;
+    return _PID;
 }
-uint8_t TaskEntry::GetTaskUID() const volatile
+int32_t TaskEntry::GetPeriod() const
 {
-    return (uint8_t)_task;
+    return _period;
 }
-uint16_t TaskEntry::GetPID() const volatile
+int32_t TaskEntry::GetRepeats() const
 {
-    return (uint16_t)_PID;
+    return _repeats;
 }
-int32_t TaskEntry::GetPeriod() const volatile
+uint32_t TaskEntry::GetTimeStamp() const
 {
-    return (int32_t)_period;
+    return _timestamp;
 }
-uint32_t TaskEntry::GetTimeStamp() const volatile
+uint16_t TaskEntry::GetArgN() const
 {
-    return (uint32_t)_timestamp;
+    return _argN;
 }
 
 ///-----------------------------------------------------------------------------
@@ -95,54 +112,39 @@ uint32_t TaskEntry::GetTimeStamp() const volatile
 ///-----------------------------------------------------------------------------
 
 /**
- * Class assignment operators for various combinations of data types
+ * Class assignment operator, makes a deep copy of arguments
  * @param arg right side of equal-sign
  * @return
  */
 TaskEntry& TaskEntry::operator= (const TaskEntry& arg)
 {
-    _libuid = arg._libuid;
-    _task = arg._task;
-    _argN = arg._argN;
-    _timestamp = arg._timestamp;
-    _period = arg._period;
-    _repeats = arg._repeats;
-    _PID = arg._PID;
-    Perf = arg.Perf;
-
-    _args = new uint8_t[_argN];
-    memcpy((void*)_args, (void*)(arg._args), _argN);
-    return *this;
-}
+    if (this == &arg)
+        return *this;
 
-volatile TaskEntry& TaskEntry::operator= (const volatile TaskEntry& arg)
-{
     _libuid = arg._libuid;
     _task = arg._task;
-    _argN = arg._argN;
     _timestamp = arg._timestamp;
     _period = arg._period;
     _repeats = arg._repeats;
     _PID = arg._PID;
-    Perf = arg.Perf;
 
-    _args = new uint8_t[_argN];
-    memcpy((void*)_args, (void*)(arg._args), _argN);
+    //  Release arguments this object might already hold before copying new ones
+    _ReleaseArgs();
+    _argN = 0;
+    AddArg((void*)arg.GetArgs(), arg._argN);
     return *this;
 }
 
-volatile TaskEntry& TaskEntry::operator= (volatile TaskEntry& arg) volatile
-{
-    _libuid = arg._libuid;
-    _task = arg._task;
-    _argN = arg._argN;
-    _timestamp = arg._timestamp;
-    _period = arg._period;
-    _repeats = arg._repeats;
-    _PID = arg._PID;
-    Perf = arg.Perf;
+///-----------------------------------------------------------------------------
+///                      Private member functions                      [PRIVATE]
+///-----------------------------------------------------------------------------
 
-    _args = new uint8_t[_argN];
-    memcpy((void*)_args, (void*)(arg._args), _argN);
-    return (volatile TaskEntry&) *this;
+/**
+ * Free argument array if it was dynamically allocated
+ */
+void TaskEntry::_ReleaseArgs()
+{
+    if ((_argN >= TE_ARGS_INLINE) && (_args.ptr != 0))
+        delete [] _args.ptr;
+    _args.ptr = 0;
 }
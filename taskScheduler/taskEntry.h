@@ -8,10 +8,38 @@
 #define ROVERKERNEL_TASKSCHEDULER_TASKENTRY_C_
 
 #include "libs/myLib.h"
-#include "tsProfiler.h"
+
+/**
+ * Wrap-safe comparison of 32-bit time stamps (in ms)
+ * Task time stamps hold only lower 32 bits of internal time, which wraps every
+ * ~49 days. Comparing the difference as a signed number gives correct ordering
+ * as long as two time stamps are less than 2^31 ms (~24.8 days) apart.
+ * @return true if time stamp [a] comes before time stamp [b]
+ */
+inline bool TS_TimeBefore(uint32_t a, uint32_t b)
+{
+    return ((int32_t)(a - b) < 0);
+}
+
+/**
+ * Expand 32-bit time stamp into full 64-bit time (in ms) using current time as
+ * a reference (time stamp is assumed to be within +/-24.8 days from [now])
+ */
+inline uint64_t TS_TimeExpand(uint32_t ts, uint64_t now)
+{
+    return now + (int64_t)(int32_t)(ts - (uint32_t)now);
+}
+
+//  Arguments shorter than this are kept inside TaskEntry instead of on the heap
+//  (one byte of the space is reserved for null-termination)
+#define TE_ARGS_INLINE  (sizeof(uint8_t*))
 
 /**
  * _taksEntry class - object wrapper for tasks handled by TaskScheduler class
+ * @note Not volatile; entries living in the task queue are only accessed within
+ * TaskScheduler critical sections (interrupts disabled)
+ * @note Members are ordered by size to avoid padding, short arguments are kept
+ * in place of the pointer to argument array
  */
 class TaskEntry
 {
@@ -23,47 +51,65 @@ class TaskEntry
     public:
         TaskEntry();
         TaskEntry(const TaskEntry& arg);
-        TaskEntry(const volatile TaskEntry& arg);
         TaskEntry(uint8_t uid, uint8_t task, uint32_t time,
                   int32_t period = 0, int32_t repeats = 0);
         ~TaskEntry();
 
-        void        AddArg(void* arg, uint16_t argLen) volatile;
+        void        AddArg(void* arg, uint16_t argLen);
 
-        uint8_t     GetLibUID() const volatile;
-        uint8_t     GetTaskUID() const volatile;
-        uint16_t    GetPID() const volatile;
-        int32_t     GetPeriod() const volatile;
-        uint32_t    GetTimeStamp() const volatile;
+        uint8_t     GetLibUID() const;
+        uint8_t     GetTaskUID() const;
+        uint16_t    GetPID() const;
+        int32_t     GetPeriod() const;
+        int32_t     GetRepeats() const;
+        uint32_t    GetTimeStamp() const;
+        uint16_t    GetArgN() const;
 
-                 TaskEntry& operator= (const TaskEntry& arg);
-        volatile TaskEntry& operator= (const volatile TaskEntry& arg);
-        volatile TaskEntry& operator= (volatile TaskEntry& arg) volatile;
+        TaskEntry&  operator= (const TaskEntry& arg);
 
-        //  Performance data regarding the task
-        Performance         Perf;
+        ///---------------------------------------------------------------------
+        ///                      Inline functions                       [PUBLIC]
+        ///---------------------------------------------------------------------
+        /**
+         * Return pointer to (null-terminated) array of arguments
+         */
+        inline uint8_t* GetArgs()
+        {
+            return (_argN < TE_ARGS_INLINE) ? _args.buf : _args.ptr;
+        }
+        inline const uint8_t* GetArgs() const
+        {
+            return (_argN < TE_ARGS_INLINE) ? _args.buf : _args.ptr;
+        }
 
     protected:
-        //  Unique identifier for library to request service from
-        volatile uint8_t    _libuid;
-        //  Service ID to execute
-        volatile uint8_t    _task;
-        //  Number of arguments provided when doing service call
-        volatile uint16_t    _argN;
-        //  Time at which to exec. service (in ms from start-up of task scheduler)
-        volatile uint32_t   _timestamp;
-        //  Arguments used when calling service - array that is dynamically
-        //  allocated in AddArg function depending on the number of arguments
-        volatile uint8_t    *_args;
+        void        _ReleaseArgs();
+
+        //  Time at which to exec. service (lower 32 bits of time in ms from
+        //  start-up of task scheduler, compare with TS_TimeBefore())
+        uint32_t            _timestamp;
         //  Period at which to execute this task (0 for non-periodic tasks)
         int32_t             _period;
         //  Number of times to repeat the task. When positive, defines how
         //  many repeats of that task remain, when negative, task
         //  will be repeated indefinitely. When == 0, task is killed.
         int32_t             _repeats;
+        //  Arguments used when calling service - short arguments are stored in
+        //  place, longer ones in array that is dynamically allocated in AddArg
+        //  function depending on the number of arguments (see GetArgs())
+        union
+        {
+            uint8_t         *ptr;
+            uint8_t         buf[TE_ARGS_INLINE];
+        }                   _args;
+        //  Number of arguments provided when doing service call
+        uint16_t            _argN;
         //  Unique process ID
-        volatile uint16_t   _PID;
-
+        uint16_t            _PID;
+        //  Unique identifier for library to request service from
+        uint8_t             _libuid;
+        //  Service ID to execute
+        uint8_t             _task;
 };
 
 #endif /* ROVERKERNEL_TASKSCHEDULER_TASKENTRY_C_ */
@@ -23,9 +23,7 @@
     #define EMIT_EV(X, Y)  EventLog::EmitEvent(TASKSCHED_UID, X, Y)
 #endif  /* __HAL_USE_EVENTLOG__ */
 
-#ifdef __DEBUG_SESSION__
-#include "serialPort/uartHW.h"
-#endif
+#include "serialPort/deferredLog.h"
 
 /**
  * Callback vector for all available kernel modules
@@ -34,7 +32,7 @@
  * called when requesting a service, and memory space for arguments to be
  * transfered to module when requesting a service
  */
-static volatile struct _kernelEntry *__kernelVector[NUM_OF_MODULES] = {0};
+static struct _kernelEntry *__kernelVector[NUM_OF_MODULES] = {0};
 
 
 /**
@@ -51,6 +49,21 @@ void TS_RegCallback(struct _kernelEntry *arg, uint8_t uid)
 //  startup(declared at the bottom)
 void _TSSyncCallback();
 
+#ifdef _TS_PERF_ANALYSIS_
+/**
+ * Report profiling statistics of a single service as a deferred log record
+ * @param libUID UID of library the service belongs to
+ * @param serviceID service ID within the library
+ * @param perf snapshot of statistics as returned by TS_ProfFind/TS_ProfFetch
+ */
+static void _TS_ProfReport(uint8_t libUID, uint8_t serviceID,
+                           const Performance &perf)
+{
+    DLOG(TS_PROF, serviceID, libUID, perf.taskRuns, perf.accRT, perf.msAcc,
+         perf.maxRT, perf.startTimeMissCnt, perf.startTimeMissTot);
+}
+#endif  /* _TS_PERF_ANALYSIS_ */
+
 /**
  * Callback routine to invoke service offered by this module from task scheduler
  * @note It is assumed that once this function is called task scheduler has
@@ -58,7 +71,7 @@ void _TSSyncCallback();
  */
 void _TS_KernelCallback(void)
 {
-    volatile TaskScheduler  &__ts = TaskScheduler::GetI();
+    TaskScheduler  &__ts = TaskScheduler::GetI();
 
     //  Check for null-pointer
     if (__ts._ker.args == 0)
@@ -105,6 +118,55 @@ void _TS_KernelCallback(void)
             __ts._ker.retVal = STATUS_OK;
         }
         break;
+    /*
+     *  Clear profiling statistics of all services
+     *  args[] = none
+     *  retVal on of myLib.h STATUS_* macros
+     */
+    case TASKSCHED_T_PROF_RESET:
+        {
+#ifdef _TS_PERF_ANALYSIS_
+            TS_ProfReset();
+            __ts._ker.retVal = STATUS_OK;
+#else
+            __ts._ker.retVal = STATUS_PROG_ERR;
+#endif
+        }
+        break;
+    /*
+     *  Report profiling statistics of a single service, or of all services if
+     *  no service is given, as deferred log records (TS_PROF)
+     *  args[] = libUID(uint8_t)|serviceID(uint8_t) (optional)
+     *  retVal on of myLib.h STATUS_* macros
+     */
+    case TASKSCHED_T_PROF_REPORT:
+        {
+#ifdef _TS_PERF_ANALYSIS_
+            uint8_t libUID, serviceID;
+            Performance perf;
+
+            __ts._ker.retVal = STATUS_OK;
+            if (__ts._ker.argN >= 2)
+            {
+                libUID = __ts._ker.args[0];
+                serviceID = __ts._ker.args[1];
+
+                if (TS_ProfFind(libUID, serviceID, perf))
+                    _TS_ProfReport(libUID, serviceID, perf);
+                else
+                    __ts._ker.retVal = STATUS_ARG_ERR;
+                break;
+            }
+
+            for (uint16_t i = 0; i < TS_PROF_SLOTS; i++)
+                if (TS_ProfFetch(i, libUID, serviceID, perf))
+                    _TS_ProfReport(libUID, serviceID, perf);
+            DLOG(TS_PROF_DROPPED, TS_ProfDropped());
+#else
+            __ts._ker.retVal = STATUS_PROG_ERR;
+#endif
+        }
+        break;
     default:
         break;
     }
@@ -126,9 +188,9 @@ void _TS_KernelCallback(void)
  * Return reference to a singleton
  * @return reference to an internal static instance
  */
- volatile TaskScheduler& TaskScheduler::GetI()
+TaskScheduler& TaskScheduler::GetI()
 {
-    static volatile TaskScheduler singletonInstance;
+    static TaskScheduler singletonInstance;
     return singletonInstance;
 }
 
@@ -136,7 +198,7 @@ void _TS_KernelCallback(void)
  * Return pointer to a singleton
  * @return pointer to a internal static instance
  */
-volatile TaskScheduler* TaskScheduler::GetP()
+TaskScheduler* TaskScheduler::GetP()
 {
     return &(TaskScheduler::GetI());
 }
@@ -152,7 +214,8 @@ volatile TaskScheduler* TaskScheduler::GetP()
  */
 bool TaskScheduler::ValidKernModule(uint8_t libUID)
 {
-    return (__kernelVector[libUID] != 0);
+    //  UIDs can come from remote commands, so check bounds as well
+    return (libUID < NUM_OF_MODULES) && (__kernelVector[libUID] != 0);
 }
 
 /**
@@ -162,7 +225,7 @@ bool TaskScheduler::ValidKernModule(uint8_t libUID)
  * @param timeStepMS internal time step (in ms) by which internal time is
  * increased every systick (also a period of systick)
  */
-void TaskScheduler::InitHW(uint32_t timeStepMS) volatile
+void TaskScheduler::InitHW(uint32_t timeStepMS)
 {
 #ifdef __HAL_USE_EVENTLOG__
     EMIT_EV(-1, EVENT_STARTUP);
@@ -174,7 +237,7 @@ void TaskScheduler::InitHW(uint32_t timeStepMS) volatile
 
     //  Register module services with task scheduler
     _ker.callBackFunc = _TS_KernelCallback;
-    TS_RegCallback((struct _kernelEntry*)&_ker, TASKSCHED_UID);
+    TS_RegCallback(&_ker, TASKSCHED_UID);
 
 #ifdef __HAL_USE_EVENTLOG__
     EMIT_EV(-1, EVENT_INITIALIZED);
@@ -188,7 +251,7 @@ void TaskScheduler::InitHW(uint32_t timeStepMS) volatile
 /**
  * Clear task schedule, remove all entries from it
  */
-void TaskScheduler::Reset() volatile
+void TaskScheduler::Reset()
 {
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
@@ -205,33 +268,133 @@ void TaskScheduler::Reset() volatile
  * Return number of tasks currently pending execution
  * @return Current number of tasks in task list
  */
-uint32_t TaskScheduler::NumOfTasks() volatile
+uint32_t TaskScheduler::NumOfTasks()
 {
     return _taskLog.size;
 }
 
 /**
- * This is implemented solely for the purpose of printing out task in task
- * scheduler. First call should be made with argument true and all consecutive
- * calls with arg false in order to get all tasks on the list out.
- * @param fromStart True to start returning from head of linked list, false to
- * return next element
- * @return TaskEntry element from the list; index corresponds to a number of
- * calls to this function since last fromStart was 'true'. If index is out of
- * boundaries, 0 (check for null pointer on exit)
+ * Copy description of a task into compact snapshot format
+ */
+static inline void _TS_FillInfo(struct _tsTaskInfo &dst, const TaskEntry &te)
+{
+    dst.timestamp = te.GetTimeStamp();
+    dst.period = te.GetPeriod();
+    dst.repeats = te.GetRepeats();
+    dst.PID = te.GetPID();
+    dst.argN = te.GetArgN();
+    dst.libUID = te.GetLibUID();
+    dst.taskID = te.GetTaskUID();
+}
+
+/**
+ * Convert 'time' argument of SyncTask()/SyncTaskPer() into absolute time stamp
+ * If time is a positive number it represent time in milliseconds from
+ * start-up of the microcontroller. If time is a negative number or 0 it
+ * represents a time in milliseconds from current time as provided by SysTick.
+ * Distance from now is computed in 64 bits before truncating to 32-bit time
+ * stamp: times in the past are executed ASAP and times further than
+ * TS_MAX_DELAY_MS in the future are clamped to TS_MAX_DELAY_MS from now
+ * @param time absolute (>0) or relative (<=0) time of execution
+ * @param now current time in ms since startup of task scheduler
+ * @return (lower 32 bits of) absolute time of execution
+ */
+static inline uint32_t _TS_StartTime(int64_t time, uint64_t now)
+{
+    int64_t delay = (time <= 0) ? -time : (time - (int64_t)now);
+
+    if (delay < 0)
+        delay = 0;
+    else if (delay > (int64_t)TS_MAX_DELAY_MS)
+        delay = TS_MAX_DELAY_MS;
+
+    return (uint32_t)(now + (uint64_t)delay);
+}
+
+/**
+ * Take a consistent snapshot of the tasks pending execution, e.g. for printing
+ * out content of task scheduler. Tasks are copied in order of their execution
+ * within a single critical section, so nothing can change the queue while it's
+ * being copied.
+ * @param dst caller-supplied buffer for task descriptions
+ * @param maxN size of dst buffer (in elements); bounds the time spent with
+ * interrupts disabled
+ * @param total (optional) if not null, set to number of tasks in the queue at
+ * the time of the snapshot (can be larger than the return value)
+ * @return number of descriptions copied into dst
+ */
+uint32_t TaskScheduler::Snapshot(struct _tsTaskInfo *dst, uint32_t maxN,
+                                 uint32_t *total)
+{
+    uint32_t n = 0;
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    for (_llnode *it = _taskLog.head; (it != 0) && (n < maxN); it = it->_next)
+        _TS_FillInfo(dst[n++], it->data);
+    if (total != 0)
+        *total = _taskLog.size;
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+
+    return n;
+}
+
+/**
+ * Paged variant of Snapshot() for queues too long to be copied at once. Each
+ * call copies the next (at most) maxN tasks following the one pointed to by
+ * the cursor and advances the cursor. Interrupts are enabled between the calls
+ * so a page is consistent on its own, but queue might change between pages:
+ * tasks added or rescheduled behind the cursor appear on later pages, tasks
+ * removed in the meantime don't.
+ * @param dst caller-supplied buffer for task descriptions
+ * @param maxN size of dst buffer (in elements)
+ * @param cursor position in queue; default-constructed cursor starts from the
+ * head of the queue
+ * @return number of descriptions copied into dst, 0 once the end of the queue
+ * has been reached
  */
-const TaskEntry* TaskScheduler::FetchNextTask(bool fromStart) volatile
+uint32_t TaskScheduler::SnapshotPage(struct _tsTaskInfo *dst, uint32_t maxN,
+                                     struct _tsSnapCursor &cursor)
 {
-    static _llnode *task = 0;
+    uint32_t n = 0;
+    _llnode *it;
 
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    it = _taskLog.head;
+    if (cursor.started)
+    {
+        //  Skip tasks scheduled before the last one returned. Among tasks with
+        //  the same time stamp continue behind the last task returned, or
+        //  behind all of them if that task is no longer in the queue
+        while ((it != 0) && !TS_TimeBefore(cursor.timestamp, it->data._timestamp))
+        {
+            bool last = (it->data._PID == cursor.PID) &&
+                        (it->data._timestamp == cursor.timestamp);
+            it = it->_next;
+            if (last)
+                break;
+        }
+    }
 
-    if (fromStart)
-        task = (_llnode*)(_taskLog.head);
-    else if (task->_next != 0)
-        task = (_llnode*)(task->_next);
+    for (; (it != 0) && (n < maxN); it = it->_next)
+        _TS_FillInfo(dst[n++], it->data);
 
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
 
-    return (TaskEntry*)(&(task->data));
+    if (n > 0)
+    {
+        cursor.timestamp = dst[n-1].timestamp;
+        cursor.PID = dst[n-1].PID;
+        cursor.started = true;
+    }
+
+    return n;
 }
 
 /**
@@ -242,29 +405,30 @@ const TaskEntry* TaskScheduler::FetchNextTask(bool fromStart) volatile
  * @param libUID UID of library to call
  * @param taskID task ID within the library to execute
  * @param time time-stamp at which to execute the task. If >0 its absolute time
- * in ms since startup of task scheduler. If <=0 its relative time from NOW
+ * in ms since startup of task scheduler. If <=0 its relative time from NOW.
+ * Time in the past executes task ASAP, time more than TS_MAX_DELAY_MS from now
+ * is clamped to TS_MAX_DELAY_MS from now
  * @param periodic If true, schedules periodic task with provided number of
  * repeats. Period is absolute value of 'time' parameter
  * @param rep repeat counter. Number of times to repeat the periodic task before
  * killing it. Set to a negative number for indefinite repeat. When scheduled,
  * task WILL BE repeated at least once.
+ * @return PID of the new task
  */
-void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
-                             int64_t time, bool periodic, int32_t rep) volatile
+uint16_t TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
+                                 int64_t time, bool periodic, int32_t rep)
 {
+    uint16_t PID;
+
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
 
     int32_t period = (int32_t)time;
-    /*
-     * If time is a positive number it represent time in milliseconds from
-     * start-up of the microcontroller. If time is a negative number or 0 it
-     * represents a time in milliseconds from current time as provided by SysTick
-     */
-    if (time <= 0)
-        time = (uint32_t)(-time) + msSinceStartup;
-    else
-        time = (uint32_t)time;
+#ifdef _TS_TRACE_
+    int64_t traceTime = time;
+    int32_t traceRep = rep;
+#endif
+    time = _TS_StartTime(time, msSinceStartup);
 
     //  Subtract 1 from number of repetition as 0 counts as actual repetition
     //  e.g. To repeat task 3 times (rep from arguments) task will be
@@ -276,9 +440,16 @@ void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
     TaskEntry teTemp(libUID, taskID, time, (periodic?period:0), rep);
 
     _lastIndex = _taskLog.AddSort(teTemp);
+    PID = _lastIndex->data._PID;
+#ifdef _TS_TRACE_
+    TS_TraceSync(msSinceStartup, libUID, taskID, traceTime,
+                 (periodic?period:0), traceRep, PID);
+#endif
 
     //  Sensitive task done, enable interrupts again
     HAL_BOARD_InterruptEnable(true);
+
+    return PID;
 }
 
 /**
@@ -289,26 +460,27 @@ void TaskScheduler::SyncTask(uint8_t libUID, uint8_t taskID,
  * @param libUID UID of library to call
  * @param taskID task ID within the library to execute
  * @param time time-stamp at which to execute the task. If >0 its absolute time
- * in ms since startup of task scheduler. If <=0 its relative time from NOW
+ * in ms since startup of task scheduler. If <=0 its relative time from NOW.
+ * Time in the past executes task ASAP, time more than TS_MAX_DELAY_MS from now
+ * is clamped to TS_MAX_DELAY_MS from now
  * @param period Period at which to repeat task
  * @param rep repeat counter. Number of times to repeat the periodic task before
  * killing it. Set to a negative number for indefinite repeat. When scheduled,
  * task WILL BE repeated at least once.
+ * @return PID of the new task
  */
-void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
-                      int32_t period, int32_t rep) volatile
+uint16_t TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID,
+                                    int64_t time, int32_t period, int32_t rep)
 {
+    uint16_t PID;
+
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
-    /*
-     * If time is a positive number it represent time in milliseconds from
-     * start-up of the microcontroller. If time is a negative number or 0 it
-     * represents a time in milliseconds from current time as provided by SysTick
-     */
-    if (time <= 0)
-        time = (uint32_t)(-time) + msSinceStartup;
-    else
-        time = (uint32_t)time;
+#ifdef _TS_TRACE_
+    int64_t traceTime = time;
+    int32_t traceRep = rep;
+#endif
+    time = _TS_StartTime(time, msSinceStartup);
 
     //  Subtract 1 from number of repetition as 0 counts as actual repetition
     //  e.g. To repeat task 3 times (rep from arguments) task will be
@@ -320,9 +492,16 @@ void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
     TaskEntry teTemp(libUID, taskID, time, period, rep);
 
     _lastIndex = _taskLog.AddSort(teTemp);
+    PID = _lastIndex->data._PID;
+#ifdef _TS_TRACE_
+    TS_TraceSync(msSinceStartup, libUID, taskID, traceTime, period, traceRep,
+                 PID);
+#endif
 
     //  Sensitive task done, enable interrupts again
     HAL_BOARD_InterruptEnable(true);
+
+    return PID;
 }
 
 /**
@@ -332,7 +511,7 @@ void TaskScheduler::SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
  * behind the existing task.
  * @param te TaskEntry object to add the the list
  */
-void TaskScheduler::SyncTask(TaskEntry te) volatile
+void TaskScheduler::SyncTask(TaskEntry te)
 {
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
@@ -354,13 +533,18 @@ void TaskScheduler::SyncTask(TaskEntry te) volatile
  * @param arg byte array of data to append (regardless of data type)
  * @param argLen size of byte array [arg]
  */
-void TaskScheduler::AddArgs(void* arg, uint16_t argLen) volatile
+void TaskScheduler::AddArgs(void* arg, uint16_t argLen)
 {
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
 
     if (_lastIndex != 0)
+    {
         _lastIndex->data.AddArg(arg, argLen);
+#ifdef _TS_TRACE_
+        TS_TraceArgs(msSinceStartup, arg, argLen);
+#endif
+    }
 
     //  Sensitive task done, enable interrupts again
     HAL_BOARD_InterruptEnable(true);
@@ -374,7 +558,7 @@ void TaskScheduler::AddArgs(void* arg, uint16_t argLen) volatile
  * @param argLen
  */
 void TaskScheduler::RemoveTask(uint8_t libUID, uint8_t taskID,
-                               void* arg, uint16_t argLen) volatile
+                               void* arg, uint16_t argLen)
 {
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
@@ -382,6 +566,9 @@ void TaskScheduler::RemoveTask(uint8_t libUID, uint8_t taskID,
     TaskEntry delT(libUID, taskID, 0);
     delT.AddArg(arg, argLen);
     _taskLog.RemoveEntry(delT);
+#ifdef _TS_TRACE_
+    TS_TraceKillMatch(msSinceStartup, libUID, taskID, arg, argLen);
+#endif
 
     //  Sensitive task done, enable interrupts again
     HAL_BOARD_InterruptEnable(true);
@@ -400,13 +587,16 @@ void TaskScheduler::RemoveTask(uint8_t libUID, uint8_t taskID,
  * @param PIDarg PID (Unque process ID) of task to kill
  * @return true if removed; false otherwise()
  */
-bool TaskScheduler::RemoveTask(uint16_t PIDarg) volatile
+bool TaskScheduler::RemoveTask(uint16_t PIDarg)
 {
     bool retVal;
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
 
     retVal = _taskLog.RemoveEntry(PIDarg);
+#ifdef _TS_TRACE_
+    TS_TraceKillPID(msSinceStartup, PIDarg);
+#endif
 
     //  Sensitive task done, enable interrupts again
     HAL_BOARD_InterruptEnable(true);
@@ -422,7 +612,7 @@ bool TaskScheduler::RemoveTask(uint16_t PIDarg) volatile
  * @return first element from task queue and delete it (by moving iterators).
  *          If the queue is empty it resets the queue.
  */
-TaskEntry TaskScheduler::PopFront() volatile
+TaskEntry TaskScheduler::PopFront()
 {
     //  Sensitive task, disable all interrupts
     HAL_BOARD_InterruptEnable(false);
@@ -441,7 +631,7 @@ TaskEntry TaskScheduler::PopFront() volatile
  * Peek at the first element of task list but leave it in the list
  * @return reference to first task in task list
  */
-volatile TaskEntry&  TaskScheduler::PeekFront() volatile
+TaskEntry& TaskScheduler::PeekFront()
 {
     return _taskLog.head->data;
 }
@@ -469,6 +659,8 @@ TaskScheduler::~TaskScheduler()
 
 /// Internal time since TaskScheduler startup (in ms) - updated in SysTick ISR
 volatile uint64_t msSinceStartup = 0;
+/// Sequence counter for tear-free reading of msSinceStartup (see TS_GetTimeMS)
+volatile SeqLock msSinceStartupSeq;
 
 /**
  * SysTick interrupt
@@ -477,7 +669,9 @@ volatile uint64_t msSinceStartup = 0;
  */
 void _TSSyncCallback(void)
 {
+    msSinceStartupSeq.WriteBegin();
     msSinceStartup += HAL_TS_GetTimeStepMS();
+    msSinceStartupSeq.WriteEnd();
 }
 
 /**
@@ -490,63 +684,99 @@ void _TSSyncCallback(void)
 void TS_GlobalCheck(void)
 {
     //  Grab reference to singleton
-    volatile TaskScheduler &__taskSch = TaskScheduler::GetI();
+    TaskScheduler &__taskSch = TaskScheduler::GetI();
 
-    //  Check if there is task scheduled to execute
-    if (!__taskSch.IsEmpty())
-        //  Check if the first task had to be executed already
-        while((__taskSch.PeekFront()._timestamp <= msSinceStartup) &&
-              (!__taskSch.IsEmpty()))
+    while (true)
+    {
+        uint64_t tStart = TS_GetTimeMS();
+        _llnode *node = 0;
+
+        //  Sensitive task, disable all interrupts
+        HAL_BOARD_InterruptEnable(false);
+        //  Check if the first task had to be executed already and take it out
+        //  of the list to process it. Node itself is kept, so periodic task can
+        //  be linked back into the list without copying it.
+        if (!__taskSch._taskLog.IsEmpty() &&
+            !TS_TimeBefore((uint32_t)tStart,
+                           __taskSch._taskLog.PeekFront()._timestamp))
         {
-            // Take out first entry to process it
-            TaskEntry tE(__taskSch.PopFront());
-            uint64_t tStart = (uint64_t)msSinceStartup;
-
-            //  If we're going to repeat this task then it makes sense to
-            //  measure its performance, run task-start hook  and calculate new
-            //  starting time for this task
-            if ((tE._period != 0) && (tE._repeats != 0))
-            {
-#ifdef _TS_PERF_ANALYSIS_
-                tE.Perf.TaskStartHook((uint64_t)msSinceStartup, tE._timestamp, HAL_TS_GetTimeStepMS());
-#endif
-                //  Change time of execution based on period (for next execution)
-                tE._timestamp = msSinceStartup + labs(tE._period);
-            }
+            node = __taskSch._taskLog.PopNode();
+            __taskSch._lastIndex = 0;
+        }
+        //  Sensitive task done, enable interrupts again
+        HAL_BOARD_InterruptEnable(true);
+
+        if (node == 0)
+            return;
 
-            // Check if module is registered in task scheduler
-            if ((__kernelVector[tE._libuid]) == 0)
-                return;
+        TaskEntry &tE = node->data;
+        uint64_t tDeadline = TS_TimeExpand(tE._timestamp, tStart);
+        bool resched = (tE._period != 0) && (tE._repeats != 0);
+
+        //  If we're going to repeat this task calculate new starting time
+        if (resched)
+            //  Change time of execution based on period (for next execution)
+            tE._timestamp = (uint32_t)(tStart + labs(tE._period));
+
+        // Check if module is registered in task scheduler
+        if (!TaskScheduler::ValidKernModule(tE._libuid))
+        {
+            delete node;
+            return;
+        }
 
 #if defined(__DEBUG_SESSION__)
-            DEBUG_WRITE("Now is %d \n", msSinceStartup);
+        DLOG(TS_NOW, (uint32_t)TS_GetTimeMS());
 
-            DEBUG_WRITE("Processing %d:%d at %ul ms\n", tE._libuid, tE._task, tE._timestamp);
-            DEBUG_WRITE("-(%d)> %s\n", tE._argN, tE._args);
+        DLOG(TS_PROCESS, tE._libuid, tE._task, (uint32_t)tE._timestamp);
+        DLOG(TS_PROCESS_ARGS, tE._argN, tE.GetArgs());
 #endif
 
-            // Make task data available to kernel
-            __kernelVector[tE._libuid]->serviceID = tE._task;
-            __kernelVector[tE._libuid]->argN = tE._argN;
-            __kernelVector[tE._libuid]->args = (uint8_t*)tE._args;
+        // Make task data available to kernel
+        __kernelVector[tE._libuid]->serviceID = tE._task;
+        __kernelVector[tE._libuid]->argN = tE._argN;
+        __kernelVector[tE._libuid]->args = tE.GetArgs();
 
-            // Call kernel module to execute task
-            __kernelVector[tE._libuid]->callBackFunc();
+#ifdef _TS_PERF_ANALYSIS_
+        //  Measure performance of the service, run service-start hook
+        Performance *perf = TS_ProfGet(tE._libuid, tE._task);
+        if (perf != 0)
+            perf->TaskStartHook(tStart, tDeadline, HAL_TS_GetTimeStepMS());
+#endif
 
-            //  If there's a period specified, reschedule task
-            //  Run post-execution hook for calculating performance
-            if ((tE._period != 0) && (tE._repeats != 0))
-            {
+        // Call kernel module to execute task
+        __kernelVector[tE._libuid]->callBackFunc();
+
+        //  Run post-execution hook for calculating performance
 #ifdef _TS_PERF_ANALYSIS_
-                tE.Perf.TaskEndHook((uint64_t)msSinceStartup);
+        if (perf != 0)
+            perf->TaskEndHook(TS_GetTimeMS());
 #endif
-                //  If using repeat counter decrease it
-                if (tE._repeats > 0)
-                    tE._repeats--;
-                //  Reschedule the task
-                __taskSch.SyncTask(tE);
-            }
+
+#ifdef _TS_TRACE_
+        HAL_BOARD_InterruptEnable(false);
+        TS_TraceDispatch(msSinceStartup, tE._libuid, tE._task, tE._PID,
+                         (int32_t)(tStart - tDeadline),
+                         (uint32_t)(msSinceStartup - tStart));
+        HAL_BOARD_InterruptEnable(true);
+#endif
+
+        //  If there's no period specified, task is done
+        if (!resched)
+        {
+            delete node;
+            continue;
         }
+
+        //  If using repeat counter decrease it
+        if (tE._repeats > 0)
+            tE._repeats--;
+
+        //  Reschedule the task by linking the same node back into the list
+        HAL_BOARD_InterruptEnable(false);
+        __taskSch._taskLog.InsertSort(node);
+        HAL_BOARD_InterruptEnable(true);
+    }
 }
 
 
@@ -5,7 +5,7 @@
  *      Author: Vedran Mikov
  *
  *  Task scheduler library
- *  @version 2.8.0
+ *  @version 2.12.0
  *  V1.1
  *  +Implementation of queue of tasks with various parameters. Tasks identified
  *      by unique integer number (defined by higher level library)
@@ -54,6 +54,32 @@
  *  +Periodically called functions switched to inline, declared in header
  *  +Implemented kernel callback for TS, allowing enable/disable signal for
  *  SysTick timer to be sent remotely
+ *  V2.8.1 - 18.10.2026
+ *  +Optional recording of scheduler API calls and dispatches (_TS_TRACE_)
+ *  V2.8.2 - 18.10.2026
+ *  +Tear-free reading of internal time through TS_GetTimeMS() (seqlock instead
+ *  of disabling interrupts)
+ *  V2.9.0 - 18.10.2026
+ *  +Removed volatile qualifiers from task queue classes, queue is guarded by
+ *  critical sections only
+ *  V2.9.1 - 18.10.2026
+ *  +Compact task layout: singly linked nodes, short arguments stored in place,
+ *  profiling data allocated separately, wrap-safe 32-bit time stamps
+ *  +Periodic tasks are rescheduled by re-linking their node instead of copying
+ *  V2.10.0 - 18.10.2026
+ *  +Profiling statistics are kept per service instead of per task (see
+ *  tsProfiler.h), every dispatch is profiled
+ *  V2.11.0 - 18.10.2026
+ *  +Replaced FetchNextTask() with Snapshot()/SnapshotPage() which copy pending
+ *  tasks out of the queue within a single (bounded) critical section
+ *  V2.11.1 - 18.10.2026
+ *  +SyncTask() and SyncTaskPer() return PID of the new task
+ *  V2.11.2 - 18.10.2026
+ *  +Start time of new tasks is computed in 64 bits, times in the past run ASAP
+ *  and delays are limited to TS_MAX_DELAY_MS
+ *  V2.12.0 - 18.10.2026
+ *  +TASKSCHED_T_PROF_REPORT service reports profiling statistics of a service,
+ *  or of all of them, as deferred log records
  *
  *  TODO:
  *  Implement UTC clock feature. If at some point program finds out what the
@@ -70,6 +96,7 @@
 #define ROVERKERNEL_TASKSCHEDULER_TASKSCHEDULER_H_
 
 #include "linkedList.h"
+#include "tsSeqLock.h"
 
 /**
  * Callback entry into the Task scheduler from individual kernel module
@@ -89,17 +116,52 @@ struct _kernelEntry
     int32_t  retVal;                // (Optional) Return variable of service exec
 };
 
+/**
+ * Compact copy of a pending task, filled by TaskScheduler::Snapshot() and
+ * TaskScheduler::SnapshotPage()
+ */
+struct _tsTaskInfo
+{
+    uint32_t timestamp;             // Time of next execution (lower 32 bits)
+    int32_t  period;                // Period of the task (0 for one-off tasks)
+    int32_t  repeats;               // Remaining repeats (<0 for indefinite)
+    uint16_t PID;                   // Process ID of the task
+    uint16_t argN;                  // Number of argument bytes
+    uint8_t  libUID;                // UID of library providing the service
+    uint8_t  taskID;                // Service ID within the library
+};
+
+/**
+ * Position in the task queue between two calls to TaskScheduler::SnapshotPage()
+ * Queue might change between calls so position is kept as (time stamp, PID) of
+ * the last task returned instead of a pointer into the queue
+ */
+struct _tsSnapCursor
+{
+    _tsSnapCursor(): timestamp(0), PID(0), started(false) {};
+
+    uint32_t timestamp;             // Time stamp of the last task returned
+    uint16_t PID;                   // PID of the last task returned
+    bool     started;               // False until first page has been fetched
+};
+
 
 //  Pass to 'repeats' argument for indefinite number of repeats
 #define T_PERIODIC  (-1)
 //  Pass to 'time' for execution as-soon-as-possible
 #define T_ASAP      (0)
+//  Longest delay (in ms) from now at which a task can be scheduled. Tasks keep
+//  32-bit time stamps which are compared wrap-safe, so pending tasks must stay
+//  within 2^31 ms (~24.8 days) of each other. Longer delays are clamped
+#define TS_MAX_DELAY_MS (0x7FFFFFFFL)
 
 //  Unique identifier of this module as registered in task scheduler
     #define TASKSCHED_UID           7
     //  Definitions of ServiceID for service offered by this module
     #define TASKSCHED_T_ENABLE      0
     #define TASKSCHED_T_KILL        1
+    #define TASKSCHED_T_PROF_RESET  2
+    #define TASKSCHED_T_PROF_REPORT 3
 
 //  Enable debug information printed on serial port
 //#define __DEBUG_SESSION2__
@@ -109,18 +171,51 @@ struct _kernelEntry
 #endif
 
 //  Compiling with this definition will enable parts of TS code used to measure
-//  performance such as missed starting time, average execution time on task...
+//  performance such as missed starting time, average execution time on service
+//  (statistics are kept per service, see tsProfiler.h)
 #define _TS_PERF_ANALYSIS_
 
 #ifdef _TS_PERF_ANALYSIS_
 #include "tsProfiler.h"
 #endif
 
+//  Compiling with this definition will record all calls to scheduler API and
+//  task dispatches into a binary trace which can be replayed on host
+//#define _TS_TRACE_
+
+#ifdef _TS_TRACE_
+#include "tsTrace.h"
+#endif
+
 //  Internal time since TaskScheduler startup (in ms); Increased by SysTick
 //  interrupt. Every tick increases this variable by value passed as argument to
 //  TaskScheduler::InitHW() function. Can be as little as 1ms, but can be also
 //  be more, depending on system requirements
 extern volatile uint64_t msSinceStartup;
+//  Sequence counter guarding updates of msSinceStartup in SysTick interrupt
+extern volatile SeqLock msSinceStartupSeq;
+
+/**
+ * Read internal time since TaskScheduler startup (in ms)
+ * 64-bit msSinceStartup can't be read atomically on a 32-bit core, reading it
+ * directly outside of interrupt might return a torn value when SysTick ticks
+ * in the middle of the read (e.g. lower word after and upper word before
+ * carry). This function retries the read instead of disabling interrupts.
+ * @return current value of msSinceStartup
+ */
+inline uint64_t TS_GetTimeMS()
+{
+    uint64_t now;
+    uint32_t seq;
+
+    do
+    {
+        seq = msSinceStartupSeq.ReadBegin();
+        now = msSinceStartup;
+    } while (msSinceStartupSeq.ReadRetry(seq));
+
+    return now;
+}
 
 /**
  * Task scheduler class implementation
@@ -131,9 +226,11 @@ extern volatile uint64_t msSinceStartup;
  * doesn't perform actual context switching. Rather it runs-to-completion a
  * single task at the time. Scheduling in this case refers to ability to provide
  * a starting time/period/repeats for a task.
- ***Class implemented with volatile functions as adding tasks is permitted from
- *  within interrupts. And in future task execution might be implemented from
- *  periodic timer interrupt as well.
+ ***Adding tasks is permitted from within interrupts. Instead of declaring
+ *  the whole class volatile, every function touching the queue does it inside
+ *  a critical section (interrupts disabled). Entering and leaving a critical
+ *  section is a call into HAL which also acts as a compiler barrier, so queue
+ *  data doesn't need to be reloaded on every access.
  */
 class TaskScheduler
 {
@@ -142,35 +239,38 @@ class TaskScheduler
     friend void TS_GlobalCheck(void);
 
 	public:
-        volatile static TaskScheduler& GetI();
-        volatile static TaskScheduler* GetP();
+        static TaskScheduler& GetI();
+        static TaskScheduler* GetP();
 
         static bool ValidKernModule(uint8_t libUID);
 
-		void                InitHW(uint32_t timeStepMS = 100) volatile;
-		inline void         Reset() volatile;
+		void                InitHW(uint32_t timeStepMS = 100);
+		inline void         Reset();
 
-		uint32_t            NumOfTasks() volatile;
-		const TaskEntry*    FetchNextTask(bool fromStart) volatile;
+		uint32_t            NumOfTasks();
+		uint32_t            Snapshot(struct _tsTaskInfo *dst, uint32_t maxN,
+		                             uint32_t *total = 0);
+		uint32_t            SnapshotPage(struct _tsTaskInfo *dst, uint32_t maxN,
+		                                 struct _tsSnapCursor &cursor);
 
 		//  Adding new tasks
-		void SyncTask(uint8_t libUID, uint8_t taskID, int64_t time,
-		              bool periodic = false, int32_t rep = 0) volatile;
-		void SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
-		                 int32_t period, int32_t rep) volatile;
-		void SyncTask(TaskEntry te) volatile;
+		uint16_t SyncTask(uint8_t libUID, uint8_t taskID, int64_t time,
+		                  bool periodic = false, int32_t rep = 0);
+		uint16_t SyncTaskPer(uint8_t libUID, uint8_t taskID, int64_t time,
+		                     int32_t period, int32_t rep);
+		void SyncTask(TaskEntry te);
 
 		//  Add arguments for the last task added
-		void AddArgs(void* arg, uint16_t argLen) volatile;
+		void AddArgs(void* arg, uint16_t argLen);
 
 		//  Remove task for task list
 		void RemoveTask(uint8_t libUID, uint8_t taskID,
-		                void* arg, uint16_t argLen) volatile;
-		bool RemoveTask(uint16_t PIDarg) volatile;
+		                void* arg, uint16_t argLen);
+		bool RemoveTask(uint16_t PIDarg);
 
 
-        TaskEntry            PopFront() volatile;
-        volatile TaskEntry&  PeekFront() volatile;
+        TaskEntry   PopFront();
+        TaskEntry&  PeekFront();
 
 		///---------------------------------------------------------------------
 		///                      Inline functions                       [PUBLIC]
@@ -180,7 +280,7 @@ class TaskScheduler
 		 * @return  true: if there's nothing in queue
 		 *         false: if queue contains data
 		 */
-		inline bool IsEmpty() volatile
+		inline bool IsEmpty()
         {
             return _taskLog.IsEmpty();
         }
@@ -193,13 +293,18 @@ class TaskScheduler
 		 * @param arg data argument to append to the current task argument list
 		 */
 		template<typename T>
-		void AddArg(T arg) volatile
+		void AddArg(T arg)
 		{
             //  Sensitive task, disable all interrupts
 		    HAL_BOARD_InterruptEnable(false);
 
 		    if (_lastIndex != 0)
+		    {
 		        _lastIndex->data.AddArg((void*)&arg, sizeof(arg));
+#ifdef _TS_TRACE_
+		        TS_TraceArgs(msSinceStartup, (void*)&arg, sizeof(arg));
+#endif
+		    }
 
 		    //  Sensitive task done, enable interrupts again
 		    HAL_BOARD_InterruptEnable(true);
@@ -213,14 +318,12 @@ class TaskScheduler
 
 
 		//  Queue of tasks to be executed, implemented as doubly linked list
-		volatile LinkedList	_taskLog;
+		LinkedList	_taskLog;
 		/*
 		 *  Pointer to last added item (to be able to append arguments to it)
 		 *  ->Is being reset to zero after calling PopFront() function
-		 *  ->volatile pointer (because it can change from within interrupt) to
-		 *  a volatile object (object can be removed from within interrupt)
 		 */
-		volatile _llnode* volatile _lastIndex;
+		_llnode     *_lastIndex;
 
         //  Interface with task scheduler - provides memory space and function
         //  to call in order for task scheduler to request service from this module
@@ -0,0 +1,149 @@
+/**
+ * tsProfiler.cpp
+ *
+ *  Created on: 18. 10. 2026.
+ */
+#include "taskScheduler.h"
+
+#if defined(__HAL_USE_TASKSCH__) && defined(_TS_PERF_ANALYSIS_)
+
+/**
+ * Single slot of profiling table
+ */
+struct _tsProfSlot
+{
+    bool        used;
+    uint8_t     libUID;
+    uint8_t     serviceID;
+    Performance perf;
+};
+
+//  Profiling table, open addressing with linear probing on (libUID, serviceID)
+static struct _tsProfSlot _profTable[TS_PROF_SLOTS];
+//  Number of dispatches that weren't profiled because table was full
+static uint32_t _profDropped = 0;
+
+///-----------------------------------------------------------------------------
+///                      Table lookup                                  [PRIVATE]
+///-----------------------------------------------------------------------------
+
+/**
+ * Find slot holding statistics of a service
+ * @param create if true and service isn't in the table, claim a free slot
+ * @return pointer to slot, 0 if service isn't in the table (or table is full)
+ */
+static struct _tsProfSlot* _ProfLookup(uint8_t libUID, uint8_t serviceID,
+                                       bool create)
+{
+    uint16_t idx = (uint16_t)(libUID * 31 + serviceID) % TS_PROF_SLOTS;
+
+    for (uint16_t i = 0; i < TS_PROF_SLOTS; i++)
+    {
+        struct _tsProfSlot *slot = &_profTable[idx];
+
+        //  Slots are never freed one by one, so the first free slot ends the
+        //  probing sequence
+        if (!slot->used)
+        {
+            if (!create)
+                return 0;
+            slot->libUID = libUID;
+            slot->serviceID = serviceID;
+            slot->perf = Performance();
+            slot->used = true;
+            return slot;
+        }
+        if ((slot->libUID == libUID) && (slot->serviceID == serviceID))
+            return slot;
+
+        idx = (idx + 1) % TS_PROF_SLOTS;
+    }
+
+    return 0;
+}
+
+///-----------------------------------------------------------------------------
+///                      Profiling table access                         [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Return statistics of a service, adding the service into the table if it's
+ * not there yet. Called by task scheduler on every dispatch.
+ * @return pointer to statistics, 0 if table is full (dispatch is counted in
+ * TS_ProfDropped())
+ */
+Performance* TS_ProfGet(uint8_t libUID, uint8_t serviceID)
+{
+    struct _tsProfSlot *slot = _ProfLookup(libUID, serviceID, true);
+
+    if (slot == 0)
+    {
+        _profDropped++;
+        return 0;
+    }
+
+    return &(slot->perf);
+}
+
+/**
+ * Take a consistent copy of statistics of a service
+ * @param dst destination for copy of statistics
+ * @return true if service has been profiled, false otherwise
+ */
+bool TS_ProfFind(uint8_t libUID, uint8_t serviceID, Performance &dst)
+{
+    struct _tsProfSlot *slot = _ProfLookup(libUID, serviceID, false);
+
+    if (slot == 0)
+        return false;
+
+    slot->perf.Snapshot(dst);
+    return true;
+}
+
+/**
+ * Used to walk over the whole table, e.g. to print statistics of all services
+ * @param slot index of slot in table (0 to TS_PROF_SLOTS-1)
+ * @param libUID UID of library the service belongs to
+ * @param serviceID service ID within the library
+ * @param dst destination for copy of statistics
+ * @return true if slot holds statistics, false if it's empty or out of range
+ */
+bool TS_ProfFetch(uint16_t slot, uint8_t &libUID, uint8_t &serviceID,
+                  Performance &dst)
+{
+    if ((slot >= TS_PROF_SLOTS) || !_profTable[slot].used)
+        return false;
+
+    libUID = _profTable[slot].libUID;
+    serviceID = _profTable[slot].serviceID;
+    _profTable[slot].perf.Snapshot(dst);
+    return true;
+}
+
+/**
+ * Return number of dispatches that weren't profiled because table was full
+ */
+uint32_t TS_ProfDropped()
+{
+    return _profDropped;
+}
+
+/**
+ * Clear all statistics
+ */
+void TS_ProfReset()
+{
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    //  Counters are cleared once slot is claimed again
+    for (uint16_t i = 0; i < TS_PROF_SLOTS; i++)
+        _profTable[i].used = false;
+    _profDropped = 0;
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+}
+
+#endif  /* __HAL_USE_TASKSCH__ && _TS_PERF_ANALYSIS_ */
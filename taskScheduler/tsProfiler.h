@@ -5,31 +5,39 @@
  *      Author: Vedran Mikov
  *
  *  Task scheduler extension for profiling of tasks (measuring run-time statistics)
- *  @version 1.0
+ *  @version 2.0
  *  V1.0
  *  +Creation of file, definition of class object for holding task-performance data
  *  V1.1
  *  +Added ability to measure average task runtime by accumulating all run times
  *  into a 32-bit counter and dividing by number of runs
+ *  V1.2 - 18.10.2026
+ *  +Hooks update counters under a sequence counter, Snapshot() takes a
+ *  consistent copy of all counters without disabling interrupts
+ *  V2.0 - 18.10.2026
+ *  +Statistics are kept per service (libUID, serviceID) in a fixed-size table
+ *  instead of per task. Every dispatch is profiled, including one-off tasks,
+ *  and statistics survive killing of the task.
  */
 
 #ifndef ROVERKERNEL_TASKSCHEDULER_TSPROFILER_H_
 #define ROVERKERNEL_TASKSCHEDULER_TSPROFILER_H_
 
+#include "tsSeqLock.h"
+
+//  Number of distinct services (libUID, serviceID pairs) that can be profiled;
+//  dispatches of services that don't fit in the table are only counted
+#define TS_PROF_SLOTS   64
+
 
 class Performance
 {
     public:
         Performance(): startTimeMissTot(0), startTimeMissCnt(0), taskRuns(0),
                        maxRT(0), _lastStartT(0), msAcc(0), accRT(0) {};
-        Performance(volatile Performance &arg)
+        Performance(const Performance &arg): _lastStartT(0)
         {
-            startTimeMissTot = arg.startTimeMissTot;
-            startTimeMissCnt = arg.startTimeMissCnt;
-            taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
-            accRT = arg.accRT;
+            *this = arg;
         }
         ~Performance() {};
 
@@ -40,6 +48,7 @@ class Performance
             //  If we missed starting time of the task for more than 1 time-step
             //  calculate for how much was the deadline missed and increase count
             //  of missed tasks
+            _seqLock.WriteBegin();
             if (timestamp > (taskStartTime + timeStep))
             {
                 startTimeMissCnt++;
@@ -49,6 +58,7 @@ class Performance
             //  Save timestamp for calculating execution time
             _lastStartT = timestamp;
             taskRuns++;
+            _seqLock.WriteEnd();
         }
 
         void TaskEndHook(const uint64_t &timestamp)
@@ -56,6 +66,7 @@ class Performance
             //  Calculate run-time of task once it's finished
             uint16_t rt = (uint16_t)(timestamp - _lastStartT);
 
+            _seqLock.WriteBegin();
             //  Check if we have new maximum run time
             if (rt > maxRT)
                 maxRT = rt;
@@ -63,69 +74,34 @@ class Performance
             //  Update millisecond accumulator and accumulated runtime
             accRT += (msAcc+rt) / 1000;
             msAcc = (msAcc+rt) % 1000;
+            _seqLock.WriteEnd();
         }
 
-        //  TODO: Make sure to include all new variables in these assignments
-        volatile Performance& operator= (volatile Performance &arg) volatile
+        /**
+         * Take a consistent copy of all counters, retrying the copy if hooks
+         * modified them in the meantime (e.g. reading from main loop while a
+         * task is being profiled from an interrupt)
+         * @param dst destination for copy of counters
+         */
+        void Snapshot(Performance &dst) const
         {
-            startTimeMissTot = arg.startTimeMissTot;
-            startTimeMissCnt = arg.startTimeMissCnt;
-            taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
-            accRT = arg.accRT;
+            uint32_t seq;
 
-            return *this;
+            do
+            {
+                seq = _seqLock.ReadBegin();
+                dst.startTimeMissTot = startTimeMissTot;
+                dst.startTimeMissCnt = startTimeMissCnt;
+                dst.taskRuns = taskRuns;
+                dst.maxRT = maxRT;
+                dst.msAcc = msAcc;
+                dst.accRT = accRT;
+            } while (_seqLock.ReadRetry(seq));
         }
-//        const Performance operator= (volatile const Performance arg)
-//        {
-//            startTimeMissTot = arg.startTimeMissTot;
-//            startTimeMissCnt = arg.startTimeMissCnt;
-//            taskRuns = arg.taskRuns;
-//            maxRT = arg.maxRT;
-//            msAcc = arg.msAcc;
-//            accRT = arg.accRT;
-//
-//            return *this;
-//        }
-//
-//        volatile Performance operator= (volatile const Performance arg) volatile
-//        {
-//            startTimeMissTot = arg.startTimeMissTot;
-//            startTimeMissCnt = arg.startTimeMissCnt;
-//            taskRuns = arg.taskRuns;
-//            maxRT = arg.maxRT;
-//            msAcc = arg.msAcc;
-//            accRT = arg.accRT;
-//
-//            return *this;
-//        }
-//
-//        Performance operator= (Performance arg)
-//        {
-//            startTimeMissTot = arg.startTimeMissTot;
-//            startTimeMissCnt = arg.startTimeMissCnt;
-//            taskRuns = arg.taskRuns;
-//            maxRT = arg.maxRT;
-//            msAcc = arg.msAcc;
-//            accRT = arg.accRT;
-//
-//            return *this;
-//        }
-
-//        const Performance& operator= (const Performance &arg)
-//        {
-//            startTimeMissTot = arg.startTimeMissTot;
-//            startTimeMissCnt = arg.startTimeMissCnt;
-//            taskRuns = arg.taskRuns;
-//            maxRT = arg.maxRT;
-//            msAcc = arg.msAcc;
-//            accRT = arg.accRT;
-//
-//            return *this;
-//        }
-
-        const volatile Performance& operator= (const volatile Performance &arg)
+
+        //  TODO: Make sure to include all new variables in this assignment
+        //  Sequence counter and start time stay with the object being assigned to
+        Performance& operator= (const Performance &arg)
         {
             startTimeMissTot = arg.startTimeMissTot;
             startTimeMissCnt = arg.startTimeMissCnt;
@@ -137,22 +113,12 @@ class Performance
             return *this;
         }
 
-        void operator= (const volatile Performance &arg) volatile
-        {
-            startTimeMissTot = arg.startTimeMissTot;
-            startTimeMissCnt = arg.startTimeMissCnt;
-            taskRuns = arg.taskRuns;
-            maxRT = arg.maxRT;
-            msAcc = arg.msAcc;
-            accRT = arg.accRT;
-        }
-
     public:
         //  Sum of time time differences between actual & specified  start time
         uint32_t startTimeMissTot;
-        //  Number of times the task has missed its starting time
+        //  Number of times the service has missed its starting time
         uint32_t startTimeMissCnt;
-        //  Number of times the task has run
+        //  Number of times the service has run
         uint32_t taskRuns;
         //  Max run-time
         uint16_t maxRT;
@@ -165,7 +131,18 @@ class Performance
     protected:
         //  Last start time of the task -> used to calculate runtime
         uint64_t _lastStartT;
+        //  Sequence counter, odd while one of the hooks is updating counters
+        SeqLock  _seqLock;
 };
 
+//  Access to profiling table, compiled only with _TS_PERF_ANALYSIS_
+extern Performance* TS_ProfGet(uint8_t libUID, uint8_t serviceID);
+extern bool         TS_ProfFind(uint8_t libUID, uint8_t serviceID,
+                                Performance &dst);
+extern bool         TS_ProfFetch(uint16_t slot, uint8_t &libUID,
+                                 uint8_t &serviceID, Performance &dst);
+extern uint32_t     TS_ProfDropped();
+extern void         TS_ProfReset();
+
 
 #endif /* ROVERKERNEL_TASKSCHEDULER_TSPROFILER_H_ */
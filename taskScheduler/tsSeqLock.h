@@ -0,0 +1,82 @@
+/**
+ *  tsSeqLock.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Task scheduler extension providing sequence counter (seqlock) for tear-free
+ *  reading of multi-word data updated from an interrupt
+ *  @version 1.0
+ *  V1.0
+ *  +Single-writer sequence counter. Writer (usually an ISR) increments counter
+ *  before and after updating protected data, so counter is odd while update is
+ *  in progress. Reader samples counter, copies data and retries if counter was
+ *  odd or has changed in the meantime. Readers never block the writer and
+ *  don't need to disable interrupts.
+ *
+ *  Usage (reader):
+ *      uint32_t seq;
+ *      do {
+ *          seq = lock.ReadBegin();
+ *          copy = data;
+ *      } while (lock.ReadRetry(seq));
+ *  @note Writer must never be interrupted by another writer of the same data.
+ *  Reader must not be able to interrupt the writer (e.g. reading from an ISR
+ *  data that's written in the main loop) as it would spin forever.
+ */
+#include "hwconfig.h"
+#include "HAL/hal.h"
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSSEQLOCK_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSSEQLOCK_H_
+
+class SeqLock
+{
+    public:
+        SeqLock(): _seq(0) {};
+
+        /**
+         * Mark start of update of protected data (counter becomes odd)
+         */
+        inline void WriteBegin() volatile
+        {
+            _seq = _seq + 1;
+            HAL_BOARD_MemBarrier();
+        }
+        /**
+         * Mark end of update of protected data (counter becomes even again)
+         */
+        inline void WriteEnd() volatile
+        {
+            HAL_BOARD_MemBarrier();
+            _seq = _seq + 1;
+        }
+        /**
+         * Wait for writer to finish and return counter value to pass to
+         * ReadRetry() once protected data has been copied
+         */
+        inline uint32_t ReadBegin() const volatile
+        {
+            uint32_t seq;
+
+            while ((seq = _seq) & 1);
+            HAL_BOARD_MemBarrier();
+
+            return seq;
+        }
+        /**
+         * Check whether protected data has been modified since ReadBegin()
+         * @param seq value returned by ReadBegin()
+         * @return true: copy is inconsistent and has to be taken again
+         *        false: copy is consistent
+         */
+        inline bool ReadRetry(uint32_t seq) const volatile
+        {
+            HAL_BOARD_MemBarrier();
+            return (_seq != seq);
+        }
+
+    private:
+        volatile uint32_t   _seq;
+};
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSSEQLOCK_H_ */
@@ -0,0 +1,289 @@
+/**
+ * tsTrace.cpp
+ *
+ *  Created on: 18. 10. 2026.
+ */
+#include "taskScheduler.h"
+#include "tsTrace.h"
+
+///-----------------------------------------------------------------------------
+///                      Encoding & decoding                            [PUBLIC]
+///-----------------------------------------------------------------------------
+
+/**
+ * Encode a record into a byte stream
+ * @param rec record to encode
+ * @param lastTime time of previously encoded record, updated to rec.time
+ * @param dst destination buffer, at least TS_TRACE_MAX_REC bytes long
+ * @return number of bytes written into dst (0 if record can't be encoded)
+ */
+uint32_t TS_TraceEncode(const struct _tsTraceRec &rec, uint64_t &lastTime,
+                        uint8_t *dst)
+{
+    uint32_t n = 0;
+
+    if (rec.argN > TS_TRACE_MAX_ARGS)
+        return 0;
+
+    dst[n++] = rec.type;
+    n += putVarint((rec.time > lastTime) ? (rec.time - lastTime) : 0, dst + n);
+
+    switch (rec.type)
+    {
+    case TS_TRACE_SYNC:
+        dst[n++] = rec.libUID;
+        dst[n++] = rec.taskID;
+        n += putVarint(zigzag(rec.tsTime), dst + n);
+        n += putVarint(zigzag(rec.period), dst + n);
+        n += putVarint(zigzag(rec.repeats), dst + n);
+        n += putVarint(rec.PID, dst + n);
+        break;
+    case TS_TRACE_KILLMATCH:
+        dst[n++] = rec.libUID;
+        dst[n++] = rec.taskID;
+        //  Fall through - same payload as TS_TRACE_ARGS after this point
+    case TS_TRACE_ARGS:
+        n += putVarint(rec.argN, dst + n);
+        memcpy(dst + n, rec.args, rec.argN);
+        n += rec.argN;
+        break;
+    case TS_TRACE_KILLPID:
+        n += putVarint(rec.PID, dst + n);
+        break;
+    case TS_TRACE_DISPATCH:
+        dst[n++] = rec.libUID;
+        dst[n++] = rec.taskID;
+        n += putVarint(rec.PID, dst + n);
+        n += putVarint(zigzag(rec.late), dst + n);
+        n += putVarint(rec.runtime, dst + n);
+        break;
+    default:
+        return 0;
+    }
+
+    //  Keep relative times monotonic even if record is older than last one
+    if (rec.time > lastTime)
+        lastTime = rec.time;
+
+    return n;
+}
+
+/**
+ * Decode a single record from a byte stream
+ * @param src pointer to the beginning of the record in stream
+ * @param len number of bytes available in src
+ * @param lastTime time of previously decoded record, updated to rec.time
+ * @param rec decoded record; rec.args points into src
+ * @return number of bytes consumed, 0 if record is incomplete or malformed
+ */
+uint32_t TS_TraceDecode(const uint8_t *src, uint32_t len, uint64_t &lastTime,
+                        struct _tsTraceRec &rec)
+{
+    const uint8_t *p = src, *end = src + len;
+    uint64_t v;
+    uint32_t n;
+
+//  Read next varint into 'v', bail out if stream is incomplete
+#define _TRACE_VARINT() \
+    if ((n = getVarint(p, end, &v)) == 0) return 0; \
+    p += n;
+//  Read next raw byte into 'X', bail out if stream is incomplete
+#define _TRACE_BYTE(X) \
+    if (p >= end) return 0; \
+    X = *(p++);
+
+    memset(&rec, 0, sizeof(rec));
+    _TRACE_BYTE(rec.type);
+    _TRACE_VARINT();
+    rec.time = lastTime + v;
+
+    switch (rec.type)
+    {
+    case TS_TRACE_SYNC:
+        _TRACE_BYTE(rec.libUID);
+        _TRACE_BYTE(rec.taskID);
+        _TRACE_VARINT();
+        rec.tsTime = unzigzag(v);
+        _TRACE_VARINT();
+        rec.period = (int32_t)unzigzag(v);
+        _TRACE_VARINT();
+        rec.repeats = (int32_t)unzigzag(v);
+        _TRACE_VARINT();
+        rec.PID = (uint16_t)v;
+        break;
+    case TS_TRACE_KILLMATCH:
+        _TRACE_BYTE(rec.libUID);
+        _TRACE_BYTE(rec.taskID);
+        //  Fall through - same payload as TS_TRACE_ARGS after this point
+    case TS_TRACE_ARGS:
+        _TRACE_VARINT();
+        if ((v > TS_TRACE_MAX_ARGS) || ((uint64_t)(end - p) < v))
+            return 0;
+        rec.argN = (uint16_t)v;
+        rec.args = p;
+        p += v;
+        break;
+    case TS_TRACE_KILLPID:
+        _TRACE_VARINT();
+        rec.PID = (uint16_t)v;
+        break;
+    case TS_TRACE_DISPATCH:
+        _TRACE_BYTE(rec.libUID);
+        _TRACE_BYTE(rec.taskID);
+        _TRACE_VARINT();
+        rec.PID = (uint16_t)v;
+        _TRACE_VARINT();
+        rec.late = (int32_t)unzigzag(v);
+        _TRACE_VARINT();
+        rec.runtime = (uint32_t)v;
+        break;
+    default:
+        return 0;
+    }
+
+#undef _TRACE_VARINT
+#undef _TRACE_BYTE
+
+    lastTime = rec.time;
+
+    return (uint32_t)(p - src);
+}
+
+#if defined(__HAL_USE_TASKSCH__) && defined(_TS_TRACE_)
+
+///-----------------------------------------------------------------------------
+///                      Recording on target                            [PUBLIC]
+///-----------------------------------------------------------------------------
+
+//  FIFO holding recorded stream; _wr and _rd are free-running indexes
+static uint8_t  _traceBuf[TS_TRACE_BUF_LEN];
+static uint32_t _traceWr = 0,
+                _traceRd = 0;
+//  Time of the last record written into FIFO
+static uint64_t _traceLastT = 0;
+//  Number of records that were dropped because FIFO was full
+static uint32_t _traceDropped = 0;
+
+/**
+ * Encode record and push it into FIFO as a whole, or drop it if it doesn't fit
+ */
+static void _TracePush(const struct _tsTraceRec &rec)
+{
+    uint8_t tmp[TS_TRACE_MAX_REC];
+    uint64_t lastT = _traceLastT;
+    uint32_t n = TS_TraceEncode(rec, lastT, tmp);
+
+    if ((n == 0) || ((TS_TRACE_BUF_LEN - (_traceWr - _traceRd)) < n))
+    {
+        _traceDropped++;
+        return;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+        _traceBuf[(_traceWr + i) % TS_TRACE_BUF_LEN] = tmp[i];
+    _traceWr += n;
+    _traceLastT = lastT;
+}
+
+void TS_TraceSync(uint64_t now, uint8_t libUID, uint8_t taskID, int64_t time,
+                  int32_t period, int32_t rep, uint16_t PID)
+{
+    struct _tsTraceRec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.type = TS_TRACE_SYNC;
+    rec.time = now;
+    rec.libUID = libUID;
+    rec.taskID = taskID;
+    rec.tsTime = time;
+    rec.period = period;
+    rec.repeats = rep;
+    rec.PID = PID;
+    _TracePush(rec);
+}
+
+void TS_TraceArgs(uint64_t now, const void *arg, uint16_t argLen)
+{
+    struct _tsTraceRec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.type = TS_TRACE_ARGS;
+    rec.time = now;
+    rec.argN = argLen;
+    rec.args = (const uint8_t*)arg;
+    _TracePush(rec);
+}
+
+void TS_TraceKillPID(uint64_t now, uint16_t PID)
+{
+    struct _tsTraceRec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.type = TS_TRACE_KILLPID;
+    rec.time = now;
+    rec.PID = PID;
+    _TracePush(rec);
+}
+
+void TS_TraceKillMatch(uint64_t now, uint8_t libUID, uint8_t taskID,
+                       const void *arg, uint16_t argLen)
+{
+    struct _tsTraceRec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.type = TS_TRACE_KILLMATCH;
+    rec.time = now;
+    rec.libUID = libUID;
+    rec.taskID = taskID;
+    rec.argN = argLen;
+    rec.args = (const uint8_t*)arg;
+    _TracePush(rec);
+}
+
+void TS_TraceDispatch(uint64_t now, uint8_t libUID, uint8_t taskID,
+                      uint16_t PID, int32_t late, uint32_t runtime)
+{
+    struct _tsTraceRec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.type = TS_TRACE_DISPATCH;
+    rec.time = now;
+    rec.libUID = libUID;
+    rec.taskID = taskID;
+    rec.PID = PID;
+    rec.late = late;
+    rec.runtime = runtime;
+    _TracePush(rec);
+}
+
+/**
+ * Move recorded stream out of FIFO, e.g. to send it over serial port
+ * @param dst destination buffer
+ * @param maxLen size of destination buffer
+ * @return number of bytes copied into dst
+ */
+uint16_t TS_TraceFetch(uint8_t *dst, uint16_t maxLen)
+{
+    uint16_t n = 0;
+
+    //  Sensitive task, disable all interrupts
+    HAL_BOARD_InterruptEnable(false);
+
+    while ((n < maxLen) && (_traceRd != _traceWr))
+        dst[n++] = _traceBuf[(_traceRd++) % TS_TRACE_BUF_LEN];
+
+    //  Sensitive task done, enable interrupts again
+    HAL_BOARD_InterruptEnable(true);
+
+    return n;
+}
+
+/**
+ * Return number of records dropped because FIFO was full
+ */
+uint32_t TS_TraceDropped()
+{
+    return _traceDropped;
+}
+
+#endif  /* __HAL_USE_TASKSCH__ && _TS_TRACE_ */
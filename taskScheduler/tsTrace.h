@@ -0,0 +1,89 @@
+/**
+ *  tsTrace.h
+ *
+ *  Created on: 18.10.2026.
+ *
+ *  Task scheduler extension for recording calls to scheduler API
+ *  @version 1.0
+ *  V1.0
+ *  +Compact binary recording of SyncTask*, AddArgs, RemoveTask and task
+ *  dispatches into a byte FIFO which can be read out at any time and replayed
+ *  on host (see host/tsReplay.cpp)
+ *
+ *  Stream is a sequence of records, all multi-byte integers are varints (7 bits
+ *  per byte, LSB first, MSB set on all but the last byte). Signed integers are
+ *  zig-zag encoded before being written as varints. Every record starts with:
+ *      type(uint8_t) | timeDelta(varint, ms since previous record)
+ *  followed by type-specific payload:
+ *      SYNC:       libUID | taskID | time(zz) | period(zz) | repeats(zz) | PID
+ *      ARGS:       argN | args[argN]
+ *      KILLPID:    PID
+ *      KILLMATCH:  libUID | taskID | argN | args[argN]
+ *      DISPATCH:   libUID | taskID | PID | late(zz) | runtime
+ *  libUID and taskID are always a single raw byte. Arguments of SYNC are
+ *  recorded as given by the caller (i.e. relative time is kept relative), PID
+ *  is the one task scheduler assigned to the new task.
+ */
+#include "hwconfig.h"
+#include "libs/myLib.h"
+
+#ifndef ROVERKERNEL_TASKSCHEDULER_TSTRACE_H_
+#define ROVERKERNEL_TASKSCHEDULER_TSTRACE_H_
+
+//  Types of records in trace stream
+#define TS_TRACE_SYNC       1
+#define TS_TRACE_ARGS       2
+#define TS_TRACE_KILLPID    3
+#define TS_TRACE_KILLMATCH  4
+#define TS_TRACE_DISPATCH   5
+
+//  Size of the FIFO holding recorded stream on the target (in bytes)
+#define TS_TRACE_BUF_LEN    2048
+//  Arguments longer than this are not recorded (record is dropped)
+#define TS_TRACE_MAX_ARGS   255
+//  Upper bound on size of a single encoded record (in bytes)
+#define TS_TRACE_MAX_REC    (TS_TRACE_MAX_ARGS + 48)
+
+/**
+ * Single decoded record from a trace stream
+ */
+struct _tsTraceRec
+{
+    uint8_t         type;       //  One of TS_TRACE_* record types
+    uint64_t        time;       //  Absolute time of the record (in ms)
+    uint8_t         libUID;
+    uint8_t         taskID;
+    uint16_t        PID;
+    int64_t         tsTime;     //  SYNC: time argument as given by caller
+    int32_t         period;     //  SYNC: period (0 for one-off tasks)
+    int32_t         repeats;    //  SYNC: repeat counter as given by caller
+    int32_t         late;       //  DISPATCH: start time - scheduled time (ms)
+    uint32_t        runtime;    //  DISPATCH: runtime of the service (ms)
+    uint16_t        argN;       //  ARGS/KILLMATCH: number of argument bytes
+    const uint8_t   *args;      //  ARGS/KILLMATCH: points into decoded stream
+};
+
+//  Recording API, only effective if _TS_TRACE_ is defined in taskScheduler.h
+//  All of these have to be called with interrupts disabled
+extern void     TS_TraceSync(uint64_t now, uint8_t libUID, uint8_t taskID,
+                             int64_t time, int32_t period, int32_t rep,
+                             uint16_t PID);
+extern void     TS_TraceArgs(uint64_t now, const void *arg, uint16_t argLen);
+extern void     TS_TraceKillPID(uint64_t now, uint16_t PID);
+extern void     TS_TraceKillMatch(uint64_t now, uint8_t libUID, uint8_t taskID,
+                                  const void *arg, uint16_t argLen);
+extern void     TS_TraceDispatch(uint64_t now, uint8_t libUID, uint8_t taskID,
+                                 uint16_t PID, int32_t late, uint32_t runtime);
+
+//  Reading out recorded stream
+extern uint16_t TS_TraceFetch(uint8_t *dst, uint16_t maxLen);
+extern uint32_t TS_TraceDropped();
+
+//  Encoding/decoding of recorded stream
+extern uint32_t TS_TraceEncode(const struct _tsTraceRec &rec,
+                               uint64_t &lastTime, uint8_t *dst);
+extern uint32_t TS_TraceDecode(const uint8_t *src, uint32_t len,
+                               uint64_t &lastTime, struct _tsTraceRec &rec);
+
+
+#endif /* ROVERKERNEL_TASKSCHEDULER_TSTRACE_H_ */
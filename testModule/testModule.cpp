@@ -5,7 +5,7 @@
  *      Author: v125
  */
 #include "testModule/testModule.h"
-#include "serialPort/uartHW.h"
+#include "serialPort/deferredLog.h"
 
 //  Integration with event log, if it's present
 #ifdef __HAL_USE_EVENTLOG__
@@ -176,7 +176,7 @@ int32_t TestMod::PrintInt16(int16_t intToPrint, uint8_t N)
 {
     //  Print the line containing the given number N times
     for (uint8_t i = 0; i < N; i++)
-        DEBUG_WRITE("I'm service 0 printing int16_t: %d\n", intToPrint);
+        DLOG(TM_PRINT_INT, intToPrint);
 
     return STATUS_OK;
 }
@@ -203,11 +203,11 @@ int32_t TestMod::PrintString(char *stringToPrint)
     //  Print out message based on the length of the string
     if ((i+1) < sizeLimit)
     {
-        DEBUG_WRITE("I'm service 1 printing a string: %s\n", stringToPrint);
+        DLOG(TM_PRINT_STR, stringToPrint);
     }
     else
     {
-        DEBUG_WRITE("I'm service 1 printing a string but there was an error with you string\n");
+        DLOG(TM_PRINT_STR_ERR);
         retVal = STATUS_ARG_ERR;
     }
 
@@ -221,7 +221,7 @@ int32_t TestMod::PrintString(char *stringToPrint)
  */
 int32_t TestMod::PrintFloat(float floatToPrint)
 {
-    DEBUG_WRITE("I'm service 2 printing int16_t: %d.%d\n", _FTOI_(floatToPrint));
+    DLOG(TM_PRINT_FLOAT, floatToPrint);
 
     return STATUS_OK;
 }
@@ -10,7 +10,9 @@
 
 MEMORY
 {
-    FLASH (RX) : origin = 0x00000000, length = 0x00100000
+    /* Last 64 KB are kept for persistent event log, see HAL_FLASH_BASE */
+    /* in HAL/tm4c1294/hal_flash_tm4c.h                                  */
+    FLASH (RX) : origin = 0x00000000, length = 0x000F0000
     SRAM (RWX) : origin = 0x20000000, length = 0x00040000
 }
 